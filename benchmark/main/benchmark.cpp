@@ -0,0 +1,91 @@
+#include "benchmark.h"
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#if CONFIG_IDF_TARGET_LINUX
+#include <malloc.h>
+#else
+#include "esp_heap_caps.h"
+#endif
+
+//==============================================================================
+
+const PL::BlackBoxHardwareInfo BlackBox::hardwareInfo = {"Benchmark Hardware", {1, 0, 0}, "1234567890"};
+const PL::BlackBoxFirmwareInfo BlackBox::firmwareInfo = {"Benchmark Firmware", {1, 0, 0}};
+
+std::shared_ptr<PL::Uart> uart = std::make_shared<PL::Uart>(UART_NUM_1);
+std::shared_ptr<PL::EspWiFiStation> wifi = std::make_shared<PL::EspWiFiStation>();
+
+static std::atomic<size_t> numberOfAllocations = 0;
+static std::atomic<size_t> allocatedSize = 0;
+
+//==============================================================================
+
+// The global allocation functions are replaced to count the heap churn (operator new[] and the nothrow variants call operator new)
+void* operator new(size_t size) {
+  numberOfAllocations++;
+  allocatedSize += size;
+  void* ptr = malloc(size ? size : 1);
+  if (!ptr)
+    abort();
+  return ptr;
+}
+
+//==============================================================================
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+//==============================================================================
+
+void operator delete(void* ptr, size_t size) noexcept {
+  free(ptr);
+}
+
+//==============================================================================
+
+PL::BlackBoxFirmwareInfo BlackBox::GetFirmwareInfo() {
+  return firmwareInfo;
+}
+
+//==============================================================================
+
+BenchmarkAllocationCounters GetBenchmarkAllocationCounters() {
+  return {numberOfAllocations, allocatedSize};
+}
+
+//==============================================================================
+
+size_t GetBenchmarkUsedHeapSize() {
+#if CONFIG_IDF_TARGET_LINUX
+  return mallinfo2().uordblks;
+#else
+  return heap_caps_get_total_size(MALLOC_CAP_DEFAULT) - heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+#endif
+}
+
+//==============================================================================
+
+void PrintBenchmarkResult(BenchmarkResult& result) {
+  std::sort(result.latencies.begin(), result.latencies.end());
+  size_t numberOfOperations = result.latencies.size();
+  auto percentile = [&result, numberOfOperations](size_t percent) -> uint32_t {
+    return numberOfOperations ? result.latencies[(numberOfOperations - 1) * percent / 100] : 0;
+  };
+  double operationsPerSecond = result.duration ? numberOfOperations * 1000000.0 / result.duration : 0;
+  double allocationsPerOperation = numberOfOperations ? (double)result.allocationCounters.numberOfAllocations / numberOfOperations : 0;
+  double allocatedBytesPerOperation = numberOfOperations ? (double)result.allocationCounters.allocatedSize / numberOfOperations : 0;
+
+  printf("{\"benchmark\":\"%s\",\"scenario\":\"%s\",\"clients\":%u,\"operations\":%u,\"errors\":%u,\"durationUs\":%" PRId64 ","
+    "\"operationsPerSecond\":%.1f,\"p50Us\":%" PRIu32 ",\"p99Us\":%" PRIu32 ",\"maxUs\":%" PRIu32 ","
+    "\"allocationsPerOperation\":%.2f,\"allocatedBytesPerOperation\":%.1f",
+    result.benchmark.c_str(), result.scenario.c_str(), (unsigned int)result.numberOfClients, (unsigned int)numberOfOperations,
+    (unsigned int)result.numberOfErrors, result.duration, operationsPerSecond, percentile(50), percentile(99), percentile(100),
+    allocationsPerOperation, allocatedBytesPerOperation);
+  for (auto& counter : result.counters)
+    printf(",\"%s\":%" PRId64, counter.first.c_str(), counter.second);
+  printf("}\n");
+  fflush(stdout);
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "pl_blackbox.h"
+#include <utility>
+#include <vector>
+
+//==============================================================================
+
+class BlackBox : public PL::BlackBox {
+public:
+  static const PL::BlackBoxHardwareInfo hardwareInfo;
+  static const PL::BlackBoxFirmwareInfo firmwareInfo;
+
+  PL::BlackBoxFirmwareInfo GetFirmwareInfo() override;
+};
+
+//==============================================================================
+
+extern std::shared_ptr<PL::Uart> uart;
+extern std::shared_ptr<PL::EspWiFiStation> wifi;
+
+//==============================================================================
+
+/// @brief Number and total size of the C++ heap allocations (operator new) since the start
+struct BenchmarkAllocationCounters {
+  size_t numberOfAllocations;
+  size_t allocatedSize;
+};
+
+/// @brief Benchmark run result
+struct BenchmarkResult {
+  /// @brief Benchmark name
+  std::string benchmark;
+  /// @brief Scenario name
+  std::string scenario;
+  /// @brief Number of concurrent clients
+  size_t numberOfClients = 1;
+  /// @brief Number of failed operations
+  size_t numberOfErrors = 0;
+  /// @brief Run duration in microseconds
+  int64_t duration = 0;
+  /// @brief Operation latencies in microseconds
+  std::vector<uint32_t> latencies;
+  /// @brief Heap allocations made during the run
+  BenchmarkAllocationCounters allocationCounters = {};
+  /// @brief Additional benchmark-specific counters
+  std::vector<std::pair<std::string, int64_t>> counters;
+};
+
+//==============================================================================
+
+/// @brief Gets the C++ heap allocation counters
+/// @return allocation counters
+BenchmarkAllocationCounters GetBenchmarkAllocationCounters();
+
+/// @brief Gets the used heap size (including the FreeRTOS objects and the C allocations)
+/// @return used heap size in bytes
+size_t GetBenchmarkUsedHeapSize();
+
+/// @brief Prints the benchmark result as a single-line JSON object
+/// @param result benchmark result (the latencies are sorted)
+void PrintBenchmarkResult(BenchmarkResult& result);
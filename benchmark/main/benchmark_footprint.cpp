@@ -0,0 +1,121 @@
+#include "benchmark_footprint.h"
+#include <cinttypes>
+#include <functional>
+
+//==============================================================================
+
+// Heap budgets per instance in bytes (measured on the 64-bit host, the 32-bit targets use less)
+static const size_t blackBoxBudget = 32768;
+static const size_t configurationBudget = 8192;
+static const size_t modbusServerBudget = 16384;
+static const size_t httpServerBudget = 16384;
+static const size_t serverBudget = 8192;
+static const size_t sntpClientBudget = 4096;
+// Several instances are created to average out the growth of the containers
+static const size_t numberOfInstances = 4;
+
+//==============================================================================
+
+static size_t MeasureFootprint(const char* type, size_t objectSize, size_t budget, const std::function<std::shared_ptr<void>(size_t)>& create);
+
+//==============================================================================
+
+size_t BenchmarkBlackBoxFootprint() {
+  size_t numberOfExceededBudgets = 0;
+
+  numberOfExceededBudgets += MeasureFootprint("BlackBox", sizeof(BlackBox), blackBoxBudget, [](size_t) {
+    return std::make_shared<BlackBox>();
+  });
+
+  // Configurations (the hardware interfaces and servers are shared by the instances and are not measured)
+  {
+    auto blackBox = std::make_shared<BlackBox>();
+    auto uartModbusServer = std::make_shared<PL::ModbusServer>(uart, PL::ModbusProtocol::rtu, 1);
+    auto networkModbusServer = std::make_shared<PL::ModbusServer>(502);
+    auto sntpClient = std::make_shared<PL::BlackBoxSntpClient>();
+
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxUartConfiguration", sizeof(PL::BlackBoxUartConfiguration), configurationBudget, [&](size_t i) {
+      return blackBox->AddUartConfiguration(uart, "fpUart" + std::to_string(i));
+    });
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxWiFiStationConfiguration", sizeof(PL::BlackBoxWiFiStationConfiguration), configurationBudget, [&](size_t i) {
+      return blackBox->AddWiFiConfiguration(wifi, "fpWiFi" + std::to_string(i));
+    });
+#if CONFIG_IDF_TARGET_LINUX
+    // The Ethernet of the hardware targets needs a board-specific MAC and PHY
+    auto ethernet = std::make_shared<PL::EspEthernet>();
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxEthernetConfiguration", sizeof(PL::BlackBoxEthernetConfiguration), configurationBudget, [&](size_t i) {
+      return blackBox->AddEthernetConfiguration(ethernet, "fpEth" + std::to_string(i));
+    });
+#endif
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxModbusServerConfiguration.stream", sizeof(PL::BlackBoxModbusServerConfiguration), configurationBudget, [&](size_t i) {
+      return blackBox->AddModbusServerConfiguration(uartModbusServer, "fpUartMb" + std::to_string(i));
+    });
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxModbusServerConfiguration.network", sizeof(PL::BlackBoxModbusServerConfiguration), configurationBudget, [&](size_t i) {
+      return blackBox->AddModbusServerConfiguration(networkModbusServer, "fpNwMb" + std::to_string(i));
+    });
+#if !CONFIG_IDF_TARGET_LINUX
+    // The HTTP server and mDNS components are not available for the host target
+    auto httpServer = std::make_shared<PL::HttpServer>();
+    auto mdnsServer = std::make_shared<PL::MdnsServer>();
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxHttpServerConfiguration", sizeof(PL::BlackBoxHttpServerConfiguration), configurationBudget, [&](size_t i) {
+      return blackBox->AddHttpServerConfiguration(httpServer, "fpHttp" + std::to_string(i));
+    });
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxMdnsServerConfiguration", sizeof(PL::BlackBoxMdnsServerConfiguration), configurationBudget, [&](size_t i) {
+      return blackBox->AddMdnsServerConfiguration(mdnsServer, "fpMdns" + std::to_string(i));
+    });
+#endif
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxSntpConfiguration", sizeof(PL::BlackBoxSntpConfiguration), configurationBudget, [&](size_t i) {
+      return blackBox->AddSntpConfiguration(sntpClient, "fpSntp" + std::to_string(i));
+    });
+  }
+
+  // Servers (the servers are not enabled, so the task stacks are not included)
+  {
+    auto blackBox = std::make_shared<BlackBox>();
+
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxModbusServer.stream", sizeof(PL::BlackBoxModbusServer), modbusServerBudget, [&](size_t) {
+      return std::make_shared<PL::BlackBoxModbusServer>(blackBox, uart, PL::ModbusProtocol::rtu, 1);
+    });
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxModbusServer.network", sizeof(PL::BlackBoxModbusServer), modbusServerBudget, [&](size_t i) {
+      return std::make_shared<PL::BlackBoxModbusServer>(blackBox, 1502 + i);
+    });
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxStreamServer", sizeof(PL::BlackBoxStreamServer), serverBudget, [&](size_t) {
+      return std::make_shared<PL::BlackBoxStreamServer>(blackBox, uart);
+    });
+#if !CONFIG_IDF_TARGET_LINUX
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxHttpServer", sizeof(PL::BlackBoxHttpServer), httpServerBudget, [&](size_t i) {
+      return std::make_shared<PL::BlackBoxHttpServer>(blackBox, 1080 + i);
+    });
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxMdnsService", sizeof(PL::BlackBoxMdnsService), serverBudget, [&](size_t) {
+      return std::make_shared<PL::BlackBoxMdnsService>(blackBox);
+    });
+#endif
+    numberOfExceededBudgets += MeasureFootprint("BlackBoxSntpClient", sizeof(PL::BlackBoxSntpClient), sntpClientBudget, [&](size_t) {
+      return std::make_shared<PL::BlackBoxSntpClient>();
+    });
+  }
+
+  return numberOfExceededBudgets;
+}
+
+//==============================================================================
+
+static size_t MeasureFootprint(const char* type, size_t objectSize, size_t budget, const std::function<std::shared_ptr<void>(size_t)>& create) {
+  std::vector<std::shared_ptr<void>> instances;
+  instances.reserve(numberOfInstances);
+
+  BenchmarkAllocationCounters startAllocationCounters = GetBenchmarkAllocationCounters();
+  size_t startUsedHeapSize = GetBenchmarkUsedHeapSize();
+  for (size_t i = 0; i < numberOfInstances; i++)
+    instances.push_back(create(i));
+  int64_t heapSize = (int64_t)GetBenchmarkUsedHeapSize() - (int64_t)startUsedHeapSize;
+  BenchmarkAllocationCounters endAllocationCounters = GetBenchmarkAllocationCounters();
+
+  int64_t heapSizePerInstance = heapSize / (int64_t)numberOfInstances;
+  double allocationsPerInstance = (double)(endAllocationCounters.numberOfAllocations - startAllocationCounters.numberOfAllocations) / numberOfInstances;
+  bool withinBudget = heapSizePerInstance <= (int64_t)budget;
+  printf("{\"benchmark\":\"footprint\",\"type\":\"%s\",\"objectSize\":%u,\"heapBytesPerInstance\":%" PRId64 ",\"allocationsPerInstance\":%.2f,\"budget\":%u,\"withinBudget\":%s}\n",
+    type, (unsigned int)objectSize, heapSizePerInstance, allocationsPerInstance, (unsigned int)budget, withinBudget ? "true" : "false");
+  fflush(stdout);
+  return withinBudget ? 0 : 1;
+}
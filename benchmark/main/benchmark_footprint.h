@@ -0,0 +1,6 @@
+#pragma once
+#include "benchmark.h"
+
+//==============================================================================
+
+size_t BenchmarkBlackBoxFootprint();
@@ -0,0 +1,176 @@
+#include "benchmark_modbus.h"
+#include "freertos/event_groups.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <atomic>
+
+//==============================================================================
+
+enum class ModbusScenario {
+  generalPoll,
+  interfacePaging,
+  holdingRegisterWrite,
+  saveConfiguration,
+  mixed
+};
+
+struct ModbusClientTaskParameters {
+  ModbusScenario scenario;
+  size_t numberOfOperations;
+  uint32_t* latencies;
+  std::atomic<size_t>* numberOfErrors;
+  EventGroupHandle_t eventGroup;
+  EventBits_t readyBit;
+  EventBits_t doneBit;
+  uint16_t numberOfHardwareInterfaces;
+};
+
+static const uint16_t port = 502;
+static const size_t maxNumberOfClients = CONFIG_BENCHMARK_MODBUS_MAX_NUMBER_OF_CLIENTS;
+static const size_t operationsPerClient = CONFIG_BENCHMARK_MODBUS_TRANSACTIONS_PER_CLIENT;
+// Saving writes the NVS, so the save scenario is run with fewer operations
+static const size_t saveOperationsPerClient = std::max<size_t>(operationsPerClient / 20, 1);
+static const EventBits_t startBit = BIT0;
+static const char benchmarkName[PL::BlackBoxModbusServer::maxNameSize] = "Benchmark Name";
+// The addresses are taken from the golden memory map, so the benchmark uses the layout that the Modbus clients use
+static constexpr uint16_t selectedHardwareInterfaceIndexAddress = PL::GetBlackBoxModbusMemoryMapAddress("generalConfigurationHR", "selectedHardwareInterfaceIndex");
+static constexpr uint16_t nameAddress = PL::GetBlackBoxModbusMemoryMapAddress("generalConfigurationHR", "name");
+static constexpr uint16_t saveConfigurationCoil = PL::GetBlackBoxModbusMemoryMapCoil("generalConfigurationHR", "saveConfiguration");
+
+//==============================================================================
+
+static esp_err_t ExecuteOperation(PL::ModbusClient& client, ModbusScenario scenario, size_t operationIndex, uint16_t numberOfHardwareInterfaces, uint16_t* data);
+static void ModbusClientTask(void* parameters);
+static void RunScenario(ModbusScenario scenario, const char* scenarioName, size_t numberOfClients, size_t operationsPerClient, uint16_t numberOfHardwareInterfaces);
+
+//==============================================================================
+
+void BenchmarkBlackBoxModbus(std::shared_ptr<BlackBox> blackBox) {
+  blackBox->AddUartConfiguration(uart, "uart");
+  blackBox->AddWiFiConfiguration(wifi, "wifi");
+
+  auto server = std::make_shared<PL::BlackBoxModbusServer>(blackBox, port);
+  if (auto networkServer = std::dynamic_pointer_cast<PL::NetworkServer>(server->GetBaseServer().lock()))
+    ESP_ERROR_CHECK(networkServer->SetMaxNumberOfClients(maxNumberOfClients));
+  blackBox->AddModbusServerConfiguration(server, "bbMbSrv");
+  ESP_ERROR_CHECK(server->Enable());
+  vTaskDelay(10);
+
+  uint16_t numberOfHardwareInterfaces = blackBox->GetHardwareInterfaceConfigurations().size();
+  // 1, 2, 4 ... clients up to the maximum number of clients
+  for (size_t numberOfClients = 1;; numberOfClients = std::min(numberOfClients * 2, maxNumberOfClients)) {
+    RunScenario(ModbusScenario::generalPoll, "generalPoll", numberOfClients, operationsPerClient, numberOfHardwareInterfaces);
+    RunScenario(ModbusScenario::interfacePaging, "interfacePaging", numberOfClients, operationsPerClient, numberOfHardwareInterfaces);
+    RunScenario(ModbusScenario::holdingRegisterWrite, "holdingRegisterWrite", numberOfClients, operationsPerClient, numberOfHardwareInterfaces);
+    RunScenario(ModbusScenario::saveConfiguration, "saveConfiguration", numberOfClients, saveOperationsPerClient, numberOfHardwareInterfaces);
+    RunScenario(ModbusScenario::mixed, "mixed", numberOfClients, operationsPerClient, numberOfHardwareInterfaces);
+    if (numberOfClients == maxNumberOfClients)
+      break;
+  }
+
+  ESP_ERROR_CHECK(server->Disable());
+}
+
+//==============================================================================
+
+static esp_err_t ExecuteOperation(PL::ModbusClient& client, ModbusScenario scenario, size_t operationIndex, uint16_t numberOfHardwareInterfaces, uint16_t* data) {
+  if (scenario == ModbusScenario::mixed) {
+    // 70% general polls, 20% interface paging, 9% holding register writes, 1% saves
+    size_t percent = operationIndex % 100;
+    if (percent < 70)
+      scenario = ModbusScenario::generalPoll;
+    else if (percent < 90)
+      scenario = ModbusScenario::interfacePaging;
+    else if (percent < 99)
+      scenario = ModbusScenario::holdingRegisterWrite;
+    else
+      scenario = ModbusScenario::saveConfiguration;
+  }
+
+  switch (scenario) {
+    case ModbusScenario::generalPoll:
+      return client.ReadInputRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL);
+
+    case ModbusScenario::interfacePaging: {
+      // Selects the next hardware interface and reads its input registers (2 transactions)
+      uint16_t hardwareInterfaceIndex = numberOfHardwareInterfaces ? operationIndex % numberOfHardwareInterfaces : 0;
+      esp_err_t error = client.WriteSingleHoldingRegister(selectedHardwareInterfaceIndexAddress, hardwareInterfaceIndex, NULL);
+      if (error != ESP_OK)
+        return error;
+      return client.ReadInputRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL);
+    }
+
+    case ModbusScenario::holdingRegisterWrite:
+      return client.WriteMultipleHoldingRegisters(nameAddress, sizeof(benchmarkName) / 2, benchmarkName, NULL);
+
+    case ModbusScenario::saveConfiguration:
+      return client.WriteSingleCoil(saveConfigurationCoil, true, NULL);
+
+    default:
+      return ESP_ERR_INVALID_ARG;
+  }
+}
+
+//==============================================================================
+
+static void ModbusClientTask(void* parameters) {
+  ModbusClientTaskParameters& taskParameters = *(ModbusClientTaskParameters*)parameters;
+  {
+    PL::ModbusClient client(PL::IpV4Address(127, 0, 0, 1), port);
+    uint16_t data[PL::BlackBoxModbusServer::registerMemoryAreaSize / 2];
+    // The first transaction connects the client, so it is not measured
+    if (client.ReadInputRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress, 1, data, NULL) != ESP_OK)
+      (*taskParameters.numberOfErrors)++;
+
+    xEventGroupSetBits(taskParameters.eventGroup, taskParameters.readyBit);
+    xEventGroupWaitBits(taskParameters.eventGroup, startBit, pdFALSE, pdTRUE, portMAX_DELAY);
+
+    for (size_t i = 0; i < taskParameters.numberOfOperations; i++) {
+      int64_t startTime = esp_timer_get_time();
+      if (ExecuteOperation(client, taskParameters.scenario, i, taskParameters.numberOfHardwareInterfaces, data) != ESP_OK)
+        (*taskParameters.numberOfErrors)++;
+      taskParameters.latencies[i] = esp_timer_get_time() - startTime;
+    }
+  }
+  xEventGroupSetBits(taskParameters.eventGroup, taskParameters.doneBit);
+  vTaskDelete(NULL);
+}
+
+//==============================================================================
+
+static void RunScenario(ModbusScenario scenario, const char* scenarioName, size_t numberOfClients, size_t operationsPerClient, uint16_t numberOfHardwareInterfaces) {
+  BenchmarkResult result;
+  result.benchmark = "modbus";
+  result.scenario = scenarioName;
+  result.numberOfClients = numberOfClients;
+  result.latencies.resize(numberOfClients * operationsPerClient);
+  std::atomic<size_t> numberOfErrors = 0;
+
+  EventGroupHandle_t eventGroup = xEventGroupCreate();
+  ESP_ERROR_CHECK(eventGroup ? ESP_OK : ESP_ERR_NO_MEM);
+  std::vector<ModbusClientTaskParameters> taskParameters(numberOfClients);
+  EventBits_t readyBits = 0;
+  EventBits_t doneBits = 0;
+  for (size_t i = 0; i < numberOfClients; i++) {
+    // Bit 0 is the start bit, the ready and done bits of the clients follow it
+    taskParameters[i] = {scenario, operationsPerClient, result.latencies.data() + i * operationsPerClient, &numberOfErrors, eventGroup,
+      (EventBits_t)1 << (1 + i), (EventBits_t)1 << (1 + maxNumberOfClients + i), numberOfHardwareInterfaces};
+    readyBits |= taskParameters[i].readyBit;
+    doneBits |= taskParameters[i].doneBit;
+    ESP_ERROR_CHECK(xTaskCreate(ModbusClientTask, "bm_modbus_client", 4096, &taskParameters[i], tskIDLE_PRIORITY + 1, NULL) == pdPASS ? ESP_OK : ESP_ERR_NO_MEM);
+  }
+  xEventGroupWaitBits(eventGroup, readyBits, pdFALSE, pdTRUE, portMAX_DELAY);
+
+  BenchmarkAllocationCounters startAllocationCounters = GetBenchmarkAllocationCounters();
+  int64_t startTime = esp_timer_get_time();
+  xEventGroupSetBits(eventGroup, startBit);
+  xEventGroupWaitBits(eventGroup, doneBits, pdFALSE, pdTRUE, portMAX_DELAY);
+  result.duration = esp_timer_get_time() - startTime;
+  BenchmarkAllocationCounters endAllocationCounters = GetBenchmarkAllocationCounters();
+  vEventGroupDelete(eventGroup);
+
+  result.allocationCounters.numberOfAllocations = endAllocationCounters.numberOfAllocations - startAllocationCounters.numberOfAllocations;
+  result.allocationCounters.allocatedSize = endAllocationCounters.allocatedSize - startAllocationCounters.allocatedSize;
+  result.numberOfErrors = numberOfErrors;
+  PrintBenchmarkResult(result);
+}
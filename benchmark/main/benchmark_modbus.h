@@ -0,0 +1,6 @@
+#pragma once
+#include "benchmark.h"
+
+//==============================================================================
+
+void BenchmarkBlackBoxModbus(std::shared_ptr<BlackBox> blackBox);
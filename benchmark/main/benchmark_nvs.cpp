@@ -0,0 +1,140 @@
+#include "benchmark_nvs.h"
+#include "nvs.h"
+#include "esp_timer.h"
+#include <functional>
+#if CONFIG_IDF_TARGET_LINUX && CONFIG_ESP_PARTITION_ENABLE_STATS
+#include "esp_private/partition_linux.h"
+#endif
+
+//==============================================================================
+
+struct NvsStorageStrategy {
+  const char* name;
+  bool snapshotSaving;
+  bool defaultProfile;
+  bool lazyLoading;
+};
+
+struct FlashCounters {
+  int64_t numberOfWrites;
+  int64_t writtenSize;
+  int64_t numberOfErases;
+};
+
+static const size_t iterations = CONFIG_BENCHMARK_NVS_ITERATIONS;
+static const NvsStorageStrategy strategies[] = {
+  {"namespaces", false, false, false},
+  {"snapshot", true, false, false},
+  {"defaultProfile", false, true, false},
+  {"lazyLoading", false, false, true}
+};
+
+//==============================================================================
+
+static std::shared_ptr<BlackBox> CreateBlackBox();
+static void RunOperation(std::shared_ptr<BlackBox> blackBox, const NvsStorageStrategy& strategy, const char* operationName,
+  const std::function<void(size_t)>& prepare, const std::function<void(size_t)>& operation);
+static FlashCounters GetFlashCounters();
+
+//==============================================================================
+
+void BenchmarkBlackBoxNvs() {
+  for (auto& strategy : strategies) {
+    auto blackBox = CreateBlackBox();
+    // The default profile has the parameter values of the created configurations, the device name differs from it
+    blackBox->SetDefaultProfile(strategy.defaultProfile ? blackBox->CreateProfile() : nullptr);
+    if (strategy.snapshotSaving)
+      blackBox->EnableSnapshotSaving();
+    if (strategy.lazyLoading)
+      blackBox->EnableLazyLoading();
+    blackBox->SetDeviceName("NVS Benchmark");
+
+    RunOperation(blackBox, strategy, "save", [&](size_t) { blackBox->EraseAllConfigurations(); }, [&](size_t) { blackBox->SaveAllConfigurations(); });
+    RunOperation(blackBox, strategy, "repeatedSave", nullptr, [&](size_t) { blackBox->SaveAllConfigurations(); });
+    RunOperation(blackBox, strategy, "changedSave", [&](size_t i) { blackBox->SetDeviceName(i % 2 ? "NVS Benchmark 1" : "NVS Benchmark 2"); },
+      [&](size_t) { blackBox->SaveAllConfigurations(); });
+    RunOperation(blackBox, strategy, "load", nullptr, [&](size_t) { blackBox->LoadAllConfigurations(); });
+    RunOperation(blackBox, strategy, "erase", [&](size_t) { blackBox->SaveAllConfigurations(); }, [&](size_t) { blackBox->EraseAllConfigurations(); });
+  }
+}
+
+//==============================================================================
+
+static std::shared_ptr<BlackBox> CreateBlackBox() {
+  auto blackBox = std::make_shared<BlackBox>();
+
+  blackBox->AddUartConfiguration(std::make_shared<PL::Uart>(UART_NUM_0), "nvsBmUart0");
+  blackBox->AddUartConfiguration(uart, "nvsBmUart1");
+  blackBox->AddWiFiConfiguration(wifi, "nvsBmWiFi");
+#if CONFIG_IDF_TARGET_LINUX
+  // The Ethernet of the hardware targets needs a board-specific MAC and PHY
+  blackBox->AddEthernetConfiguration(std::make_shared<PL::EspEthernet>(), "nvsBmEth");
+#endif
+
+  blackBox->AddModbusServerConfiguration(std::make_shared<PL::ModbusServer>(uart, PL::ModbusProtocol::rtu, 1), "nvsBmUartMb");
+  blackBox->AddModbusServerConfiguration(std::make_shared<PL::ModbusServer>(502), "nvsBmNwMb");
+#if !CONFIG_IDF_TARGET_LINUX
+  // The HTTP server and mDNS components are not available for the host target
+  blackBox->AddHttpServerConfiguration(std::make_shared<PL::HttpServer>(), "nvsBmHttp");
+  blackBox->AddMdnsServerConfiguration(std::make_shared<PL::MdnsServer>(), "nvsBmMdns");
+#endif
+  return blackBox;
+}
+
+//==============================================================================
+
+static void RunOperation(std::shared_ptr<BlackBox> blackBox, const NvsStorageStrategy& strategy, const char* operationName,
+    const std::function<void(size_t)>& prepare, const std::function<void(size_t)>& operation) {
+  BenchmarkResult result;
+  result.benchmark = "nvs";
+  result.scenario = std::string(strategy.name) + "." + operationName;
+  FlashCounters flashCounters = {};
+
+  for (size_t i = 0; i < iterations; i++) {
+    // Only the operation is measured
+    if (prepare)
+      prepare(i);
+    BenchmarkAllocationCounters startAllocationCounters = GetBenchmarkAllocationCounters();
+    FlashCounters startFlashCounters = GetFlashCounters();
+    int64_t startTime = esp_timer_get_time();
+    operation(i);
+    int64_t latency = esp_timer_get_time() - startTime;
+    FlashCounters endFlashCounters = GetFlashCounters();
+    BenchmarkAllocationCounters endAllocationCounters = GetBenchmarkAllocationCounters();
+
+    result.latencies.push_back(latency);
+    result.duration += latency;
+    result.allocationCounters.numberOfAllocations += endAllocationCounters.numberOfAllocations - startAllocationCounters.numberOfAllocations;
+    result.allocationCounters.allocatedSize += endAllocationCounters.allocatedSize - startAllocationCounters.allocatedSize;
+    flashCounters.numberOfWrites += endFlashCounters.numberOfWrites - startFlashCounters.numberOfWrites;
+    flashCounters.writtenSize += endFlashCounters.writtenSize - startFlashCounters.writtenSize;
+    flashCounters.numberOfErases += endFlashCounters.numberOfErases - startFlashCounters.numberOfErases;
+  }
+
+  // The flash counters are only available for the NVS partition image of the host (Linux) target
+#if CONFIG_IDF_TARGET_LINUX && CONFIG_ESP_PARTITION_ENABLE_STATS
+  result.counters.push_back({"flashWrites", flashCounters.numberOfWrites});
+  result.counters.push_back({"flashWrittenBytes", flashCounters.writtenSize});
+  result.counters.push_back({"flashErases", flashCounters.numberOfErases});
+#endif
+  // NVS usage after the last operation
+  nvs_stats_t nvsStats;
+  if (nvs_get_stats(NULL, &nvsStats) == ESP_OK) {
+    result.counters.push_back({"nvsUsedEntries", nvsStats.used_entries});
+    result.counters.push_back({"nvsFreeEntries", nvsStats.free_entries});
+    result.counters.push_back({"nvsNamespaces", nvsStats.namespace_count});
+  }
+  else
+    result.numberOfErrors++;
+  PrintBenchmarkResult(result);
+}
+
+//==============================================================================
+
+static FlashCounters GetFlashCounters() {
+#if CONFIG_IDF_TARGET_LINUX && CONFIG_ESP_PARTITION_ENABLE_STATS
+  return {(int64_t)esp_partition_get_write_ops(), (int64_t)esp_partition_get_write_bytes(), (int64_t)esp_partition_get_erase_ops()};
+#else
+  return {};
+#endif
+}
@@ -0,0 +1,6 @@
+#pragma once
+#include "benchmark.h"
+
+//==============================================================================
+
+void BenchmarkBlackBoxNvs();
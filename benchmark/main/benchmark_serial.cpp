@@ -0,0 +1,165 @@
+#include "benchmark_serial.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+//==============================================================================
+
+enum class SerialModbusScenario {
+  generalPoll,
+  interfacePaging
+};
+
+struct SerialModbusFrameSizes {
+  size_t requestSize;
+  size_t responseSize;
+};
+
+static const uint8_t stationAddress = 1;
+static const uint32_t baudRates[] = {9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600};
+static const size_t pollsPerBaudRate = CONFIG_BENCHMARK_SERIAL_MODBUS_POLLS;
+static const uint16_t numberOfPolledRegisters = PL::BlackBoxModbusServer::registerMemoryAreaSize / 2;
+// The address is taken from the golden memory map, so the benchmark uses the layout that the Modbus clients use
+static constexpr uint16_t selectedHardwareInterfaceIndexAddress = PL::GetBlackBoxModbusMemoryMapAddress("generalConfigurationHR", "selectedHardwareInterfaceIndex");
+// PDU sizes of the read registers and write single register transactions
+static const SerialModbusFrameSizes readRegistersPduSizes = {5, 2 + 2 * numberOfPolledRegisters};
+static const SerialModbusFrameSizes writeRegisterPduSizes = {5, 5};
+// RTU inter-frame silence above 19200 baud
+static const int64_t fixedInterFrameTime = 1750;
+static const TickType_t extraReadTimeout = 100 / portTICK_PERIOD_MS;
+
+//==============================================================================
+
+static void RunScenario(std::shared_ptr<PL::Uart> clientUart, PL::ModbusClient& client, PL::ModbusProtocol protocol,
+  SerialModbusScenario scenario, const char* scenarioName, uint16_t numberOfHardwareInterfaces);
+static size_t GetFrameSize(PL::ModbusProtocol protocol, size_t pduSize);
+static int64_t GetInterFrameTime(std::shared_ptr<PL::Uart> uart, PL::ModbusProtocol protocol);
+static void WaitUntil(int64_t time);
+
+//==============================================================================
+
+void BenchmarkBlackBoxSerialModbus(std::shared_ptr<BlackBox> blackBox) {
+  blackBox->AddUartConfiguration(uart, "uart");
+  blackBox->AddWiFiConfiguration(wifi, "wifi");
+  uint16_t numberOfHardwareInterfaces = blackBox->GetHardwareInterfaceConfigurations().size();
+
+  // The simulated UARTs of the host target are connected to each other and paced with the baud rate
+  auto serverUart = std::make_shared<PL::Uart>(UART_NUM_2);
+  auto clientUart = std::make_shared<PL::Uart>(UART_NUM_0);
+  ESP_ERROR_CHECK(PL::Uart::Connect(*serverUart, *clientUart));
+  for (auto& serialPort : {serverUart, clientUart}) {
+    ESP_ERROR_CHECK(serialPort->Initialize());
+    serialPort->EnableBaudRatePacing();
+    ESP_ERROR_CHECK(serialPort->Enable());
+  }
+
+  for (auto protocol : {PL::ModbusProtocol::rtu, PL::ModbusProtocol::ascii}) {
+    auto server = std::make_shared<PL::BlackBoxModbusServer>(blackBox, serverUart, protocol, stationAddress);
+    PL::ModbusClient client(clientUart, protocol);
+    ESP_ERROR_CHECK(client.SetStationAddress(stationAddress));
+
+    for (auto baudRate : baudRates) {
+      ESP_ERROR_CHECK(serverUart->SetBaudRate(baudRate));
+      ESP_ERROR_CHECK(clientUart->SetBaudRate(baudRate));
+      // The longest response is received within the read timeout
+      TickType_t readTimeout = clientUart->GetTransmissionTime(GetFrameSize(protocol, readRegistersPduSizes.responseSize)) / 1000 / portTICK_PERIOD_MS + extraReadTimeout;
+      ESP_ERROR_CHECK(clientUart->SetReadTimeout(readTimeout));
+
+      ESP_ERROR_CHECK(server->Enable());
+      vTaskDelay(10);
+      RunScenario(clientUart, client, protocol, SerialModbusScenario::generalPoll, "generalPoll", numberOfHardwareInterfaces);
+      RunScenario(clientUart, client, protocol, SerialModbusScenario::interfacePaging, "interfacePaging", numberOfHardwareInterfaces);
+      ESP_ERROR_CHECK(server->Disable());
+    }
+  }
+
+  ESP_ERROR_CHECK(clientUart->Disconnect());
+}
+
+//==============================================================================
+
+static void RunScenario(std::shared_ptr<PL::Uart> clientUart, PL::ModbusClient& client, PL::ModbusProtocol protocol,
+    SerialModbusScenario scenario, const char* scenarioName, uint16_t numberOfHardwareInterfaces) {
+  BenchmarkResult result;
+  result.benchmark = (protocol == PL::ModbusProtocol::rtu) ? "modbusRtu" : "modbusAscii";
+  result.scenario = scenarioName;
+  result.latencies.resize(pollsPerBaudRate);
+
+  std::vector<SerialModbusFrameSizes> pduSizes;
+  if (scenario == SerialModbusScenario::interfacePaging)
+    pduSizes.push_back(writeRegisterPduSizes);
+  pduSizes.push_back(readRegistersPduSizes);
+  int64_t frameTime = 0;
+  for (auto& transactionPduSizes : pduSizes)
+    frameTime += clientUart->GetTransmissionTime(GetFrameSize(protocol, transactionPduSizes.requestSize)) +
+      clientUart->GetTransmissionTime(GetFrameSize(protocol, transactionPduSizes.responseSize));
+  int64_t interFrameTime = GetInterFrameTime(clientUart, protocol);
+
+  uint16_t data[numberOfPolledRegisters];
+  BenchmarkAllocationCounters startAllocationCounters = GetBenchmarkAllocationCounters();
+  int64_t startTime = esp_timer_get_time();
+  int64_t transactionEndTime = startTime;
+  for (size_t i = 0; i < pollsPerBaudRate; i++) {
+    // The poll cycle includes the inter-frame silence before each transaction
+    int64_t pollStartTime = transactionEndTime;
+    if (scenario == SerialModbusScenario::interfacePaging) {
+      WaitUntil(transactionEndTime + interFrameTime);
+      uint16_t hardwareInterfaceIndex = numberOfHardwareInterfaces ? i % numberOfHardwareInterfaces : 0;
+      if (client.WriteSingleHoldingRegister(selectedHardwareInterfaceIndexAddress, hardwareInterfaceIndex, NULL) != ESP_OK)
+        result.numberOfErrors++;
+      transactionEndTime = esp_timer_get_time();
+    }
+    WaitUntil(transactionEndTime + interFrameTime);
+    uint16_t address = (scenario == SerialModbusScenario::interfacePaging) ?
+      PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress : PL::BlackBoxModbusServer::generalConfigurationMemoryAddress;
+    if (client.ReadInputRegisters(address, numberOfPolledRegisters, data, NULL) != ESP_OK)
+      result.numberOfErrors++;
+    transactionEndTime = esp_timer_get_time();
+    result.latencies[i] = transactionEndTime - pollStartTime;
+  }
+  result.duration = esp_timer_get_time() - startTime;
+  BenchmarkAllocationCounters endAllocationCounters = GetBenchmarkAllocationCounters();
+  result.allocationCounters.numberOfAllocations = endAllocationCounters.numberOfAllocations - startAllocationCounters.numberOfAllocations;
+  result.allocationCounters.allocatedSize = endAllocationCounters.allocatedSize - startAllocationCounters.allocatedSize;
+
+  // The turnaround time is the median poll cycle time that is not spent transmitting the frames or in the inter-frame silence
+  std::sort(result.latencies.begin(), result.latencies.end());
+  int64_t medianCycleTime = result.latencies.empty() ? 0 : result.latencies[result.latencies.size() / 2];
+  int64_t turnaroundTime = (medianCycleTime - frameTime - interFrameTime * (int64_t)pduSizes.size()) / (int64_t)pduSizes.size();
+  result.counters.push_back({"baudRate", clientUart->GetBaudRate()});
+  result.counters.push_back({"frameUs", frameTime});
+  result.counters.push_back({"interFrameUs", interFrameTime});
+  result.counters.push_back({"turnaroundUs", std::max<int64_t>(turnaroundTime, 0)});
+  result.counters.push_back({"lineUtilizationPercent", medianCycleTime ? frameTime * 100 / medianCycleTime : 0});
+  PrintBenchmarkResult(result);
+}
+
+//==============================================================================
+
+static size_t GetFrameSize(PL::ModbusProtocol protocol, size_t pduSize) {
+  // RTU: station address, PDU and CRC. ASCII: colon, hexadecimal station address, PDU and LRC, CR and LF.
+  if (protocol == PL::ModbusProtocol::ascii)
+    return 1 + 2 * (1 + pduSize + 1) + 2;
+  return 1 + pduSize + 2;
+}
+
+//==============================================================================
+
+static int64_t GetInterFrameTime(std::shared_ptr<PL::Uart> uart, PL::ModbusProtocol protocol) {
+  // RTU frames are separated by the silence of 3.5 characters (fixed above 19200 baud), ASCII frames are delimited by the characters
+  if (protocol != PL::ModbusProtocol::rtu)
+    return 0;
+  if (uart->GetBaudRate() > 19200)
+    return fixedInterFrameTime;
+  return uart->GetTransmissionTime(7) / 2;
+}
+
+//==============================================================================
+
+static void WaitUntil(int64_t time) {
+  for (int64_t remainingTime; (remainingTime = time - esp_timer_get_time()) > 0;) {
+    if (remainingTime >= 2000 * portTICK_PERIOD_MS)
+      vTaskDelay(remainingTime / 1000 / portTICK_PERIOD_MS - 1);
+    else
+      taskYIELD();
+  }
+}
\ No newline at end of file
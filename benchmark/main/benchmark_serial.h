@@ -0,0 +1,6 @@
+#pragma once
+#include "benchmark.h"
+
+//==============================================================================
+
+void BenchmarkBlackBoxSerialModbus(std::shared_ptr<BlackBox> blackBox);
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "nvs_flash.h"
+#include "esp_event.h"
+#include "pl_nvs.h"
+#include "benchmark.h"
+#include "benchmark_modbus.h"
+#include "benchmark_nvs.h"
+#include "benchmark_footprint.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "benchmark_serial.h"
+#endif
+#include <cstdlib>
+
+//==============================================================================
+
+extern "C" void app_main(void) {
+  ESP_ERROR_CHECK(esp_event_loop_create_default());
+#if !CONFIG_IDF_TARGET_LINUX
+  ESP_ERROR_CHECK(esp_netif_init());
+#endif
+  esp_err_t err = nvs_flash_init();
+  if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+      ESP_ERROR_CHECK(nvs_flash_erase());
+      err = nvs_flash_init();
+  }
+  ESP_ERROR_CHECK(err);
+
+  {
+    PL::NvsNamespace nvsNamespace(PL::BlackBox::defaultHardwareInfoNvsNamespaceName, PL::NvsAccessMode::readWrite);
+    ESP_ERROR_CHECK(nvsNamespace.Write(PL::BlackBox::hardwareInfoNameNvsKey, BlackBox::hardwareInfo.name));
+    ESP_ERROR_CHECK(nvsNamespace.Write(PL::BlackBox::hardwareInfoMajorVersionNvsKey, BlackBox::hardwareInfo.version.major));
+    ESP_ERROR_CHECK(nvsNamespace.Write(PL::BlackBox::hardwareInfoMinorVersionNvsKey, BlackBox::hardwareInfo.version.minor));
+    ESP_ERROR_CHECK(nvsNamespace.Write(PL::BlackBox::hardwareInfoPatchVersionNvsKey, BlackBox::hardwareInfo.version.patch));
+    ESP_ERROR_CHECK(nvsNamespace.Write(PL::BlackBox::hardwareInfoUidNvsKey, BlackBox::hardwareInfo.uid));
+  }
+
+  ESP_ERROR_CHECK(uart->Initialize());
+  ESP_ERROR_CHECK(wifi->Initialize());
+
+  // Each benchmark prints one JSON line per run.
+  // The footprint is measured first, while no other tasks allocate memory.
+  size_t numberOfExceededFootprintBudgets = BenchmarkBlackBoxFootprint();
+  {
+    auto blackBox = std::make_shared<BlackBox>();
+    BenchmarkBlackBoxModbus(blackBox);
+    blackBox->EraseAllConfigurations();
+  }
+#if CONFIG_IDF_TARGET_LINUX
+  // The serial Modbus benchmark needs the connected simulated UARTs of the host target
+  {
+    auto blackBox = std::make_shared<BlackBox>();
+    BenchmarkBlackBoxSerialModbus(blackBox);
+    blackBox->EraseAllConfigurations();
+  }
+#endif
+  BenchmarkBlackBoxNvs();
+
+#if CONFIG_IDF_TARGET_LINUX
+  // The process exit code is the number of exceeded footprint budgets, so CI fails when a budget is exceeded
+  exit(numberOfExceededFootprintBudgets);
+#else
+  if (numberOfExceededFootprintBudgets)
+    printf("Exceeded footprint budgets: %u\n", (unsigned int)numberOfExceededFootprintBudgets);
+#endif
+}
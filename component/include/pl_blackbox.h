@@ -3,6 +3,17 @@
 #include "pl_blackbox_base.h"
 #include "pl_blackbox_configuration_parameter.h"
 #include "pl_blackbox_configuration.h"
+#include "pl_blackbox_configuration_registry.h"
+#include "pl_blackbox_configuration_storage.h"
+#include "pl_blackbox_configuration_profile.h"
+#include "pl_blackbox_configuration_snapshot.h"
+#include "pl_blackbox_event_recorder.h"
+#include "pl_blackbox_health_monitor.h"
+#include "pl_blackbox_link_monitor.h"
+#include "pl_blackbox_firmware_updater.h"
+#include "pl_blackbox_clock.h"
+#include "pl_blackbox_trace.h"
+#include "pl_blackbox_trace_recorder.h"
 #include "pl_blackbox_hardware_interface_configuration.h"
 #include "pl_blackbox_uart_configuration.h"
 #include "pl_blackbox_network_interface_configuration.h"
@@ -13,6 +24,19 @@
 #include "pl_blackbox_stream_server_configuration.h"
 #include "pl_blackbox_network_server_configuration.h"
 #include "pl_blackbox_modbus_server_configuration.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "pl_blackbox_http_server_configuration.h"
 #include "pl_blackbox_mdns_server_configuration.h"
-#include "pl_blackbox_modbus_server.h"
\ No newline at end of file
+#endif
+#include "pl_blackbox_sntp_configuration.h"
+#include "pl_blackbox_modbus_memory_map.h"
+#include "pl_blackbox_modbus_server.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "pl_blackbox_http_server.h"
+#endif
+#include "pl_blackbox_stream_protocol.h"
+#include "pl_blackbox_stream_server.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "pl_blackbox_mdns_service.h"
+#endif
+#include "pl_blackbox_sntp_client.h"
\ No newline at end of file
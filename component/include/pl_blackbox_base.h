@@ -1,5 +1,11 @@
 #pragma once
 #include "pl_blackbox_types.h"
+#include "pl_blackbox_configuration_registry.h"
+#include "pl_blackbox_configuration_snapshot.h"
+#include "pl_blackbox_event_recorder.h"
+#include "pl_blackbox_trace_recorder.h"
+#include "pl_blackbox_health_monitor.h"
+#include "pl_blackbox_firmware_updater.h"
 #include "pl_blackbox_hardware_interface_configuration.h"
 #include "pl_blackbox_uart_configuration.h"
 #include "pl_blackbox_network_interface_configuration.h"
@@ -9,9 +15,12 @@
 #include "pl_blackbox_server_configuration.h"
 #include "pl_blackbox_stream_server_configuration.h"
 #include "pl_blackbox_network_server_configuration.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "pl_blackbox_http_server_configuration.h"
 #include "pl_blackbox_mdns_server_configuration.h"
+#endif
 #include "pl_blackbox_modbus_server_configuration.h"
+#include "pl_blackbox_sntp_configuration.h"
 
 //==============================================================================
 
@@ -19,6 +28,10 @@ namespace PL {
 
 //==============================================================================
 
+class BlackBoxLinkMonitor;
+
+//==============================================================================
+
 /// @brief Base class for the BlackBox device
 class BlackBox {
 public:
@@ -40,10 +53,12 @@ public:
 
   /// @brief General configuration device name NVS key
   static const std::string generalConfigurationDeviceNameNvsKey;
+  /// @brief General configuration index NVS key (enabled flags of the hardware interface and server configurations)
+  static const std::string generalConfigurationIndexNvsKey;
 
   /// @brief Creates a BlackBox device
   BlackBox();
-  ~BlackBox() {}
+  ~BlackBox();
   BlackBox(const BlackBox&) = delete;
   BlackBox& operator=(const BlackBox&) = delete;
 
@@ -90,6 +105,87 @@ public:
   /// @brief Clears the reset flag
   void ClearRestartedFlag();
 
+  /// @brief Gets the reset information
+  /// @details The information is captured at the first BlackBox creation after the reset and is kept in the RTC memory.
+  /// The panic program counter, backtrace and task are read from the core dump summary
+  /// (requires the ELF core dump to flash, the backtrace is available only for Xtensa targets).
+  /// @return reset information
+  BlackBoxResetInfo GetResetInfo();
+
+  /// @brief Clears the abnormal reset counter and the last abnormal reset information
+  void ClearResetInfo();
+
+  /// @brief Gets the configuration generation
+  /// @details The generation changes when a configuration is added, removed or replaced, when a parameter value of
+  /// a hardware interface or server configuration changes, and when the device name, the restarted flag or the reset information changes.
+  /// It can be compared with the previously read generation to skip reading unchanged configurations.
+  /// The generations restart after each reset, so they include the generation epoch (a random number chosen at the BlackBox creation):
+  /// a generation read before the reset does not match the generations after it.
+  /// @return configuration generation
+  uint64_t GetConfigurationGeneration();
+
+  /// @brief Gets the generation epoch
+  /// @details The epoch is a random number chosen at the BlackBox creation. It can be added to the configuration generations
+  /// that are sent to the clients, so the generations from before the reset do not match.
+  /// @return generation epoch
+  uint32_t GetGenerationEpoch();
+
+  /// @brief Adds a change observer
+  /// @details The observer is called from the task that made the change and should not block.
+  /// The configuration argument is set only for the configuration change type.
+  /// @param observer change observer
+  /// @return change observer ID
+  uint32_t AddChangeObserver(std::function<void(BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration)> observer);
+
+  /// @brief Removes the change observer
+  /// @details The observer is not running and will not be called after the method returns.
+  /// @param observerId change observer ID
+  void RemoveChangeObserver(uint32_t observerId);
+
+  /// @brief Gets the event recorder
+  /// @return event recorder (nullptr if the events are not stored)
+  std::shared_ptr<BlackBoxEventRecorder> GetEventRecorder();
+
+  /// @brief Sets the event recorder
+  /// @details The BlackBox records the reset, restart, configuration change, save and apply events with BlackBoxEventRecorder::Record
+  /// regardless of the event recorder. The event recorder is flushed before the restart.
+  /// @param eventRecorder event recorder (nullptr if the events should not be stored)
+  void SetEventRecorder(std::shared_ptr<BlackBoxEventRecorder> eventRecorder);
+
+  /// @brief Gets the trace recorder
+  /// @return trace recorder (nullptr if the trace points are not recorded)
+  std::shared_ptr<BlackBoxTraceRecorder> GetTraceRecorder();
+
+  /// @brief Sets the trace recorder that is used by the BlackBox servers
+  /// @details The trace recorder is set as the trace hook (BlackBoxTrace::SetHook),
+  /// so it should be set before the BlackBox is used by other tasks.
+  /// @param traceRecorder trace recorder (nullptr if the trace points should not be recorded)
+  void SetTraceRecorder(std::shared_ptr<BlackBoxTraceRecorder> traceRecorder);
+
+  /// @brief Gets the health monitor
+  /// @return health monitor (nullptr if there is no health monitor)
+  std::shared_ptr<BlackBoxHealthMonitor> GetHealthMonitor();
+
+  /// @brief Sets the health monitor that is used by the BlackBox servers
+  /// @param healthMonitor health monitor (nullptr if there is no health monitor)
+  void SetHealthMonitor(std::shared_ptr<BlackBoxHealthMonitor> healthMonitor);
+
+  /// @brief Gets the network interface link monitor
+  /// @return link monitor (nullptr if there is no link monitor)
+  std::shared_ptr<BlackBoxLinkMonitor> GetLinkMonitor();
+
+  /// @brief Sets the network interface link monitor that is used by the BlackBox servers
+  /// @param linkMonitor link monitor (nullptr if there is no link monitor)
+  void SetLinkMonitor(std::shared_ptr<BlackBoxLinkMonitor> linkMonitor);
+
+  /// @brief Gets the firmware updater
+  /// @return firmware updater (nullptr if the firmware update is disabled)
+  std::shared_ptr<BlackBoxFirmwareUpdater> GetFirmwareUpdater();
+
+  /// @brief Sets the firmware updater that is used by the BlackBox servers
+  /// @param firmwareUpdater firmware updater (nullptr if the firmware update should be disabled)
+  void SetFirmwareUpdater(std::shared_ptr<BlackBoxFirmwareUpdater> firmwareUpdater);
+
   /// @brief Adds a configuration
   void AddConfiguration(std::shared_ptr<BlackBoxConfiguration> configuration);
 
@@ -112,21 +208,161 @@ public:
   std::shared_ptr<BlackBoxStreamServerConfiguration> AddStreamServerConfiguration(std::shared_ptr<StreamServer> server, std::string nvsNamespaceName);
   std::shared_ptr<BlackBoxNetworkServerConfiguration> AddNetworkServerConfiguration(std::shared_ptr<NetworkServer> server, std::string nvsNamespaceName);
   std::shared_ptr<BlackBoxModbusServerConfiguration> AddModbusServerConfiguration(std::shared_ptr<ModbusServer> server, std::string nvsNamespaceName);
+#if !CONFIG_IDF_TARGET_LINUX
   std::shared_ptr<BlackBoxHttpServerConfiguration> AddHttpServerConfiguration(std::shared_ptr<HttpServer> server, std::string nvsNamespaceName);
   std::shared_ptr<BlackBoxMdnsServerConfiguration> AddMdnsServerConfiguration(std::shared_ptr<MdnsServer> server, std::string nvsNamespaceName);
+#endif
+  std::shared_ptr<BlackBoxSntpConfiguration> AddSntpConfiguration(std::shared_ptr<BlackBoxSntpClient> sntpClient, std::string nvsNamespaceName);
+
+  /// @brief Removes a configuration
+  /// @details Removal is safe while other tasks read configurations: a removed configuration stays valid for the readers that still hold it.
+  /// The configuration lists (all, hardware interface and server configurations) are updated one after another and the configuration generation
+  /// changes after all of them have been updated, so a reader that combines several lists can compare the generation before and after reading
+  /// to detect a concurrent change.
+  /// @param configuration configuration
+  /// @return error code
+  esp_err_t RemoveConfiguration(std::shared_ptr<BlackBoxConfiguration> configuration);
+
+  /// @brief Replaces a configuration keeping its index
+  /// @details A hardware interface configuration can only be replaced with a hardware interface configuration and
+  /// a server configuration can only be replaced with a server configuration. The configuration lists are updated as with RemoveConfiguration.
+  /// @param oldConfiguration configuration to replace
+  /// @param newConfiguration new configuration
+  /// @return error code
+  esp_err_t ReplaceConfiguration(std::shared_ptr<BlackBoxConfiguration> oldConfiguration, std::shared_ptr<BlackBoxConfiguration> newConfiguration);
 
-  /// @brief Gets all configurations
+  /// @brief Gets a copy of all configurations
   /// @return configurations
   std::vector<std::shared_ptr<BlackBoxConfiguration>> GetAllConfigurations();
 
-  /// @brief Gets the hardware interface configurations
+  /// @brief Gets the configuration by NVS namespace name
+  /// @param nvsNamespaceName NVS namespace name
+  /// @return configuration (nullptr if not found)
+  std::shared_ptr<BlackBoxConfiguration> GetConfiguration(const std::string& nvsNamespaceName);
+
+  /// @brief Calls the visitor for every configuration
+  /// @param visitor visitor
+  void ForEachConfiguration(const std::function<void(BlackBoxConfiguration&)>& visitor);
+
+  /// @brief Gets a copy of the hardware interface configurations
   /// @return hardware interface configurations
   std::vector<std::shared_ptr<BlackBoxHardwareInterfaceConfiguration>> GetHardwareInterfaceConfigurations();
 
-  /// @brief Gets the server configurations
+  /// @brief Gets the number of hardware interface configurations
+  /// @return number of hardware interface configurations
+  size_t GetNumberOfHardwareInterfaceConfigurations();
+
+  /// @brief Gets the number of hardware interface configurations of the specified type
+  /// @param type hardware interface type
+  /// @return number of hardware interface configurations
+  size_t GetNumberOfHardwareInterfaceConfigurations(BlackBoxHardwareInterfaceType type);
+
+  /// @brief Gets the hardware interface configuration by index
+  /// @param index hardware interface configuration index
+  /// @return hardware interface configuration (nullptr if not found)
+  std::shared_ptr<BlackBoxHardwareInterfaceConfiguration> GetHardwareInterfaceConfiguration(size_t index);
+
+  /// @brief Gets the hardware interface configuration by hardware interface name
+  /// @param name hardware interface name
+  /// @return hardware interface configuration (nullptr if not found)
+  std::shared_ptr<BlackBoxHardwareInterfaceConfiguration> GetHardwareInterfaceConfiguration(const std::string& name);
+
+  /// @brief Gets the hardware interface configuration by type and index among the configurations of this type
+  /// @param type hardware interface type
+  /// @param index hardware interface configuration index among the configurations of this type
+  /// @return hardware interface configuration (nullptr if not found)
+  std::shared_ptr<BlackBoxHardwareInterfaceConfiguration> GetHardwareInterfaceConfiguration(BlackBoxHardwareInterfaceType type, size_t index = 0);
+
+  /// @brief Gets the hardware interface configuration index
+  /// @param configuration hardware interface configuration
+  /// @return hardware interface configuration index (SIZE_MAX if not found)
+  size_t GetHardwareInterfaceConfigurationIndex(BlackBoxHardwareInterfaceConfiguration& configuration);
+
+  /// @brief Calls the visitor for every hardware interface configuration
+  /// @param visitor visitor
+  void ForEachHardwareInterfaceConfiguration(const std::function<void(BlackBoxHardwareInterfaceConfiguration&)>& visitor);
+
+  /// @brief Gets a copy of the server configurations
   /// @return server configurations
   std::vector<std::shared_ptr<BlackBoxServerConfiguration>> GetServerConfigurations();
 
+  /// @brief Gets the number of server configurations
+  /// @return number of server configurations
+  size_t GetNumberOfServerConfigurations();
+
+  /// @brief Gets the number of server configurations of the specified type
+  /// @param type server type
+  /// @return number of server configurations
+  size_t GetNumberOfServerConfigurations(BlackBoxServerType type);
+
+  /// @brief Gets the server configuration by index
+  /// @param index server configuration index
+  /// @return server configuration (nullptr if not found)
+  std::shared_ptr<BlackBoxServerConfiguration> GetServerConfiguration(size_t index);
+
+  /// @brief Gets the server configuration by server name
+  /// @param name server name
+  /// @return server configuration (nullptr if not found)
+  std::shared_ptr<BlackBoxServerConfiguration> GetServerConfiguration(const std::string& name);
+
+  /// @brief Gets the server configuration by type and index among the configurations of this type
+  /// @param type server type
+  /// @param index server configuration index among the configurations of this type
+  /// @return server configuration (nullptr if not found)
+  std::shared_ptr<BlackBoxServerConfiguration> GetServerConfiguration(BlackBoxServerType type, size_t index = 0);
+
+  /// @brief Gets the server configuration index
+  /// @param configuration server configuration
+  /// @return server configuration index (SIZE_MAX if not found)
+  size_t GetServerConfigurationIndex(BlackBoxServerConfiguration& configuration);
+
+  /// @brief Calls the visitor for every server configuration
+  /// @param visitor visitor
+  void ForEachServerConfiguration(const std::function<void(BlackBoxServerConfiguration&)>& visitor);
+
+  /// @brief Enables the lazy loading of configurations
+  /// @details In the lazy mode LoadAllConfigurations reads the enabled flags of the hardware interface and server configurations
+  /// from the general configuration index and defers the loading of their NVS namespaces until the first parameter access or apply.
+  /// The deferred loading does not overwrite the enabled flags, so they can be changed before the first access.
+  /// Configurations that are absent from the index are loaded immediately. The index is written by SaveAllConfigurations.
+  void EnableLazyLoading();
+
+  /// @brief Disables the lazy loading of configurations
+  void DisableLazyLoading();
+
+  /// @brief Checks if the lazy loading of configurations is enabled
+  /// @return true if the lazy loading is enabled
+  bool IsLazyLoadingEnabled();
+
+  /// @brief Enables saving of all configurations as one snapshot
+  /// @details SaveAllConfigurations writes the parameters of all configurations to the inactive snapshot slot
+  /// in the general configuration NVS namespace and then makes it active, so a power loss during saving cannot mix old and new values.
+  /// LoadAllConfigurations reads the newest valid snapshot and falls back to the configuration NVS namespaces if there is none.
+  void EnableSnapshotSaving();
+
+  /// @brief Disables saving of all configurations as one snapshot
+  void DisableSnapshotSaving();
+
+  /// @brief Checks if saving of all configurations as one snapshot is enabled
+  /// @return true if snapshot saving is enabled
+  bool IsSnapshotSavingEnabled();
+
+  /// @brief Sets the default configuration profile
+  /// @details LoadAllConfigurations loads the default profile section of every configuration before the saved parameters
+  /// and SaveAllConfigurations saves only the parameters that differ from the default profile.
+  /// EraseAllConfigurations drops the saved parameters, so it is followed by LoadAllConfigurations for a factory reset.
+  /// @param profile default configuration profile (nullptr if there is no default profile)
+  void SetDefaultProfile(std::shared_ptr<BlackBoxConfigurationProfile> profile);
+
+  /// @brief Gets the default configuration profile
+  /// @return default configuration profile (nullptr if there is no default profile)
+  std::shared_ptr<BlackBoxConfigurationProfile> GetDefaultProfile();
+
+  /// @brief Creates a configuration profile with the current parameters of all configurations
+  /// @details The encoded profile (BlackBoxConfigurationProfile::GetData) can be compiled into the firmware as the default profile.
+  /// @return configuration profile
+  std::shared_ptr<BlackBoxConfigurationProfile> CreateProfile();
+
   /// @brief Loads all configurations
   void LoadAllConfigurations();
 
@@ -149,9 +385,25 @@ private:
   bool hardwareInfoLoaded = false;
   std::string deviceName;
   bool restartedFlag = true;
-  std::vector<std::shared_ptr<BlackBoxConfiguration>> allConfigurations;
-  std::vector<std::shared_ptr<BlackBoxHardwareInterfaceConfiguration>> hardwareInterfaceConfigurations;
-  std::vector<std::shared_ptr<BlackBoxServerConfiguration>> serverConfigurations;
+  std::atomic<uint32_t> deviceGeneration = 0;
+  bool lazyLoadingEnabled = false;
+  bool snapshotSavingEnabled = false;
+  std::shared_ptr<BlackBoxConfigurationProfile> defaultProfile;
+  std::shared_ptr<BlackBoxEventRecorder> eventRecorder;
+  std::shared_ptr<BlackBoxTraceRecorder> traceRecorder;
+  std::shared_ptr<BlackBoxHealthMonitor> healthMonitor;
+  std::shared_ptr<BlackBoxLinkMonitor> linkMonitor;
+  std::shared_ptr<BlackBoxFirmwareUpdater> firmwareUpdater;
+  std::unordered_map<uint32_t, bool> configurationIndex;
+  Mutex configurationListMutex;
+  std::atomic<uint32_t> configurationListGeneration = 0;
+  const uint32_t generationEpoch;
+  BlackBoxConfigurationRegistry<BlackBoxConfiguration> allConfigurations;
+  BlackBoxConfigurationRegistry<BlackBoxHardwareInterfaceConfiguration> hardwareInterfaceConfigurations;
+  BlackBoxConfigurationRegistry<BlackBoxServerConfiguration> serverConfigurations;
+  Mutex changeObserverMutex;
+  uint32_t nextChangeObserverId = 1;
+  std::vector<std::pair<uint32_t, std::function<void(BlackBoxChangeType, std::shared_ptr<BlackBoxConfiguration>)>>> changeObservers;
 
   class GeneralConfiguration : public BlackBoxConfiguration {
     public:
@@ -160,17 +412,38 @@ private:
       void Load() override;
       void Save() override;
       void Erase() override;
+      void LoadParameters(BlackBoxConfigurationStorage& storage) override;
+      void SaveParameters(BlackBoxConfigurationStorage& storage) override;
 
-      std::string GetNvsNamespaceName();
+      std::string GetNvsNamespaceName() override;
       void SetNvsNamespaceName(const std::string& nvsNamespaceName);
+      uint32_t GetGeneration() override;
 
     private:
+      // Locked after the BlackBox mutex (SaveAllConfigurations and LoadAllConfigurations lock the BlackBox mutex first)
       Mutex mutex;
       BlackBox& blackBox;
       std::string nvsNamespaceName;
   };
 
   std::shared_ptr<GeneralConfiguration> generalConfiguration;
+
+  #pragma pack(push, 1)
+  struct ConfigurationIndexEntry {
+    uint32_t nvsNamespaceNameHash;
+    uint8_t enabled;
+  };
+  #pragma pack(pop)
+
+  static uint32_t GetNvsNamespaceNameHash(const std::string& nvsNamespaceName);
+
+  void ObserveConfiguration(std::shared_ptr<BlackBoxConfiguration> configuration);
+  void NotifyChange(BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration = nullptr);
+
+  template <class T>
+  std::shared_ptr<T> RegisterHardwareInterfaceConfiguration(std::shared_ptr<T> configuration);
+  template <class T>
+  std::shared_ptr<T> RegisterServerConfiguration(std::shared_ptr<T> configuration);
 };
 
 //==============================================================================
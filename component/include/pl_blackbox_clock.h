@@ -0,0 +1,53 @@
+#pragma once
+#include "pl_blackbox_types.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox time base with the monotonic time since the reset and the UTC time
+/// @details The UTC time is the monotonic time plus the offset that is set on every time synchronization,
+/// so it does not jump between the synchronizations and the monotonic timestamps (event, health and other telemetry times)
+/// can be converted to UTC, including the ones taken before the synchronization.
+/// The monotonic time source can be replaced (for example, by a manually advanced test clock).
+class BlackBoxClock {
+public:
+  /// @brief Monotonic time source
+  /// @return time since the reset in microseconds
+  using TimeSource = int64_t (*)();
+
+  /// @brief Sets the monotonic time source
+  /// @param timeSource time source (NULL: esp_timer time since the reset)
+  static void SetTimeSource(TimeSource timeSource);
+
+  /// @brief Gets the monotonic time
+  /// @return time since the reset in microseconds
+  static int64_t GetMonotonicTime();
+
+  /// @brief Gets the UTC time
+  /// @return time since 1970-01-01 00:00:00 UTC in microseconds (0 if the time has not been synchronized)
+  static int64_t GetUtcTime();
+
+  /// @brief Converts the monotonic time to the UTC time
+  /// @param monotonicTime time since the reset in microseconds
+  /// @return time since 1970-01-01 00:00:00 UTC in microseconds (0 if the time has not been synchronized)
+  static int64_t ToUtcTime(int64_t monotonicTime);
+
+  /// @brief Checks if the time has been synchronized
+  /// @return true if the time has been synchronized
+  static bool IsSynchronized();
+
+  /// @brief Gets the monotonic time of the last synchronization
+  /// @return time since the reset in microseconds (0 if the time has not been synchronized)
+  static int64_t GetLastSynchronizationTime();
+
+  /// @brief Synchronizes the UTC time with the system time
+  /// @details Called by the BlackBox SNTP client after every synchronization and can be called after the system time is set in any other way.
+  static void Synchronize();
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -1,4 +1,8 @@
 #pragma once
+#include "pl_blackbox_configuration_storage.h"
+#include <functional>
+#include <memory>
+#include <string>
 
 //==============================================================================
 
@@ -17,6 +21,44 @@ public:
 
   /// @brief Erases the configuration
   virtual void Erase() = 0;
+
+  /// @brief Loads the configuration parameters from the storage
+  /// @details Configurations that do not support storages load the parameters from their own NVS namespace.
+  /// @param storage storage
+  virtual void LoadParameters(BlackBoxConfigurationStorage& storage) { Load(); }
+
+  /// @brief Saves the configuration parameters to the storage
+  /// @details Configurations that do not support storages save the parameters to their own NVS namespace.
+  /// @param storage storage
+  virtual void SaveParameters(BlackBoxConfigurationStorage& storage) { Save(); }
+
+  /// @brief Saves the configuration parameters that can be read by the BlackBox clients to the storage
+  /// @details Write-only parameters (passwords) are not saved, so they are never sent to the clients.
+  /// @param storage storage
+  virtual void SaveReadableParameters(BlackBoxConfigurationStorage& storage) { SaveParameters(storage); }
+
+  /// @brief Defers the configuration loading until the first parameter access or apply
+  /// @details Configurations that do not support deferred loading are loaded immediately.
+  /// @param storage storage to load the parameters from (nullptr to load them from the configuration NVS namespace)
+  virtual void DeferLoad(std::shared_ptr<BlackBoxConfigurationStorage> storage = nullptr) {
+    if (storage)
+      LoadParameters(*storage);
+    else
+      Load();
+  }
+
+  /// @brief Gets the configuration NVS namespace name
+  /// @return NVS namespace name (empty if the configuration is not bound to a single NVS namespace)
+  virtual std::string GetNvsNamespaceName() { return std::string(); }
+
+  /// @brief Gets the configuration generation that is incremented on every parameter value change
+  /// @return configuration generation (always 0 if the configuration does not track changes)
+  virtual uint32_t GetGeneration() { return 0; }
+
+  /// @brief Sets the handler that is called after every parameter value change
+  /// @details Configurations that do not track changes never call the handler.
+  /// @param changeHandler change handler (nullptr to remove the handler)
+  virtual void SetChangeHandler(std::function<void()> changeHandler) {}
 };
 
 //==============================================================================
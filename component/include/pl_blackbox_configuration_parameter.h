@@ -28,6 +28,8 @@ public:
 
   /// @brief Gets the parameter value
   T GetValue() {
+    if (accessHandler)
+      accessHandler();
     LockGuard lg(mutex);
     return value;
   }
@@ -36,11 +38,17 @@ public:
   /// @param value parameter value
   /// @return error code
   esp_err_t SetValue(T value) {
-    LockGuard lg(mutex);
-    if (this->value != value) {
+    if (accessHandler)
+      accessHandler();
+    {
+      LockGuard lg(mutex);
+      if (this->value == value)
+        return ESP_OK;
       ESP_RETURN_ON_FALSE(valueValidator(value), ESP_ERR_INVALID_ARG, CONFIG_PARAM_TAG, "parameter value validation failed");
       this->value = value;
     }
+    if (changeHandler)
+      changeHandler();
     return ESP_OK;
   }
 
@@ -63,10 +71,24 @@ public:
     this->valueValidator = [](T value) { return true; };
   }
 
+  /// @brief Sets the handler that is called before every value access (should be set before the parameter is used by other tasks)
+  /// @param accessHandler access handler
+  void SetAccessHandler(std::function<void()> accessHandler) {
+    this->accessHandler = accessHandler;
+  }
+
+  /// @brief Sets the handler that is called after every value change (should be set before the parameter is used by other tasks)
+  /// @param changeHandler change handler
+  void SetChangeHandler(std::function<void()> changeHandler) {
+    this->changeHandler = changeHandler;
+  }
+
 private:
   Mutex mutex;
   T value;
   std::function<bool(T)> valueValidator;
+  std::function<void()> accessHandler;
+  std::function<void()> changeHandler;
 };
 
 //==============================================================================
@@ -0,0 +1,59 @@
+#pragma once
+#include "pl_blackbox_configuration_storage.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox configuration profile: a set of configuration sections identified by the configuration NVS namespace names
+/// @details Encoded section: NVS namespace name size (1 byte), NVS namespace name, section data size (2 bytes, little-endian),
+/// section data (BlackBoxTlvConfigurationStorage records).
+class BlackBoxConfigurationProfile : public Lockable {
+public:
+  /// @brief Creates an empty BlackBox configuration profile
+  BlackBoxConfigurationProfile() {}
+
+  /// @brief Creates a BlackBox configuration profile from the encoded sections (for example a profile compiled into flash)
+  /// @param data encoded sections
+  /// @param size encoded sections size
+  BlackBoxConfigurationProfile(const void* data, size_t size);
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+
+  /// @brief Gets the configuration section
+  /// @param nvsNamespaceName configuration NVS namespace name
+  /// @return configuration section (nullptr if not found)
+  std::shared_ptr<BlackBoxTlvConfigurationStorage> GetSection(const std::string& nvsNamespaceName);
+
+  /// @brief Adds an empty configuration section or gets the existing one
+  /// @param nvsNamespaceName configuration NVS namespace name
+  /// @return configuration section
+  std::shared_ptr<BlackBoxTlvConfigurationStorage> AddSection(const std::string& nvsNamespaceName);
+
+  /// @brief Gets the NVS namespace names of all sections in the order of adding
+  /// @return section NVS namespace names
+  std::vector<std::string> GetSectionNames();
+
+  /// @brief Gets the encoded sections
+  /// @return encoded sections
+  std::vector<uint8_t> GetData();
+
+  /// @brief Replaces the sections with the encoded sections
+  /// @param data encoded sections
+  /// @param size encoded sections size
+  /// @return error code
+  esp_err_t SetData(const void* data, size_t size);
+
+protected:
+  Mutex mutex;
+
+private:
+  std::vector<std::pair<std::string, std::shared_ptr<BlackBoxTlvConfigurationStorage>>> sections;
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
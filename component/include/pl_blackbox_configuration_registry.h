@@ -0,0 +1,260 @@
+#pragma once
+#include "pl_common.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox configuration registry with lookup by index, name, NVS namespace name and type
+/// @details Readers never lock: every change publishes a new immutable snapshot of the registry
+/// and the previous snapshot is released after all readers that could have seen it have finished (read-copy-update).
+template <class T>
+class BlackBoxConfigurationRegistry {
+public:
+  /// @brief Creates an empty BlackBox configuration registry
+  BlackBoxConfigurationRegistry() : snapshot(new Snapshot()) {}
+  ~BlackBoxConfigurationRegistry() {
+    delete snapshot.load();
+  }
+  BlackBoxConfigurationRegistry(const BlackBoxConfigurationRegistry&) = delete;
+  BlackBoxConfigurationRegistry& operator=(const BlackBoxConfigurationRegistry&) = delete;
+
+  /// @brief Adds a configuration to the registry
+  /// @param configuration configuration
+  /// @param name configuration name (empty if the configuration should not be indexed by name)
+  /// @param nvsNamespaceName configuration NVS namespace name (empty if the configuration should not be indexed by NVS namespace name)
+  /// @param type configuration type
+  void Add(std::shared_ptr<T> configuration, const std::string& name, const std::string& nvsNamespaceName, uint8_t type = 0) {
+    LockGuard lg(writeMutex);
+    Snapshot* newSnapshot = new Snapshot(*snapshot.load());
+    newSnapshot->entries.push_back({configuration, name, nvsNamespaceName, type});
+    Publish(newSnapshot);
+  }
+
+  /// @brief Removes a configuration from the registry
+  /// @param configuration configuration
+  /// @return true if the configuration has been removed
+  bool Remove(const std::shared_ptr<T>& configuration) {
+    LockGuard lg(writeMutex);
+    Snapshot* newSnapshot = new Snapshot(*snapshot.load());
+    auto& entries = newSnapshot->entries;
+    auto entry = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.configuration == configuration; });
+    if (entry == entries.end()) {
+      delete newSnapshot;
+      return false;
+    }
+    entries.erase(entry);
+    Publish(newSnapshot);
+    return true;
+  }
+
+  /// @brief Replaces a configuration keeping its index
+  /// @param oldConfiguration configuration to replace
+  /// @param newConfiguration new configuration
+  /// @param name new configuration name
+  /// @param nvsNamespaceName new configuration NVS namespace name
+  /// @param type new configuration type
+  /// @return true if the configuration has been replaced
+  bool Replace(const std::shared_ptr<T>& oldConfiguration, std::shared_ptr<T> newConfiguration, const std::string& name, const std::string& nvsNamespaceName, uint8_t type = 0) {
+    LockGuard lg(writeMutex);
+    Snapshot* newSnapshot = new Snapshot(*snapshot.load());
+    auto& entries = newSnapshot->entries;
+    auto entry = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) { return entry.configuration == oldConfiguration; });
+    if (entry == entries.end()) {
+      delete newSnapshot;
+      return false;
+    }
+    *entry = {newConfiguration, name, nvsNamespaceName, type};
+    Publish(newSnapshot);
+    return true;
+  }
+
+  /// @brief Changes the NVS namespace name index entry of the configuration
+  /// @param oldNvsNamespaceName old NVS namespace name
+  /// @param newNvsNamespaceName new NVS namespace name
+  void RenameNvsNamespace(const std::string& oldNvsNamespaceName, const std::string& newNvsNamespaceName) {
+    LockGuard lg(writeMutex);
+    Snapshot* newSnapshot = new Snapshot(*snapshot.load());
+    for (auto& entry : newSnapshot->entries) {
+      if (entry.nvsNamespaceName == oldNvsNamespaceName)
+        entry.nvsNamespaceName = newNvsNamespaceName;
+    }
+    Publish(newSnapshot);
+  }
+
+  /// @brief Gets the registry generation that is incremented on every change
+  /// @return registry generation
+  uint32_t GetGeneration() const {
+    return generation.load();
+  }
+
+  /// @brief Gets the number of configurations
+  /// @return number of configurations
+  size_t GetSize() const {
+    ReadGuard rg(*this);
+    return rg->entries.size();
+  }
+
+  /// @brief Gets the number of configurations of the specified type
+  /// @param type configuration type
+  /// @return number of configurations
+  size_t GetSize(uint8_t type) const {
+    ReadGuard rg(*this);
+    auto item = rg->typeIndex.find(type);
+    return item == rg->typeIndex.end() ? 0 : item->second.size();
+  }
+
+  /// @brief Gets the configuration by index
+  /// @param index configuration index
+  /// @return configuration (nullptr if not found)
+  std::shared_ptr<T> Get(size_t index) const {
+    ReadGuard rg(*this);
+    return index < rg->entries.size() ? rg->entries[index].configuration : nullptr;
+  }
+
+  /// @brief Gets the configuration by name
+  /// @param name configuration name
+  /// @return configuration (nullptr if not found)
+  std::shared_ptr<T> Get(const std::string& name) const {
+    ReadGuard rg(*this);
+    auto item = rg->nameIndex.find(name);
+    return item == rg->nameIndex.end() ? nullptr : rg->entries[item->second].configuration;
+  }
+
+  /// @brief Gets the configuration by type and index among the configurations of this type
+  /// @param type configuration type
+  /// @param index configuration index among the configurations of this type
+  /// @return configuration (nullptr if not found)
+  std::shared_ptr<T> Get(uint8_t type, size_t index) const {
+    ReadGuard rg(*this);
+    auto item = rg->typeIndex.find(type);
+    if (item == rg->typeIndex.end() || index >= item->second.size())
+      return nullptr;
+    return rg->entries[item->second[index]].configuration;
+  }
+
+  /// @brief Gets the configuration by NVS namespace name
+  /// @param nvsNamespaceName NVS namespace name
+  /// @return configuration (nullptr if not found)
+  std::shared_ptr<T> GetByNvsNamespaceName(const std::string& nvsNamespaceName) const {
+    ReadGuard rg(*this);
+    auto item = rg->nvsNamespaceNameIndex.find(nvsNamespaceName);
+    return item == rg->nvsNamespaceNameIndex.end() ? nullptr : rg->entries[item->second].configuration;
+  }
+
+  /// @brief Gets the index of the configuration
+  /// @details The configuration is looked up by its NVS namespace name, so the lookup does not depend on the number of configurations.
+  /// @param configuration configuration
+  /// @param nvsNamespaceName configuration NVS namespace name
+  /// @return configuration index (SIZE_MAX if not found)
+  size_t GetIndex(const T& configuration, const std::string& nvsNamespaceName) const {
+    ReadGuard rg(*this);
+    auto item = rg->nvsNamespaceNameIndex.find(nvsNamespaceName);
+    if (item == rg->nvsNamespaceNameIndex.end() || rg->entries[item->second].configuration.get() != &configuration)
+      return SIZE_MAX;
+    return item->second;
+  }
+
+  /// @brief Gets a copy of all configurations
+  /// @return configurations
+  std::vector<std::shared_ptr<T>> GetAll() const {
+    ReadGuard rg(*this);
+    std::vector<std::shared_ptr<T>> configurations;
+    configurations.reserve(rg->entries.size());
+    for (auto& entry : rg->entries)
+      configurations.push_back(entry.configuration);
+    return configurations;
+  }
+
+  /// @brief Calls the visitor for every configuration in the order of adding
+  /// @details The visitor works with the registry snapshot taken at the moment of the call.
+  /// The visitor should not add, remove or replace configurations in the same registry.
+  /// @param visitor visitor
+  void ForEach(const std::function<void(T&)>& visitor) const {
+    ReadGuard rg(*this);
+    for (auto& entry : rg->entries)
+      visitor(*entry.configuration);
+  }
+
+private:
+  struct Entry {
+    std::shared_ptr<T> configuration;
+    std::string name;
+    std::string nvsNamespaceName;
+    uint8_t type;
+  };
+
+  struct Snapshot {
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, size_t> nameIndex;
+    std::unordered_map<std::string, size_t> nvsNamespaceNameIndex;
+    std::unordered_map<uint8_t, std::vector<size_t>> typeIndex;
+  };
+
+  class ReadGuard {
+  public:
+    ReadGuard(const BlackBoxConfigurationRegistry& registry) : registry(registry) {
+      while (true) {
+        epochIndex = registry.epoch.load() & 1;
+        registry.numberOfReaders[epochIndex].fetch_add(1);
+        if ((registry.epoch.load() & 1) == epochIndex)
+          break;
+        registry.numberOfReaders[epochIndex].fetch_sub(1);
+      }
+      snapshot = registry.snapshot.load();
+    }
+    ~ReadGuard() {
+      registry.numberOfReaders[epochIndex].fetch_sub(1);
+    }
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+    const Snapshot* operator->() const {
+      return snapshot;
+    }
+
+  private:
+    const BlackBoxConfigurationRegistry& registry;
+    uint32_t epochIndex;
+    const Snapshot* snapshot;
+  };
+
+  Mutex writeMutex;
+  std::atomic<Snapshot*> snapshot;
+  std::atomic<uint32_t> generation = 0;
+  mutable std::atomic<uint32_t> epoch = 0;
+  mutable std::atomic<uint32_t> numberOfReaders[2] = {0, 0};
+
+  void Publish(Snapshot* newSnapshot) {
+    newSnapshot->nameIndex.clear();
+    newSnapshot->nvsNamespaceNameIndex.clear();
+    newSnapshot->typeIndex.clear();
+    for (size_t i = 0; i < newSnapshot->entries.size(); i++) {
+      auto& entry = newSnapshot->entries[i];
+      if (!entry.name.empty())
+        newSnapshot->nameIndex.emplace(entry.name, i);
+      if (!entry.nvsNamespaceName.empty())
+        newSnapshot->nvsNamespaceNameIndex.emplace(entry.nvsNamespaceName, i);
+      newSnapshot->typeIndex[entry.type].push_back(i);
+    }
+
+    Snapshot* oldSnapshot = snapshot.exchange(newSnapshot);
+    generation.fetch_add(1);
+
+    // Readers that started before the epoch change could still use the old snapshot
+    uint32_t oldEpochIndex = epoch.fetch_add(1) & 1;
+    while (numberOfReaders[oldEpochIndex].load())
+      vTaskDelay(1);
+    delete oldSnapshot;
+  }
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
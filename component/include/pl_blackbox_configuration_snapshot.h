@@ -0,0 +1,57 @@
+#pragma once
+#include "pl_blackbox_configuration_profile.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox configuration snapshot: the parameters of all configurations saved atomically in one of two NVS slots
+/// @details The snapshot is written to the inactive slot and then the header that points to it is written.
+/// A power loss during saving leaves the header pointing to the previous valid slot.
+class BlackBoxConfigurationSnapshot : public BlackBoxConfigurationProfile {
+public:
+  /// @brief Header NVS key
+  static const std::string headerNvsKey;
+  /// @brief Slot NVS keys
+  static const std::string slotNvsKeys[2];
+  /// @brief Maximum snapshot data size
+  static const size_t maxDataSize = 4000;
+
+  /// @brief Creates an empty BlackBox configuration snapshot
+  /// @param nvsNamespaceName NVS namespace name of the header and slots
+  BlackBoxConfigurationSnapshot(const std::string& nvsNamespaceName);
+
+  /// @brief Reads the newest valid snapshot
+  /// @details Only the header and the slot it points to are read. The other slot is checked only if the header or its slot is damaged.
+  /// @return error code
+  esp_err_t Read();
+
+  /// @brief Writes the snapshot to the inactive slot and makes it active
+  /// @return error code
+  esp_err_t Write();
+
+  /// @brief Gets the sequence number of the last read or written snapshot
+  /// @return sequence number (0 if there is no snapshot)
+  uint32_t GetSequenceNumber();
+
+private:
+  #pragma pack(push, 1)
+  struct Header {
+    uint32_t sequenceNumber;
+    uint8_t slot;
+    uint16_t dataSize;
+    uint32_t dataCrc;
+  };
+  #pragma pack(pop)
+
+  std::string nvsNamespaceName;
+  uint32_t sequenceNumber = 0;
+
+  esp_err_t ReadSlot(NvsNamespace& nvsNamespace, uint8_t slot, Header& header, std::vector<uint8_t>& data);
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,240 @@
+#pragma once
+#include "pl_common.h"
+#include "pl_nvs.h"
+#include "pl_blackbox_types.h"
+#include <vector>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief Base class for a BlackBox configuration storage (a set of typed values accessed by key)
+class BlackBoxConfigurationStorage {
+public:
+  virtual ~BlackBoxConfigurationStorage() {}
+
+  /// @brief Reads the value
+  /// @param key value key
+  /// @param value value
+  /// @return error code
+  virtual esp_err_t Read(const std::string& key, uint8_t& value) = 0;
+  virtual esp_err_t Read(const std::string& key, uint16_t& value) = 0;
+  virtual esp_err_t Read(const std::string& key, uint32_t& value) = 0;
+  virtual esp_err_t Read(const std::string& key, std::string& value) = 0;
+
+  /// @brief Reads the binary value
+  /// @param key value key
+  /// @param value value buffer
+  /// @param size value buffer size
+  /// @param readSize number of read bytes (can be NULL)
+  /// @return error code
+  virtual esp_err_t Read(const std::string& key, void* value, size_t size, size_t* readSize) = 0;
+
+  /// @brief Writes the value
+  /// @param key value key
+  /// @param value value
+  /// @return error code
+  virtual esp_err_t Write(const std::string& key, uint8_t value) = 0;
+  virtual esp_err_t Write(const std::string& key, uint16_t value) = 0;
+  virtual esp_err_t Write(const std::string& key, uint32_t value) = 0;
+  virtual esp_err_t Write(const std::string& key, const std::string& value) = 0;
+
+  /// @brief Writes the binary value
+  /// @param key value key
+  /// @param value value buffer
+  /// @param size value size
+  /// @return error code
+  virtual esp_err_t Write(const std::string& key, const void* value, size_t size) = 0;
+
+  /// @brief Erases the value
+  /// @param key value key
+  /// @return error code
+  virtual esp_err_t Erase(const std::string& key) = 0;
+};
+
+//==============================================================================
+
+/// @brief BlackBox configuration storage that keeps every value in a separate key of the NVS namespace
+class BlackBoxNvsConfigurationStorage : public BlackBoxConfigurationStorage {
+public:
+  /// @brief Creates a BlackBox NVS configuration storage
+  /// @param nvsNamespaceName NVS namespace name
+  /// @param accessMode NVS access mode
+  BlackBoxNvsConfigurationStorage(const std::string& nvsNamespaceName, NvsAccessMode accessMode);
+
+  esp_err_t Read(const std::string& key, uint8_t& value) override;
+  esp_err_t Read(const std::string& key, uint16_t& value) override;
+  esp_err_t Read(const std::string& key, uint32_t& value) override;
+  esp_err_t Read(const std::string& key, std::string& value) override;
+  esp_err_t Read(const std::string& key, void* value, size_t size, size_t* readSize) override;
+  esp_err_t Write(const std::string& key, uint8_t value) override;
+  esp_err_t Write(const std::string& key, uint16_t value) override;
+  esp_err_t Write(const std::string& key, uint32_t value) override;
+  esp_err_t Write(const std::string& key, const std::string& value) override;
+  esp_err_t Write(const std::string& key, const void* value, size_t size) override;
+  esp_err_t Erase(const std::string& key) override;
+
+private:
+  NvsNamespace nvsNamespace;
+};
+
+//==============================================================================
+
+/// @brief BlackBox configuration storage that keeps the values in memory as type-length-value records
+/// @details Record: value type (1 byte), key size (1 byte), key, value size (2 bytes, little-endian), value.
+class BlackBoxTlvConfigurationStorage : public Lockable, public BlackBoxConfigurationStorage {
+public:
+  /// @brief Creates an empty BlackBox TLV configuration storage
+  BlackBoxTlvConfigurationStorage() {}
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+
+  esp_err_t Read(const std::string& key, uint8_t& value) override;
+  esp_err_t Read(const std::string& key, uint16_t& value) override;
+  esp_err_t Read(const std::string& key, uint32_t& value) override;
+  esp_err_t Read(const std::string& key, std::string& value) override;
+  esp_err_t Read(const std::string& key, void* value, size_t size, size_t* readSize) override;
+  esp_err_t Write(const std::string& key, uint8_t value) override;
+  esp_err_t Write(const std::string& key, uint16_t value) override;
+  esp_err_t Write(const std::string& key, uint32_t value) override;
+  esp_err_t Write(const std::string& key, const std::string& value) override;
+  esp_err_t Write(const std::string& key, const void* value, size_t size) override;
+  esp_err_t Erase(const std::string& key) override;
+
+  /// @brief Gets the encoded records
+  /// @return encoded records
+  std::vector<uint8_t> GetData();
+
+  /// @brief Replaces the records with the encoded records
+  /// @param data encoded records
+  /// @param size encoded records size
+  /// @return error code
+  esp_err_t SetData(const void* data, size_t size);
+
+  /// @brief Checks if every record of this storage is present in the other storage with the same type and value
+  /// @param storage other storage
+  /// @return true if every record is present in the other storage
+  bool IsSubsetOf(BlackBoxTlvConfigurationStorage& storage);
+
+private:
+  Mutex mutex;
+  std::vector<uint8_t> data;
+
+  esp_err_t Find(const std::string& key, BlackBoxConfigurationValueType type, size_t& valueOffset, size_t& valueSize);
+  esp_err_t Add(const std::string& key, BlackBoxConfigurationValueType type, const void* value, size_t size);
+  bool Remove(const std::string& key);
+};
+
+//==============================================================================
+
+/// @brief BlackBox configuration storage that keeps the values in memory as members of a flat JSON object
+/// @details Integers are JSON numbers, strings are JSON strings and binary values are JSON strings of hexadecimal digits.
+/// JSON true and false are read as integers 1 and 0.
+class BlackBoxJsonConfigurationStorage : public Lockable, public BlackBoxConfigurationStorage {
+public:
+  /// @brief Creates an empty BlackBox JSON configuration storage
+  BlackBoxJsonConfigurationStorage() {}
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+
+  esp_err_t Read(const std::string& key, uint8_t& value) override;
+  esp_err_t Read(const std::string& key, uint16_t& value) override;
+  esp_err_t Read(const std::string& key, uint32_t& value) override;
+  esp_err_t Read(const std::string& key, std::string& value) override;
+  esp_err_t Read(const std::string& key, void* value, size_t size, size_t* readSize) override;
+  esp_err_t Write(const std::string& key, uint8_t value) override;
+  esp_err_t Write(const std::string& key, uint16_t value) override;
+  esp_err_t Write(const std::string& key, uint32_t value) override;
+  esp_err_t Write(const std::string& key, const std::string& value) override;
+  esp_err_t Write(const std::string& key, const void* value, size_t size) override;
+  esp_err_t Erase(const std::string& key) override;
+
+  /// @brief Gets the JSON object
+  /// @return JSON object
+  std::string GetJson();
+
+  /// @brief Replaces the values with the members of the JSON object
+  /// @param json JSON object
+  /// @return error code
+  esp_err_t SetJson(const std::string& json);
+
+  /// @brief Checks if every value of this storage is present in the other storage with the same value
+  /// @param storage other storage
+  /// @return true if every value is present in the other storage
+  bool IsSubsetOf(BlackBoxJsonConfigurationStorage& storage);
+
+  /// @brief Encodes the string as a JSON string
+  /// @param value string
+  /// @return JSON string (with quotes)
+  static std::string EncodeString(const std::string& value);
+
+private:
+  struct Member {
+    std::string key;
+    bool isString;
+    // Decimal number or decoded string
+    std::string value;
+  };
+
+  Mutex mutex;
+  std::vector<Member> members;
+
+  Member* Find(const std::string& key);
+  void Set(const std::string& key, bool isString, const std::string& value);
+  esp_err_t ReadNumber(const std::string& key, uint32_t maxValue, uint32_t& value);
+};
+
+//==============================================================================
+
+/// @brief BlackBox configuration storage that keeps only the values that differ from the default values
+/// @details Values are read from the override storage and, if absent, from the default storage.
+/// A written value that is equal to the default value is erased from the override storage. A binary override of another size is erased
+/// before the new value is written, so a stale larger override can never be read instead of the new value.
+class BlackBoxOverrideConfigurationStorage : public BlackBoxConfigurationStorage {
+public:
+  /// @brief Creates a BlackBox override configuration storage
+  /// @param defaultStorage default value storage
+  /// @param overrideStorage override value storage
+  BlackBoxOverrideConfigurationStorage(BlackBoxConfigurationStorage& defaultStorage, BlackBoxConfigurationStorage& overrideStorage);
+
+  esp_err_t Read(const std::string& key, uint8_t& value) override;
+  esp_err_t Read(const std::string& key, uint16_t& value) override;
+  esp_err_t Read(const std::string& key, uint32_t& value) override;
+  esp_err_t Read(const std::string& key, std::string& value) override;
+  esp_err_t Read(const std::string& key, void* value, size_t size, size_t* readSize) override;
+  esp_err_t Write(const std::string& key, uint8_t value) override;
+  esp_err_t Write(const std::string& key, uint16_t value) override;
+  esp_err_t Write(const std::string& key, uint32_t value) override;
+  esp_err_t Write(const std::string& key, const std::string& value) override;
+  esp_err_t Write(const std::string& key, const void* value, size_t size) override;
+  esp_err_t Erase(const std::string& key) override;
+
+private:
+  BlackBoxConfigurationStorage& defaultStorage;
+  BlackBoxConfigurationStorage& overrideStorage;
+
+  esp_err_t EraseOverride(const std::string& key);
+
+  template <class T>
+  esp_err_t ReadValue(const std::string& key, T& value) {
+    if (overrideStorage.Read(key, value) == ESP_OK)
+      return ESP_OK;
+    return defaultStorage.Read(key, value);
+  }
+
+  template <class T>
+  esp_err_t WriteValue(const std::string& key, const T& value) {
+    T defaultValue;
+    if (defaultStorage.Read(key, defaultValue) == ESP_OK && defaultValue == value)
+      return EraseOverride(key);
+    return overrideStorage.Write(key, value);
+  }
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
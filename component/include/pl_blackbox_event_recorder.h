@@ -0,0 +1,94 @@
+#pragma once
+#include "pl_blackbox_types.h"
+#include "esp_partition.h"
+#include "esp_timer.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox event recorder (flight recorder)
+/// @details Events are recorded to a ring buffer in the RTC memory that is not initialized after a software reset,
+/// so the events before a restart, a panic or a watchdog reset survive. Recording is lock-free and can be done from any task:
+/// the producers reserve the sequence numbers atomically and claim the event slot by its sequence number (sequence lock).
+/// If the ring buffer wraps while an event is written, the producer that does not get the slot drops its event.
+/// The first event after the reset is the reset event with the reset reason.
+/// The recorder object appends the recorded events to a flash data partition that is used as a circular log.
+class BlackBoxEventRecorder : public Lockable {
+public:
+  /// @brief Number of events in the RAM ring buffer
+  inline static const size_t ringBufferCapacity = 64;
+  /// @brief Sequence number of an empty or incomplete event slot
+  inline static const uint32_t invalidSequenceNumber = 0xFFFFFFFF;
+
+  /// @brief Records the event
+  /// @param type event type
+  /// @param code event code
+  /// @param value event value
+  static void Record(BlackBoxEventType type, uint16_t code = 0, uint32_t value = 0);
+
+  /// @brief Gets the sequence number of the oldest event in the RAM ring buffer
+  /// @return sequence number
+  static uint32_t GetFirstSequenceNumber();
+
+  /// @brief Gets the sequence number of the next recorded event
+  /// @return sequence number
+  static uint32_t GetNextSequenceNumber();
+
+  /// @brief Reads the event from the RAM ring buffer
+  /// @param sequenceNumber event sequence number
+  /// @param event event
+  /// @return error code (ESP_ERR_NOT_FOUND if the event has been overwritten or has not been recorded yet)
+  static esp_err_t ReadEvent(uint32_t sequenceNumber, BlackBoxEvent& event);
+
+  /// @brief Creates a BlackBox event recorder that stores the events in the flash data partition
+  /// @param partitionLabel data partition label
+  BlackBoxEventRecorder(const std::string& partitionLabel);
+  ~BlackBoxEventRecorder();
+  BlackBoxEventRecorder(const BlackBoxEventRecorder&) = delete;
+  BlackBoxEventRecorder& operator=(const BlackBoxEventRecorder&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+
+  /// @brief Appends the events that have not been stored yet to the partition
+  /// @return error code
+  esp_err_t Flush();
+
+  /// @brief Enables periodic flushing
+  /// @param interval flush interval in microseconds
+  /// @return error code
+  esp_err_t EnablePeriodicFlush(uint64_t interval);
+
+  /// @brief Disables periodic flushing
+  /// @return error code
+  esp_err_t DisablePeriodicFlush();
+
+  /// @brief Calls the visitor for every event stored in the partition from the oldest to the newest
+  /// @param visitor visitor
+  /// @return error code
+  esp_err_t ForEachStoredEvent(const std::function<void(const BlackBoxEvent& event)>& visitor);
+
+  /// @brief Erases all events stored in the partition
+  /// @return error code
+  esp_err_t EraseStoredEvents();
+
+private:
+  Mutex mutex;
+  std::string partitionLabel;
+  const esp_partition_t* partition = NULL;
+  size_t numberOfSlots = 0;
+  size_t writeSlot = 0;
+  esp_timer_handle_t flushTimer = NULL;
+
+  esp_err_t OpenPartition();
+  esp_err_t WriteStoredEvent(const BlackBoxEvent& event);
+
+  static void FlushTimerCallback(void* arg);
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
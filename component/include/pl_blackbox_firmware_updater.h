@@ -0,0 +1,84 @@
+#pragma once
+#include "pl_blackbox_types.h"
+#include "freertos/stream_buffer.h"
+#include <atomic>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox firmware updater that streams the firmware image to the inactive OTA partition
+/// @details The received data is queued to a stream buffer and written by a separate task, so the flash erase and write
+/// are done while the next data is received. The OTA partition is erased sector by sector as the image is written,
+/// so no image buffer is needed. The SHA-256 hash of the written image is compared with the expected hash,
+/// then the image is verified and set as the boot image. The update fails with ESP_ERR_TIMEOUT if no data is received within the inactivity timeout,
+/// so a disconnected client does not keep the OTA partition open.
+class BlackBoxFirmwareUpdater : public Lockable {
+public:
+  /// @brief Default stream buffer size
+  static const size_t defaultBufferSize = 8192;
+  /// @brief Write task stack depth
+  static const uint32_t taskStackDepth = 4096;
+  /// @brief Maximum time the write waits for the stream buffer space
+  inline static const TickType_t writeTimeout = pdMS_TO_TICKS(2000);
+  /// @brief Default maximum time between the received data
+  inline static const TickType_t defaultInactivityTimeout = pdMS_TO_TICKS(60000);
+  /// @brief SHA-256 hash size
+  inline static const size_t sha256Size = 32;
+
+  /// @brief Creates a BlackBox firmware updater
+  /// @param bufferSize stream buffer size
+  /// @param inactivityTimeout maximum time between the received data
+  BlackBoxFirmwareUpdater(size_t bufferSize = defaultBufferSize, TickType_t inactivityTimeout = defaultInactivityTimeout);
+  ~BlackBoxFirmwareUpdater();
+  BlackBoxFirmwareUpdater(const BlackBoxFirmwareUpdater&) = delete;
+  BlackBoxFirmwareUpdater& operator=(const BlackBoxFirmwareUpdater&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+
+  /// @brief Begins the update
+  /// @param imageSize image size in bytes
+  /// @param sha256 expected SHA-256 hash of the image
+  /// @return error code
+  esp_err_t Begin(uint32_t imageSize, const uint8_t* sha256);
+
+  /// @brief Writes the image data
+  /// @details The data that has already been received is skipped, so a retransmitted request does not corrupt the image.
+  /// @param offset data offset in the image (should not be greater than the number of received bytes)
+  /// @param data data
+  /// @param size data size
+  /// @return error code
+  esp_err_t Write(uint32_t offset, const void* data, size_t size);
+
+  /// @brief Aborts the update
+  /// @return error code
+  esp_err_t Abort();
+
+  /// @brief Gets the update status
+  /// @return update status
+  BlackBoxFirmwareUpdateStatus GetStatus();
+
+private:
+  Mutex mutex;
+  StreamBufferHandle_t streamBuffer = NULL;
+  TickType_t inactivityTimeout;
+  uint8_t expectedSha256[sha256Size] = {};
+  std::atomic<uint32_t> imageSize = 0;
+  std::atomic<BlackBoxFirmwareUpdateState> state = BlackBoxFirmwareUpdateState::idle;
+  std::atomic<esp_err_t> error = ESP_OK;
+  std::atomic<uint32_t> receivedSize = 0;
+  std::atomic<uint32_t> writtenSize = 0;
+  std::atomic<bool> abortRequested = false;
+  std::atomic<bool> taskRunning = false;
+
+  esp_err_t WriteImage();
+
+  static void WriteTask(void* parameters);
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -1,7 +1,10 @@
 #pragma once
 #include "pl_blackbox_configuration.h"
 #include "pl_blackbox_configuration_parameter.h"
+#include "pl_blackbox_configuration_storage.h"
+#include "pl_blackbox_types.h"
 #include "pl_nvs.h"
+#include <atomic>
 
 //==============================================================================
 
@@ -30,11 +33,26 @@ public:
   /// @return hardware interface
   std::shared_ptr<HardwareInterface> GetHardwareInterface();
 
+  /// @brief Gets the hardware interface type
+  /// @return hardware interface type
+  BlackBoxHardwareInterfaceType GetType();
+
   esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
   esp_err_t Unlock() override;
   void Load() override;
   void Save() override;
   void Erase() override;
+  void LoadParameters(BlackBoxConfigurationStorage& storage) override;
+  void SaveParameters(BlackBoxConfigurationStorage& storage) override;
+  std::string GetNvsNamespaceName() override;
+  void DeferLoad(std::shared_ptr<BlackBoxConfigurationStorage> storage = nullptr) override;
+
+  /// @brief Checks if the configuration loading is deferred and has not been performed yet
+  /// @return true if the configuration loading is deferred
+  bool IsLoadDeferred();
+
+  uint32_t GetGeneration() override;
+  void SetChangeHandler(std::function<void()> changeHandler) override;
 
   /// @brief Applies the configuration to the hardware interface
   virtual void Apply();
@@ -43,8 +61,33 @@ protected:
   Mutex mutex;
   std::string nvsNamespaceName;
 
+  /// @brief Makes the parameters load the deferred configuration on the first value access and report every value change
+  /// @param parameters parameters
+  template <class... T>
+  void InitializeParameters(BlackBoxConfigurationParameter<T>&... parameters) {
+    (parameters.SetAccessHandler([this]() { LoadIfDeferred(); }), ...);
+    (parameters.SetChangeHandler([this]() { OnParameterChanged(); }), ...);
+  }
+
+  /// @brief Loads the configuration if the loading is deferred
+  void LoadIfDeferred();
+
+  /// @brief Increments the configuration generation and calls the change handler
+  void OnParameterChanged();
+
 private:
+  enum class LoadState : uint8_t {
+    loaded,
+    deferred,
+    loading
+  };
+
   std::shared_ptr<HardwareInterface> hardwareInterface;
+  BlackBoxHardwareInterfaceType type;
+  std::atomic<LoadState> loadState = LoadState::loaded;
+  std::shared_ptr<BlackBoxConfigurationStorage> deferredLoadStorage;
+  std::atomic<uint32_t> generation = 0;
+  std::function<void()> changeHandler;
 };
 
 //==============================================================================
@@ -0,0 +1,66 @@
+#pragma once
+#include "pl_blackbox_types.h"
+#include "esp_timer.h"
+#include <atomic>
+#include <unordered_map>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox health monitor that periodically samples the heap, task stack and CPU load information
+/// @details The sampler writes the snapshot to the inactive one of two buffers and then switches the buffers,
+/// so GetHealth never blocks the sampler and is never blocked by it.
+/// Task information requires CONFIG_FREERTOS_USE_TRACE_FACILITY, CPU load requires CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+class BlackBoxHealthMonitor : public Lockable {
+public:
+  /// @brief Maximum number of tasks in the snapshot
+  inline static const size_t maxNumberOfTasks = sizeof(BlackBoxHealth::tasks) / sizeof(BlackBoxTaskHealth);
+  /// @brief Default sampling interval in microseconds
+  static const uint64_t defaultSamplingInterval = 1000000;
+
+  /// @brief Creates a BlackBox health monitor
+  BlackBoxHealthMonitor();
+  ~BlackBoxHealthMonitor();
+  BlackBoxHealthMonitor(const BlackBoxHealthMonitor&) = delete;
+  BlackBoxHealthMonitor& operator=(const BlackBoxHealthMonitor&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+
+  /// @brief Enables periodic sampling
+  /// @param samplingInterval sampling interval in microseconds
+  /// @return error code
+  esp_err_t EnablePeriodicSampling(uint64_t samplingInterval = defaultSamplingInterval);
+
+  /// @brief Disables periodic sampling
+  /// @return error code
+  esp_err_t DisablePeriodicSampling();
+
+  /// @brief Samples the health information
+  /// @return error code
+  esp_err_t Sample();
+
+  /// @brief Gets the last health snapshot
+  /// @return health snapshot
+  BlackBoxHealth GetHealth();
+
+private:
+  Mutex mutex;
+  esp_timer_handle_t samplingTimer = NULL;
+  BlackBoxHealth snapshots[2] = {};
+  // Number of published snapshots, the last one is snapshots[numberOfSnapshots % 2]
+  std::atomic<uint32_t> numberOfSnapshots = 0;
+  uint32_t sampleNumber = 0;
+  uint32_t previousTotalRunTime = 0;
+  std::unordered_map<TaskHandle_t, uint32_t> previousTaskRunTimes;
+
+  static void SamplingTimerCallback(void* arg);
+  static BlackBoxHeapHealth GetHeapHealth(uint32_t capabilities);
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
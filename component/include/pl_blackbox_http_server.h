@@ -0,0 +1,133 @@
+#pragma once
+#include "pl_blackbox_base.h"
+#include "pl_network.h"
+#include "esp_http_server.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox HTTP server that serves the device information and the configurations as JSON
+/// @details GET of the URI prefix returns the device information and the parameters of all hardware interface and server configurations
+/// (parameter NVS keys are used as JSON member names). The response is sent in chunks (one chunk per configuration)
+/// and has an ETag based on the BlackBox configuration generation: a request with a matching If-None-Match header gets 304 Not Modified.
+/// PATCH of the URI prefix + "/device", "/hardwareInterfaces/<index>" or "/servers/<index>" with a JSON object of parameters sets these parameters
+/// (they are applied after the restart, as with BlackBoxModbusServer). The device accepts the "devName" parameter
+/// and the "restart", "saveConfiguration", "clearRestartedFlag" and "clearResetInfo" commands (non-zero value executes the command).
+/// The response contains the resulting parameters. A configuration response has 422 Unprocessable Entity status if some parameter values have not been accepted.
+/// Write-only parameters (WiFi password) can be set with PATCH, but are never sent: neither in the responses nor in the events.
+/// GET of the URI prefix + "/events" opens a server-sent event stream with "device", "hardwareInterface", "server" (changed parameters),
+/// "status" (hardware interface enabled and connected state), "saved" and "resync" events. Events are queued per client and
+/// sent by a separate task, so the changes are never blocked by slow clients: a queue overflow or a configuration list change replaces the queued events
+/// with a "resync" event, after which the client should get the whole document again.
+/// GET of the URI prefix + "/trace" returns the binary dump of the BlackBox trace recorder (BlackBoxTraceRecorder::GetDump).
+/// The server is a network server, so its port and maximum number of clients can be configured with BlackBox::AddNetworkServerConfiguration.
+class BlackBoxHttpServer : public NetworkServer {
+public:
+  /// @brief Default port
+  static const uint16_t defaultPort = 80;
+  /// @brief Default maximum number of clients
+  static const size_t defaultMaxNumberOfClients = 4;
+  /// @brief Maximum PATCH request body size
+  static const size_t maxRequestBodySize = 1024;
+  /// @brief URI prefix
+  static const std::string uriPrefix;
+  /// @brief Maximum number of event stream clients
+  static const size_t maxNumberOfEventClients = 2;
+  /// @brief Maximum number of queued events per event stream client
+  static const size_t maxNumberOfQueuedEvents = 16;
+  /// @brief Event stream task stack depth
+  static const uint32_t eventTaskStackDepth = 4096;
+  /// @brief Hardware interface status poll interval
+  inline static const TickType_t statusPollInterval = pdMS_TO_TICKS(250);
+  /// @brief Event stream keep-alive interval
+  inline static const TickType_t keepAliveInterval = pdMS_TO_TICKS(15000);
+  /// @brief Event stream client stop timeout (Disable fails with ESP_ERR_TIMEOUT and the server stays enabled if the event tasks have not finished,
+  /// the destructor shuts down the event stream client sockets after this timeout and waits for the same time again)
+  inline static const TickType_t eventClientStopTimeout = pdMS_TO_TICKS(10000);
+
+  /// @brief Creates a BlackBox HTTP server
+  /// @param blackBox BlackBox
+  /// @param port port
+  BlackBoxHttpServer(std::shared_ptr<BlackBox> blackBox, uint16_t port = defaultPort);
+  ~BlackBoxHttpServer();
+  BlackBoxHttpServer(const BlackBoxHttpServer&) = delete;
+  BlackBoxHttpServer& operator=(const BlackBoxHttpServer&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+  esp_err_t Enable() override;
+  esp_err_t Disable() override;
+  bool IsEnabled() override;
+
+  /// @brief Gets the port
+  /// @return port
+  uint16_t GetPort() override;
+
+  /// @brief Sets the port (restarts the server if it is enabled)
+  /// @param port port
+  /// @return error code
+  esp_err_t SetPort(uint16_t port) override;
+
+  /// @brief Gets the maximum number of clients
+  /// @return maximum number of clients
+  size_t GetMaxNumberOfClients() override;
+
+  /// @brief Sets the maximum number of clients (restarts the server if it is enabled)
+  /// @param maxNumberOfClients maximum number of clients
+  /// @return error code
+  esp_err_t SetMaxNumberOfClients(size_t maxNumberOfClients) override;
+
+  /// @brief Gets the configuration JSON object that is sent to the clients
+  /// @details Write-only parameters (passwords) are not included (BlackBoxConfiguration::SaveReadableParameters).
+  /// @param configuration configuration
+  /// @param name hardware interface or server name
+  /// @param type configuration type
+  /// @return JSON object
+  static std::string GetConfigurationJson(BlackBoxConfiguration& configuration, const std::string& name, uint8_t type);
+
+private:
+  struct EventClient {
+    BlackBoxHttpServer* server;
+    httpd_req_t* request;
+    int socket = -1;
+    TaskHandle_t task = NULL;
+    Mutex mutex;
+    std::vector<std::pair<BlackBoxChangeType, std::shared_ptr<BlackBoxConfiguration>>> events;
+    bool resync = false;
+    bool stop = false;
+  };
+
+  Mutex mutex;
+  std::shared_ptr<BlackBox> blackBox;
+  httpd_handle_t handle = NULL;
+  uint16_t port;
+  size_t maxNumberOfClients = defaultMaxNumberOfClients;
+  Mutex eventClientMutex;
+  std::vector<std::shared_ptr<EventClient>> eventClients;
+  uint32_t changeObserverId = 0;
+
+  esp_err_t Restart();
+  std::string GetDeviceJson();
+  void OnChange(BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration);
+  esp_err_t StopEventClients();
+  void ShutdownEventClientSockets();
+  void SendEvents(EventClient& client);
+  std::string GetEventJson(BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration, std::string& eventName);
+  std::vector<uint8_t> GetHardwareInterfaceStatus();
+
+  static esp_err_t HandleGetRequest(httpd_req_t* request);
+  static esp_err_t HandlePatchRequest(httpd_req_t* request);
+  static esp_err_t HandleEventRequest(httpd_req_t* request);
+  static esp_err_t HandleTraceRequest(httpd_req_t* request);
+  static void EventTask(void* parameters);
+  static esp_err_t PatchConfiguration(httpd_req_t* request, BlackBoxConfiguration* configuration, BlackBoxJsonConfigurationStorage& parameters,
+    const std::string& name, uint8_t type);
+  static esp_err_t SendJson(httpd_req_t* request, const char* status, const std::string& json);
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#pragma once
+#include "pl_blackbox_base.h"
+#if CONFIG_ETH_ENABLED
+#include "esp_eth.h"
+#endif
+#include "esp_event.h"
+#include "esp_timer.h"
+#include <unordered_map>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox network interface link monitor that periodically samples the link quality of the BlackBox network interfaces
+/// @details The driver calls are made by the sampler and the results are cached, so GetLinkQuality never waits for a driver.
+/// Reconnections and disconnections are counted from the network interface events and passed as the trace points.
+/// Wi-Fi information is read for the ESP Wi-Fi station. Ethernet information is read for the first BlackBox ESP Ethernet interface
+/// at the link monitor creation and for the last connected ESP Ethernet driver after that.
+class BlackBoxLinkMonitor : public Lockable {
+public:
+  /// @brief Default sampling interval in microseconds
+  static const uint64_t defaultSamplingInterval = 2000000;
+
+  /// @brief Creates a BlackBox link monitor
+  /// @param blackBox BlackBox
+  BlackBoxLinkMonitor(std::shared_ptr<BlackBox> blackBox);
+  ~BlackBoxLinkMonitor();
+  BlackBoxLinkMonitor(const BlackBoxLinkMonitor&) = delete;
+  BlackBoxLinkMonitor& operator=(const BlackBoxLinkMonitor&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+
+  /// @brief Enables periodic sampling
+  /// @param samplingInterval sampling interval in microseconds
+  /// @return error code
+  esp_err_t EnablePeriodicSampling(uint64_t samplingInterval = defaultSamplingInterval);
+
+  /// @brief Disables periodic sampling
+  /// @return error code
+  esp_err_t DisablePeriodicSampling();
+
+  /// @brief Samples the link quality of the network interfaces of the BlackBox hardware interface configurations
+  /// @return error code
+  esp_err_t Sample();
+
+  /// @brief Gets the last sampled link quality of the network interface
+  /// @param networkInterface network interface
+  /// @param linkQuality link quality
+  /// @return error code (ESP_ERR_NOT_FOUND if the network interface has not been sampled)
+  esp_err_t GetLinkQuality(NetworkInterface& networkInterface, BlackBoxLinkQuality& linkQuality);
+
+private:
+  struct LinkState {
+    std::shared_ptr<NetworkInterface> networkInterface;
+    std::shared_ptr<LinkState*> eventHandlerObject;
+    BlackBoxLinkQuality linkQuality = {};
+    int64_t disconnectTime = 0;
+    // Index of the hardware interface configuration at the last sampling (trace point code)
+    uint16_t hardwareInterfaceIndex = 0;
+  };
+
+  Mutex mutex;
+  // Protects the link states and the Ethernet handle, is never locked during the driver calls
+  Mutex linkStateMutex;
+  std::shared_ptr<BlackBox> blackBox;
+  esp_timer_handle_t samplingTimer = NULL;
+#if CONFIG_ETH_ENABLED
+  esp_event_handler_instance_t ethernetEventHandlerInstance = NULL;
+  esp_eth_handle_t ethernetHandle = NULL;
+#endif
+  std::unordered_map<NetworkInterface*, LinkState> linkStates;
+
+  void OnConnected(NetworkInterface& networkInterface);
+  void OnDisconnected(NetworkInterface& networkInterface);
+
+  static void SamplingTimerCallback(void* arg);
+#if CONFIG_ETH_ENABLED
+  static void EthernetEventHandler(void* arg, esp_event_base_t eventBase, int32_t eventId, void* eventData);
+#endif
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
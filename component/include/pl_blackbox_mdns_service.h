@@ -0,0 +1,57 @@
+#pragma once
+#include "pl_blackbox_base.h"
+#include "esp_timer.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox mDNS service that publishes the BlackBox identity and service endpoints as DNS-SD TXT records
+/// @details The service is published by the mDNS server, so it should be enabled after the mDNS server.
+/// TXT records: "hw", "hwv", "uid" (hardware name, version and UID), "fw", "fwv" (firmware name and version), "dev" (device name),
+/// "modbus", "http" (enabled Modbus TCP and HTTP server ports, absent if there is no such server) and "gen" (configuration generation, 16 hexadecimal digits).
+/// The service port is the Modbus TCP port (the HTTP port if there is no Modbus TCP server).
+/// The records are updated after the BlackBox changes (the changes within the update delay are combined into one update).
+class BlackBoxMdnsService : public Server {
+public:
+  /// @brief Service type
+  static const std::string serviceType;
+  /// @brief Service protocol
+  static const std::string serviceProtocol;
+  /// @brief Delay between the change and the TXT record update in microseconds
+  static const uint64_t updateDelay = 200000;
+
+  /// @brief Creates a BlackBox mDNS service
+  /// @param blackBox BlackBox
+  BlackBoxMdnsService(std::shared_ptr<BlackBox> blackBox);
+  ~BlackBoxMdnsService();
+  BlackBoxMdnsService(const BlackBoxMdnsService&) = delete;
+  BlackBoxMdnsService& operator=(const BlackBoxMdnsService&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+  esp_err_t Enable() override;
+  esp_err_t Disable() override;
+  bool IsEnabled() override;
+
+  /// @brief Updates the TXT records immediately
+  /// @return error code
+  esp_err_t Update();
+
+private:
+  Mutex mutex;
+  std::shared_ptr<BlackBox> blackBox;
+  esp_timer_handle_t updateTimer = NULL;
+  bool enabled = false;
+  uint32_t changeObserverId = 0;
+
+  std::vector<std::pair<std::string, std::string>> GetTxtRecords(uint16_t& port);
+
+  static void UpdateTimerCallback(void* arg);
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,268 @@
+#pragma once
+#include "pl_modbus.h"
+#include <cstdint>
+#include <string_view>
+
+//==============================================================================
+
+/// @brief Golden BlackBox Modbus memory areas: AREA(area, memory type, address constant of PL::BlackBoxModbusServer, register address)
+/// @details The coils of the holding register areas have the same address (coil address = area address + register offset * 16 + bit).
+#define PL_BLACKBOX_MODBUS_MEMORY_AREAS(AREA) \
+  AREA(generalConfigurationHR, holdingRegisters, generalConfigurationMemoryAddress, 0) \
+  AREA(generalConfigurationIR, inputRegisters, generalConfigurationMemoryAddress, 0) \
+  AREA(hardwareInterfaceConfigurationHR, holdingRegisters, hardwareInterfaceConfigurationMemoryAddress, 100) \
+  AREA(hardwareInterfaceConfigurationIR, inputRegisters, hardwareInterfaceConfigurationMemoryAddress, 100) \
+  AREA(serverConfigurationHR, holdingRegisters, serverConfigurationMemoryAddress, 200) \
+  AREA(serverConfigurationIR, inputRegisters, serverConfigurationMemoryAddress, 200) \
+  AREA(eventLogHR, holdingRegisters, eventLogMemoryAddress, 300) \
+  AREA(eventLogIR, inputRegisters, eventLogMemoryAddress, 300) \
+  AREA(healthIR, inputRegisters, healthMemoryAddress, 400) \
+  AREA(firmwareUpdateHR, holdingRegisters, firmwareUpdateMemoryAddress, 500) \
+  AREA(firmwareUpdateIR, inputRegisters, firmwareUpdateMemoryAddress, 500) \
+  AREA(firmwareImageHR, holdingRegisters, firmwareImageMemoryAddress, 600)
+
+/// @brief Golden BlackBox Modbus memory area fields: FIELD(area, field, byte offset in the area, size in bytes, type) and BITS(area, field, byte offset of the register in the area, bit)
+/// @details The fields of the hardware interface and server configuration areas depend on the selected interface or server type, so they overlap.
+/// The array element fields (for example events[0]) describe the layout of each element.
+/// The layout of PL::BlackBoxModbusServer is checked against this list at compile time: a layout change must update the list and the memory map version.
+#define PL_BLACKBOX_MODBUS_MEMORY_MAP(FIELD, BITS) \
+  BITS(generalConfigurationHR, restart, 0, 0) \
+  BITS(generalConfigurationHR, saveConfiguration, 0, 1) \
+  BITS(generalConfigurationHR, clearRestartedFlag, 2, 0) \
+  BITS(generalConfigurationHR, clearResetInfo, 2, 1) \
+  FIELD(generalConfigurationHR, name, 4, 32, string) \
+  FIELD(generalConfigurationHR, selectedHardwareInterfaceIndex, 36, 2, uint16) \
+  FIELD(generalConfigurationHR, selectedServerIndex, 38, 2, uint16) \
+  FIELD(generalConfigurationIR, statusBits, 0, 2, uint16) \
+  BITS(generalConfigurationIR, restartedFlag, 2, 0) \
+  FIELD(generalConfigurationIR, plbbSignature, 4, 4, string) \
+  FIELD(generalConfigurationIR, memoryMapVersion, 8, 2, uint16) \
+  FIELD(generalConfigurationIR, hardwareInfo.name, 10, 32, string) \
+  FIELD(generalConfigurationIR, hardwareInfo.version.major, 42, 2, uint16) \
+  FIELD(generalConfigurationIR, hardwareInfo.version.minor, 44, 2, uint16) \
+  FIELD(generalConfigurationIR, hardwareInfo.version.patch, 46, 2, uint16) \
+  FIELD(generalConfigurationIR, hardwareInfo.uid, 48, 32, string) \
+  FIELD(generalConfigurationIR, firmwareInfo.name, 80, 32, string) \
+  FIELD(generalConfigurationIR, firmwareInfo.version.major, 112, 2, uint16) \
+  FIELD(generalConfigurationIR, firmwareInfo.version.minor, 114, 2, uint16) \
+  FIELD(generalConfigurationIR, firmwareInfo.version.patch, 116, 2, uint16) \
+  FIELD(generalConfigurationIR, numberOfHardwareInterfaces, 118, 2, uint16) \
+  FIELD(generalConfigurationIR, numberOfServers, 120, 2, uint16) \
+  FIELD(generalConfigurationIR, uptime, 122, 4, uint32) \
+  FIELD(generalConfigurationIR, minFreeHeapSize, 126, 4, uint32) \
+  FIELD(generalConfigurationIR, resetInfo.reason, 130, 2, uint16) \
+  FIELD(generalConfigurationIR, resetInfo.resetCounter, 132, 4, uint32) \
+  FIELD(generalConfigurationIR, resetInfo.abnormalResetCounter, 136, 4, uint32) \
+  FIELD(generalConfigurationIR, resetInfo.lastAbnormalResetReason, 140, 2, uint16) \
+  FIELD(generalConfigurationIR, resetInfo.panicPc, 142, 4, uint32) \
+  FIELD(generalConfigurationIR, resetInfo.panicBacktrace, 146, 16, uint32) \
+  FIELD(generalConfigurationIR, resetInfo.panicTaskName, 162, 16, string) \
+  FIELD(generalConfigurationIR, utcTime, 178, 4, uint32) \
+  FIELD(generalConfigurationIR, timeSinceSynchronization, 182, 4, uint32) \
+  BITS(hardwareInterfaceConfigurationHR, common.enabled, 0, 0) \
+  FIELD(hardwareInterfaceConfigurationHR, common.clearStickyStatusBits, 2, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationHR, uart.baudRate, 4, 4, uint32) \
+  FIELD(hardwareInterfaceConfigurationHR, uart.dataBits, 8, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationHR, uart.parity, 10, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationHR, uart.stopBits, 12, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationHR, uart.flowControl, 14, 2, uint16) \
+  BITS(hardwareInterfaceConfigurationHR, networkInterface.enabled, 0, 0) \
+  BITS(hardwareInterfaceConfigurationHR, networkInterface.ipV4DhcpClientEnabled, 0, 1) \
+  BITS(hardwareInterfaceConfigurationHR, networkInterface.ipV6DhcpClientEnabled, 0, 2) \
+  FIELD(hardwareInterfaceConfigurationHR, networkInterface.clearStickyStatusBits, 2, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationHR, networkInterface.ipV4Address, 4, 4, uint32) \
+  FIELD(hardwareInterfaceConfigurationHR, networkInterface.ipV4Netmask, 8, 4, uint32) \
+  FIELD(hardwareInterfaceConfigurationHR, networkInterface.ipV4Gateway, 12, 4, uint32) \
+  FIELD(hardwareInterfaceConfigurationHR, networkInterface.ipV6GlobalAddress, 16, 16, uint32) \
+  FIELD(hardwareInterfaceConfigurationHR, wifi.ssid, 32, 32, string) \
+  FIELD(hardwareInterfaceConfigurationHR, wifi.password, 64, 64, string) \
+  FIELD(hardwareInterfaceConfigurationIR, common.statusBits, 0, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationIR, common.stickyStatusBits, 2, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationIR, common.type, 4, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationIR, common.name, 6, 32, string) \
+  BITS(hardwareInterfaceConfigurationIR, networkInterface.connected, 0, 0) \
+  FIELD(hardwareInterfaceConfigurationIR, networkInterface.stickyStatusBits, 2, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationIR, networkInterface.type, 4, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationIR, networkInterface.name, 6, 32, string) \
+  FIELD(hardwareInterfaceConfigurationIR, networkInterface.ipV6LinkLocalAddress, 38, 16, uint32) \
+  FIELD(hardwareInterfaceConfigurationIR, networkInterface.reconnectCounter, 54, 4, uint32) \
+  FIELD(hardwareInterfaceConfigurationIR, networkInterface.timeSinceDisconnect, 58, 4, uint32) \
+  FIELD(hardwareInterfaceConfigurationIR, networkInterface.linkErrorCounter, 62, 4, uint32) \
+  FIELD(hardwareInterfaceConfigurationIR, networkInterface.linkDropCounter, 66, 4, uint32) \
+  FIELD(hardwareInterfaceConfigurationIR, ethernet.speed, 70, 2, uint16) \
+  BITS(hardwareInterfaceConfigurationIR, ethernet.fullDuplex, 72, 0) \
+  FIELD(hardwareInterfaceConfigurationIR, wifi.rssi, 70, 2, int16) \
+  FIELD(hardwareInterfaceConfigurationIR, wifi.channel, 72, 2, uint16) \
+  FIELD(hardwareInterfaceConfigurationIR, wifi.phyMode, 74, 2, uint16) \
+  BITS(serverConfigurationHR, common.enabled, 0, 0) \
+  FIELD(serverConfigurationHR, common.clearStickyStatusBits, 2, 2, uint16) \
+  FIELD(serverConfigurationHR, networkServer.port, 4, 2, uint16) \
+  FIELD(serverConfigurationHR, networkServer.maxNumberOfClients, 6, 2, uint16) \
+  FIELD(serverConfigurationHR, modbusServer.protocol, 4, 2, uint16) \
+  FIELD(serverConfigurationHR, modbusServer.stationAddress, 6, 2, uint16) \
+  FIELD(serverConfigurationHR, networkModbusServer.port, 8, 2, uint16) \
+  FIELD(serverConfigurationHR, networkModbusServer.maxNumberOfClients, 10, 2, uint16) \
+  FIELD(serverConfigurationHR, sntpClient.primaryServer, 4, 64, string) \
+  FIELD(serverConfigurationHR, sntpClient.secondaryServer, 68, 64, string) \
+  FIELD(serverConfigurationHR, sntpClient.syncInterval, 132, 4, uint32) \
+  FIELD(serverConfigurationHR, sntpClient.timeZone, 136, 32, string) \
+  FIELD(serverConfigurationIR, common.statusBits, 0, 2, uint16) \
+  FIELD(serverConfigurationIR, common.stickyStatusBits, 2, 2, uint16) \
+  FIELD(serverConfigurationIR, common.type, 4, 2, uint16) \
+  FIELD(serverConfigurationIR, common.name, 6, 32, string) \
+  FIELD(eventLogHR, selectedEventSequenceNumber, 0, 4, uint32) \
+  FIELD(eventLogIR, firstSequenceNumber, 0, 4, uint32) \
+  FIELD(eventLogIR, nextSequenceNumber, 4, 4, uint32) \
+  FIELD(eventLogIR, selectedEventSequenceNumber, 8, 4, uint32) \
+  FIELD(eventLogIR, events, 12, 176, bytes) \
+  FIELD(eventLogIR, events[0].sequenceNumber, 12, 4, uint32) \
+  FIELD(eventLogIR, events[0].time, 16, 4, uint32) \
+  FIELD(eventLogIR, events[0].type, 20, 1, uint8) \
+  FIELD(eventLogIR, events[0].bootNumber, 21, 1, uint8) \
+  FIELD(eventLogIR, events[0].code, 22, 2, uint16) \
+  FIELD(eventLogIR, events[0].value, 24, 4, uint32) \
+  FIELD(healthIR, uptime, 0, 4, uint32) \
+  FIELD(healthIR, heaps, 4, 36, bytes) \
+  FIELD(healthIR, heaps[0].freeSize, 4, 4, uint32) \
+  FIELD(healthIR, heaps[0].minFreeSize, 8, 4, uint32) \
+  FIELD(healthIR, heaps[0].largestFreeBlockSize, 12, 4, uint32) \
+  FIELD(healthIR, coreIdleTime, 40, 4, uint16) \
+  FIELD(healthIR, numberOfTasks, 44, 2, uint16) \
+  FIELD(healthIR, tasks, 46, 154, bytes) \
+  FIELD(healthIR, tasks[0].name, 46, 16, string) \
+  FIELD(healthIR, tasks[0].stackHighWaterMark, 62, 4, uint32) \
+  FIELD(healthIR, tasks[0].cpuLoad, 66, 2, uint16) \
+  BITS(firmwareUpdateHR, begin, 0, 0) \
+  BITS(firmwareUpdateHR, abort, 0, 1) \
+  FIELD(firmwareUpdateHR, imageSize, 2, 4, uint32) \
+  FIELD(firmwareUpdateHR, sha256, 6, 32, bytes) \
+  FIELD(firmwareUpdateIR, state, 0, 2, uint16) \
+  FIELD(firmwareUpdateIR, error, 2, 4, int32) \
+  FIELD(firmwareUpdateIR, imageSize, 6, 4, uint32) \
+  FIELD(firmwareUpdateIR, receivedSize, 10, 4, uint32) \
+  FIELD(firmwareUpdateIR, writtenSize, 14, 4, uint32) \
+  FIELD(firmwareImageHR, offset, 0, 4, uint32) \
+  FIELD(firmwareImageHR, size, 4, 2, uint16) \
+  FIELD(firmwareImageHR, data, 6, 194, bytes)
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox Modbus memory map version described by the golden memory map
+static const uint16_t blackBoxModbusGoldenMemoryMapVersion = 2;
+
+/// @brief BlackBox Modbus memory map field type (the encoding of the field in the registers)
+enum class BlackBoxModbusFieldType {
+  /// @brief bit in a register (a coil for the holding registers)
+  bits,
+  /// @brief unsigned 8-bit integer in the low (even offset) or high (odd offset) byte of a register
+  uint8,
+  /// @brief unsigned 16-bit integer in one register
+  uint16,
+  /// @brief signed 16-bit integer in one register
+  int16,
+  /// @brief unsigned 32-bit integer (or an array of them) in two registers per integer, the low register first
+  uint32,
+  /// @brief signed 32-bit integer in two registers, the low register first
+  int32,
+  /// @brief characters (null-terminated if shorter than the field), two characters per register, the first character in the low byte
+  string,
+  /// @brief bytes, two bytes per register, the first byte in the low byte
+  bytes
+};
+
+//==============================================================================
+
+/// @brief BlackBox Modbus memory area of the golden memory map
+struct BlackBoxModbusMemoryArea {
+  /// @brief Area name
+  const char* name;
+  /// @brief Memory type
+  ModbusMemoryType memoryType;
+  /// @brief Register address
+  uint16_t address;
+};
+
+/// @brief BlackBox Modbus memory area field of the golden memory map
+struct BlackBoxModbusMemoryMapField {
+  /// @brief Area name
+  const char* area;
+  /// @brief Field name
+  const char* name;
+  /// @brief Byte offset in the area (register offset = offset / 2)
+  uint16_t offset;
+  /// @brief Size in bytes
+  uint16_t size;
+  /// @brief Type
+  BlackBoxModbusFieldType type;
+  /// @brief Bit number in the register (bits type only)
+  uint8_t bit;
+};
+
+//==============================================================================
+
+/// @brief Golden BlackBox Modbus memory areas
+inline constexpr BlackBoxModbusMemoryArea blackBoxModbusMemoryAreas[] = {
+  #define PL_BLACKBOX_MODBUS_AREA_ENTRY(area, memoryType, addressConstant, address) {#area, ModbusMemoryType::memoryType, address},
+  PL_BLACKBOX_MODBUS_MEMORY_AREAS(PL_BLACKBOX_MODBUS_AREA_ENTRY)
+  #undef PL_BLACKBOX_MODBUS_AREA_ENTRY
+};
+
+/// @brief Golden BlackBox Modbus memory area fields
+inline constexpr BlackBoxModbusMemoryMapField blackBoxModbusMemoryMap[] = {
+  #define PL_BLACKBOX_MODBUS_FIELD_ENTRY(area, field, offset, size, type) {#area, #field, offset, size, BlackBoxModbusFieldType::type, 0},
+  #define PL_BLACKBOX_MODBUS_BITS_ENTRY(area, field, offset, bit) {#area, #field, offset, 2, BlackBoxModbusFieldType::bits, bit},
+  PL_BLACKBOX_MODBUS_MEMORY_MAP(PL_BLACKBOX_MODBUS_FIELD_ENTRY, PL_BLACKBOX_MODBUS_BITS_ENTRY)
+  #undef PL_BLACKBOX_MODBUS_FIELD_ENTRY
+  #undef PL_BLACKBOX_MODBUS_BITS_ENTRY
+};
+
+//==============================================================================
+
+/// @brief Finds the memory area of the golden memory map
+/// @param area area name
+/// @return memory area (nullptr if not found)
+constexpr const BlackBoxModbusMemoryArea* FindBlackBoxModbusMemoryArea(std::string_view area) {
+  for (auto& memoryArea : blackBoxModbusMemoryAreas) {
+    if (area == memoryArea.name)
+      return &memoryArea;
+  }
+  return nullptr;
+}
+
+/// @brief Finds the memory area field of the golden memory map
+/// @param area area name
+/// @param name field name
+/// @return memory area field (nullptr if not found)
+constexpr const BlackBoxModbusMemoryMapField* FindBlackBoxModbusMemoryMapField(std::string_view area, std::string_view name) {
+  for (auto& field : blackBoxModbusMemoryMap) {
+    if (area == field.area && name == field.name)
+      return &field;
+  }
+  return nullptr;
+}
+
+/// @brief Gets the register address of the memory area field of the golden memory map
+/// @details A missing area or field fails the compilation, so the function is intended for constant expressions.
+/// @param area area name
+/// @param name field name
+/// @return register address
+constexpr uint16_t GetBlackBoxModbusMemoryMapAddress(std::string_view area, std::string_view name) {
+  return FindBlackBoxModbusMemoryArea(area)->address + FindBlackBoxModbusMemoryMapField(area, name)->offset / 2;
+}
+
+/// @brief Gets the coil address of the bits field of the golden memory map (holding register areas only)
+/// @details A missing area or field fails the compilation, so the function is intended for constant expressions.
+/// @param area area name
+/// @param name field name
+/// @return coil address
+constexpr uint16_t GetBlackBoxModbusMemoryMapCoil(std::string_view area, std::string_view name) {
+  return FindBlackBoxModbusMemoryArea(area)->address + FindBlackBoxModbusMemoryMapField(area, name)->offset / 2 * 16 + FindBlackBoxModbusMemoryMapField(area, name)->bit;
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
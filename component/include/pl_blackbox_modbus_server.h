@@ -1,6 +1,8 @@
 #pragma once
 #include "pl_blackbox_base.h"
 #include "pl_modbus.h"
+#include "pl_blackbox_health_monitor.h"
+#include "pl_blackbox_modbus_memory_map.h"
 
 //==============================================================================
 
@@ -20,18 +22,34 @@ public:
   static const uint16_t hardwareInterfaceConfigurationMemoryAddress = generalConfigurationMemoryAddress + registerMemoryAreaSize / 2;
   /// @brief Server configuration memory address
   static const uint16_t serverConfigurationMemoryAddress = hardwareInterfaceConfigurationMemoryAddress + registerMemoryAreaSize / 2;
+  /// @brief Event log memory address
+  static const uint16_t eventLogMemoryAddress = serverConfigurationMemoryAddress + registerMemoryAreaSize / 2;
+  /// @brief Health memory address
+  static const uint16_t healthMemoryAddress = eventLogMemoryAddress + registerMemoryAreaSize / 2;
+  /// @brief Firmware update memory address (control holding registers and status input registers)
+  static const uint16_t firmwareUpdateMemoryAddress = healthMemoryAddress + registerMemoryAreaSize / 2;
+  /// @brief Firmware image memory address (image data holding registers)
+  static const uint16_t firmwareImageMemoryAddress = firmwareUpdateMemoryAddress + registerMemoryAreaSize / 2;
+  /// @brief Maximum image data size in one firmware image holding register write
+  inline static const size_t firmwareImageChunkSize = registerMemoryAreaSize - sizeof(uint32_t) - sizeof(uint16_t);
+  /// @brief Number of events in the event log input register window
+  inline static const size_t eventLogWindowSize = (registerMemoryAreaSize - 3 * sizeof(uint32_t)) / sizeof(BlackBoxEvent);
 
   /// @brief BlackBox signature
   static const std::string plbbSignature;
   /// @brief Memory map version
-  static const uint16_t memoryMapVersion = 1;
+  static const uint16_t memoryMapVersion = 2;
 
-  /// @brief Maximum device, firmware and hardware name size
+  /// @brief Maximum device, firmware and hardware name size (including the terminating null character)
   inline static const size_t maxNameSize = 32;
-  /// @brief Maximum Wi-Fi SSID size
+  /// @brief Maximum Wi-Fi SSID size (including the terminating null character)
   inline static const size_t maxWiFiSsidSize = 32;
-  /// @brief Maximum Wi-Fi password size
+  /// @brief Maximum Wi-Fi password size (including the terminating null character)
   inline static const size_t maxWiFiPasswordSize = 64;
+  /// @brief Maximum SNTP server name size (including the terminating null character)
+  inline static const size_t maxSntpServerNameSize = 64;
+  /// @brief Maximum time zone size (including the terminating null character)
+  inline static const size_t maxTimeZoneSize = 32;
 
   /// @brief Creates a stream BlackBox Modbus server with shared transaction buffer
   /// @param blackBox BlackBox
@@ -61,10 +79,17 @@ public:
   /// @param bufferSize transaction buffer size
   BlackBoxModbusServer(std::shared_ptr<BlackBox> blackBox, uint16_t port, size_t bufferSize = defaultBufferSize);
 
+  /// @brief Checks the memory data bit fields against the golden memory map
+  /// @details The bit order of the bit fields is implementation-defined, so it cannot be checked at compile time.
+  /// Each bit field is set separately and must set only its bit of the golden memory map register.
+  /// @return true if all bit fields match the golden memory map
+  static bool CheckMemoryMapBits();
+
 private:
   std::shared_ptr<BlackBox> blackBox;
   uint16_t selectedHardwareInterfaceIndex = 0;
   uint16_t selectedServerIndex = 0;
+  uint32_t selectedEventSequenceNumber = 0;
 
   #pragma pack(push, 1)
   union MemoryData {
@@ -75,6 +100,7 @@ private:
       uint16_t saveConfiguration:1;
       uint16_t :0;
       uint16_t clearRestartedFlag:1;
+      uint16_t clearResetInfo:1;
       uint16_t :0;
       char name[maxNameSize];
       uint16_t selectedHardwareInterfaceIndex;
@@ -106,6 +132,19 @@ private:
       } firmwareInfo;
       uint16_t numberOfHardwareInterfaces;
       uint16_t numberOfServers;
+      uint32_t uptime;
+      uint32_t minFreeHeapSize;
+      struct {
+        uint16_t reason;
+        uint32_t resetCounter;
+        uint32_t abnormalResetCounter;
+        uint16_t lastAbnormalResetReason;
+        uint32_t panicPc;
+        uint32_t panicBacktrace[4];
+        char panicTaskName[16];
+      } resetInfo;
+      uint32_t utcTime;
+      uint32_t timeSinceSynchronization;
     } generalConfigurationIR;
 
     union HardwareInterfaceConfigurationHR {
@@ -170,14 +209,24 @@ private:
         uint16_t type;
         char name[maxNameSize];
         uint32_t ipV6LinkLocalAddress[4];
+        uint32_t reconnectCounter;
+        uint32_t timeSinceDisconnect;
+        uint32_t linkErrorCounter;
+        uint32_t linkDropCounter;
       } networkInterface;
       
       struct Ethernet {
         uint8_t networkInterface[sizeof(NetworkInterface)];
+        uint16_t speed;
+        uint16_t fullDuplex:1;
+        uint16_t :0;
       } ethernet;
       
       struct WiFi {
         uint8_t networkInterface[sizeof(NetworkInterface)];
+        int16_t rssi;
+        uint16_t channel;
+        uint16_t phyMode;
       } wifi;
 
       struct UsbDeviceCdc {
@@ -221,6 +270,14 @@ private:
       struct MdnsServer {
         uint8_t networkServer[sizeof(NetworkServer)];
       } mdnsServer;
+
+      struct SntpClient {
+        uint8_t common[sizeof(Common)];
+        char primaryServer[maxSntpServerNameSize];
+        char secondaryServer[maxSntpServerNameSize];
+        uint32_t syncInterval;
+        char timeZone[maxTimeZoneSize];
+      } sntpClient;
     } serverConfigurationHR;
 
     union ServerConfigurationIR {
@@ -255,9 +312,73 @@ private:
         uint8_t networkServer[sizeof(NetworkServer)];
       } mdnsServer;
     } serverConfigurationIR;
+
+    struct EventLogHR {
+      uint32_t selectedEventSequenceNumber;
+    } eventLogHR;
+
+    struct EventLogIR {
+      uint32_t firstSequenceNumber;
+      uint32_t nextSequenceNumber;
+      uint32_t selectedEventSequenceNumber;
+      BlackBoxEvent events[eventLogWindowSize];
+    } eventLogIR;
+
+    struct HealthIR {
+      uint32_t uptime;
+      struct {
+        uint32_t freeSize;
+        uint32_t minFreeSize;
+        uint32_t largestFreeBlockSize;
+      } heaps[3];
+      uint16_t coreIdleTime[2];
+      uint16_t numberOfTasks;
+      struct {
+        char name[sizeof(BlackBoxTaskHealth::name)];
+        uint32_t stackHighWaterMark;
+        uint16_t cpuLoad;
+      } tasks[BlackBoxHealthMonitor::maxNumberOfTasks];
+    } healthIR;
+
+    struct FirmwareUpdateHR {
+      uint16_t begin:1;
+      uint16_t abort:1;
+      uint16_t :0;
+      uint32_t imageSize;
+      uint8_t sha256[BlackBoxFirmwareUpdater::sha256Size];
+    } firmwareUpdateHR;
+
+    struct FirmwareUpdateIR {
+      uint16_t state;
+      int32_t error;
+      uint32_t imageSize;
+      uint32_t receivedSize;
+      uint32_t writtenSize;
+    } firmwareUpdateIR;
+
+    struct FirmwareImageHR {
+      uint32_t offset;
+      uint16_t size;
+      uint8_t data[firmwareImageChunkSize];
+    } firmwareImageHR;
   } memoryData;
   #pragma pack(pop)
 
+  // The memory data layout is checked against the golden memory map, so the layout changes that break the Modbus clients do not compile
+  static_assert(memoryMapVersion == blackBoxModbusGoldenMemoryMapVersion, "memory map version differs from the golden memory map version");
+  #define PL_BLACKBOX_MODBUS_CHECK_AREA(area, memoryType, addressConstant, address) \
+    static_assert(addressConstant == address && sizeof(MemoryData::area) <= registerMemoryAreaSize, "memory area " #area " differs from the golden memory map");
+  #define PL_BLACKBOX_MODBUS_CHECK_FIELD(area, field, offset, size, type) \
+    static_assert(offsetof(MemoryData, area.field) == offset && sizeof(MemoryData::area.field) == size, "memory area field " #area "." #field " differs from the golden memory map");
+  // The bit order is checked at run time by CheckMemoryMapBits
+  #define PL_BLACKBOX_MODBUS_CHECK_BITS(area, field, offset, bit) \
+    static_assert(offset % 2 == 0 && offset < sizeof(MemoryData::area) && bit < 16, "memory area bit " #area "." #field " is outside the memory area");
+  PL_BLACKBOX_MODBUS_MEMORY_AREAS(PL_BLACKBOX_MODBUS_CHECK_AREA)
+  PL_BLACKBOX_MODBUS_MEMORY_MAP(PL_BLACKBOX_MODBUS_CHECK_FIELD, PL_BLACKBOX_MODBUS_CHECK_BITS)
+  #undef PL_BLACKBOX_MODBUS_CHECK_AREA
+  #undef PL_BLACKBOX_MODBUS_CHECK_FIELD
+  #undef PL_BLACKBOX_MODBUS_CHECK_BITS
+
   class GeneralConfigurationHR : public ModbusMemoryArea {
   public:
     GeneralConfigurationHR(BlackBoxModbusServer& modbusServer, ModbusMemoryType memoryType, size_t size);
@@ -314,6 +435,63 @@ private:
   private:
     BlackBoxModbusServer& modbusServer;
   };
+
+  class EventLogHR : public ModbusMemoryArea {
+  public:
+    EventLogHR(BlackBoxModbusServer& modbusServer);
+    esp_err_t OnRead() override;
+    esp_err_t OnWrite() override;
+  
+  private:
+    BlackBoxModbusServer& modbusServer;
+  };
+
+  class EventLogIR : public ModbusMemoryArea {
+  public:
+    EventLogIR(BlackBoxModbusServer& modbusServer);
+    esp_err_t OnRead() override;
+  
+  private:
+    BlackBoxModbusServer& modbusServer;
+  };
+
+  class HealthIR : public ModbusMemoryArea {
+  public:
+    HealthIR(BlackBoxModbusServer& modbusServer);
+    esp_err_t OnRead() override;
+  
+  private:
+    BlackBoxModbusServer& modbusServer;
+  };
+
+  class FirmwareUpdateHR : public ModbusMemoryArea {
+  public:
+    FirmwareUpdateHR(BlackBoxModbusServer& modbusServer);
+    esp_err_t OnRead() override;
+    esp_err_t OnWrite() override;
+  
+  private:
+    BlackBoxModbusServer& modbusServer;
+  };
+
+  class FirmwareUpdateIR : public ModbusMemoryArea {
+  public:
+    FirmwareUpdateIR(BlackBoxModbusServer& modbusServer);
+    esp_err_t OnRead() override;
+  
+  private:
+    BlackBoxModbusServer& modbusServer;
+  };
+
+  class FirmwareImageHR : public ModbusMemoryArea {
+  public:
+    FirmwareImageHR(BlackBoxModbusServer& modbusServer);
+    esp_err_t OnRead() override;
+    esp_err_t OnWrite() override;
+  
+  private:
+    BlackBoxModbusServer& modbusServer;
+  };
   
   std::shared_ptr<PL::TypedBuffer<MemoryData>> memoryDataBuffer;
 
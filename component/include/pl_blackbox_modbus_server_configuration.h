@@ -40,8 +40,8 @@ public:
   /// @brief max number of clients parameter
   BlackBoxConfigurationParameter<size_t> maxNumberOfClients;
 
-  void Load() override;
-  void Save() override;
+  void LoadParameters(BlackBoxConfigurationStorage& storage) override;
+  void SaveParameters(BlackBoxConfigurationStorage& storage) override;
   void Apply() override;
 
 private:
@@ -47,8 +47,8 @@ public:
   /// @brief IPv6 DHCP client enabled parameter
   BlackBoxConfigurationParameter<bool> ipV6DhcpClientEnabled;
 
-  void Load() override;
-  void Save() override;
+  void LoadParameters(BlackBoxConfigurationStorage& storage) override;
+  void SaveParameters(BlackBoxConfigurationStorage& storage) override;
   void Apply() override;
 
 private:
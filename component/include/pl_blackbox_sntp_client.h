@@ -0,0 +1,81 @@
+#pragma once
+#include "pl_blackbox_clock.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox SNTP client that synchronizes the system time and the BlackBox clock
+/// @details The client uses the ESP-IDF SNTP service, so only one client should be enabled.
+/// The number of servers used is limited by CONFIG_LWIP_SNTP_MAX_SERVERS.
+class BlackBoxSntpClient : public Server {
+public:
+  /// @brief Maximum number of servers
+  inline static const size_t maxNumberOfServers = 2;
+  /// @brief Default server name
+  static const std::string defaultServerName;
+  /// @brief Default synchronization interval in seconds
+  static const uint32_t defaultSyncInterval = 3600;
+  /// @brief Minimum synchronization interval in seconds
+  static const uint32_t minSyncInterval = 15;
+  /// @brief Default time zone
+  static const std::string defaultTimeZone;
+
+  /// @brief Creates a BlackBox SNTP client
+  BlackBoxSntpClient();
+  ~BlackBoxSntpClient();
+  BlackBoxSntpClient(const BlackBoxSntpClient&) = delete;
+  BlackBoxSntpClient& operator=(const BlackBoxSntpClient&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+  esp_err_t Enable() override;
+  esp_err_t Disable() override;
+  bool IsEnabled() override;
+
+  /// @brief Gets the server name
+  /// @param index server index
+  /// @return server name (empty if the server is not used)
+  std::string GetServerName(size_t index);
+
+  /// @brief Sets the server name
+  /// @param index server index
+  /// @param serverName server name (empty if the server should not be used)
+  /// @return error code
+  esp_err_t SetServerName(size_t index, const std::string& serverName);
+
+  /// @brief Gets the synchronization interval
+  /// @return synchronization interval in seconds
+  uint32_t GetSyncInterval();
+
+  /// @brief Sets the synchronization interval
+  /// @param syncInterval synchronization interval in seconds
+  /// @return error code
+  esp_err_t SetSyncInterval(uint32_t syncInterval);
+
+  /// @brief Gets the time zone
+  /// @return POSIX TZ time zone string
+  std::string GetTimeZone();
+
+  /// @brief Sets the time zone of the local time functions
+  /// @param timeZone POSIX TZ time zone string (e.g. "CET-1CEST,M3.5.0,M10.5.0/3")
+  /// @return error code
+  esp_err_t SetTimeZone(const std::string& timeZone);
+
+private:
+  Mutex mutex;
+  bool enabled = false;
+  std::string serverNames[maxNumberOfServers];
+  uint32_t syncInterval = defaultSyncInterval;
+  std::string timeZone;
+
+  esp_err_t Restart();
+
+  static void TimeSyncCallback(struct timeval* time);
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
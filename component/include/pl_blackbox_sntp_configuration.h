@@ -0,0 +1,50 @@
+#pragma once
+#include "pl_blackbox_server_configuration.h"
+#include "pl_blackbox_sntp_client.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox SNTP configuration
+class BlackBoxSntpConfiguration : public BlackBoxServerConfiguration {
+public:
+  /// @brief primary server parameter NVS key
+  static const std::string primaryServerNvsKey;
+  /// @brief secondary server parameter NVS key
+  static const std::string secondaryServerNvsKey;
+  /// @brief synchronization interval parameter NVS key
+  static const std::string syncIntervalNvsKey;
+  /// @brief time zone parameter NVS key
+  static const std::string timeZoneNvsKey;
+
+  /// @brief Creates a BlackBox SNTP configuration
+  /// @param sntpClient SNTP client
+  /// @param nvsNamespaceName NVS namespace name
+  BlackBoxSntpConfiguration(std::shared_ptr<BlackBoxSntpClient> sntpClient, std::string nvsNamespaceName);
+
+  /// @brief primary server parameter
+  BlackBoxConfigurationParameter<std::string> primaryServer;
+
+  /// @brief secondary server parameter
+  BlackBoxConfigurationParameter<std::string> secondaryServer;
+
+  /// @brief synchronization interval (in seconds) parameter
+  BlackBoxConfigurationParameter<uint32_t> syncInterval;
+
+  /// @brief time zone (POSIX TZ string) parameter
+  BlackBoxConfigurationParameter<std::string> timeZone;
+
+  void LoadParameters(BlackBoxConfigurationStorage& storage) override;
+  void SaveParameters(BlackBoxConfigurationStorage& storage) override;
+  void Apply() override;
+
+private:
+  std::shared_ptr<BlackBoxSntpClient> sntpClient;
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
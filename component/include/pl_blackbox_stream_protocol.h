@@ -0,0 +1,227 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox stream protocol command
+enum class BlackBoxStreamCommand : uint8_t {
+  /// @brief read the configurations that have changed since the specified generations
+  readConfiguration = 1,
+  /// @brief write the configuration parameters
+  writeConfiguration = 2,
+  /// @brief save all configurations
+  saveConfiguration = 3,
+  /// @brief restart the device
+  restart = 4
+};
+
+//==============================================================================
+
+/// @brief BlackBox stream protocol response status
+enum class BlackBoxStreamStatus : uint8_t {
+  /// @brief success
+  ok = 0,
+  /// @brief unknown command
+  invalidCommand = 1,
+  /// @brief invalid request payload
+  invalidData = 2,
+  /// @brief configuration with the specified NVS namespace name not found
+  configurationNotFound = 3,
+  /// @brief some parameter values have not been accepted
+  valueRejected = 4,
+  /// @brief response payload exceeds the maximum payload size
+  tooLarge = 5
+};
+
+//==============================================================================
+
+/// @brief BlackBox stream protocol frame decode result
+enum class BlackBoxStreamDecodeResult : uint8_t {
+  /// @brief frame decoded
+  ok = 0,
+  /// @brief more data is needed
+  incomplete = 1,
+  /// @brief invalid start byte, payload size or CRC (the frame size is the number of bytes to skip)
+  invalid = 2
+};
+
+//==============================================================================
+
+/// @brief BlackBox stream protocol codec
+/// @details The codec depends only on the C++ standard library and can be compiled into the host tools as is.
+/// Frame: start byte, command (1 byte), payload size (2 bytes, little-endian), payload,
+/// CRC-32 of the command, payload size and payload (4 bytes, little-endian, zlib-compatible).
+/// Response command is the request command with the response flag set, response payload starts with the status byte.
+/// Configurations are transferred as BlackBoxConfigurationProfile sections (one section per configuration).
+class BlackBoxStreamProtocol {
+public:
+  /// @brief Frame start byte
+  static const uint8_t startByte = 0xBB;
+  /// @brief Response command flag
+  static const uint8_t responseFlag = 0x80;
+  /// @brief Frame header size (start byte, command, payload size)
+  static const size_t headerSize = 4;
+  /// @brief Frame CRC size
+  static const size_t crcSize = 4;
+  /// @brief Maximum payload size
+  static const size_t maxPayloadSize = 4096;
+
+  /// @brief Calculates the CRC-32 (zlib-compatible)
+  /// @param crc previous CRC (0 for the first block)
+  /// @param data data
+  /// @param size data size
+  /// @return CRC
+  static uint32_t GetCrc(uint32_t crc, const void* data, size_t size) {
+    static const uint32_t nibbleTable[16] = {
+      0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+      0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+    const uint8_t* bytes = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+      crc = nibbleTable[(crc ^ bytes[i]) & 0x0F] ^ (crc >> 4);
+      crc = nibbleTable[(crc ^ (bytes[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+    return ~crc;
+  }
+
+  /// @brief Encodes the frame
+  /// @param command command
+  /// @param payload payload
+  /// @param payloadSize payload size (not more than the maximum payload size)
+  /// @return encoded frame
+  static std::vector<uint8_t> EncodeFrame(uint8_t command, const void* payload, size_t payloadSize) {
+    std::vector<uint8_t> frame = {startByte, command, (uint8_t)payloadSize, (uint8_t)(payloadSize >> 8)};
+    frame.insert(frame.end(), (const uint8_t*)payload, (const uint8_t*)payload + payloadSize);
+    AppendU32(frame, GetCrc(0, frame.data() + 1, frame.size() - 1));
+    return frame;
+  }
+
+  /// @brief Decodes the frame at the beginning of the data
+  /// @param data data
+  /// @param size data size
+  /// @param command decoded command
+  /// @param payload decoded payload
+  /// @param frameSize number of bytes used by the decoded or invalid frame
+  /// @return decode result
+  static BlackBoxStreamDecodeResult DecodeFrame(const void* data, size_t size, uint8_t& command, std::vector<uint8_t>& payload, size_t& frameSize) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    frameSize = 1;
+    if (!size)
+      return BlackBoxStreamDecodeResult::incomplete;
+    if (bytes[0] != startByte)
+      return BlackBoxStreamDecodeResult::invalid;
+    if (size < headerSize)
+      return BlackBoxStreamDecodeResult::incomplete;
+    size_t payloadSize = bytes[2] | (bytes[3] << 8);
+    if (payloadSize > maxPayloadSize)
+      return BlackBoxStreamDecodeResult::invalid;
+    if (size < headerSize + payloadSize + crcSize)
+      return BlackBoxStreamDecodeResult::incomplete;
+    if (GetCrc(0, bytes + 1, headerSize - 1 + payloadSize) != ReadU32(bytes + headerSize + payloadSize))
+      return BlackBoxStreamDecodeResult::invalid;
+
+    command = bytes[1];
+    payload.assign(bytes + headerSize, bytes + headerSize + payloadSize);
+    frameSize = headerSize + payloadSize + crcSize;
+    return BlackBoxStreamDecodeResult::ok;
+  }
+
+  /// @brief Appends the configuration value record (BlackBoxTlvConfigurationStorage record)
+  /// @param data encoded records
+  /// @param type value type (BlackBoxConfigurationValueType)
+  /// @param key value key
+  /// @param value value
+  /// @param size value size
+  static void AppendRecord(std::vector<uint8_t>& data, uint8_t type, const std::string& key, const void* value, size_t size) {
+    data.push_back(type);
+    data.push_back((uint8_t)key.size());
+    data.insert(data.end(), key.begin(), key.end());
+    data.push_back((uint8_t)size);
+    data.push_back((uint8_t)(size >> 8));
+    data.insert(data.end(), (const uint8_t*)value, (const uint8_t*)value + size);
+  }
+
+  /// @brief Appends the configuration section (BlackBoxConfigurationProfile section)
+  /// @param data encoded sections
+  /// @param nvsNamespaceName configuration NVS namespace name
+  /// @param records encoded section records
+  static void AppendSection(std::vector<uint8_t>& data, const std::string& nvsNamespaceName, const std::vector<uint8_t>& records) {
+    data.push_back((uint8_t)nvsNamespaceName.size());
+    data.insert(data.end(), nvsNamespaceName.begin(), nvsNamespaceName.end());
+    data.push_back((uint8_t)records.size());
+    data.push_back((uint8_t)(records.size() >> 8));
+    data.insert(data.end(), records.begin(), records.end());
+  }
+
+  /// @brief Calls the visitor for every configuration value record
+  /// @param data encoded records
+  /// @param size encoded records size
+  /// @param visitor visitor (value type, key, value, value size)
+  /// @return false if the records are invalid
+  static bool ForEachRecord(const void* data, size_t size, const std::function<void(uint8_t type, const std::string& key, const uint8_t* value, size_t size)>& visitor) {
+    return ForEachItem(data, size, 1, [&](const uint8_t* item, const std::string& key, const uint8_t* value, size_t valueSize) {
+      visitor(item[0], key, value, valueSize);
+    });
+  }
+
+  /// @brief Calls the visitor for every configuration section
+  /// @param data encoded sections
+  /// @param size encoded sections size
+  /// @param visitor visitor (configuration NVS namespace name, encoded section records, encoded section records size)
+  /// @return false if the sections are invalid
+  static bool ForEachSection(const void* data, size_t size, const std::function<void(const std::string& nvsNamespaceName, const uint8_t* records, size_t size)>& visitor) {
+    return ForEachItem(data, size, 0, [&](const uint8_t* item, const std::string& nvsNamespaceName, const uint8_t* records, size_t recordsSize) {
+      visitor(nvsNamespaceName, records, recordsSize);
+    });
+  }
+
+  /// @brief Appends the 32-bit value (little-endian)
+  /// @param data data
+  /// @param value value
+  static void AppendU32(std::vector<uint8_t>& data, uint32_t value) {
+    for (int i = 0; i < 4; i++)
+      data.push_back((uint8_t)(value >> (i * 8)));
+  }
+
+  /// @brief Reads the 32-bit value (little-endian)
+  /// @param data data
+  /// @return value
+  static uint32_t ReadU32(const uint8_t* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+  }
+
+private:
+  // Item: prefix (prefixSize bytes), key size (1 byte), key, value size (2 bytes, little-endian), value
+  static bool ForEachItem(const void* data, size_t size, size_t prefixSize,
+      const std::function<void(const uint8_t* item, const std::string& key, const uint8_t* value, size_t size)>& visitor) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t offset = 0; offset < size;) {
+      if (offset + prefixSize + 1 > size)
+        return false;
+      size_t keySize = bytes[offset + prefixSize];
+      size_t valueSizeOffset = offset + prefixSize + 1 + keySize;
+      if (valueSizeOffset + 2 > size)
+        return false;
+      size_t valueSize = bytes[valueSizeOffset] | (bytes[valueSizeOffset + 1] << 8);
+      size_t valueOffset = valueSizeOffset + 2;
+      if (valueOffset + valueSize > size)
+        return false;
+      visitor(bytes + offset, std::string((const char*)bytes + offset + prefixSize + 1, keySize), bytes + valueOffset, valueSize);
+      offset = valueOffset + valueSize;
+    }
+    return true;
+  }
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+#include "pl_blackbox_base.h"
+#include "pl_blackbox_configuration_profile.h"
+#include "pl_blackbox_stream_protocol.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox stream server that transfers the configurations as compact binary frames (BlackBoxStreamProtocol)
+/// @details Read configuration request payload is empty or contains the generation records (u32 BlackBoxTlvConfigurationStorage records
+/// with configuration NVS namespace names as keys) from the previous response. Response payload: status, generation records size (2 bytes, little-endian),
+/// generation records of all configurations, BlackBoxConfigurationProfile sections of the configurations whose generation differs from the requested one
+/// (configurations with zero generation are always sent). Generations include the BlackBox generation epoch, so they do not match the generations
+/// read before the reset. Configurations that are absent from the generation records have been removed.
+/// Write configuration request payload contains BlackBoxConfigurationProfile sections with only the parameters to change.
+/// The parameters are applied after the restart, as with BlackBoxModbusServer. Save configuration and restart requests have an empty payload.
+/// Write-only parameters (WiFi password) can be written, but are never read (BlackBoxConfiguration::SaveReadableParameters).
+class BlackBoxStreamServer : public StreamServer {
+public:
+  /// @brief Creates a BlackBox stream server
+  /// @param blackBox BlackBox
+  /// @param stream stream
+  BlackBoxStreamServer(std::shared_ptr<BlackBox> blackBox, std::shared_ptr<Stream> stream);
+
+  /// @brief Handles the read configuration request payload
+  /// @param request request payload
+  /// @param response response payload (without status)
+  /// @return status
+  BlackBoxStreamStatus ReadConfiguration(const std::vector<uint8_t>& request, std::vector<uint8_t>& response);
+
+  /// @brief Handles the write configuration request payload
+  /// @param request request payload
+  /// @return status
+  BlackBoxStreamStatus WriteConfiguration(const std::vector<uint8_t>& request);
+
+protected:
+  esp_err_t HandleRequest(Stream& stream) override;
+
+private:
+  std::shared_ptr<BlackBox> blackBox;
+
+  static esp_err_t SendResponse(Stream& stream, uint8_t command, BlackBoxStreamStatus status, const std::vector<uint8_t>& payload = {});
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+#include "pl_blackbox_types.h"
+#include "sdkconfig.h"
+
+//==============================================================================
+
+/// @brief Passes the BlackBox trace point to the trace hook (removed at compile time if CONFIG_PL_BLACKBOX_TRACE_ENABLED is not set)
+/// @param tracePoint BlackBoxTracePoint member name
+#if CONFIG_PL_BLACKBOX_TRACE_ENABLED
+#define PL_BLACKBOX_TRACE(tracePoint, ...) PL::BlackBoxTrace::Emit(PL::BlackBoxTracePoint::tracePoint, ##__VA_ARGS__)
+#else
+#define PL_BLACKBOX_TRACE(tracePoint, ...) ((void)0)
+#endif
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief BlackBox trace point
+enum class BlackBoxTracePoint : uint8_t {
+  /// @brief configurations application started (code: 0 - hardware interface configurations, 1 - server configurations)
+  applyStart = 0,
+  /// @brief configurations application finished (code: 0 - hardware interface configurations, 1 - server configurations)
+  applyEnd = 1,
+  /// @brief all configurations saving started
+  saveStart = 2,
+  /// @brief all configurations saving finished
+  saveEnd = 3,
+  /// @brief all configurations loading started
+  loadStart = 4,
+  /// @brief all configurations loading finished
+  loadEnd = 5,
+  /// @brief BlackBox Modbus server memory area read (code: Modbus memory type, value: memory area address)
+  modbusAreaRead = 6,
+  /// @brief BlackBox Modbus server memory area write processed (code: Modbus memory type, value: memory area address)
+  modbusAreaWrite = 7,
+  /// @brief configuration parameter value changed (value: configuration NVS namespace name hash)
+  parameterChange = 8,
+  /// @brief network interface connected (code: hardware interface index)
+  interfaceConnected = 9,
+  /// @brief network interface disconnected (code: hardware interface index)
+  interfaceDisconnected = 10,
+  /// @brief BlackBox mDNS service update finished (code: 1 - service updated, 0 - service disabled)
+  mdnsUpdate = 11
+};
+
+//==============================================================================
+
+/// @brief BlackBox trace hook
+class BlackBoxTraceHook {
+public:
+  virtual ~BlackBoxTraceHook() {}
+
+  /// @brief Handles the trace point
+  /// @details Called by the task that passes the trace point, possibly with the BlackBox and configuration mutexes locked,
+  /// so the handler should be short and should not call the BlackBox functions.
+  /// @param tracePoint trace point
+  /// @param code trace point code
+  /// @param value trace point value
+  virtual void OnTracePoint(BlackBoxTracePoint tracePoint, uint16_t code, uint32_t value) = 0;
+};
+
+//==============================================================================
+
+/// @brief BlackBox trace
+/// @details The BlackBox passes the trace points to the trace hook with the PL_BLACKBOX_TRACE macro.
+/// The macro is removed at compile time if CONFIG_PL_BLACKBOX_TRACE_ENABLED is not set and costs one atomic load if the hook is not set.
+class BlackBoxTrace {
+public:
+  /// @brief Gets the trace hook
+  /// @return trace hook (NULL if not set)
+  static BlackBoxTraceHook* GetHook();
+
+  /// @brief Sets the trace hook
+  /// @details The hook is not owned by the trace. The function returns after the tasks that pass the trace points
+  /// to the previous hook have finished, so the previous hook can be destroyed after it (it should not be called from the hook).
+  /// @param hook trace hook (NULL: no hook)
+  static void SetHook(BlackBoxTraceHook* hook);
+
+  /// @brief Passes the trace point to the trace hook
+  /// @param tracePoint trace point
+  /// @param code trace point code
+  /// @param value trace point value
+  static void Emit(BlackBoxTracePoint tracePoint, uint16_t code = 0, uint32_t value = 0);
+};
+
+//==============================================================================
+
+/// @brief BlackBox trace hook that records the trace points with the event recorder
+/// @details The trace points are recorded as the BlackBoxEventType::trace events
+/// (code: trace point in the high byte and the low byte of the trace point code in the low byte, value: trace point value).
+class BlackBoxEventRecorderTraceHook : public BlackBoxTraceHook {
+public:
+  /// @brief All trace points mask
+  inline static const uint32_t allTracePoints = 0xFFFFFFFF;
+
+  /// @brief Gets the trace point mask bit
+  /// @param tracePoint trace point
+  /// @return trace point mask bit
+  static constexpr uint32_t GetMaskBit(BlackBoxTracePoint tracePoint) { return (uint32_t)1 << (uint8_t)tracePoint; }
+
+  /// @brief Creates a BlackBox event recorder trace hook
+  /// @param tracePointMask mask of the recorded trace points
+  BlackBoxEventRecorderTraceHook(uint32_t tracePointMask = allTracePoints);
+
+  void OnTracePoint(BlackBoxTracePoint tracePoint, uint16_t code, uint32_t value) override;
+
+private:
+  const uint32_t tracePointMask;
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
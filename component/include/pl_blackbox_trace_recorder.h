@@ -0,0 +1,112 @@
+#pragma once
+#include "pl_blackbox_trace.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <vector>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+#pragma pack(push, 1)
+/// @brief BlackBox trace record
+struct BlackBoxTraceRecord {
+  /// @brief Time since the device reset in microseconds (modulo 2^32)
+  uint32_t time;
+  /// @brief Trace point
+  BlackBoxTracePoint tracePoint;
+  /// @brief Index of the task in the trace dump task table (BlackBoxTraceRecorder::unknownTaskIndex if the task table is full)
+  uint8_t taskIndex;
+  /// @brief Trace point code
+  uint16_t code;
+  /// @brief Trace point value
+  uint32_t value;
+};
+
+/// @brief BlackBox trace dump header
+/// @details The dump (little-endian) consists of the header, the task table (task names of taskNameSize bytes)
+/// and the trace records from the oldest to the newest.
+struct BlackBoxTraceDumpHeader {
+  /// @brief Signature (BlackBoxTraceRecorder::dumpSignature)
+  uint32_t signature;
+  /// @brief Dump format version (BlackBoxTraceRecorder::dumpVersion)
+  uint16_t version;
+  /// @brief Header size
+  uint16_t headerSize;
+  /// @brief Trace record size
+  uint16_t recordSize;
+  /// @brief Task name size
+  uint16_t taskNameSize;
+  /// @brief Number of tasks in the task table
+  uint16_t numberOfTasks;
+  /// @brief Reserved
+  uint16_t reserved;
+  /// @brief Number of trace records
+  uint32_t numberOfRecords;
+  /// @brief Number of overwritten trace records
+  uint32_t numberOfLostRecords;
+  /// @brief Time of the dump since the device reset in microseconds
+  int64_t time;
+  /// @brief UTC time of the dump in microseconds since 1970 (0 if the time has not been synchronized)
+  int64_t utcTime;
+};
+#pragma pack(pop)
+
+//==============================================================================
+
+/// @brief BlackBox trace recorder that buffers the trace points in a RAM ring buffer
+/// @details The trace points are recorded in a critical section, so the recorder can be used by any task and never blocks.
+/// The oldest records are overwritten when the ring buffer is full. The recording tasks are identified by the task table
+/// that stores the name of each task on its first trace point.
+/// The dump can be downloaded with BlackBoxHttpServer and converted to the Chrome/Perfetto trace JSON by tools/blackbox_trace_to_json.py.
+class BlackBoxTraceRecorder : public BlackBoxTraceHook {
+public:
+  /// @brief Default number of trace records in the ring buffer
+  static const size_t defaultCapacity = 512;
+  /// @brief Maximum number of tasks in the task table
+  static const size_t maxNumberOfTasks = 32;
+  /// @brief Task name size in the task table
+  static const size_t taskNameSize = 16;
+  /// @brief Task index of the tasks that are not in the task table
+  static const uint8_t unknownTaskIndex = 0xFF;
+  /// @brief Dump signature
+  static const uint32_t dumpSignature = 0x54424C50;
+  /// @brief Dump format version
+  static const uint16_t dumpVersion = 1;
+
+  /// @brief Creates a BlackBox trace recorder
+  /// @param capacity number of trace records in the ring buffer
+  BlackBoxTraceRecorder(size_t capacity = defaultCapacity);
+  BlackBoxTraceRecorder(const BlackBoxTraceRecorder&) = delete;
+  BlackBoxTraceRecorder& operator=(const BlackBoxTraceRecorder&) = delete;
+
+  void OnTracePoint(BlackBoxTracePoint tracePoint, uint16_t code, uint32_t value) override;
+
+  /// @brief Gets the number of trace records in the ring buffer
+  /// @return number of trace records
+  size_t GetNumberOfRecords();
+
+  /// @brief Clears the trace records and the task table
+  void Clear();
+
+  /// @brief Gets the dump of the task table and the trace records
+  /// @return dump
+  std::vector<uint8_t> GetDump();
+
+private:
+  portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+  std::vector<BlackBoxTraceRecord> records;
+  uint32_t numberOfRecordedRecords = 0;
+  int64_t lastRecordTime = 0;
+  TaskHandle_t tasks[maxNumberOfTasks];
+  char taskNames[maxNumberOfTasks][taskNameSize];
+  size_t numberOfTasks = 0;
+
+  uint8_t GetTaskIndex(TaskHandle_t task);
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -62,7 +62,209 @@ enum class BlackBoxServerType : uint8_t {
   /// @brief HTTP server
   httpServer = 5,
   /// @brief mDNS server
-  mdnsServer = 6
+  mdnsServer = 6,
+  /// @brief SNTP client
+  sntpClient = 7
+};
+
+//==============================================================================
+
+/// @brief BlackBox configuration storage value type
+enum class BlackBoxConfigurationValueType : uint8_t {
+  /// @brief unsigned 8-bit integer
+  u8 = 1,
+  /// @brief unsigned 16-bit integer
+  u16 = 2,
+  /// @brief unsigned 32-bit integer
+  u32 = 3,
+  /// @brief string
+  string = 4,
+  /// @brief binary data
+  blob = 5
+};
+
+//==============================================================================
+
+/// @brief BlackBox change type
+enum class BlackBoxChangeType : uint8_t {
+  /// @brief device name or restarted flag changed
+  device = 1,
+  /// @brief configuration parameter value changed
+  configuration = 2,
+  /// @brief configuration added, removed or replaced
+  configurationList = 3,
+  /// @brief all configurations saved
+  configurationsSaved = 4
+};
+
+//==============================================================================
+
+/// @brief BlackBox event type
+enum class BlackBoxEventType : uint8_t {
+  /// @brief device reset (value: reset reason)
+  reset = 1,
+  /// @brief restart requested
+  restart = 2,
+  /// @brief configuration parameter value changed (value: configuration NVS namespace name hash)
+  configurationChanged = 3,
+  /// @brief all configurations saved
+  configurationsSaved = 4,
+  /// @brief hardware interface configuration applied (code: hardware interface index, value: enabled)
+  hardwareInterfaceApplied = 5,
+  /// @brief server configuration applied (code: server index, value: enabled)
+  serverApplied = 6,
+  /// @brief Modbus error (code: Modbus exception or error code)
+  modbusError = 7,
+  /// @brief time synchronized (value: UTC time in seconds since 1970)
+  timeSynchronized = 8,
+  /// @brief trace point (code: trace point and trace point code, value: trace point value)
+  trace = 9,
+  /// @brief first application-defined event type
+  user = 128
+};
+
+//==============================================================================
+
+#pragma pack(push, 1)
+/// @brief BlackBox event record
+struct BlackBoxEvent {
+  /// @brief Sequence number
+  uint32_t sequenceNumber;
+  /// @brief Time since the device reset in milliseconds
+  uint32_t time;
+  /// @brief Event type
+  BlackBoxEventType type;
+  /// @brief Boot number (modulo 256)
+  uint8_t bootNumber;
+  /// @brief Event code (meaning depends on the event type)
+  uint16_t code;
+  /// @brief Event value (meaning depends on the event type)
+  uint32_t value;
+};
+#pragma pack(pop)
+
+//==============================================================================
+
+/// @brief BlackBox heap health
+struct BlackBoxHeapHealth {
+  /// @brief Free size in bytes
+  uint32_t freeSize;
+  /// @brief Minimum free size since the reset in bytes
+  uint32_t minFreeSize;
+  /// @brief Largest free block size in bytes
+  uint32_t largestFreeBlockSize;
+};
+
+//==============================================================================
+
+/// @brief BlackBox task health
+struct BlackBoxTaskHealth {
+  /// @brief Task name
+  char name[16];
+  /// @brief Stack high-water mark (minimum free stack size) in bytes
+  uint32_t stackHighWaterMark;
+  /// @brief CPU load in 0.1% of one core during the last sampling interval
+  uint16_t cpuLoad;
+};
+
+//==============================================================================
+
+/// @brief BlackBox health snapshot
+struct BlackBoxHealth {
+  /// @brief Sample number (0 if there have been no samples)
+  uint32_t sampleNumber;
+  /// @brief Time since the device reset in milliseconds
+  uint64_t uptime;
+  /// @brief Default capability heap health
+  BlackBoxHeapHealth defaultHeap;
+  /// @brief Internal memory heap health
+  BlackBoxHeapHealth internalHeap;
+  /// @brief External memory (SPIRAM) heap health
+  BlackBoxHeapHealth spiramHeap;
+  /// @brief Idle time in 0.1% for every core during the last sampling interval
+  uint16_t coreIdleTime[2];
+  /// @brief Number of tasks in the task list
+  uint16_t numberOfTasks;
+  /// @brief Tasks with the lowest stack high-water marks
+  BlackBoxTaskHealth tasks[7];
+};
+
+//==============================================================================
+
+/// @brief BlackBox reset information
+/// @details The abnormal reset information is sticky: it is kept over the following normal resets until it is cleared.
+struct BlackBoxResetInfo {
+  /// @brief Reason of the last reset (esp_reset_reason_t)
+  uint16_t reason;
+  /// @brief Number of resets since the power-on
+  uint32_t resetCounter;
+  /// @brief Number of abnormal (panic, watchdog and brownout) resets since the power-on or the clear
+  uint32_t abnormalResetCounter;
+  /// @brief Reason of the last abnormal reset (ESP_RST_UNKNOWN if there has been no abnormal reset)
+  /// @details The watchdog resets are reported as ESP_RST_INT_WDT, ESP_RST_TASK_WDT and ESP_RST_WDT.
+  uint16_t lastAbnormalResetReason;
+  /// @brief Program counter of the last panic (0 if unknown)
+  uint32_t panicPc;
+  /// @brief First addresses of the last panic backtrace (0 if unknown)
+  uint32_t panicBacktrace[4];
+  /// @brief Name of the task that was running at the last panic (empty if unknown)
+  char panicTaskName[16];
+};
+
+//==============================================================================
+
+/// @brief BlackBox network interface link quality
+struct BlackBoxLinkQuality {
+  /// @brief Number of connections after a disconnection since the monitoring start
+  uint32_t reconnectCounter;
+  /// @brief Time since the last disconnection in seconds (0xFFFFFFFF if there has been no disconnection since the monitoring start)
+  uint32_t timeSinceDisconnect;
+  /// @brief Wi-Fi RSSI in dBm (0 if unknown)
+  int8_t wifiRssi;
+  /// @brief Wi-Fi primary channel (0 if unknown)
+  uint8_t wifiChannel;
+  /// @brief Wi-Fi negotiated PHY mode (wifi_phy_mode_t)
+  uint8_t wifiPhyMode;
+  /// @brief Ethernet link speed in Mbit/s (0 if unknown)
+  uint16_t ethernetSpeed;
+  /// @brief Ethernet full duplex mode
+  bool ethernetFullDuplex;
+  /// @brief Link layer error counter (lwIP statistics of all network interfaces)
+  uint32_t linkErrorCounter;
+  /// @brief Link layer dropped packet counter (lwIP statistics of all network interfaces)
+  uint32_t linkDropCounter;
+};
+
+//==============================================================================
+
+/// @brief BlackBox firmware update state
+enum class BlackBoxFirmwareUpdateState : uint8_t {
+  /// @brief no update
+  idle = 0,
+  /// @brief image is being received and written
+  receiving = 1,
+  /// @brief image is being verified
+  verifying = 2,
+  /// @brief image is verified and set as the boot image, the device can be restarted
+  ready = 3,
+  /// @brief update has failed
+  error = 4
+};
+
+//==============================================================================
+
+/// @brief BlackBox firmware update status
+struct BlackBoxFirmwareUpdateStatus {
+  /// @brief State
+  BlackBoxFirmwareUpdateState state;
+  /// @brief Error code of the failed update
+  esp_err_t error;
+  /// @brief Image size in bytes
+  uint32_t imageSize;
+  /// @brief Number of received bytes
+  uint32_t receivedSize;
+  /// @brief Number of bytes written to the OTA partition
+  uint32_t writtenSize;
 };
 
 //==============================================================================
@@ -42,8 +42,8 @@ public:
   /// @brief flow control parameter
   BlackBoxConfigurationParameter<UartFlowControl> flowControl;
   
-  void Load() override;
-  void Save() override;
+  void LoadParameters(BlackBoxConfigurationStorage& storage) override;
+  void SaveParameters(BlackBoxConfigurationStorage& storage) override;
   void Apply() override;
 
 private:
@@ -26,8 +26,9 @@ public:
     /// @brief password parameter
   BlackBoxConfigurationParameter<std::string> password;
 
-  void Load() override;
-  void Save() override;
+  void LoadParameters(BlackBoxConfigurationStorage& storage) override;
+  void SaveParameters(BlackBoxConfigurationStorage& storage) override;
+  void SaveReadableParameters(BlackBoxConfigurationStorage& storage) override;
   void Apply() override;
 
 private:
@@ -1,5 +1,18 @@
 #include "pl_blackbox_base.h"
+#include "pl_blackbox_trace.h"
 #include "esp_check.h"
+#include "esp_attr.h"
+#include "esp_random.h"
+#include "sdkconfig.h"
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH && CONFIG_ESP_COREDUMP_DATA_FORMAT_ELF
+#include "esp_core_dump.h"
+#endif
+#include <algorithm>
+#include <cstring>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_base";
 
 //==============================================================================
 
@@ -17,11 +30,117 @@ const std::string BlackBox::hardwareInfoPatchVersionNvsKey = "verPatch";
 const std::string BlackBox::hardwareInfoUidNvsKey = "uid";
 
 const std::string BlackBox::generalConfigurationDeviceNameNvsKey = "devName";
+const std::string BlackBox::generalConfigurationIndexNvsKey = "cfgIndex";
+
+//==============================================================================
+
+struct BlackBoxResetInfoStorage {
+  uint32_t signature;
+  uint32_t size;
+  BlackBoxResetInfo resetInfo;
+};
+
+static const uint32_t resetInfoStorageSignature = 0x52424C50;
+static RTC_NOINIT_ATTR BlackBoxResetInfoStorage resetInfoStorage;
+
+//==============================================================================
+
+static bool InitializeResetInfo() {
+  esp_reset_reason_t resetReason = esp_reset_reason();
+  BlackBoxResetInfo& resetInfo = resetInfoStorage.resetInfo;
+  // The RTC memory content is undefined after the power-on reset. After the brownout reset it is kept if the signature and size are valid,
+  // so that the brownout storms do not erase the previous reset history.
+  if (resetReason == ESP_RST_POWERON || resetInfoStorage.signature != resetInfoStorageSignature ||
+      resetInfoStorage.size != sizeof(BlackBoxResetInfoStorage)) {
+    memset(&resetInfoStorage, 0, sizeof(BlackBoxResetInfoStorage));
+    resetInfoStorage.signature = resetInfoStorageSignature;
+    resetInfoStorage.size = sizeof(BlackBoxResetInfoStorage);
+  }
+  resetInfo.reason = resetReason;
+  resetInfo.resetCounter++;
+
+  if (resetReason != ESP_RST_PANIC && resetReason != ESP_RST_INT_WDT && resetReason != ESP_RST_TASK_WDT &&
+      resetReason != ESP_RST_WDT && resetReason != ESP_RST_BROWNOUT)
+    return true;
+  resetInfo.abnormalResetCounter++;
+  resetInfo.lastAbnormalResetReason = resetReason;
+  resetInfo.panicPc = 0;
+  memset(resetInfo.panicBacktrace, 0, sizeof(resetInfo.panicBacktrace));
+  memset(resetInfo.panicTaskName, 0, sizeof(resetInfo.panicTaskName));
+
+#if CONFIG_ESP_COREDUMP_ENABLE_TO_FLASH && CONFIG_ESP_COREDUMP_DATA_FORMAT_ELF
+  // The core dump is written only by the panic handler (watchdogs that do not panic leave the previous core dump)
+  if (resetReason == ESP_RST_PANIC || resetReason == ESP_RST_INT_WDT || resetReason == ESP_RST_TASK_WDT) {
+    esp_core_dump_summary_t summary;
+    if (esp_core_dump_get_summary(&summary) == ESP_OK) {
+      resetInfo.panicPc = summary.exc_pc;
+      strncpy(resetInfo.panicTaskName, summary.exc_task, sizeof(resetInfo.panicTaskName) - 1);
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+      for (size_t i = 0; i < std::min<size_t>(summary.exc_bt_info.depth, std::size(resetInfo.panicBacktrace)); i++)
+        resetInfo.panicBacktrace[i] = summary.exc_bt_info.bt[i];
+#endif
+    }
+  }
+#endif
+  return true;
+}
+
+//==============================================================================
+
+static void InitializeResetInfoOnce() {
+  static const bool resetInfoInitialized = InitializeResetInfo();
+  (void)resetInfoInitialized;
+}
+
+//==============================================================================
+
+BlackBox::BlackBox() : generationEpoch(esp_random()), generalConfiguration(std::make_shared<GeneralConfiguration>(*this)) {
+  allConfigurations.Add(generalConfiguration, std::string(), generalConfiguration->GetNvsNamespaceName());
+  // The reset event is recorded on the first access to the event ring buffer
+  BlackBoxEventRecorder::GetNextSequenceNumber();
+  InitializeResetInfoOnce();
+}
+
+//==============================================================================
+
+BlackBox::~BlackBox() {
+  // Configurations can outlive the BlackBox
+  allConfigurations.ForEach([](BlackBoxConfiguration& configuration) { configuration.SetChangeHandler(nullptr); });
+  // The trace recorder is released after the tasks that pass the trace points to it have finished
+  if (traceRecorder && BlackBoxTrace::GetHook() == traceRecorder.get())
+    BlackBoxTrace::SetHook(NULL);
+}
 
 //==============================================================================
 
-BlackBox::BlackBox() : generalConfiguration(std::make_shared<GeneralConfiguration>(*this)) {
-  allConfigurations.push_back(generalConfiguration);
+template <class T>
+std::shared_ptr<T> BlackBox::RegisterHardwareInterfaceConfiguration(std::shared_ptr<T> configuration) {
+  std::string nvsNamespaceName = configuration->GetNvsNamespaceName();
+  {
+    LockGuard lg(configurationListMutex);
+    hardwareInterfaceConfigurations.Add(configuration, configuration->GetHardwareInterface()->GetName(), nvsNamespaceName, (uint8_t)configuration->GetType());
+    allConfigurations.Add(configuration, std::string(), nvsNamespaceName);
+    configurationListGeneration.fetch_add(1);
+  }
+  ObserveConfiguration(configuration);
+  NotifyChange(BlackBoxChangeType::configurationList);
+  return configuration;
+}
+
+//==============================================================================
+
+template <class T>
+std::shared_ptr<T> BlackBox::RegisterServerConfiguration(std::shared_ptr<T> configuration) {
+  std::string nvsNamespaceName = configuration->GetNvsNamespaceName();
+  {
+    LockGuard lg(configurationListMutex);
+    serverConfigurations.Add(configuration, configuration->GetServer()->GetName(), nvsNamespaceName, (uint8_t)configuration->GetType());
+    allConfigurations.Add(configuration, std::string(), nvsNamespaceName);
+    configurationListGeneration.fetch_add(1);
+  }
+  ObserveConfiguration(configuration);
+  NotifyChange(BlackBoxChangeType::configurationList);
+  return configuration;
 }
 
 //==============================================================================
@@ -47,6 +166,11 @@ std::string BlackBox::GetGeneralConfigurationNvsNamespaceName() {
 //==============================================================================
 
 void BlackBox::SetGeneralConfigurationNvsNamespaceName(const std::string& nvsNamespaceName) {
+  {
+    LockGuard lg(configurationListMutex);
+    allConfigurations.RenameNvsNamespace(generalConfiguration->GetNvsNamespaceName(), nvsNamespaceName);
+    configurationListGeneration.fetch_add(1);
+  }
   LockGuard lg(mutex);
   generalConfiguration->SetNvsNamespaceName(nvsNamespaceName);
   hardwareInfoLoaded = false;
@@ -88,14 +212,23 @@ std::string BlackBox::GetDeviceName() {
 //==============================================================================
 
 void BlackBox::SetDeviceName(const std::string& name) {
-  LockGuard lg(mutex);
-  deviceName = name;
+  {
+    LockGuard lg(mutex);
+    if (deviceName == name)
+      return;
+    deviceName = name;
+    deviceGeneration.fetch_add(1);
+  }
+  NotifyChange(BlackBoxChangeType::device);
 }
 
 //==============================================================================
 
 esp_err_t BlackBox::Restart() {
   LockGuard lg(mutex);
+  BlackBoxEventRecorder::Record(BlackBoxEventType::restart);
+  if (eventRecorder)
+    eventRecorder->Flush();
   esp_restart();
   return ESP_OK;
 }
@@ -110,185 +243,617 @@ bool BlackBox::GetRestartedFlag() {
 //==============================================================================
 
 void BlackBox::ClearRestartedFlag() {
+  {
+    LockGuard lg(mutex);
+    if (!restartedFlag)
+      return;
+    restartedFlag = false;
+    deviceGeneration.fetch_add(1);
+  }
+  NotifyChange(BlackBoxChangeType::device);
+}
+
+//==============================================================================
+
+BlackBoxResetInfo BlackBox::GetResetInfo() {
+  LockGuard lg(mutex);
+  return resetInfoStorage.resetInfo;
+}
+
+//==============================================================================
+
+void BlackBox::ClearResetInfo() {
+  {
+    LockGuard lg(mutex);
+    BlackBoxResetInfo& resetInfo = resetInfoStorage.resetInfo;
+    if (!resetInfo.abnormalResetCounter && resetInfo.lastAbnormalResetReason == ESP_RST_UNKNOWN)
+      return;
+    resetInfo.abnormalResetCounter = 0;
+    resetInfo.lastAbnormalResetReason = ESP_RST_UNKNOWN;
+    resetInfo.panicPc = 0;
+    memset(resetInfo.panicBacktrace, 0, sizeof(resetInfo.panicBacktrace));
+    memset(resetInfo.panicTaskName, 0, sizeof(resetInfo.panicTaskName));
+    deviceGeneration.fetch_add(1);
+  }
+  NotifyChange(BlackBoxChangeType::device);
+}
+
+//==============================================================================
+
+uint64_t BlackBox::GetConfigurationGeneration() {
+  // Within one configuration list generation the set of configurations is fixed, so the sum of their generations only grows
+  uint32_t registryGeneration = configurationListGeneration;
+  uint32_t parameterGeneration = 0;
+  allConfigurations.ForEach([&](BlackBoxConfiguration& configuration) { parameterGeneration += configuration.GetGeneration(); });
+  return ((uint64_t)(generationEpoch + registryGeneration) << 32) | parameterGeneration;
+}
+
+//==============================================================================
+
+uint32_t BlackBox::GetGenerationEpoch() {
+  return generationEpoch;
+}
+
+//==============================================================================
+
+uint32_t BlackBox::AddChangeObserver(std::function<void(BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration)> observer) {
+  LockGuard lg(changeObserverMutex);
+  uint32_t observerId = nextChangeObserverId++;
+  changeObservers.push_back({observerId, observer});
+  return observerId;
+}
+
+//==============================================================================
+
+void BlackBox::RemoveChangeObserver(uint32_t observerId) {
+  LockGuard lg(changeObserverMutex);
+  changeObservers.erase(std::remove_if(changeObservers.begin(), changeObservers.end(),
+    [&](const auto& changeObserver) { return changeObserver.first == observerId; }), changeObservers.end());
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxEventRecorder> BlackBox::GetEventRecorder() {
+  LockGuard lg(mutex);
+  return eventRecorder;
+}
+
+//==============================================================================
+
+void BlackBox::SetEventRecorder(std::shared_ptr<BlackBoxEventRecorder> eventRecorder) {
+  LockGuard lg(mutex);
+  this->eventRecorder = eventRecorder;
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxTraceRecorder> BlackBox::GetTraceRecorder() {
+  LockGuard lg(mutex);
+  return traceRecorder;
+}
+
+//==============================================================================
+
+void BlackBox::SetTraceRecorder(std::shared_ptr<BlackBoxTraceRecorder> traceRecorder) {
+  LockGuard lg(mutex);
+  // Removing the trace recorder does not remove a trace hook that has been set after it
+  if (traceRecorder || BlackBoxTrace::GetHook() == this->traceRecorder.get())
+    BlackBoxTrace::SetHook(traceRecorder.get());
+  // SetHook waits for the tasks that pass the trace points to the previous trace recorder, so it can be released
+  this->traceRecorder = traceRecorder;
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxHealthMonitor> BlackBox::GetHealthMonitor() {
+  LockGuard lg(mutex);
+  return healthMonitor;
+}
+
+//==============================================================================
+
+void BlackBox::SetHealthMonitor(std::shared_ptr<BlackBoxHealthMonitor> healthMonitor) {
+  LockGuard lg(mutex);
+  this->healthMonitor = healthMonitor;
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxLinkMonitor> BlackBox::GetLinkMonitor() {
   LockGuard lg(mutex);
-  restartedFlag = false;
+  return linkMonitor;
+}
+
+//==============================================================================
+
+void BlackBox::SetLinkMonitor(std::shared_ptr<BlackBoxLinkMonitor> linkMonitor) {
+  LockGuard lg(mutex);
+  this->linkMonitor = linkMonitor;
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxFirmwareUpdater> BlackBox::GetFirmwareUpdater() {
+  LockGuard lg(mutex);
+  return firmwareUpdater;
+}
+
+//==============================================================================
+
+void BlackBox::SetFirmwareUpdater(std::shared_ptr<BlackBoxFirmwareUpdater> firmwareUpdater) {
+  LockGuard lg(mutex);
+  this->firmwareUpdater = firmwareUpdater;
 }
 
 //==============================================================================
 
 void BlackBox::AddConfiguration(std::shared_ptr<BlackBoxConfiguration> configuration) {
-  allConfigurations.push_back(configuration);
+  {
+    LockGuard lg(configurationListMutex);
+    allConfigurations.Add(configuration, std::string(), configuration->GetNvsNamespaceName());
+    configurationListGeneration.fetch_add(1);
+  }
+  ObserveConfiguration(configuration);
+  NotifyChange(BlackBoxChangeType::configurationList);
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxHardwareInterfaceConfiguration> BlackBox::AddHardwareInterfaceConfiguration(std::shared_ptr<HardwareInterface> hardwareInterface, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxHardwareInterfaceConfiguration>(hardwareInterface, nvsNamespaceName);
-  hardwareInterfaceConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterHardwareInterfaceConfiguration(std::make_shared<BlackBoxHardwareInterfaceConfiguration>(hardwareInterface, nvsNamespaceName));
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxUartConfiguration> BlackBox::AddUartConfiguration(std::shared_ptr<Uart> hardwareInterface, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxUartConfiguration>(hardwareInterface, nvsNamespaceName);
-  hardwareInterfaceConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterHardwareInterfaceConfiguration(std::make_shared<BlackBoxUartConfiguration>(hardwareInterface, nvsNamespaceName));
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxNetworkInterfaceConfiguration> BlackBox::AddNetworkInterfaceConfiguration(std::shared_ptr<NetworkInterface> hardwareInterface, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxNetworkInterfaceConfiguration>(hardwareInterface, nvsNamespaceName);
-  hardwareInterfaceConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterHardwareInterfaceConfiguration(std::make_shared<BlackBoxNetworkInterfaceConfiguration>(hardwareInterface, nvsNamespaceName));
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxEthernetConfiguration> BlackBox::AddEthernetConfiguration(std::shared_ptr<Ethernet> hardwareInterface, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxEthernetConfiguration>(hardwareInterface, nvsNamespaceName);
-  hardwareInterfaceConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterHardwareInterfaceConfiguration(std::make_shared<BlackBoxEthernetConfiguration>(hardwareInterface, nvsNamespaceName));
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxWiFiStationConfiguration> BlackBox::AddWiFiConfiguration(std::shared_ptr<WiFiStation> hardwareInterface, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxWiFiStationConfiguration>(hardwareInterface, nvsNamespaceName);
-  hardwareInterfaceConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterHardwareInterfaceConfiguration(std::make_shared<BlackBoxWiFiStationConfiguration>(hardwareInterface, nvsNamespaceName));
 }
 
 //==============================================================================
 
 #if CONFIG_TINYUSB_CDC_ENABLED
 std::shared_ptr<BlackBoxUsbDeviceCdcConfiguration> BlackBox::AddUsbDeviceCdcConfiguration(std::shared_ptr<UsbDeviceCdc> hardwareInterface, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxUsbDeviceCdcConfiguration>(hardwareInterface, nvsNamespaceName);
-  hardwareInterfaceConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterHardwareInterfaceConfiguration(std::make_shared<BlackBoxUsbDeviceCdcConfiguration>(hardwareInterface, nvsNamespaceName));
 }
 #endif
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxServerConfiguration> BlackBox::AddServerConfiguration(std::shared_ptr<Server> server, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxServerConfiguration>(server, nvsNamespaceName);
-  serverConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterServerConfiguration(std::make_shared<BlackBoxServerConfiguration>(server, nvsNamespaceName));
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxStreamServerConfiguration> BlackBox::AddStreamServerConfiguration(std::shared_ptr<StreamServer> server, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxStreamServerConfiguration>(server, nvsNamespaceName);
-  serverConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterServerConfiguration(std::make_shared<BlackBoxStreamServerConfiguration>(server, nvsNamespaceName));
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxNetworkServerConfiguration> BlackBox::AddNetworkServerConfiguration(std::shared_ptr<NetworkServer> server, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxNetworkServerConfiguration>(server, nvsNamespaceName);
-  serverConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterServerConfiguration(std::make_shared<BlackBoxNetworkServerConfiguration>(server, nvsNamespaceName));
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxModbusServerConfiguration> BlackBox::AddModbusServerConfiguration(std::shared_ptr<ModbusServer> server, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxModbusServerConfiguration>(server, nvsNamespaceName);
-  serverConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterServerConfiguration(std::make_shared<BlackBoxModbusServerConfiguration>(server, nvsNamespaceName));
 }
 
 //==============================================================================
 
+#if !CONFIG_IDF_TARGET_LINUX
 std::shared_ptr<BlackBoxHttpServerConfiguration> BlackBox::AddHttpServerConfiguration(std::shared_ptr<HttpServer> server, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxHttpServerConfiguration>(server, nvsNamespaceName);
-  serverConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterServerConfiguration(std::make_shared<BlackBoxHttpServerConfiguration>(server, nvsNamespaceName));
 }
 
 //==============================================================================
 
 std::shared_ptr<BlackBoxMdnsServerConfiguration> BlackBox::AddMdnsServerConfiguration(std::shared_ptr<MdnsServer> server, std::string nvsNamespaceName) {
-  auto configuration = std::make_shared<BlackBoxMdnsServerConfiguration>(server, nvsNamespaceName);
-  serverConfigurations.push_back(configuration);
-  allConfigurations.push_back(configuration);
-  return configuration;
+  return RegisterServerConfiguration(std::make_shared<BlackBoxMdnsServerConfiguration>(server, nvsNamespaceName));
+}
+#endif
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxSntpConfiguration> BlackBox::AddSntpConfiguration(std::shared_ptr<BlackBoxSntpClient> sntpClient, std::string nvsNamespaceName) {
+  return RegisterServerConfiguration(std::make_shared<BlackBoxSntpConfiguration>(sntpClient, nvsNamespaceName));
+}
+
+//==============================================================================
+
+esp_err_t BlackBox::RemoveConfiguration(std::shared_ptr<BlackBoxConfiguration> configuration) {
+  ESP_RETURN_ON_FALSE(configuration && configuration != generalConfiguration, ESP_ERR_INVALID_ARG, TAG, "invalid configuration");
+  {
+    LockGuard lg(configurationListMutex);
+    ESP_RETURN_ON_FALSE(allConfigurations.Remove(configuration), ESP_ERR_NOT_FOUND, TAG, "configuration not found");
+    if (auto hardwareInterfaceConfiguration = std::dynamic_pointer_cast<BlackBoxHardwareInterfaceConfiguration>(configuration))
+      hardwareInterfaceConfigurations.Remove(hardwareInterfaceConfiguration);
+    if (auto serverConfiguration = std::dynamic_pointer_cast<BlackBoxServerConfiguration>(configuration))
+      serverConfigurations.Remove(serverConfiguration);
+    // The change is published after all registries have been updated
+    configurationListGeneration.fetch_add(1);
+  }
+  configuration->SetChangeHandler(nullptr);
+  NotifyChange(BlackBoxChangeType::configurationList);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBox::ReplaceConfiguration(std::shared_ptr<BlackBoxConfiguration> oldConfiguration, std::shared_ptr<BlackBoxConfiguration> newConfiguration) {
+  ESP_RETURN_ON_FALSE(oldConfiguration && oldConfiguration != generalConfiguration && newConfiguration, ESP_ERR_INVALID_ARG, TAG, "invalid configuration");
+  auto oldHardwareInterfaceConfiguration = std::dynamic_pointer_cast<BlackBoxHardwareInterfaceConfiguration>(oldConfiguration);
+  auto newHardwareInterfaceConfiguration = std::dynamic_pointer_cast<BlackBoxHardwareInterfaceConfiguration>(newConfiguration);
+  auto oldServerConfiguration = std::dynamic_pointer_cast<BlackBoxServerConfiguration>(oldConfiguration);
+  auto newServerConfiguration = std::dynamic_pointer_cast<BlackBoxServerConfiguration>(newConfiguration);
+  ESP_RETURN_ON_FALSE(!oldHardwareInterfaceConfiguration == !newHardwareInterfaceConfiguration && !oldServerConfiguration == !newServerConfiguration,
+    ESP_ERR_INVALID_ARG, TAG, "configuration kind mismatch");
+
+  std::string nvsNamespaceName = newConfiguration->GetNvsNamespaceName();
+  {
+    LockGuard lg(configurationListMutex);
+    ESP_RETURN_ON_FALSE(allConfigurations.Replace(oldConfiguration, newConfiguration, std::string(), nvsNamespaceName), ESP_ERR_NOT_FOUND, TAG, "configuration not found");
+    if (oldHardwareInterfaceConfiguration) {
+      hardwareInterfaceConfigurations.Replace(oldHardwareInterfaceConfiguration, newHardwareInterfaceConfiguration,
+        newHardwareInterfaceConfiguration->GetHardwareInterface()->GetName(), nvsNamespaceName, (uint8_t)newHardwareInterfaceConfiguration->GetType());
+    }
+    if (oldServerConfiguration) {
+      serverConfigurations.Replace(oldServerConfiguration, newServerConfiguration,
+        newServerConfiguration->GetServer()->GetName(), nvsNamespaceName, (uint8_t)newServerConfiguration->GetType());
+    }
+    // The change is published after all registries have been updated
+    configurationListGeneration.fetch_add(1);
+  }
+  oldConfiguration->SetChangeHandler(nullptr);
+  ObserveConfiguration(newConfiguration);
+  NotifyChange(BlackBoxChangeType::configurationList);
+  return ESP_OK;
 }
 
 //==============================================================================
 
 std::vector<std::shared_ptr<BlackBoxConfiguration>> BlackBox::GetAllConfigurations() {
-  LockGuard lg(mutex);
-  return allConfigurations;
+  return allConfigurations.GetAll();
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxConfiguration> BlackBox::GetConfiguration(const std::string& nvsNamespaceName) {
+  return allConfigurations.GetByNvsNamespaceName(nvsNamespaceName);
+}
+
+//==============================================================================
+
+void BlackBox::ForEachConfiguration(const std::function<void(BlackBoxConfiguration&)>& visitor) {
+  allConfigurations.ForEach(visitor);
 }
 
 //==============================================================================
 
 std::vector<std::shared_ptr<BlackBoxHardwareInterfaceConfiguration>> BlackBox::GetHardwareInterfaceConfigurations() {
-  LockGuard lg(mutex);
-  return hardwareInterfaceConfigurations;
+  return hardwareInterfaceConfigurations.GetAll();
+}
+
+//==============================================================================
+
+size_t BlackBox::GetNumberOfHardwareInterfaceConfigurations() {
+  return hardwareInterfaceConfigurations.GetSize();
+}
+
+//==============================================================================
+
+size_t BlackBox::GetNumberOfHardwareInterfaceConfigurations(BlackBoxHardwareInterfaceType type) {
+  return hardwareInterfaceConfigurations.GetSize((uint8_t)type);
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxHardwareInterfaceConfiguration> BlackBox::GetHardwareInterfaceConfiguration(size_t index) {
+  return hardwareInterfaceConfigurations.Get(index);
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxHardwareInterfaceConfiguration> BlackBox::GetHardwareInterfaceConfiguration(const std::string& name) {
+  return hardwareInterfaceConfigurations.Get(name);
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxHardwareInterfaceConfiguration> BlackBox::GetHardwareInterfaceConfiguration(BlackBoxHardwareInterfaceType type, size_t index) {
+  return hardwareInterfaceConfigurations.Get((uint8_t)type, index);
+}
+
+//==============================================================================
+
+size_t BlackBox::GetHardwareInterfaceConfigurationIndex(BlackBoxHardwareInterfaceConfiguration& configuration) {
+  return hardwareInterfaceConfigurations.GetIndex(configuration, configuration.GetNvsNamespaceName());
+}
+
+//==============================================================================
+
+void BlackBox::ForEachHardwareInterfaceConfiguration(const std::function<void(BlackBoxHardwareInterfaceConfiguration&)>& visitor) {
+  hardwareInterfaceConfigurations.ForEach(visitor);
 }
 
 //==============================================================================
 
 std::vector<std::shared_ptr<BlackBoxServerConfiguration>> BlackBox::GetServerConfigurations() {
+  return serverConfigurations.GetAll();
+}
+
+//==============================================================================
+
+size_t BlackBox::GetNumberOfServerConfigurations() {
+  return serverConfigurations.GetSize();
+}
+
+//==============================================================================
+
+size_t BlackBox::GetNumberOfServerConfigurations(BlackBoxServerType type) {
+  return serverConfigurations.GetSize((uint8_t)type);
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxServerConfiguration> BlackBox::GetServerConfiguration(size_t index) {
+  return serverConfigurations.Get(index);
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxServerConfiguration> BlackBox::GetServerConfiguration(const std::string& name) {
+  return serverConfigurations.Get(name);
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxServerConfiguration> BlackBox::GetServerConfiguration(BlackBoxServerType type, size_t index) {
+  return serverConfigurations.Get((uint8_t)type, index);
+}
+
+//==============================================================================
+
+size_t BlackBox::GetServerConfigurationIndex(BlackBoxServerConfiguration& configuration) {
+  return serverConfigurations.GetIndex(configuration, configuration.GetNvsNamespaceName());
+}
+
+//==============================================================================
+
+void BlackBox::ForEachServerConfiguration(const std::function<void(BlackBoxServerConfiguration&)>& visitor) {
+  serverConfigurations.ForEach(visitor);
+}
+
+//==============================================================================
+
+void BlackBox::EnableLazyLoading() {
+  LockGuard lg(mutex);
+  lazyLoadingEnabled = true;
+}
+
+//==============================================================================
+
+void BlackBox::DisableLazyLoading() {
+  LockGuard lg(mutex);
+  lazyLoadingEnabled = false;
+}
+
+//==============================================================================
+
+bool BlackBox::IsLazyLoadingEnabled() {
+  LockGuard lg(mutex);
+  return lazyLoadingEnabled;
+}
+
+//==============================================================================
+
+void BlackBox::EnableSnapshotSaving() {
+  LockGuard lg(mutex);
+  snapshotSavingEnabled = true;
+}
+
+//==============================================================================
+
+void BlackBox::DisableSnapshotSaving() {
+  LockGuard lg(mutex);
+  snapshotSavingEnabled = false;
+}
+
+//==============================================================================
+
+bool BlackBox::IsSnapshotSavingEnabled() {
+  LockGuard lg(mutex);
+  return snapshotSavingEnabled;
+}
+
+//==============================================================================
+
+void BlackBox::SetDefaultProfile(std::shared_ptr<BlackBoxConfigurationProfile> profile) {
   LockGuard lg(mutex);
-  return serverConfigurations;
+  defaultProfile = profile;
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxConfigurationProfile> BlackBox::GetDefaultProfile() {
+  LockGuard lg(mutex);
+  return defaultProfile;
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxConfigurationProfile> BlackBox::CreateProfile() {
+  LockGuard lg(mutex);
+  auto profile = std::make_shared<BlackBoxConfigurationProfile>();
+  allConfigurations.ForEach([&](BlackBoxConfiguration& configuration) {
+    configuration.SaveParameters(*profile->AddSection(configuration.GetNvsNamespaceName()));
+  });
+  return profile;
 }
 
 //==============================================================================
 
 void BlackBox::LoadAllConfigurations() {
   LockGuard lg(mutex);
-  for (auto& configuration : allConfigurations)
-    configuration->Load();
+  PL_BLACKBOX_TRACE(loadStart);
+  BlackBoxConfigurationSnapshot snapshot(generalConfiguration->GetNvsNamespaceName());
+  bool snapshotValid = snapshotSavingEnabled && snapshot.Read() == ESP_OK;
+
+  // The general configuration goes first and reads the index
+  allConfigurations.ForEach([&](BlackBoxConfiguration& configuration) {
+    std::string nvsNamespaceName = configuration.GetNvsNamespaceName();
+    std::shared_ptr<BlackBoxConfigurationStorage> storage = snapshotValid ? snapshot.GetSection(nvsNamespaceName) : nullptr;
+    // Saved parameters contain only the differences from the default profile
+    if (auto defaultSection = defaultProfile ? defaultProfile->GetSection(nvsNamespaceName) : nullptr)
+      configuration.LoadParameters(*defaultSection);
+
+    auto indexEntry = configurationIndex.find(GetNvsNamespaceNameHash(nvsNamespaceName));
+    if (!lazyLoadingEnabled || indexEntry == configurationIndex.end()) {
+      if (storage)
+        configuration.LoadParameters(*storage);
+      else
+        configuration.Load();
+      return;
+    }
+    if (auto hardwareInterfaceConfiguration = dynamic_cast<BlackBoxHardwareInterfaceConfiguration*>(&configuration))
+      hardwareInterfaceConfiguration->enabled.SetValue(indexEntry->second);
+    if (auto serverConfiguration = dynamic_cast<BlackBoxServerConfiguration*>(&configuration))
+      serverConfiguration->enabled.SetValue(indexEntry->second);
+    configuration.DeferLoad(storage);
+  });
+  PL_BLACKBOX_TRACE(loadEnd);
 }
 
 //==============================================================================
 
 void BlackBox::SaveAllConfigurations() {
   LockGuard lg(mutex);
-  for (auto& configuration : allConfigurations)
-    configuration->Save();
+  PL_BLACKBOX_TRACE(saveStart);
+  BlackBoxConfigurationSnapshot snapshot(generalConfiguration->GetNvsNamespaceName());
+
+  allConfigurations.ForEach([&](BlackBoxConfiguration& configuration) {
+    std::string nvsNamespaceName = configuration.GetNvsNamespaceName();
+    auto defaultSection = defaultProfile ? defaultProfile->GetSection(nvsNamespaceName) : nullptr;
+
+    if (snapshotSavingEnabled) {
+      auto section = snapshot.AddSection(nvsNamespaceName);
+      if (defaultSection) {
+        BlackBoxOverrideConfigurationStorage storage(*defaultSection, *section);
+        configuration.SaveParameters(storage);
+      }
+      else
+        configuration.SaveParameters(*section);
+    }
+    else {
+      if (defaultSection) {
+        BlackBoxNvsConfigurationStorage nvsStorage(nvsNamespaceName, NvsAccessMode::readWrite);
+        BlackBoxOverrideConfigurationStorage storage(*defaultSection, nvsStorage);
+        configuration.SaveParameters(storage);
+      }
+      else
+        configuration.Save();
+    }
+  });
+
+  if (snapshotSavingEnabled)
+    snapshot.Write();
+  PL_BLACKBOX_TRACE(saveEnd);
+  BlackBoxEventRecorder::Record(BlackBoxEventType::configurationsSaved);
+  NotifyChange(BlackBoxChangeType::configurationsSaved);
 }
 
 //==============================================================================
 
 void BlackBox::EraseAllConfigurations() {
   LockGuard lg(mutex);
-  for (auto& configuration : allConfigurations)
-    configuration->Erase();
+  allConfigurations.ForEach([](BlackBoxConfiguration& configuration) { configuration.Erase(); });
 }
 
 //==============================================================================
 
 void BlackBox::ApplyHardwareInterfaceConfigurations() {
   LockGuard lg(mutex);
-  for (auto& configuration : hardwareInterfaceConfigurations)
-    configuration->Apply();
+  PL_BLACKBOX_TRACE(applyStart, 0);
+  uint16_t index = 0;
+  hardwareInterfaceConfigurations.ForEach([&](BlackBoxHardwareInterfaceConfiguration& configuration) {
+    // A disabled configuration that has not been loaded yet only disables the hardware interface
+    if (configuration.IsLoadDeferred() && !configuration.enabled.GetValue())
+      configuration.BlackBoxHardwareInterfaceConfiguration::Apply();
+    else
+      configuration.Apply();
+    BlackBoxEventRecorder::Record(BlackBoxEventType::hardwareInterfaceApplied, index++, configuration.enabled.GetValue());
+  });
+  PL_BLACKBOX_TRACE(applyEnd, 0);
 }
 
 //==============================================================================
 
 void BlackBox::ApplyServerConfigurations() {
   LockGuard lg(mutex);
-  for (auto& configuration : serverConfigurations)
-    configuration->Apply();
+  PL_BLACKBOX_TRACE(applyStart, 1);
+  uint16_t index = 0;
+  serverConfigurations.ForEach([&](BlackBoxServerConfiguration& configuration) {
+    // A disabled configuration that has not been loaded yet only disables the server
+    if (configuration.IsLoadDeferred() && !configuration.enabled.GetValue())
+      configuration.BlackBoxServerConfiguration::Apply();
+    else
+      configuration.Apply();
+    BlackBoxEventRecorder::Record(BlackBoxEventType::serverApplied, index++, configuration.enabled.GetValue());
+  });
+  PL_BLACKBOX_TRACE(applyEnd, 1);
+}
+
+//==============================================================================
+
+uint32_t BlackBox::GetNvsNamespaceNameHash(const std::string& nvsNamespaceName) {
+  // FNV-1a
+  uint32_t hash = 2166136261;
+  for (char c : nvsNamespaceName)
+    hash = (hash ^ (uint8_t)c) * 16777619;
+  return hash;
+}
+
+//==============================================================================
+
+void BlackBox::ObserveConfiguration(std::shared_ptr<BlackBoxConfiguration> configuration) {
+  // The configuration does not own the BlackBox and the handler is removed when the configuration is removed or replaced
+  std::weak_ptr<BlackBoxConfiguration> weakConfiguration = configuration;
+  configuration->SetChangeHandler([this, weakConfiguration]() {
+    if (auto configuration = weakConfiguration.lock()) {
+      uint32_t nvsNamespaceNameHash = GetNvsNamespaceNameHash(configuration->GetNvsNamespaceName());
+      PL_BLACKBOX_TRACE(parameterChange, 0, nvsNamespaceNameHash);
+      BlackBoxEventRecorder::Record(BlackBoxEventType::configurationChanged, 0, nvsNamespaceNameHash);
+      NotifyChange(BlackBoxChangeType::configuration, configuration);
+    }
+  });
+}
+
+//==============================================================================
+
+void BlackBox::NotifyChange(BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration) {
+  LockGuard lg(changeObserverMutex);
+  for (auto& changeObserver : changeObservers)
+    changeObserver.second(type, configuration);
 }
 
 //==============================================================================
@@ -298,21 +863,54 @@ BlackBox::GeneralConfiguration::GeneralConfiguration(BlackBox& blackBox) : black
 //==============================================================================
 
 void BlackBox::GeneralConfiguration::Load() {
-  LockGuard lg(mutex);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readOnly);
+  LockGuard lg(blackBox.mutex, mutex);
+  BlackBoxNvsConfigurationStorage storage(nvsNamespaceName, NvsAccessMode::readOnly);
+  LoadParameters(storage);
+}
+
+//==============================================================================
+
+void BlackBox::GeneralConfiguration::Save() {
+  LockGuard lg(blackBox.mutex, mutex);
+  BlackBoxNvsConfigurationStorage storage(nvsNamespaceName, NvsAccessMode::readWrite);
+  SaveParameters(storage);
+}
+
+//==============================================================================
+
+void BlackBox::GeneralConfiguration::LoadParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(blackBox.mutex, mutex);
   std::string stringValue;
 
-  if (nvsNamespace.Read(generalConfigurationDeviceNameNvsKey, stringValue) == ESP_OK)
+  if (storage.Read(generalConfigurationDeviceNameNvsKey, stringValue) == ESP_OK)
     blackBox.SetDeviceName(stringValue);
+
+  size_t maxNumberOfIndexEntries = blackBox.hardwareInterfaceConfigurations.GetSize() + blackBox.serverConfigurations.GetSize();
+  std::vector<ConfigurationIndexEntry> indexEntries(maxNumberOfIndexEntries);
+  size_t indexSize = 0;
+  // Partial writes (BlackBoxStreamServer, BlackBoxHttpServer) without the index keep the current index
+  if (maxNumberOfIndexEntries && storage.Read(generalConfigurationIndexNvsKey, indexEntries.data(), indexEntries.size() * sizeof(ConfigurationIndexEntry), &indexSize) == ESP_OK) {
+    blackBox.configurationIndex.clear();
+    for (size_t i = 0; i < indexSize / sizeof(ConfigurationIndexEntry); i++)
+      blackBox.configurationIndex[indexEntries[i].nvsNamespaceNameHash] = indexEntries[i].enabled;
+  }
 }
 
 //==============================================================================
 
-void BlackBox::GeneralConfiguration::Save() {
-  LockGuard lg(mutex);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readWrite);
+void BlackBox::GeneralConfiguration::SaveParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(blackBox.mutex, mutex);
+
+  storage.Write(generalConfigurationDeviceNameNvsKey, blackBox.GetDeviceName());
 
-  nvsNamespace.Write(generalConfigurationDeviceNameNvsKey, blackBox.GetDeviceName());
+  std::vector<ConfigurationIndexEntry> indexEntries;
+  blackBox.ForEachHardwareInterfaceConfiguration([&](BlackBoxHardwareInterfaceConfiguration& configuration) {
+    indexEntries.push_back({GetNvsNamespaceNameHash(configuration.GetNvsNamespaceName()), configuration.enabled.GetValue()});
+  });
+  blackBox.ForEachServerConfiguration([&](BlackBoxServerConfiguration& configuration) {
+    indexEntries.push_back({GetNvsNamespaceNameHash(configuration.GetNvsNamespaceName()), configuration.enabled.GetValue()});
+  });
+  storage.Write(generalConfigurationIndexNvsKey, indexEntries.data(), indexEntries.size() * sizeof(ConfigurationIndexEntry));
 }
 
 //==============================================================================
@@ -339,4 +937,10 @@ void BlackBox::GeneralConfiguration::SetNvsNamespaceName(const std::string& nvsN
 
 //==============================================================================
 
+uint32_t BlackBox::GeneralConfiguration::GetGeneration() {
+  return blackBox.deviceGeneration;
+}
+
+//==============================================================================
+
 }
\ No newline at end of file
@@ -0,0 +1,69 @@
+#include "pl_blackbox_clock.h"
+#include "pl_blackbox_event_recorder.h"
+#include "esp_timer.h"
+#include <atomic>
+#include <sys/time.h>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+static std::atomic<int64_t> utcTimeOffset = 0;
+static std::atomic<int64_t> lastSynchronizationTime = 0;
+static std::atomic<BlackBoxClock::TimeSource> timeSource = NULL;
+
+//==============================================================================
+
+void BlackBoxClock::SetTimeSource(TimeSource timeSource) {
+  PL::timeSource = timeSource;
+}
+
+//==============================================================================
+
+int64_t BlackBoxClock::GetMonotonicTime() {
+  TimeSource timeSource = PL::timeSource;
+  return timeSource ? timeSource() : esp_timer_get_time();
+}
+
+//==============================================================================
+
+int64_t BlackBoxClock::GetUtcTime() {
+  return ToUtcTime(GetMonotonicTime());
+}
+
+//==============================================================================
+
+int64_t BlackBoxClock::ToUtcTime(int64_t monotonicTime) {
+  int64_t offset = utcTimeOffset;
+  return offset ? monotonicTime + offset : 0;
+}
+
+//==============================================================================
+
+bool BlackBoxClock::IsSynchronized() {
+  return utcTimeOffset != 0;
+}
+
+//==============================================================================
+
+int64_t BlackBoxClock::GetLastSynchronizationTime() {
+  return lastSynchronizationTime;
+}
+
+//==============================================================================
+
+void BlackBoxClock::Synchronize() {
+  struct timeval systemTime;
+  gettimeofday(&systemTime, NULL);
+  int64_t monotonicTime = GetMonotonicTime();
+  int64_t utcTime = (int64_t)systemTime.tv_sec * 1000000 + systemTime.tv_usec;
+  utcTimeOffset = utcTime - monotonicTime;
+  lastSynchronizationTime = monotonicTime;
+  BlackBoxEventRecorder::Record(BlackBoxEventType::timeSynchronized, 0, systemTime.tv_sec);
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "pl_blackbox_configuration_profile.h"
+#include "esp_check.h"
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_configuration_profile";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+BlackBoxConfigurationProfile::BlackBoxConfigurationProfile(const void* data, size_t size) {
+  SetData(data, size);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxConfigurationProfile::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxConfigurationProfile::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxTlvConfigurationStorage> BlackBoxConfigurationProfile::GetSection(const std::string& nvsNamespaceName) {
+  LockGuard lg(*this);
+  for (auto& section : sections) {
+    if (section.first == nvsNamespaceName)
+      return section.second;
+  }
+  return nullptr;
+}
+
+//==============================================================================
+
+std::shared_ptr<BlackBoxTlvConfigurationStorage> BlackBoxConfigurationProfile::AddSection(const std::string& nvsNamespaceName) {
+  LockGuard lg(*this);
+  if (auto section = GetSection(nvsNamespaceName))
+    return section;
+  auto section = std::make_shared<BlackBoxTlvConfigurationStorage>();
+  sections.push_back({nvsNamespaceName, section});
+  return section;
+}
+
+//==============================================================================
+
+std::vector<std::string> BlackBoxConfigurationProfile::GetSectionNames() {
+  LockGuard lg(*this);
+  std::vector<std::string> sectionNames;
+  for (auto& section : sections)
+    sectionNames.push_back(section.first);
+  return sectionNames;
+}
+
+//==============================================================================
+
+std::vector<uint8_t> BlackBoxConfigurationProfile::GetData() {
+  LockGuard lg(*this);
+  std::vector<uint8_t> data;
+  for (auto& section : sections) {
+    std::vector<uint8_t> sectionData = section.second->GetData();
+    data.push_back((uint8_t)section.first.size());
+    data.insert(data.end(), section.first.begin(), section.first.end());
+    data.push_back(sectionData.size() & 0xFF);
+    data.push_back((sectionData.size() >> 8) & 0xFF);
+    data.insert(data.end(), sectionData.begin(), sectionData.end());
+  }
+  return data;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxConfigurationProfile::SetData(const void* data, size_t size) {
+  LockGuard lg(*this);
+  const uint8_t* encodedSections = (const uint8_t*)data;
+  std::vector<std::pair<std::string, std::shared_ptr<BlackBoxTlvConfigurationStorage>>> decodedSections;
+
+  for (size_t offset = 0; offset < size;) {
+    size_t nameSize = encodedSections[offset];
+    size_t sectionSizeOffset = offset + 1 + nameSize;
+    ESP_RETURN_ON_FALSE(sectionSizeOffset + 2 <= size, ESP_ERR_INVALID_SIZE, TAG, "invalid section");
+    size_t sectionSize = encodedSections[sectionSizeOffset] | (encodedSections[sectionSizeOffset + 1] << 8);
+    size_t sectionOffset = sectionSizeOffset + 2;
+    ESP_RETURN_ON_FALSE(sectionOffset + sectionSize <= size, ESP_ERR_INVALID_SIZE, TAG, "invalid section");
+
+    auto section = std::make_shared<BlackBoxTlvConfigurationStorage>();
+    ESP_RETURN_ON_ERROR(section->SetData(encodedSections + sectionOffset, sectionSize), TAG, "invalid section data");
+    decodedSections.push_back({std::string((const char*)encodedSections + offset + 1, nameSize), section});
+    offset = sectionOffset + sectionSize;
+  }
+
+  sections.swap(decodedSections);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "pl_blackbox_configuration_snapshot.h"
+#include "esp_check.h"
+#include "esp_rom_crc.h"
+#include <algorithm>
+#include <cstring>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_configuration_snapshot";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+const std::string BlackBoxConfigurationSnapshot::headerNvsKey = "snapHeader";
+const std::string BlackBoxConfigurationSnapshot::slotNvsKeys[2] = {"snapSlotA", "snapSlotB"};
+
+//==============================================================================
+
+BlackBoxConfigurationSnapshot::BlackBoxConfigurationSnapshot(const std::string& nvsNamespaceName) : nvsNamespaceName(nvsNamespaceName) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxConfigurationSnapshot::Read() {
+  LockGuard lg(*this);
+  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readOnly);
+  Header header, slotHeader;
+  std::vector<uint8_t> data;
+
+  if (nvsNamespace.Read(headerNvsKey, &header, sizeof(header), NULL) == ESP_OK && header.slot < 2 &&
+      ReadSlot(nvsNamespace, header.slot, slotHeader, data) == ESP_OK && !memcmp(&header, &slotHeader, sizeof(header))) {
+    ESP_RETURN_ON_ERROR(SetData(data.data(), data.size()), TAG, "snapshot decode failed");
+    sequenceNumber = header.sequenceNumber;
+    return ESP_OK;
+  }
+
+  // The header is missing or does not match its slot: use the newest valid slot
+  bool slotFound = false;
+  std::vector<uint8_t> newestSlotData;
+  for (uint8_t slot = 0; slot < 2; slot++) {
+    if (ReadSlot(nvsNamespace, slot, slotHeader, data) == ESP_OK && (!slotFound || slotHeader.sequenceNumber > header.sequenceNumber)) {
+      header = slotHeader;
+      newestSlotData.swap(data);
+      slotFound = true;
+    }
+  }
+  if (!slotFound)
+    return ESP_ERR_NOT_FOUND;
+
+  ESP_RETURN_ON_ERROR(SetData(newestSlotData.data(), newestSlotData.size()), TAG, "snapshot decode failed");
+  sequenceNumber = header.sequenceNumber;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxConfigurationSnapshot::Write() {
+  LockGuard lg(*this);
+  std::vector<uint8_t> data = GetData();
+  ESP_RETURN_ON_FALSE(data.size() <= maxDataSize, ESP_ERR_INVALID_SIZE, TAG, "snapshot is too large");
+
+  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readWrite);
+  Header header = {};
+  uint8_t slot = 0;
+  if (nvsNamespace.Read(headerNvsKey, &header, sizeof(header), NULL) == ESP_OK && header.slot < 2)
+    slot = header.slot ^ 1;
+  else
+    header = {};
+
+  header.sequenceNumber = std::max(header.sequenceNumber, sequenceNumber) + 1;
+  header.slot = slot;
+  header.dataSize = data.size();
+  header.dataCrc = esp_rom_crc32_le(0, data.data(), data.size());
+
+  data.insert(data.begin(), (uint8_t*)&header, (uint8_t*)&header + sizeof(header));
+  ESP_RETURN_ON_ERROR(nvsNamespace.Write(slotNvsKeys[slot], data.data(), data.size()), TAG, "slot write failed");
+  // The slot becomes active only after the header is written
+  ESP_RETURN_ON_ERROR(nvsNamespace.Write(headerNvsKey, &header, sizeof(header)), TAG, "header write failed");
+  sequenceNumber = header.sequenceNumber;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+uint32_t BlackBoxConfigurationSnapshot::GetSequenceNumber() {
+  LockGuard lg(*this);
+  return sequenceNumber;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxConfigurationSnapshot::ReadSlot(NvsNamespace& nvsNamespace, uint8_t slot, Header& header, std::vector<uint8_t>& data) {
+  data.resize(sizeof(Header) + maxDataSize);
+  size_t readSize = 0;
+  esp_err_t error = nvsNamespace.Read(slotNvsKeys[slot], data.data(), data.size(), &readSize);
+  if (error != ESP_OK)
+    return error;
+  ESP_RETURN_ON_FALSE(readSize >= sizeof(Header), ESP_ERR_INVALID_SIZE, TAG, "invalid slot size");
+
+  memcpy(&header, data.data(), sizeof(Header));
+  data.erase(data.begin(), data.begin() + sizeof(Header));
+  data.resize(readSize - sizeof(Header));
+  ESP_RETURN_ON_FALSE(header.slot == slot && header.dataSize == data.size(), ESP_ERR_INVALID_SIZE, TAG, "invalid slot header");
+  ESP_RETURN_ON_FALSE(header.dataCrc == esp_rom_crc32_le(0, data.data(), data.size()), ESP_ERR_INVALID_CRC, TAG, "slot CRC mismatch");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
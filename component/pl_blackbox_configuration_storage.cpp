@@ -0,0 +1,784 @@
+#include "pl_blackbox_configuration_storage.h"
+#include "esp_check.h"
+#include "nvs.h"
+#include <algorithm>
+#include <cstring>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_configuration_storage";
+
+//==============================================================================
+
+static int GetHexDigitValue(char c) {
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  return -1;
+}
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+BlackBoxNvsConfigurationStorage::BlackBoxNvsConfigurationStorage(const std::string& nvsNamespaceName, NvsAccessMode accessMode) :
+  nvsNamespace(nvsNamespaceName, accessMode) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Read(const std::string& key, uint8_t& value) {
+  return nvsNamespace.Read(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Read(const std::string& key, uint16_t& value) {
+  return nvsNamespace.Read(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Read(const std::string& key, uint32_t& value) {
+  return nvsNamespace.Read(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Read(const std::string& key, std::string& value) {
+  return nvsNamespace.Read(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Read(const std::string& key, void* value, size_t size, size_t* readSize) {
+  return nvsNamespace.Read(key, value, size, readSize);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Write(const std::string& key, uint8_t value) {
+  return nvsNamespace.Write(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Write(const std::string& key, uint16_t value) {
+  return nvsNamespace.Write(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Write(const std::string& key, uint32_t value) {
+  return nvsNamespace.Write(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Write(const std::string& key, const std::string& value) {
+  return nvsNamespace.Write(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Write(const std::string& key, const void* value, size_t size) {
+  return nvsNamespace.Write(key, value, size);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxNvsConfigurationStorage::Erase(const std::string& key) {
+  return nvsNamespace.Erase(key);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Read(const std::string& key, uint8_t& value) {
+  LockGuard lg(*this);
+  size_t valueOffset, valueSize;
+  esp_err_t error = Find(key, BlackBoxConfigurationValueType::u8, valueOffset, valueSize);
+  if (error != ESP_OK)
+    return error;
+  ESP_RETURN_ON_FALSE(valueSize == sizeof(value), ESP_ERR_INVALID_SIZE, TAG, "invalid value size");
+  memcpy(&value, data.data() + valueOffset, sizeof(value));
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Read(const std::string& key, uint16_t& value) {
+  LockGuard lg(*this);
+  size_t valueOffset, valueSize;
+  esp_err_t error = Find(key, BlackBoxConfigurationValueType::u16, valueOffset, valueSize);
+  if (error != ESP_OK)
+    return error;
+  ESP_RETURN_ON_FALSE(valueSize == sizeof(value), ESP_ERR_INVALID_SIZE, TAG, "invalid value size");
+  memcpy(&value, data.data() + valueOffset, sizeof(value));
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Read(const std::string& key, uint32_t& value) {
+  LockGuard lg(*this);
+  size_t valueOffset, valueSize;
+  esp_err_t error = Find(key, BlackBoxConfigurationValueType::u32, valueOffset, valueSize);
+  if (error != ESP_OK)
+    return error;
+  ESP_RETURN_ON_FALSE(valueSize == sizeof(value), ESP_ERR_INVALID_SIZE, TAG, "invalid value size");
+  memcpy(&value, data.data() + valueOffset, sizeof(value));
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Read(const std::string& key, std::string& value) {
+  LockGuard lg(*this);
+  size_t valueOffset, valueSize;
+  esp_err_t error = Find(key, BlackBoxConfigurationValueType::string, valueOffset, valueSize);
+  if (error != ESP_OK)
+    return error;
+  value.assign((const char*)data.data() + valueOffset, valueSize);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Read(const std::string& key, void* value, size_t size, size_t* readSize) {
+  LockGuard lg(*this);
+  size_t valueOffset, valueSize;
+  esp_err_t error = Find(key, BlackBoxConfigurationValueType::blob, valueOffset, valueSize);
+  if (error != ESP_OK)
+    return error;
+  ESP_RETURN_ON_FALSE(valueSize <= size, ESP_ERR_INVALID_SIZE, TAG, "buffer is too small");
+  memcpy(value, data.data() + valueOffset, valueSize);
+  if (readSize)
+    *readSize = valueSize;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Write(const std::string& key, uint8_t value) {
+  LockGuard lg(*this);
+  return Add(key, BlackBoxConfigurationValueType::u8, &value, sizeof(value));
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Write(const std::string& key, uint16_t value) {
+  LockGuard lg(*this);
+  return Add(key, BlackBoxConfigurationValueType::u16, &value, sizeof(value));
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Write(const std::string& key, uint32_t value) {
+  LockGuard lg(*this);
+  return Add(key, BlackBoxConfigurationValueType::u32, &value, sizeof(value));
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Write(const std::string& key, const std::string& value) {
+  LockGuard lg(*this);
+  return Add(key, BlackBoxConfigurationValueType::string, value.data(), value.size());
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Write(const std::string& key, const void* value, size_t size) {
+  LockGuard lg(*this);
+  return Add(key, BlackBoxConfigurationValueType::blob, value, size);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Erase(const std::string& key) {
+  LockGuard lg(*this);
+  return Remove(key) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+//==============================================================================
+
+std::vector<uint8_t> BlackBoxTlvConfigurationStorage::GetData() {
+  LockGuard lg(*this);
+  return data;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::SetData(const void* data, size_t size) {
+  LockGuard lg(*this);
+  const uint8_t* records = (const uint8_t*)data;
+
+  for (size_t offset = 0; offset < size;) {
+    ESP_RETURN_ON_FALSE(offset + 2 <= size, ESP_ERR_INVALID_SIZE, TAG, "invalid record");
+    size_t valueSizeOffset = offset + 2 + records[offset + 1];
+    ESP_RETURN_ON_FALSE(valueSizeOffset + 2 <= size, ESP_ERR_INVALID_SIZE, TAG, "invalid record");
+    offset = valueSizeOffset + 2 + (records[valueSizeOffset] | (records[valueSizeOffset + 1] << 8));
+    ESP_RETURN_ON_FALSE(offset <= size, ESP_ERR_INVALID_SIZE, TAG, "invalid record");
+  }
+
+  this->data.assign(records, records + size);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool BlackBoxTlvConfigurationStorage::IsSubsetOf(BlackBoxTlvConfigurationStorage& storage) {
+  LockGuard lg(*this, storage);
+  for (size_t offset = 0; offset < data.size();) {
+    size_t keySize = data[offset + 1];
+    size_t valueSizeOffset = offset + 2 + keySize;
+    size_t valueOffset = valueSizeOffset + 2;
+    size_t valueSize = data[valueSizeOffset] | (data[valueSizeOffset + 1] << 8);
+    size_t otherValueOffset, otherValueSize;
+    std::string key((const char*)data.data() + offset + 2, keySize);
+    if (storage.Find(key, (BlackBoxConfigurationValueType)data[offset], otherValueOffset, otherValueSize) != ESP_OK ||
+        otherValueSize != valueSize || memcmp(data.data() + valueOffset, storage.data.data() + otherValueOffset, valueSize))
+      return false;
+    offset = valueOffset + valueSize;
+  }
+  return true;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Find(const std::string& key, BlackBoxConfigurationValueType type, size_t& valueOffset, size_t& valueSize) {
+  // Records are validated on write and in SetData
+  for (size_t offset = 0; offset < data.size();) {
+    size_t keySize = data[offset + 1];
+    size_t valueSizeOffset = offset + 2 + keySize;
+    valueOffset = valueSizeOffset + 2;
+    valueSize = data[valueSizeOffset] | (data[valueSizeOffset + 1] << 8);
+    if (keySize == key.size() && !memcmp(data.data() + offset + 2, key.data(), keySize)) {
+      ESP_RETURN_ON_FALSE(data[offset] == (uint8_t)type, ESP_ERR_INVALID_ARG, TAG, "value type mismatch");
+      return ESP_OK;
+    }
+    offset = valueOffset + valueSize;
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxTlvConfigurationStorage::Add(const std::string& key, BlackBoxConfigurationValueType type, const void* value, size_t size) {
+  ESP_RETURN_ON_FALSE(key.size() <= UINT8_MAX, ESP_ERR_INVALID_ARG, TAG, "key is too long");
+  ESP_RETURN_ON_FALSE(size <= UINT16_MAX, ESP_ERR_INVALID_SIZE, TAG, "value is too large");
+
+  Remove(key);
+  data.push_back((uint8_t)type);
+  data.push_back((uint8_t)key.size());
+  data.insert(data.end(), key.begin(), key.end());
+  data.push_back(size & 0xFF);
+  data.push_back(size >> 8);
+  data.insert(data.end(), (const uint8_t*)value, (const uint8_t*)value + size);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool BlackBoxTlvConfigurationStorage::Remove(const std::string& key) {
+  for (size_t offset = 0; offset < data.size();) {
+    size_t keySize = data[offset + 1];
+    size_t valueSizeOffset = offset + 2 + keySize;
+    size_t nextOffset = valueSizeOffset + 2 + (data[valueSizeOffset] | (data[valueSizeOffset + 1] << 8));
+    if (keySize == key.size() && !memcmp(data.data() + offset + 2, key.data(), keySize)) {
+      data.erase(data.begin() + offset, data.begin() + nextOffset);
+      return true;
+    }
+    offset = nextOffset;
+  }
+  return false;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Read(const std::string& key, uint8_t& value) {
+  uint32_t u32Value;
+  esp_err_t error = ReadNumber(key, UINT8_MAX, u32Value);
+  if (error != ESP_OK)
+    return error;
+  value = u32Value;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Read(const std::string& key, uint16_t& value) {
+  uint32_t u32Value;
+  esp_err_t error = ReadNumber(key, UINT16_MAX, u32Value);
+  if (error != ESP_OK)
+    return error;
+  value = u32Value;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Read(const std::string& key, uint32_t& value) {
+  return ReadNumber(key, UINT32_MAX, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Read(const std::string& key, std::string& value) {
+  LockGuard lg(*this);
+  Member* member = Find(key);
+  if (!member)
+    return ESP_ERR_NOT_FOUND;
+  ESP_RETURN_ON_FALSE(member->isString, ESP_ERR_INVALID_ARG, TAG, "value type mismatch");
+  value = member->value;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Read(const std::string& key, void* value, size_t size, size_t* readSize) {
+  LockGuard lg(*this);
+  Member* member = Find(key);
+  if (!member)
+    return ESP_ERR_NOT_FOUND;
+  ESP_RETURN_ON_FALSE(member->isString && member->value.size() % 2 == 0, ESP_ERR_INVALID_ARG, TAG, "value type mismatch");
+  ESP_RETURN_ON_FALSE(member->value.size() / 2 <= size, ESP_ERR_INVALID_SIZE, TAG, "buffer is too small");
+
+  std::vector<uint8_t> bytes(member->value.size() / 2);
+  for (size_t i = 0; i < member->value.size(); i++) {
+    int digit = GetHexDigitValue(member->value[i]);
+    ESP_RETURN_ON_FALSE(digit >= 0, ESP_ERR_INVALID_ARG, TAG, "invalid hexadecimal digit");
+    bytes[i / 2] = (bytes[i / 2] << 4) | digit;
+  }
+  memcpy(value, bytes.data(), bytes.size());
+  if (readSize)
+    *readSize = bytes.size();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Write(const std::string& key, uint8_t value) {
+  LockGuard lg(*this);
+  Set(key, false, std::to_string(value));
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Write(const std::string& key, uint16_t value) {
+  LockGuard lg(*this);
+  Set(key, false, std::to_string(value));
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Write(const std::string& key, uint32_t value) {
+  LockGuard lg(*this);
+  Set(key, false, std::to_string(value));
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Write(const std::string& key, const std::string& value) {
+  LockGuard lg(*this);
+  Set(key, true, value);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Write(const std::string& key, const void* value, size_t size) {
+  LockGuard lg(*this);
+  static const char hexDigits[] = "0123456789abcdef";
+  std::string hexValue;
+  hexValue.reserve(size * 2);
+  for (size_t i = 0; i < size; i++) {
+    hexValue.push_back(hexDigits[((const uint8_t*)value)[i] >> 4]);
+    hexValue.push_back(hexDigits[((const uint8_t*)value)[i] & 0x0F]);
+  }
+  Set(key, true, hexValue);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::Erase(const std::string& key) {
+  LockGuard lg(*this);
+  auto member = std::find_if(members.begin(), members.end(), [&](const Member& member) { return member.key == key; });
+  if (member == members.end())
+    return ESP_ERR_NOT_FOUND;
+  members.erase(member);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+std::string BlackBoxJsonConfigurationStorage::GetJson() {
+  LockGuard lg(*this);
+  std::string json = "{";
+  for (auto& member : members) {
+    if (json.size() > 1)
+      json += ',';
+    json += EncodeString(member.key) + ':' + (member.isString ? EncodeString(member.value) : member.value);
+  }
+  return json + '}';
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::SetJson(const std::string& json) {
+  LockGuard lg(*this);
+  std::vector<Member> newMembers;
+  size_t position = 0;
+
+  auto skipWhitespace = [&]() {
+    while (position < json.size() && (json[position] == ' ' || json[position] == '\t' || json[position] == '\r' || json[position] == '\n'))
+      position++;
+  };
+
+  auto parseHexDigits = [&](uint32_t& value) {
+    value = 0;
+    for (size_t end = position + 4; position < end; position++) {
+      int digit = position < json.size() ? GetHexDigitValue(json[position]) : -1;
+      if (digit < 0)
+        return false;
+      value = (value << 4) | digit;
+    }
+    return true;
+  };
+
+  auto parseString = [&](std::string& value) {
+    if (position >= json.size() || json[position++] != '"')
+      return false;
+    value.clear();
+    while (position < json.size()) {
+      char c = json[position++];
+      if (c == '"')
+        return true;
+      if ((uint8_t)c < 0x20)
+        return false;
+      if (c != '\\') {
+        value += c;
+        continue;
+      }
+      if (position >= json.size())
+        return false;
+      switch (c = json[position++]) {
+        case '"': case '\\': case '/': value += c; break;
+        case 'b': value += '\b'; break;
+        case 'f': value += '\f'; break;
+        case 'n': value += '\n'; break;
+        case 'r': value += '\r'; break;
+        case 't': value += '\t'; break;
+        case 'u': {
+          uint32_t codePoint, lowSurrogate;
+          if (!parseHexDigits(codePoint))
+            return false;
+          if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+            if (json.compare(position, 2, "\\u") || (position += 2, !parseHexDigits(lowSurrogate)) || lowSurrogate < 0xDC00 || lowSurrogate > 0xDFFF)
+              return false;
+            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+          }
+          else if (codePoint >= 0xDC00 && codePoint <= 0xDFFF)
+            return false;
+          // UTF-8 encoding
+          if (codePoint < 0x80)
+            value += (char)codePoint;
+          else if (codePoint < 0x800) {
+            value += (char)(0xC0 | (codePoint >> 6));
+            value += (char)(0x80 | (codePoint & 0x3F));
+          }
+          else if (codePoint < 0x10000) {
+            value += (char)(0xE0 | (codePoint >> 12));
+            value += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+            value += (char)(0x80 | (codePoint & 0x3F));
+          }
+          else {
+            value += (char)(0xF0 | (codePoint >> 18));
+            value += (char)(0x80 | ((codePoint >> 12) & 0x3F));
+            value += (char)(0x80 | ((codePoint >> 6) & 0x3F));
+            value += (char)(0x80 | (codePoint & 0x3F));
+          }
+          break;
+        }
+        default: return false;
+      }
+    }
+    return false;
+  };
+
+  auto parseValue = [&](Member& member) {
+    if (position < json.size() && json[position] == '"') {
+      member.isString = true;
+      return parseString(member.value);
+    }
+    member.isString = false;
+    if (!json.compare(position, 4, "true")) {
+      position += 4;
+      member.value = "1";
+      return true;
+    }
+    if (!json.compare(position, 5, "false")) {
+      position += 5;
+      member.value = "0";
+      return true;
+    }
+    // Only unsigned integers are supported
+    uint64_t number = 0;
+    size_t start = position;
+    for (; position < json.size() && json[position] >= '0' && json[position] <= '9'; position++) {
+      number = number * 10 + (json[position] - '0');
+      if (number > UINT32_MAX)
+        return false;
+    }
+    if (position == start || (json[start] == '0' && position - start > 1))
+      return false;
+    member.value = std::to_string(number);
+    return true;
+  };
+
+  skipWhitespace();
+  ESP_RETURN_ON_FALSE(position < json.size() && json[position++] == '{', ESP_ERR_INVALID_ARG, TAG, "JSON object expected");
+  skipWhitespace();
+  if (position < json.size() && json[position] == '}')
+    position++;
+  else {
+    while (true) {
+      Member member;
+      skipWhitespace();
+      ESP_RETURN_ON_FALSE(parseString(member.key), ESP_ERR_INVALID_ARG, TAG, "invalid JSON member name");
+      skipWhitespace();
+      ESP_RETURN_ON_FALSE(position < json.size() && json[position++] == ':', ESP_ERR_INVALID_ARG, TAG, "JSON member value expected");
+      skipWhitespace();
+      ESP_RETURN_ON_FALSE(parseValue(member), ESP_ERR_INVALID_ARG, TAG, "invalid JSON member value");
+      auto existingMember = std::find_if(newMembers.begin(), newMembers.end(), [&](const Member& newMember) { return newMember.key == member.key; });
+      if (existingMember != newMembers.end())
+        *existingMember = member;
+      else
+        newMembers.push_back(member);
+      skipWhitespace();
+      ESP_RETURN_ON_FALSE(position < json.size(), ESP_ERR_INVALID_ARG, TAG, "unterminated JSON object");
+      char c = json[position++];
+      if (c == '}')
+        break;
+      ESP_RETURN_ON_FALSE(c == ',', ESP_ERR_INVALID_ARG, TAG, "invalid JSON object");
+    }
+  }
+  skipWhitespace();
+  ESP_RETURN_ON_FALSE(position == json.size(), ESP_ERR_INVALID_ARG, TAG, "unexpected data after JSON object");
+
+  members.swap(newMembers);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool BlackBoxJsonConfigurationStorage::IsSubsetOf(BlackBoxJsonConfigurationStorage& storage) {
+  LockGuard lg(*this, storage);
+  for (auto& member : members) {
+    Member* otherMember = storage.Find(member.key);
+    if (!otherMember || otherMember->isString != member.isString || otherMember->value != member.value)
+      return false;
+  }
+  return true;
+}
+
+//==============================================================================
+
+std::string BlackBoxJsonConfigurationStorage::EncodeString(const std::string& value) {
+  static const char hexDigits[] = "0123456789abcdef";
+  std::string json = "\"";
+  json.reserve(value.size() + 2);
+  for (char c : value) {
+    switch (c) {
+      case '"': json += "\\\""; break;
+      case '\\': json += "\\\\"; break;
+      case '\n': json += "\\n"; break;
+      case '\r': json += "\\r"; break;
+      case '\t': json += "\\t"; break;
+      default:
+        if ((uint8_t)c < 0x20) {
+          json += "\\u00";
+          json += hexDigits[c >> 4];
+          json += hexDigits[c & 0x0F];
+        }
+        else
+          json += c;
+    }
+  }
+  return json + '"';
+}
+
+//==============================================================================
+
+BlackBoxJsonConfigurationStorage::Member* BlackBoxJsonConfigurationStorage::Find(const std::string& key) {
+  for (auto& member : members) {
+    if (member.key == key)
+      return &member;
+  }
+  return nullptr;
+}
+
+//==============================================================================
+
+void BlackBoxJsonConfigurationStorage::Set(const std::string& key, bool isString, const std::string& value) {
+  if (Member* member = Find(key)) {
+    member->isString = isString;
+    member->value = value;
+  }
+  else
+    members.push_back({key, isString, value});
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxJsonConfigurationStorage::ReadNumber(const std::string& key, uint32_t maxValue, uint32_t& value) {
+  LockGuard lg(*this);
+  Member* member = Find(key);
+  if (!member)
+    return ESP_ERR_NOT_FOUND;
+  ESP_RETURN_ON_FALSE(!member->isString, ESP_ERR_INVALID_ARG, TAG, "value type mismatch");
+  // Numbers are validated on write and in SetJson
+  uint32_t number = strtoul(member->value.c_str(), NULL, 10);
+  ESP_RETURN_ON_FALSE(number <= maxValue, ESP_ERR_INVALID_ARG, TAG, "value is out of range");
+  value = number;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+BlackBoxOverrideConfigurationStorage::BlackBoxOverrideConfigurationStorage(BlackBoxConfigurationStorage& defaultStorage, BlackBoxConfigurationStorage& overrideStorage) :
+  defaultStorage(defaultStorage), overrideStorage(overrideStorage) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Read(const std::string& key, uint8_t& value) {
+  return ReadValue(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Read(const std::string& key, uint16_t& value) {
+  return ReadValue(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Read(const std::string& key, uint32_t& value) {
+  return ReadValue(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Read(const std::string& key, std::string& value) {
+  return ReadValue(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Read(const std::string& key, void* value, size_t size, size_t* readSize) {
+  if (overrideStorage.Read(key, value, size, readSize) == ESP_OK)
+    return ESP_OK;
+  return defaultStorage.Read(key, value, size, readSize);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Write(const std::string& key, uint8_t value) {
+  return WriteValue(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Write(const std::string& key, uint16_t value) {
+  return WriteValue(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Write(const std::string& key, uint32_t value) {
+  return WriteValue(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Write(const std::string& key, const std::string& value) {
+  return WriteValue(key, value);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Write(const std::string& key, const void* value, size_t size) {
+  std::vector<uint8_t> storedValue(size);
+  size_t storedValueSize = 0;
+  if (defaultStorage.Read(key, storedValue.data(), storedValue.size(), &storedValueSize) == ESP_OK &&
+      storedValueSize == size && !memcmp(storedValue.data(), value, size))
+    return EraseOverride(key);
+  // An override of another size or type can not be read into the buffer of this size, so it is erased before the new value is written
+  esp_err_t error = overrideStorage.Read(key, storedValue.data(), storedValue.size(), &storedValueSize);
+  if (error != ESP_OK && error != ESP_ERR_NOT_FOUND && error != ESP_ERR_NVS_NOT_FOUND)
+    ESP_RETURN_ON_ERROR(EraseOverride(key), TAG, "override erase failed");
+  return overrideStorage.Write(key, value, size);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::Erase(const std::string& key) {
+  return overrideStorage.Erase(key);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxOverrideConfigurationStorage::EraseOverride(const std::string& key) {
+  // The override is not read before erasing, because an override of another size or type can not be read
+  esp_err_t error = overrideStorage.Erase(key);
+  return (error == ESP_ERR_NOT_FOUND || error == ESP_ERR_NVS_NOT_FOUND) ? ESP_OK : error;
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
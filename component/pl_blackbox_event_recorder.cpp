@@ -0,0 +1,298 @@
+#include "pl_blackbox_event_recorder.h"
+#include "pl_blackbox_clock.h"
+#include "esp_check.h"
+#include "esp_attr.h"
+#include <algorithm>
+#include <cstring>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_event_recorder";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+struct BlackBoxEventRingBuffer {
+  uint32_t signature;
+  uint32_t size;
+  uint32_t bootNumber;
+  uint32_t nextSequenceNumber;
+  uint32_t flushedSequenceNumber;
+  // Sequence number of the completely written event in the slot (sequence lock)
+  uint32_t slotSequenceNumbers[BlackBoxEventRecorder::ringBufferCapacity];
+  BlackBoxEvent events[BlackBoxEventRecorder::ringBufferCapacity];
+};
+
+static const uint32_t ringBufferSignature = 0x45424C50;
+// Slot sequence number while a producer writes the event (never used as an event sequence number)
+static const uint32_t busySequenceNumber = BlackBoxEventRecorder::invalidSequenceNumber - 1;
+static RTC_NOINIT_ATTR BlackBoxEventRingBuffer ringBuffer;
+
+//==============================================================================
+
+static void AppendEvent(BlackBoxEventType type, uint16_t code, uint32_t value) {
+  uint32_t sequenceNumber;
+  do {
+    sequenceNumber = __atomic_fetch_add(&ringBuffer.nextSequenceNumber, 1, __ATOMIC_RELAXED);
+  } while (sequenceNumber == BlackBoxEventRecorder::invalidSequenceNumber || sequenceNumber == busySequenceNumber);
+  size_t slot = sequenceNumber % BlackBoxEventRecorder::ringBufferCapacity;
+
+  // The producers of the sequence numbers that differ by a multiple of the ring buffer capacity write the same slot,
+  // so the slot is claimed first. The event is dropped if another producer is writing the slot or the slot has a newer event.
+  uint32_t slotSequenceNumber = __atomic_load_n(&ringBuffer.slotSequenceNumbers[slot], __ATOMIC_RELAXED);
+  do {
+    if (slotSequenceNumber == busySequenceNumber ||
+        (slotSequenceNumber != BlackBoxEventRecorder::invalidSequenceNumber && (int32_t)(sequenceNumber - slotSequenceNumber) <= 0))
+      return;
+  } while (!__atomic_compare_exchange_n(&ringBuffer.slotSequenceNumbers[slot], &slotSequenceNumber, busySequenceNumber, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  // Readers discard the event if the slot sequence number changes while they copy it
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  BlackBoxEvent& event = ringBuffer.events[slot];
+  event.sequenceNumber = sequenceNumber;
+  event.time = BlackBoxClock::GetMonotonicTime() / 1000;
+  event.type = type;
+  event.bootNumber = ringBuffer.bootNumber;
+  event.code = code;
+  event.value = value;
+  __atomic_store_n(&ringBuffer.slotSequenceNumbers[slot], sequenceNumber, __ATOMIC_RELEASE);
+}
+
+//==============================================================================
+
+static bool InitializeRingBuffer() {
+  esp_reset_reason_t resetReason = esp_reset_reason();
+  // The RTC memory content is undefined after the power-on reset. The events before a brownout reset are kept if the ring buffer header is valid.
+  if (resetReason == ESP_RST_POWERON || ringBuffer.signature != ringBufferSignature ||
+      ringBuffer.size != sizeof(BlackBoxEventRingBuffer) || ringBuffer.flushedSequenceNumber > ringBuffer.nextSequenceNumber) {
+    memset(&ringBuffer, 0, sizeof(BlackBoxEventRingBuffer));
+    std::fill(std::begin(ringBuffer.slotSequenceNumbers), std::end(ringBuffer.slotSequenceNumbers), BlackBoxEventRecorder::invalidSequenceNumber);
+    ringBuffer.signature = ringBufferSignature;
+    ringBuffer.size = sizeof(BlackBoxEventRingBuffer);
+  }
+  // The events that were being written at the reset are incomplete
+  for (auto& slotSequenceNumber : ringBuffer.slotSequenceNumbers) {
+    if (slotSequenceNumber == busySequenceNumber)
+      slotSequenceNumber = BlackBoxEventRecorder::invalidSequenceNumber;
+  }
+  ringBuffer.bootNumber++;
+  AppendEvent(BlackBoxEventType::reset, 0, resetReason);
+  return true;
+}
+
+//==============================================================================
+
+static void InitializeRingBufferOnce() {
+  static const bool ringBufferInitialized = InitializeRingBuffer();
+  (void)ringBufferInitialized;
+}
+
+//==============================================================================
+
+void BlackBoxEventRecorder::Record(BlackBoxEventType type, uint16_t code, uint32_t value) {
+  InitializeRingBufferOnce();
+  AppendEvent(type, code, value);
+}
+
+//==============================================================================
+
+uint32_t BlackBoxEventRecorder::GetFirstSequenceNumber() {
+  uint32_t nextSequenceNumber = GetNextSequenceNumber();
+  return nextSequenceNumber < ringBufferCapacity ? 0 : nextSequenceNumber - ringBufferCapacity;
+}
+
+//==============================================================================
+
+uint32_t BlackBoxEventRecorder::GetNextSequenceNumber() {
+  InitializeRingBufferOnce();
+  return __atomic_load_n(&ringBuffer.nextSequenceNumber, __ATOMIC_RELAXED);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::ReadEvent(uint32_t sequenceNumber, BlackBoxEvent& event) {
+  InitializeRingBufferOnce();
+  size_t slot = sequenceNumber % ringBufferCapacity;
+  if (__atomic_load_n(&ringBuffer.slotSequenceNumbers[slot], __ATOMIC_ACQUIRE) != sequenceNumber)
+    return ESP_ERR_NOT_FOUND;
+  event = ringBuffer.events[slot];
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  if (__atomic_load_n(&ringBuffer.slotSequenceNumbers[slot], __ATOMIC_RELAXED) != sequenceNumber)
+    return ESP_ERR_NOT_FOUND;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+BlackBoxEventRecorder::BlackBoxEventRecorder(const std::string& partitionLabel) : partitionLabel(partitionLabel) {}
+
+//==============================================================================
+
+BlackBoxEventRecorder::~BlackBoxEventRecorder() {
+  DisablePeriodicFlush();
+  if (flushTimer)
+    esp_timer_delete(flushTimer);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::Flush() {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_ERROR(OpenPartition(), TAG, "partition open failed");
+
+  uint32_t firstSequenceNumber = GetFirstSequenceNumber();
+  uint32_t nextSequenceNumber = GetNextSequenceNumber();
+  uint32_t sequenceNumber = ringBuffer.flushedSequenceNumber;
+  // Events that have been overwritten before the flush are lost
+  if (nextSequenceNumber - sequenceNumber > nextSequenceNumber - firstSequenceNumber)
+    sequenceNumber = firstSequenceNumber;
+
+  for (; sequenceNumber != nextSequenceNumber; sequenceNumber++) {
+    if (sequenceNumber != invalidSequenceNumber) {
+      BlackBoxEvent event;
+      // The event that is being recorded is stored by the next flush
+      if (ReadEvent(sequenceNumber, event) != ESP_OK)
+        break;
+      ESP_RETURN_ON_ERROR(WriteStoredEvent(event), TAG, "event write failed");
+    }
+    ringBuffer.flushedSequenceNumber = sequenceNumber + 1;
+  }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::EnablePeriodicFlush(uint64_t interval) {
+  LockGuard lg(*this);
+  if (!flushTimer) {
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = FlushTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "pl_bb_events";
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timerArgs, &flushTimer), TAG, "flush timer create failed");
+  }
+  esp_timer_stop(flushTimer);
+  ESP_RETURN_ON_ERROR(esp_timer_start_periodic(flushTimer, interval), TAG, "flush timer start failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::DisablePeriodicFlush() {
+  LockGuard lg(*this);
+  if (flushTimer)
+    esp_timer_stop(flushTimer);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::ForEachStoredEvent(const std::function<void(const BlackBoxEvent& event)>& visitor) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_ERROR(OpenPartition(), TAG, "partition open failed");
+
+  // The oldest events follow the erased slots at the write position
+  for (size_t i = 0; i < numberOfSlots; i++) {
+    size_t slot = (writeSlot + i) % numberOfSlots;
+    BlackBoxEvent event;
+    ESP_RETURN_ON_ERROR(esp_partition_read(partition, slot * sizeof(BlackBoxEvent), &event, sizeof(BlackBoxEvent)), TAG, "partition read failed");
+    if (event.sequenceNumber != invalidSequenceNumber)
+      visitor(event);
+  }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::EraseStoredEvents() {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_ERROR(OpenPartition(), TAG, "partition open failed");
+  ESP_RETURN_ON_ERROR(esp_partition_erase_range(partition, 0, partition->size), TAG, "partition erase failed");
+  writeSlot = 0;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::OpenPartition() {
+  if (partition)
+    return ESP_OK;
+
+  const esp_partition_t* foundPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, partitionLabel.c_str());
+  ESP_RETURN_ON_FALSE(foundPartition, ESP_ERR_NOT_FOUND, TAG, "partition not found");
+  ESP_RETURN_ON_FALSE(foundPartition->size >= 2 * foundPartition->erase_size && foundPartition->size % foundPartition->erase_size == 0,
+    ESP_ERR_INVALID_SIZE, TAG, "partition should have at least 2 sectors");
+  size_t foundNumberOfSlots = foundPartition->size / sizeof(BlackBoxEvent);
+
+  // The write position is the first erased slot after a written slot (there is always an erased slot, see WriteStoredEvent)
+  auto isSlotErased = [](const BlackBoxEvent& event) { return event.sequenceNumber == invalidSequenceNumber; };
+  BlackBoxEvent events[16];
+  ESP_RETURN_ON_ERROR(esp_partition_read(foundPartition, foundPartition->size - sizeof(BlackBoxEvent), events, sizeof(BlackBoxEvent)), TAG, "partition read failed");
+  bool previousSlotErased = isSlotErased(events[0]);
+  bool erasedSlotFound = false, writeSlotFound = false;
+  size_t foundWriteSlot = 0;
+  for (size_t slot = 0; slot < foundNumberOfSlots && !writeSlotFound; slot += sizeof(events) / sizeof(BlackBoxEvent)) {
+    size_t numberOfEvents = std::min(sizeof(events) / sizeof(BlackBoxEvent), foundNumberOfSlots - slot);
+    ESP_RETURN_ON_ERROR(esp_partition_read(foundPartition, slot * sizeof(BlackBoxEvent), events, numberOfEvents * sizeof(BlackBoxEvent)), TAG, "partition read failed");
+    for (size_t i = 0; i < numberOfEvents; i++) {
+      bool slotErased = isSlotErased(events[i]);
+      erasedSlotFound |= slotErased;
+      if (slotErased && !previousSlotErased) {
+        foundWriteSlot = slot + i;
+        writeSlotFound = true;
+        break;
+      }
+      previousSlotErased = slotErased;
+    }
+  }
+  if (!erasedSlotFound)
+    ESP_RETURN_ON_ERROR(esp_partition_erase_range(foundPartition, 0, foundPartition->erase_size), TAG, "partition erase failed");
+
+  partition = foundPartition;
+  numberOfSlots = foundNumberOfSlots;
+  writeSlot = foundWriteSlot;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxEventRecorder::WriteStoredEvent(const BlackBoxEvent& event) {
+  ESP_RETURN_ON_ERROR(esp_partition_write(partition, writeSlot * sizeof(BlackBoxEvent), &event, sizeof(BlackBoxEvent)), TAG, "partition write failed");
+  writeSlot = (writeSlot + 1) % numberOfSlots;
+  // The next sector is erased in advance, so the write position can be found after the reset
+  if ((writeSlot * sizeof(BlackBoxEvent)) % partition->erase_size == 0)
+    ESP_RETURN_ON_ERROR(esp_partition_erase_range(partition, writeSlot * sizeof(BlackBoxEvent), partition->erase_size), TAG, "partition erase failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+void BlackBoxEventRecorder::FlushTimerCallback(void* arg) {
+  ((BlackBoxEventRecorder*)arg)->Flush();
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
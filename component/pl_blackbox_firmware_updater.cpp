@@ -0,0 +1,195 @@
+#include "pl_blackbox_firmware_updater.h"
+#include "esp_check.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_ota_ops.h"
+#include "mbedtls/sha256.h"
+#endif
+#include <algorithm>
+#include <cstring>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_firmware_updater";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+BlackBoxFirmwareUpdater::BlackBoxFirmwareUpdater(size_t bufferSize, TickType_t inactivityTimeout) :
+  streamBuffer(xStreamBufferCreate(bufferSize, 1)), inactivityTimeout(inactivityTimeout) {}
+
+//==============================================================================
+
+BlackBoxFirmwareUpdater::~BlackBoxFirmwareUpdater() {
+  Abort();
+  while (taskRunning)
+    vTaskDelay(1);
+  if (streamBuffer)
+    vStreamBufferDelete(streamBuffer);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxFirmwareUpdater::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxFirmwareUpdater::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxFirmwareUpdater::Begin(uint32_t imageSize, const uint8_t* sha256) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(streamBuffer, ESP_ERR_NO_MEM, TAG, "stream buffer create failed");
+  ESP_RETURN_ON_FALSE(!taskRunning, ESP_ERR_INVALID_STATE, TAG, "update is in progress");
+  ESP_RETURN_ON_FALSE(imageSize, ESP_ERR_INVALID_SIZE, TAG, "invalid image size");
+
+  xStreamBufferReset(streamBuffer);
+  this->imageSize = imageSize;
+  memcpy(expectedSha256, sha256, sha256Size);
+  error = ESP_OK;
+  receivedSize = 0;
+  writtenSize = 0;
+  abortRequested = false;
+  state = BlackBoxFirmwareUpdateState::receiving;
+  taskRunning = true;
+  if (xTaskCreate(WriteTask, "pl_bb_fw_update", taskStackDepth, this, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+    taskRunning = false;
+    state = BlackBoxFirmwareUpdateState::error;
+    error = ESP_ERR_NO_MEM;
+    ESP_RETURN_ON_ERROR(ESP_ERR_NO_MEM, TAG, "write task create failed");
+  }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxFirmwareUpdater::Write(uint32_t offset, const void* data, size_t size) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(state == BlackBoxFirmwareUpdateState::receiving, ESP_ERR_INVALID_STATE, TAG, "update is not in progress");
+  uint32_t receivedSize = this->receivedSize;
+  ESP_RETURN_ON_FALSE(offset <= receivedSize, ESP_ERR_INVALID_ARG, TAG, "data is missing before the offset");
+  if (offset + size <= receivedSize)
+    return ESP_OK;
+  size_t skippedSize = receivedSize - offset;
+  size -= skippedSize;
+  ESP_RETURN_ON_FALSE(receivedSize + size <= imageSize, ESP_ERR_INVALID_SIZE, TAG, "data exceeds the image size");
+
+  // The write waits for the space while the task writes the flash, which throttles the client
+  size_t sentSize = xStreamBufferSend(streamBuffer, (const uint8_t*)data + skippedSize, size, writeTimeout);
+  this->receivedSize = receivedSize + sentSize;
+  ESP_RETURN_ON_FALSE(sentSize == size, ESP_ERR_TIMEOUT, TAG, "stream buffer send timeout");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxFirmwareUpdater::Abort() {
+  LockGuard lg(*this);
+  abortRequested = true;
+  if (!taskRunning && state != BlackBoxFirmwareUpdateState::error)
+    state = BlackBoxFirmwareUpdateState::idle;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+BlackBoxFirmwareUpdateStatus BlackBoxFirmwareUpdater::GetStatus() {
+  BlackBoxFirmwareUpdateStatus status;
+  status.state = state;
+  status.error = error;
+  status.imageSize = imageSize;
+  status.receivedSize = receivedSize;
+  status.writtenSize = writtenSize;
+  return status;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxFirmwareUpdater::WriteImage() {
+#if CONFIG_IDF_TARGET_LINUX
+  // The host target has no OTA partitions
+  return ESP_ERR_NOT_SUPPORTED;
+#else
+  const esp_partition_t* partition = esp_ota_get_next_update_partition(NULL);
+  ESP_RETURN_ON_FALSE(partition, ESP_ERR_NOT_FOUND, TAG, "OTA partition not found");
+  ESP_RETURN_ON_FALSE(imageSize <= partition->size, ESP_ERR_INVALID_SIZE, TAG, "image does not fit the OTA partition");
+  esp_ota_handle_t otaHandle;
+  // Sequential writes erase the partition sector by sector instead of erasing the whole image before the reception
+  ESP_RETURN_ON_ERROR(esp_ota_begin(partition, OTA_WITH_SEQUENTIAL_WRITES, &otaHandle), TAG, "OTA begin failed");
+
+  std::vector<uint8_t> chunk(4096);
+  mbedtls_sha256_context sha256Context;
+  mbedtls_sha256_init(&sha256Context);
+  mbedtls_sha256_starts(&sha256Context, 0);
+  esp_err_t error = ESP_OK;
+  TickType_t receiveTime = xTaskGetTickCount();
+  while (writtenSize < imageSize) {
+    if (abortRequested) {
+      error = ESP_ERR_INVALID_STATE;
+      break;
+    }
+    size_t size = xStreamBufferReceive(streamBuffer, chunk.data(), std::min<size_t>(chunk.size(), imageSize - writtenSize), pdMS_TO_TICKS(100));
+    if (!size) {
+      // The OTA handle is released if the client has stopped sending the image
+      if (xTaskGetTickCount() - receiveTime >= inactivityTimeout) {
+        error = ESP_ERR_TIMEOUT;
+        break;
+      }
+      continue;
+    }
+    receiveTime = xTaskGetTickCount();
+    mbedtls_sha256_update(&sha256Context, chunk.data(), size);
+    if ((error = esp_ota_write(otaHandle, chunk.data(), size)) != ESP_OK)
+      break;
+    writtenSize += size;
+  }
+  uint8_t sha256[sha256Size];
+  mbedtls_sha256_finish(&sha256Context, sha256);
+  mbedtls_sha256_free(&sha256Context);
+  if (error != ESP_OK) {
+    esp_ota_abort(otaHandle);
+    ESP_RETURN_ON_ERROR(error, TAG, "image write failed");
+  }
+
+  state = BlackBoxFirmwareUpdateState::verifying;
+  if (memcmp(sha256, expectedSha256, sha256Size)) {
+    esp_ota_abort(otaHandle);
+    ESP_RETURN_ON_ERROR(ESP_ERR_INVALID_CRC, TAG, "image hash mismatch");
+  }
+  ESP_RETURN_ON_ERROR(esp_ota_end(otaHandle), TAG, "image verification failed");
+  ESP_RETURN_ON_ERROR(esp_ota_set_boot_partition(partition), TAG, "boot partition set failed");
+  return ESP_OK;
+#endif
+}
+
+//==============================================================================
+
+void BlackBoxFirmwareUpdater::WriteTask(void* parameters) {
+  BlackBoxFirmwareUpdater& updater = *(BlackBoxFirmwareUpdater*)parameters;
+  esp_err_t error = updater.WriteImage();
+  updater.error = error;
+  if (error == ESP_OK)
+    updater.state = BlackBoxFirmwareUpdateState::ready;
+  else
+    updater.state = updater.abortRequested ? BlackBoxFirmwareUpdateState::idle : BlackBoxFirmwareUpdateState::error;
+  updater.taskRunning = false;
+  vTaskDelete(NULL);
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
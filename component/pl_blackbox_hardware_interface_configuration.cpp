@@ -1,4 +1,9 @@
 #include "pl_blackbox_hardware_interface_configuration.h"
+#include "pl_uart.h"
+#include "pl_network.h"
+#if CONFIG_TINYUSB_CDC_ENABLED
+#include "pl_usb.h"
+#endif
 
 //==============================================================================
 
@@ -15,7 +20,21 @@ const std::string BlackBoxHardwareInterfaceConfiguration::enabledNvsKey = "enabl
 //==============================================================================
 
 BlackBoxHardwareInterfaceConfiguration::BlackBoxHardwareInterfaceConfiguration(std::shared_ptr<HardwareInterface> hardwareInterface, std::string nvsNamespaceName) :
-    nvsNamespaceName(nvsNamespaceName), hardwareInterface(hardwareInterface) {}
+    nvsNamespaceName(nvsNamespaceName), hardwareInterface(hardwareInterface), type(BlackBoxHardwareInterfaceType::unknown) {
+  if (dynamic_cast<Uart*>(hardwareInterface.get()))
+    type = BlackBoxHardwareInterfaceType::uart;
+  if (dynamic_cast<NetworkInterface*>(hardwareInterface.get()))
+    type = BlackBoxHardwareInterfaceType::networkInterface;
+  if (dynamic_cast<Ethernet*>(hardwareInterface.get()))
+    type = BlackBoxHardwareInterfaceType::ethernet;
+  if (dynamic_cast<WiFiStation*>(hardwareInterface.get()))
+    type = BlackBoxHardwareInterfaceType::wifiStation;
+#if CONFIG_TINYUSB_CDC_ENABLED
+  if (dynamic_cast<UsbDeviceCdc*>(hardwareInterface.get()))
+    type = BlackBoxHardwareInterfaceType::usbDeviceCdc;
+#endif
+  enabled.SetChangeHandler([this]() { OnParameterChanged(); });
+}
 
 //==============================================================================
 
@@ -45,22 +64,24 @@ std::shared_ptr<HardwareInterface> BlackBoxHardwareInterfaceConfiguration::GetHa
 
 //==============================================================================
 
+BlackBoxHardwareInterfaceType BlackBoxHardwareInterfaceConfiguration::GetType() {
+  return type;
+}
+
+//==============================================================================
+
 void BlackBoxHardwareInterfaceConfiguration::Load() {
   LockGuard lg(*this);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readOnly);
-  uint8_t u8Value;
-
-  if (nvsNamespace.Read(enabledNvsKey, u8Value) == ESP_OK)
-    enabled.SetValue(u8Value);
+  BlackBoxNvsConfigurationStorage storage(nvsNamespaceName, NvsAccessMode::readOnly);
+  LoadParameters(storage);
 }
 
 //==============================================================================
 
 void BlackBoxHardwareInterfaceConfiguration::Save() {
   LockGuard lg(*this);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readWrite);
-
-  nvsNamespace.Write(enabledNvsKey, (uint8_t)enabled.GetValue());
+  BlackBoxNvsConfigurationStorage storage(nvsNamespaceName, NvsAccessMode::readWrite);
+  SaveParameters(storage);
 }
 
 //==============================================================================
@@ -73,6 +94,86 @@ void BlackBoxHardwareInterfaceConfiguration::Erase() {
 
 //==============================================================================
 
+void BlackBoxHardwareInterfaceConfiguration::LoadParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(*this);
+  uint8_t u8Value;
+
+  // The enabled flag of the deferred configuration has been set from the general configuration index and could have been changed since then
+  if (loadState != LoadState::loading && storage.Read(enabledNvsKey, u8Value) == ESP_OK)
+    enabled.SetValue(u8Value);
+}
+
+//==============================================================================
+
+void BlackBoxHardwareInterfaceConfiguration::SaveParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(*this);
+
+  storage.Write(enabledNvsKey, (uint8_t)enabled.GetValue());
+}
+
+//==============================================================================
+
+std::string BlackBoxHardwareInterfaceConfiguration::GetNvsNamespaceName() {
+  LockGuard lg(*this);
+  return nvsNamespaceName;
+}
+
+//==============================================================================
+
+void BlackBoxHardwareInterfaceConfiguration::DeferLoad(std::shared_ptr<BlackBoxConfigurationStorage> storage) {
+  LockGuard lg(*this);
+  deferredLoadStorage = storage;
+  loadState = LoadState::deferred;
+}
+
+//==============================================================================
+
+bool BlackBoxHardwareInterfaceConfiguration::IsLoadDeferred() {
+  return loadState == LoadState::deferred;
+}
+
+//==============================================================================
+
+uint32_t BlackBoxHardwareInterfaceConfiguration::GetGeneration() {
+  return generation;
+}
+
+//==============================================================================
+
+void BlackBoxHardwareInterfaceConfiguration::SetChangeHandler(std::function<void()> changeHandler) {
+  LockGuard lg(mutex);
+  this->changeHandler = changeHandler;
+}
+
+//==============================================================================
+
+void BlackBoxHardwareInterfaceConfiguration::LoadIfDeferred() {
+  if (loadState == LoadState::loaded)
+    return;
+  LockGuard lg(*this);
+  // Other tasks wait for the mutex until the loading is finished, the loading task itself gets here from the parameter access handlers
+  if (loadState != LoadState::deferred)
+    return;
+  loadState = LoadState::loading;
+  if (deferredLoadStorage)
+    LoadParameters(*deferredLoadStorage);
+  else
+    Load();
+  deferredLoadStorage.reset();
+  loadState = LoadState::loaded;
+}
+
+//==============================================================================
+
+void BlackBoxHardwareInterfaceConfiguration::OnParameterChanged() {
+  generation.fetch_add(1);
+  LockGuard lg(mutex);
+  if (changeHandler)
+    changeHandler();
+}
+
+//==============================================================================
+
 void BlackBoxHardwareInterfaceConfiguration::Apply() {
   LockGuard lg(*this, *hardwareInterface);
   
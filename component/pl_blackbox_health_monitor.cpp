@@ -0,0 +1,167 @@
+#include "pl_blackbox_health_monitor.h"
+#include "pl_blackbox_clock.h"
+#include "esp_check.h"
+#include "esp_heap_caps.h"
+#include <algorithm>
+#include <cstring>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_health_monitor";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+BlackBoxHealthMonitor::BlackBoxHealthMonitor() {}
+
+//==============================================================================
+
+BlackBoxHealthMonitor::~BlackBoxHealthMonitor() {
+  DisablePeriodicSampling();
+  if (samplingTimer)
+    esp_timer_delete(samplingTimer);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHealthMonitor::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHealthMonitor::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHealthMonitor::EnablePeriodicSampling(uint64_t samplingInterval) {
+  LockGuard lg(*this);
+  if (!samplingTimer) {
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = SamplingTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "pl_bb_health";
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timerArgs, &samplingTimer), TAG, "sampling timer create failed");
+  }
+  esp_timer_stop(samplingTimer);
+  ESP_RETURN_ON_ERROR(esp_timer_start_periodic(samplingTimer, samplingInterval), TAG, "sampling timer start failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHealthMonitor::DisablePeriodicSampling() {
+  LockGuard lg(*this);
+  if (samplingTimer)
+    esp_timer_stop(samplingTimer);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHealthMonitor::Sample() {
+  LockGuard lg(*this);
+  uint32_t publishedSnapshots = numberOfSnapshots.load(std::memory_order_relaxed);
+  BlackBoxHealth& health = snapshots[(publishedSnapshots + 1) % 2];
+  memset(&health, 0, sizeof(BlackBoxHealth));
+
+  health.sampleNumber = ++sampleNumber;
+  health.uptime = BlackBoxClock::GetMonotonicTime() / 1000;
+  health.defaultHeap = GetHeapHealth(MALLOC_CAP_DEFAULT);
+  health.internalHeap = GetHeapHealth(MALLOC_CAP_INTERNAL);
+  health.spiramHeap = GetHeapHealth(MALLOC_CAP_SPIRAM);
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+  // A few extra entries for the tasks created after the number of tasks is read
+  std::vector<TaskStatus_t> taskStatuses(uxTaskGetNumberOfTasks() + 4);
+  uint32_t totalRunTime = 0;
+  taskStatuses.resize(uxTaskGetSystemState(taskStatuses.data(), taskStatuses.size(), &totalRunTime));
+  health.numberOfTasks = taskStatuses.size();
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  uint32_t totalRunTimeDelta = totalRunTime - previousTotalRunTime;
+  previousTotalRunTime = totalRunTime;
+  std::unordered_map<TaskHandle_t, uint32_t> taskRunTimes;
+  auto getCpuLoad = [&](const TaskStatus_t& taskStatus) -> uint16_t {
+    auto previousTaskRunTime = previousTaskRunTimes.find(taskStatus.xHandle);
+    if (!totalRunTimeDelta || previousTaskRunTime == previousTaskRunTimes.end())
+      return 0;
+    return std::min<uint64_t>((uint64_t)(taskStatus.ulRunTimeCounter - previousTaskRunTime->second) * 1000 / totalRunTimeDelta, 1000);
+  };
+  for (auto& taskStatus : taskStatuses)
+    taskRunTimes[taskStatus.xHandle] = taskStatus.ulRunTimeCounter;
+  for (BaseType_t core = 0; core < std::min<BaseType_t>(configNUMBER_OF_CORES, 2); core++) {
+    TaskHandle_t idleTask = xTaskGetIdleTaskHandleForCore(core);
+    for (auto& taskStatus : taskStatuses) {
+      if (taskStatus.xHandle == idleTask)
+        health.coreIdleTime[core] = getCpuLoad(taskStatus);
+    }
+  }
+#endif
+
+  // The tasks with the lowest stack high-water marks are the most likely to overflow
+  size_t numberOfReportedTasks = std::min(maxNumberOfTasks, taskStatuses.size());
+  std::partial_sort(taskStatuses.begin(), taskStatuses.begin() + numberOfReportedTasks, taskStatuses.end(),
+    [](const TaskStatus_t& a, const TaskStatus_t& b) { return a.usStackHighWaterMark < b.usStackHighWaterMark; });
+  for (size_t i = 0; i < numberOfReportedTasks; i++) {
+    strncpy(health.tasks[i].name, taskStatuses[i].pcTaskName, sizeof(health.tasks[i].name) - 1);
+    health.tasks[i].stackHighWaterMark = taskStatuses[i].usStackHighWaterMark;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    health.tasks[i].cpuLoad = getCpuLoad(taskStatuses[i]);
+#endif
+  }
+
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  previousTaskRunTimes.swap(taskRunTimes);
+#endif
+#endif
+
+  numberOfSnapshots.store(publishedSnapshots + 1, std::memory_order_release);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+BlackBoxHealth BlackBoxHealthMonitor::GetHealth() {
+  // The snapshot is copied again if the sampler has started to overwrite it
+  while (true) {
+    uint32_t publishedSnapshots = numberOfSnapshots.load(std::memory_order_acquire);
+    BlackBoxHealth health = snapshots[publishedSnapshots % 2];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (numberOfSnapshots.load(std::memory_order_relaxed) == publishedSnapshots)
+      return health;
+  }
+}
+
+//==============================================================================
+
+void BlackBoxHealthMonitor::SamplingTimerCallback(void* arg) {
+  ((BlackBoxHealthMonitor*)arg)->Sample();
+}
+
+//==============================================================================
+
+BlackBoxHeapHealth BlackBoxHealthMonitor::GetHeapHealth(uint32_t capabilities) {
+  BlackBoxHeapHealth heapHealth;
+  heapHealth.freeSize = heap_caps_get_free_size(capabilities);
+  heapHealth.minFreeSize = heap_caps_get_minimum_free_size(capabilities);
+  heapHealth.largestFreeBlockSize = heap_caps_get_largest_free_block(capabilities);
+  return heapHealth;
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,564 @@
+#include "pl_blackbox_http_server.h"
+#include "esp_check.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/socket.h>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_http_server";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+const std::string BlackBoxHttpServer::uriPrefix = "/blackbox";
+
+//==============================================================================
+
+BlackBoxHttpServer::BlackBoxHttpServer(std::shared_ptr<BlackBox> blackBox, uint16_t port) : NetworkServer("blackbox_http"), blackBox(blackBox), port(port) {}
+
+//==============================================================================
+
+BlackBoxHttpServer::~BlackBoxHttpServer() {
+  // Event tasks and HTTP server handlers use the server, so it cannot be destroyed while they run.
+  // An event task that is blocked by a client that does not receive the data finishes after its socket is shut down.
+  if (Disable() == ESP_ERR_TIMEOUT) {
+    ShutdownEventClientSockets();
+    Disable();
+  }
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::Enable() {
+  LockGuard lg(*this);
+  if (handle)
+    return ESP_OK;
+
+  httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+  config.server_port = port;
+  // The control port should differ from the control ports of the other HTTP servers.
+  // The ports above the default control port are used as is (the control socket is UDP, so it does not conflict with the server TCP port).
+  config.ctrl_port = ESP_HTTPD_DEF_CTRL_PORT + port % (UINT16_MAX + 1 - ESP_HTTPD_DEF_CTRL_PORT);
+  config.max_open_sockets = maxNumberOfClients;
+  config.uri_match_fn = httpd_uri_match_wildcard;
+  ESP_RETURN_ON_ERROR(httpd_start(&handle, &config), TAG, "server start failed");
+
+  static const std::string patchUri = uriPrefix + "/*";
+  static const std::string eventUri = uriPrefix + "/events";
+  static const std::string traceUri = uriPrefix + "/trace";
+  httpd_uri_t getUriHandler = {uriPrefix.c_str(), HTTP_GET, HandleGetRequest, this};
+  httpd_uri_t patchUriHandler = {patchUri.c_str(), HTTP_PATCH, HandlePatchRequest, this};
+  httpd_uri_t eventUriHandler = {eventUri.c_str(), HTTP_GET, HandleEventRequest, this};
+  httpd_uri_t traceUriHandler = {traceUri.c_str(), HTTP_GET, HandleTraceRequest, this};
+  esp_err_t error = httpd_register_uri_handler(handle, &getUriHandler);
+  if (error == ESP_OK)
+    error = httpd_register_uri_handler(handle, &patchUriHandler);
+  if (error == ESP_OK)
+    error = httpd_register_uri_handler(handle, &eventUriHandler);
+  if (error == ESP_OK)
+    error = httpd_register_uri_handler(handle, &traceUriHandler);
+  if (error != ESP_OK) {
+    httpd_stop(handle);
+    handle = NULL;
+    ESP_RETURN_ON_ERROR(error, TAG, "URI handler registration failed");
+  }
+
+  changeObserverId = blackBox->AddChangeObserver([this](BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration) {
+    OnChange(type, configuration);
+  });
+  enabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::Disable() {
+  LockGuard lg(*this);
+  if (!handle)
+    return ESP_OK;
+
+  // Event stream requests should be completed before the server stops
+  ESP_RETURN_ON_ERROR(StopEventClients(), TAG, "event client stop failed");
+  blackBox->RemoveChangeObserver(changeObserverId);
+  ESP_RETURN_ON_ERROR(httpd_stop(handle), TAG, "server stop failed");
+  handle = NULL;
+  disabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool BlackBoxHttpServer::IsEnabled() {
+  LockGuard lg(*this);
+  return handle != NULL;
+}
+
+//==============================================================================
+
+uint16_t BlackBoxHttpServer::GetPort() {
+  LockGuard lg(*this);
+  return port;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::SetPort(uint16_t port) {
+  LockGuard lg(*this);
+  this->port = port;
+  return Restart();
+}
+
+//==============================================================================
+
+size_t BlackBoxHttpServer::GetMaxNumberOfClients() {
+  LockGuard lg(*this);
+  return maxNumberOfClients;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::SetMaxNumberOfClients(size_t maxNumberOfClients) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(maxNumberOfClients > 0 && maxNumberOfClients <= UINT16_MAX, ESP_ERR_INVALID_ARG, TAG, "invalid maximum number of clients");
+  this->maxNumberOfClients = maxNumberOfClients;
+  return Restart();
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::Restart() {
+  if (!handle)
+    return ESP_OK;
+  ESP_RETURN_ON_ERROR(Disable(), TAG, "disable failed");
+  ESP_RETURN_ON_ERROR(Enable(), TAG, "enable failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+std::string BlackBoxHttpServer::GetDeviceJson() {
+  BlackBoxJsonConfigurationStorage general, hardwareInfo, firmwareInfo;
+
+  general.Write(BlackBox::generalConfigurationDeviceNameNvsKey, blackBox->GetDeviceName());
+  general.Write("restartedFlag", (uint8_t)blackBox->GetRestartedFlag());
+  BlackBoxResetInfo resetInfo = blackBox->GetResetInfo();
+  general.Write("resetReason", resetInfo.reason);
+  general.Write("resetCounter", resetInfo.resetCounter);
+  general.Write("abnormalResetCounter", resetInfo.abnormalResetCounter);
+  general.Write("lastAbnormalResetReason", resetInfo.lastAbnormalResetReason);
+  general.Write("panicPc", resetInfo.panicPc);
+  general.Write("utcTime", (uint32_t)(BlackBoxClock::GetUtcTime() / 1000000));
+  general.Write("panicTask", std::string(resetInfo.panicTaskName, strnlen(resetInfo.panicTaskName, sizeof(resetInfo.panicTaskName))));
+
+  BlackBoxHardwareInfo hardware = blackBox->GetHardwareInfo();
+  hardwareInfo.Write(BlackBox::hardwareInfoNameNvsKey, hardware.name);
+  hardwareInfo.Write(BlackBox::hardwareInfoMajorVersionNvsKey, hardware.version.major);
+  hardwareInfo.Write(BlackBox::hardwareInfoMinorVersionNvsKey, hardware.version.minor);
+  hardwareInfo.Write(BlackBox::hardwareInfoPatchVersionNvsKey, hardware.version.patch);
+  hardwareInfo.Write(BlackBox::hardwareInfoUidNvsKey, hardware.uid);
+
+  BlackBoxFirmwareInfo firmware = blackBox->GetFirmwareInfo();
+  firmwareInfo.Write(BlackBox::hardwareInfoNameNvsKey, firmware.name);
+  firmwareInfo.Write(BlackBox::hardwareInfoMajorVersionNvsKey, firmware.version.major);
+  firmwareInfo.Write(BlackBox::hardwareInfoMinorVersionNvsKey, firmware.version.minor);
+  firmwareInfo.Write(BlackBox::hardwareInfoPatchVersionNvsKey, firmware.version.patch);
+
+  std::string json = general.GetJson();
+  json.pop_back();
+  return json + ",\"hardwareInfo\":" + hardwareInfo.GetJson() + ",\"firmwareInfo\":" + firmwareInfo.GetJson() + '}';
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::HandleGetRequest(httpd_req_t* request) {
+  BlackBoxHttpServer& server = *(BlackBoxHttpServer*)request->user_ctx;
+  BlackBox& blackBox = *server.blackBox;
+
+  // The generation is read before the configurations, so a change during sending makes the next request get the full response
+  char eTag[20];
+  snprintf(eTag, sizeof(eTag), "\"%016llx\"", (unsigned long long)blackBox.GetConfigurationGeneration());
+  httpd_resp_set_hdr(request, "ETag", eTag);
+  httpd_resp_set_hdr(request, "Cache-Control", "no-cache");
+
+  size_t ifNoneMatchSize = httpd_req_get_hdr_value_len(request, "If-None-Match");
+  if (ifNoneMatchSize) {
+    std::string ifNoneMatch(ifNoneMatchSize + 1, 0);
+    if (httpd_req_get_hdr_value_str(request, "If-None-Match", ifNoneMatch.data(), ifNoneMatch.size()) == ESP_OK &&
+        (strstr(ifNoneMatch.c_str(), eTag) || !strcmp(ifNoneMatch.c_str(), "*"))) {
+      httpd_resp_set_status(request, "304 Not Modified");
+      return httpd_resp_send(request, NULL, 0);
+    }
+  }
+
+  httpd_resp_set_type(request, "application/json");
+  std::string chunk = "{\"device\":" + server.GetDeviceJson() + ",\"hardwareInterfaces\":[";
+  ESP_RETURN_ON_ERROR(httpd_resp_send_chunk(request, chunk.data(), chunk.size()), TAG, "response send failed");
+
+  const char* separator = "";
+  for (auto& configuration : blackBox.GetHardwareInterfaceConfigurations()) {
+    chunk = separator + GetConfigurationJson(*configuration, configuration->GetHardwareInterface()->GetName(), (uint8_t)configuration->GetType());
+    ESP_RETURN_ON_ERROR(httpd_resp_send_chunk(request, chunk.data(), chunk.size()), TAG, "response send failed");
+    separator = ",";
+  }
+
+  chunk = "],\"servers\":[";
+  ESP_RETURN_ON_ERROR(httpd_resp_send_chunk(request, chunk.data(), chunk.size()), TAG, "response send failed");
+
+  separator = "";
+  for (auto& configuration : blackBox.GetServerConfigurations()) {
+    chunk = separator + GetConfigurationJson(*configuration, configuration->GetServer()->GetName(), (uint8_t)configuration->GetType());
+    ESP_RETURN_ON_ERROR(httpd_resp_send_chunk(request, chunk.data(), chunk.size()), TAG, "response send failed");
+    separator = ",";
+  }
+
+  chunk = "]}";
+  ESP_RETURN_ON_ERROR(httpd_resp_send_chunk(request, chunk.data(), chunk.size()), TAG, "response send failed");
+  return httpd_resp_send_chunk(request, NULL, 0);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::HandlePatchRequest(httpd_req_t* request) {
+  BlackBoxHttpServer& server = *(BlackBoxHttpServer*)request->user_ctx;
+  BlackBox& blackBox = *server.blackBox;
+
+  if (request->content_len > maxRequestBodySize)
+    return SendJson(request, "413 Payload Too Large", "{}");
+
+  std::string body(request->content_len, 0);
+  for (size_t offset = 0; offset < body.size();) {
+    int readSize = httpd_req_recv(request, body.data() + offset, body.size() - offset);
+    if (readSize == HTTPD_SOCK_ERR_TIMEOUT)
+      continue;
+    if (readSize <= 0)
+      return ESP_FAIL;
+    offset += readSize;
+  }
+
+  BlackBoxJsonConfigurationStorage parameters;
+  if (parameters.SetJson(body) != ESP_OK)
+    return httpd_resp_send_err(request, HTTPD_400_BAD_REQUEST, "invalid JSON object");
+
+  std::string uri(request->uri);
+  uri = uri.substr(0, uri.find('?'));
+
+  if (uri == uriPrefix + "/device") {
+    std::string stringValue;
+    uint8_t u8Value;
+
+    if (parameters.Read(BlackBox::generalConfigurationDeviceNameNvsKey, stringValue) == ESP_OK)
+      blackBox.SetDeviceName(stringValue);
+    if (parameters.Read("clearRestartedFlag", u8Value) == ESP_OK && u8Value)
+      blackBox.ClearRestartedFlag();
+    if (parameters.Read("clearResetInfo", u8Value) == ESP_OK && u8Value)
+      blackBox.ClearResetInfo();
+    if (parameters.Read("saveConfiguration", u8Value) == ESP_OK && u8Value)
+      blackBox.SaveAllConfigurations();
+
+    esp_err_t error = SendJson(request, "200 OK", server.GetDeviceJson());
+    // The device restarts after the response is sent
+    if (parameters.Read("restart", u8Value) == ESP_OK && u8Value)
+      blackBox.Restart();
+    return error;
+  }
+
+  static const std::string hardwareInterfacesUriPrefix = uriPrefix + "/hardwareInterfaces/";
+  static const std::string serversUriPrefix = uriPrefix + "/servers/";
+  bool isHardwareInterfaceUri = !uri.compare(0, hardwareInterfacesUriPrefix.size(), hardwareInterfacesUriPrefix);
+  bool isServerUri = !uri.compare(0, serversUriPrefix.size(), serversUriPrefix);
+  if (!isHardwareInterfaceUri && !isServerUri)
+    return httpd_resp_send_err(request, HTTPD_404_NOT_FOUND, "unknown URI");
+
+  std::string indexString = uri.substr(isHardwareInterfaceUri ? hardwareInterfacesUriPrefix.size() : serversUriPrefix.size());
+  char* indexEnd;
+  size_t index = strtoul(indexString.c_str(), &indexEnd, 10);
+  if (indexString.empty() || *indexEnd)
+    return httpd_resp_send_err(request, HTTPD_404_NOT_FOUND, "unknown URI");
+
+  if (isHardwareInterfaceUri) {
+    auto configuration = blackBox.GetHardwareInterfaceConfiguration(index);
+    if (!configuration)
+      return httpd_resp_send_err(request, HTTPD_404_NOT_FOUND, "hardware interface not found");
+    return PatchConfiguration(request, configuration.get(), parameters, configuration->GetHardwareInterface()->GetName(), (uint8_t)configuration->GetType());
+  }
+
+  auto configuration = blackBox.GetServerConfiguration(index);
+  if (!configuration)
+    return httpd_resp_send_err(request, HTTPD_404_NOT_FOUND, "server not found");
+  return PatchConfiguration(request, configuration.get(), parameters, configuration->GetServer()->GetName(), (uint8_t)configuration->GetType());
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::HandleEventRequest(httpd_req_t* request) {
+  BlackBoxHttpServer& server = *(BlackBoxHttpServer*)request->user_ctx;
+  LockGuard lg(server.eventClientMutex);
+  if (server.eventClients.size() >= maxNumberOfEventClients) {
+    httpd_resp_set_status(request, "503 Service Unavailable");
+    return httpd_resp_send(request, NULL, 0);
+  }
+
+  // The event stream is sent by a separate task, so the HTTP server task is free to handle other requests
+  auto client = std::make_shared<EventClient>();
+  client->server = &server;
+  ESP_RETURN_ON_ERROR(httpd_req_async_handler_begin(request, &client->request), TAG, "async request start failed");
+  client->socket = httpd_req_to_sockfd(client->request);
+  BaseType_t result = xTaskCreate(EventTask, "pl_bb_http_events", eventTaskStackDepth, client.get(), tskIDLE_PRIORITY + 1, &client->task);
+  if (result != pdPASS)
+    httpd_req_async_handler_complete(client->request);
+  ESP_RETURN_ON_FALSE(result == pdPASS, ESP_FAIL, TAG, "event task create failed");
+  server.eventClients.push_back(client);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::HandleTraceRequest(httpd_req_t* request) {
+  BlackBoxHttpServer& server = *(BlackBoxHttpServer*)request->user_ctx;
+  auto traceRecorder = server.blackBox->GetTraceRecorder();
+  if (!traceRecorder)
+    return httpd_resp_send_err(request, HTTPD_404_NOT_FOUND, "trace recorder not found");
+
+  std::vector<uint8_t> dump = traceRecorder->GetDump();
+  httpd_resp_set_type(request, "application/octet-stream");
+  httpd_resp_set_hdr(request, "Content-Disposition", "attachment; filename=\"blackbox.trace\"");
+  httpd_resp_set_hdr(request, "Cache-Control", "no-cache");
+  return httpd_resp_send(request, (const char*)dump.data(), dump.size());
+}
+
+//==============================================================================
+
+void BlackBoxHttpServer::EventTask(void* parameters) {
+  EventClient& client = *(EventClient*)parameters;
+  BlackBoxHttpServer& server = *client.server;
+
+  httpd_resp_set_type(client.request, "text/event-stream");
+  httpd_resp_set_hdr(client.request, "Cache-Control", "no-cache");
+  server.SendEvents(client);
+  httpd_req_async_handler_complete(client.request);
+
+  {
+    LockGuard lg(server.eventClientMutex);
+    auto& eventClients = server.eventClients;
+    eventClients.erase(std::remove_if(eventClients.begin(), eventClients.end(),
+      [&](const std::shared_ptr<EventClient>& eventClient) { return eventClient.get() == &client; }), eventClients.end());
+  }
+  vTaskDelete(NULL);
+}
+
+//==============================================================================
+
+void BlackBoxHttpServer::SendEvents(EventClient& client) {
+  std::vector<uint8_t> status;
+  bool statusSent = false;
+  std::string data = ": open\n\n";
+  TickType_t lastSendTime = 0;
+
+  while (true) {
+    std::vector<uint8_t> newStatus = GetHardwareInterfaceStatus();
+    // Status changes of the added and removed hardware interfaces are covered by the resync event
+    if (!statusSent || newStatus.size() == status.size()) {
+      for (size_t i = 0; i < newStatus.size(); i++) {
+        if (!statusSent || status[i] != newStatus[i]) {
+          data += "event: status\ndata: {\"index\":" + std::to_string(i) + ",\"enabled\":" + std::to_string(newStatus[i] & 1) +
+            ",\"connected\":" + std::to_string(newStatus[i] >> 1) + "}\n\n";
+        }
+      }
+    }
+    status.swap(newStatus);
+    statusSent = true;
+
+    if (data.empty() && xTaskGetTickCount() - lastSendTime >= keepAliveInterval)
+      data = ": keep-alive\n\n";
+    if (!data.empty()) {
+      if (httpd_resp_send_chunk(client.request, data.data(), data.size()) != ESP_OK)
+        return;
+      lastSendTime = xTaskGetTickCount();
+      data.clear();
+    }
+
+    ulTaskNotifyTake(pdTRUE, statusPollInterval);
+
+    std::vector<std::pair<BlackBoxChangeType, std::shared_ptr<BlackBoxConfiguration>>> events;
+    bool resync;
+    {
+      LockGuard lg(client.mutex);
+      if (client.stop)
+        return;
+      events.swap(client.events);
+      resync = client.resync;
+      client.resync = false;
+    }
+
+    if (resync)
+      data = "event: resync\ndata: {}\n\n";
+    else {
+      for (auto& event : events) {
+        std::string eventName;
+        std::string eventJson = GetEventJson(event.first, event.second, eventName);
+        if (!eventName.empty())
+          data += "event: " + eventName + "\ndata: " + eventJson + "\n\n";
+      }
+    }
+  }
+}
+
+//==============================================================================
+
+std::string BlackBoxHttpServer::GetEventJson(BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration, std::string& eventName) {
+  switch (type) {
+    case BlackBoxChangeType::device:
+      eventName = "device";
+      return GetDeviceJson();
+    case BlackBoxChangeType::configurationsSaved:
+      eventName = "saved";
+      return "{}";
+    case BlackBoxChangeType::configuration: {
+      // Changes of other configurations (and of the configurations that have been removed) are not sent
+      if (auto hardwareInterfaceConfiguration = dynamic_cast<BlackBoxHardwareInterfaceConfiguration*>(configuration.get())) {
+        size_t index = blackBox->GetHardwareInterfaceConfigurationIndex(*hardwareInterfaceConfiguration);
+        if (index == SIZE_MAX)
+          return std::string();
+        eventName = "hardwareInterface";
+        return "{\"index\":" + std::to_string(index) + ",\"configuration\":" + GetConfigurationJson(*configuration,
+          hardwareInterfaceConfiguration->GetHardwareInterface()->GetName(), (uint8_t)hardwareInterfaceConfiguration->GetType()) + '}';
+      }
+      if (auto serverConfiguration = dynamic_cast<BlackBoxServerConfiguration*>(configuration.get())) {
+        size_t index = blackBox->GetServerConfigurationIndex(*serverConfiguration);
+        if (index == SIZE_MAX)
+          return std::string();
+        eventName = "server";
+        return "{\"index\":" + std::to_string(index) + ",\"configuration\":" + GetConfigurationJson(*configuration,
+          serverConfiguration->GetServer()->GetName(), (uint8_t)serverConfiguration->GetType()) + '}';
+      }
+      return std::string();
+    }
+    default:
+      return std::string();
+  }
+}
+
+//==============================================================================
+
+std::vector<uint8_t> BlackBoxHttpServer::GetHardwareInterfaceStatus() {
+  std::vector<uint8_t> status;
+  for (auto& configuration : blackBox->GetHardwareInterfaceConfigurations()) {
+    auto hardwareInterface = configuration->GetHardwareInterface();
+    auto networkInterface = dynamic_cast<NetworkInterface*>(hardwareInterface.get());
+    status.push_back(hardwareInterface->IsEnabled() | ((networkInterface && networkInterface->IsConnected()) << 1));
+  }
+  return status;
+}
+
+//==============================================================================
+
+void BlackBoxHttpServer::OnChange(BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration) {
+  LockGuard lg(eventClientMutex);
+  for (auto& client : eventClients) {
+    {
+      LockGuard lgClient(client->mutex);
+      if (client->resync)
+        continue;
+      auto& events = client->events;
+      // Queued events are sent with the current values, so repeated changes are merged
+      bool queued = std::find(events.begin(), events.end(), std::make_pair(type, configuration)) != events.end();
+      if (type == BlackBoxChangeType::configurationList || (!queued && events.size() >= maxNumberOfQueuedEvents)) {
+        events.clear();
+        client->resync = true;
+      }
+      else if (!queued)
+        events.push_back({type, configuration});
+    }
+    xTaskNotifyGive(client->task);
+  }
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::StopEventClients() {
+  TickType_t startTime = xTaskGetTickCount();
+  while (true) {
+    {
+      LockGuard lg(eventClientMutex);
+      // Event tasks remove their clients before they finish. Clients that have connected during the wait are stopped too.
+      if (eventClients.empty())
+        return ESP_OK;
+      for (auto& client : eventClients) {
+        {
+          LockGuard lgClient(client->mutex);
+          client->stop = true;
+        }
+        xTaskNotifyGive(client->task);
+      }
+    }
+    // An event task can be blocked by a slow client send or by a lock held by the disabling task
+    ESP_RETURN_ON_FALSE(xTaskGetTickCount() - startTime < eventClientStopTimeout, ESP_ERR_TIMEOUT, TAG, "event clients have not stopped");
+    vTaskDelay(1);
+  }
+}
+
+//==============================================================================
+
+void BlackBoxHttpServer::ShutdownEventClientSockets() {
+  LockGuard lg(eventClientMutex);
+  // The blocked sends fail, so the event tasks finish and complete their requests
+  for (auto& client : eventClients)
+    shutdown(client->socket, SHUT_RDWR);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::PatchConfiguration(httpd_req_t* request, BlackBoxConfiguration* configuration, BlackBoxJsonConfigurationStorage& parameters,
+    const std::string& name, uint8_t type) {
+  configuration->LoadParameters(parameters);
+
+  // Parameters with invalid values keep their previous values
+  BlackBoxJsonConfigurationStorage resultingParameters;
+  configuration->SaveParameters(resultingParameters);
+  const char* status = parameters.IsSubsetOf(resultingParameters) ? "200 OK" : "422 Unprocessable Entity";
+  return SendJson(request, status, GetConfigurationJson(*configuration, name, type));
+}
+
+//==============================================================================
+
+std::string BlackBoxHttpServer::GetConfigurationJson(BlackBoxConfiguration& configuration, const std::string& name, uint8_t type) {
+  BlackBoxJsonConfigurationStorage parameters;
+  configuration.SaveReadableParameters(parameters);
+  return "{\"name\":" + BlackBoxJsonConfigurationStorage::EncodeString(name) + ",\"type\":" + std::to_string(type) +
+    ",\"nvsNamespaceName\":" + BlackBoxJsonConfigurationStorage::EncodeString(configuration.GetNvsNamespaceName()) + ",\"parameters\":" + parameters.GetJson() + '}';
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxHttpServer::SendJson(httpd_req_t* request, const char* status, const std::string& json) {
+  httpd_resp_set_status(request, status);
+  httpd_resp_set_type(request, "application/json");
+  return httpd_resp_send(request, json.data(), json.size());
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,226 @@
+#include "pl_blackbox_link_monitor.h"
+#include "pl_blackbox_clock.h"
+#include "pl_blackbox_trace.h"
+#include "esp_check.h"
+#include "soc/soc_caps.h"
+#if SOC_WIFI_SUPPORTED
+#include "esp_wifi.h"
+#endif
+#include "lwip/stats.h"
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_link_monitor";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+BlackBoxLinkMonitor::BlackBoxLinkMonitor(std::shared_ptr<BlackBox> blackBox) : blackBox(blackBox) {
+#if CONFIG_ETH_ENABLED
+  // The connected event is not generated again for the ESP Ethernet driver that is already connected
+  blackBox->ForEachHardwareInterfaceConfiguration([this](BlackBoxHardwareInterfaceConfiguration& configuration) {
+    if (auto espEthernet = dynamic_cast<EspEthernet*>(configuration.GetHardwareInterface().get())) {
+      if (!ethernetHandle)
+        ethernetHandle = espEthernet->GetHandle();
+    }
+  });
+  // Fails if the default event loop has not been created, in which case the Ethernet information is not available
+  if (esp_event_handler_instance_register(ETH_EVENT, ESP_EVENT_ANY_ID, EthernetEventHandler, this, &ethernetEventHandlerInstance) != ESP_OK)
+    ethernetEventHandlerInstance = NULL;
+#endif
+}
+
+//==============================================================================
+
+BlackBoxLinkMonitor::~BlackBoxLinkMonitor() {
+  DisablePeriodicSampling();
+  if (samplingTimer)
+    esp_timer_delete(samplingTimer);
+#if CONFIG_ETH_ENABLED
+  if (ethernetEventHandlerInstance)
+    esp_event_handler_instance_unregister(ETH_EVENT, ESP_EVENT_ANY_ID, ethernetEventHandlerInstance);
+#endif
+  LockGuard lg(linkStateMutex);
+  for (auto& linkState : linkStates) {
+    linkState.second.networkInterface->connectedEvent.RemoveHandler(linkState.second.eventHandlerObject);
+    linkState.second.networkInterface->disconnectedEvent.RemoveHandler(linkState.second.eventHandlerObject);
+  }
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxLinkMonitor::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxLinkMonitor::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxLinkMonitor::EnablePeriodicSampling(uint64_t samplingInterval) {
+  LockGuard lg(*this);
+  if (!samplingTimer) {
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = SamplingTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "pl_bb_link";
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timerArgs, &samplingTimer), TAG, "sampling timer create failed");
+  }
+  esp_timer_stop(samplingTimer);
+  ESP_RETURN_ON_ERROR(esp_timer_start_periodic(samplingTimer, samplingInterval), TAG, "sampling timer start failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxLinkMonitor::DisablePeriodicSampling() {
+  LockGuard lg(*this);
+  if (samplingTimer)
+    esp_timer_stop(samplingTimer);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxLinkMonitor::Sample() {
+  LockGuard lg(*this);
+
+  std::vector<std::pair<std::shared_ptr<NetworkInterface>, uint16_t>> networkInterfaces;
+  uint16_t index = 0;
+  blackBox->ForEachHardwareInterfaceConfiguration([&](BlackBoxHardwareInterfaceConfiguration& configuration) {
+    if (auto networkInterface = std::dynamic_pointer_cast<NetworkInterface>(configuration.GetHardwareInterface()))
+      networkInterfaces.push_back({networkInterface, index});
+    index++;
+  });
+
+#if CONFIG_ETH_ENABLED
+  esp_eth_handle_t ethernetHandle;
+  {
+    LockGuard lg(linkStateMutex);
+    ethernetHandle = this->ethernetHandle;
+  }
+#endif
+
+  for (auto& [networkInterface, hardwareInterfaceIndex] : networkInterfaces) {
+    BlackBoxLinkQuality sampledLinkQuality = {};
+    bool connected = networkInterface->IsConnected();
+
+#if SOC_WIFI_SUPPORTED
+    if (connected && dynamic_cast<WiFiStation*>(networkInterface.get())) {
+      wifi_ap_record_t apInfo;
+      if (esp_wifi_sta_get_ap_info(&apInfo) == ESP_OK) {
+        sampledLinkQuality.wifiRssi = apInfo.rssi;
+        sampledLinkQuality.wifiChannel = apInfo.primary;
+      }
+      wifi_phy_mode_t phyMode;
+      if (esp_wifi_sta_get_negotiated_phymode(&phyMode) == ESP_OK)
+        sampledLinkQuality.wifiPhyMode = phyMode;
+    }
+#endif
+
+#if CONFIG_ETH_ENABLED
+    if (connected && ethernetHandle && dynamic_cast<Ethernet*>(networkInterface.get())) {
+      eth_speed_t speed;
+      if (esp_eth_ioctl(ethernetHandle, ETH_CMD_G_SPEED, &speed) == ESP_OK)
+        sampledLinkQuality.ethernetSpeed = (speed == ETH_SPEED_10M) ? 10 : ((speed == ETH_SPEED_100M) ? 100 : 1000);
+      eth_duplex_t duplex;
+      if (esp_eth_ioctl(ethernetHandle, ETH_CMD_G_DUPLEX_MODE, &duplex) == ESP_OK)
+        sampledLinkQuality.ethernetFullDuplex = (duplex == ETH_DUPLEX_FULL);
+    }
+#endif
+
+#if LWIP_STATS && LINK_STATS
+    sampledLinkQuality.linkErrorCounter = lwip_stats.link.err;
+    sampledLinkQuality.linkDropCounter = lwip_stats.link.drop;
+#endif
+
+    LockGuard lg(linkStateMutex);
+    auto linkStateIterator = linkStates.find(networkInterface.get());
+    if (linkStateIterator == linkStates.end()) {
+      LinkState& linkState = linkStates[networkInterface.get()];
+      linkState.networkInterface = networkInterface;
+      linkState.eventHandlerObject = std::make_shared<LinkState*>(&linkState);
+      networkInterface->connectedEvent.AddHandler(linkState.eventHandlerObject, [this](NetworkInterface& networkInterface) { OnConnected(networkInterface); });
+      networkInterface->disconnectedEvent.AddHandler(linkState.eventHandlerObject, [this](NetworkInterface& networkInterface) { OnDisconnected(networkInterface); });
+      linkStateIterator = linkStates.find(networkInterface.get());
+    }
+    linkStateIterator->second.hardwareInterfaceIndex = hardwareInterfaceIndex;
+    BlackBoxLinkQuality& linkQuality = linkStateIterator->second.linkQuality;
+    sampledLinkQuality.reconnectCounter = linkQuality.reconnectCounter;
+    linkQuality = sampledLinkQuality;
+  }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxLinkMonitor::GetLinkQuality(NetworkInterface& networkInterface, BlackBoxLinkQuality& linkQuality) {
+  LockGuard lg(linkStateMutex);
+  auto linkStateIterator = linkStates.find(&networkInterface);
+  if (linkStateIterator == linkStates.end())
+    return ESP_ERR_NOT_FOUND;
+  linkQuality = linkStateIterator->second.linkQuality;
+  int64_t disconnectTime = linkStateIterator->second.disconnectTime;
+  linkQuality.timeSinceDisconnect = disconnectTime ? (BlackBoxClock::GetMonotonicTime() - disconnectTime) / 1000000 : 0xFFFFFFFF;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+void BlackBoxLinkMonitor::OnConnected(NetworkInterface& networkInterface) {
+  LockGuard lg(linkStateMutex);
+  auto linkStateIterator = linkStates.find(&networkInterface);
+  if (linkStateIterator == linkStates.end())
+    return;
+  PL_BLACKBOX_TRACE(interfaceConnected, linkStateIterator->second.hardwareInterfaceIndex);
+  if (linkStateIterator->second.disconnectTime)
+    linkStateIterator->second.linkQuality.reconnectCounter++;
+}
+
+//==============================================================================
+
+void BlackBoxLinkMonitor::OnDisconnected(NetworkInterface& networkInterface) {
+  LockGuard lg(linkStateMutex);
+  auto linkStateIterator = linkStates.find(&networkInterface);
+  if (linkStateIterator == linkStates.end())
+    return;
+  PL_BLACKBOX_TRACE(interfaceDisconnected, linkStateIterator->second.hardwareInterfaceIndex);
+  linkStateIterator->second.disconnectTime = BlackBoxClock::GetMonotonicTime();
+}
+
+//==============================================================================
+
+void BlackBoxLinkMonitor::SamplingTimerCallback(void* arg) {
+  ((BlackBoxLinkMonitor*)arg)->Sample();
+}
+
+//==============================================================================
+
+#if CONFIG_ETH_ENABLED
+void BlackBoxLinkMonitor::EthernetEventHandler(void* arg, esp_event_base_t eventBase, int32_t eventId, void* eventData) {
+  if (eventId != ETHERNET_EVENT_CONNECTED)
+    return;
+  BlackBoxLinkMonitor& linkMonitor = *(BlackBoxLinkMonitor*)arg;
+  LockGuard lg(linkMonitor.linkStateMutex);
+  linkMonitor.ethernetHandle = *(esp_eth_handle_t*)eventData;
+}
+#endif
+
+//==============================================================================
+
+}
\ No newline at end of file
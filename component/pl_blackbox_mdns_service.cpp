@@ -0,0 +1,213 @@
+#include "pl_blackbox_mdns_service.h"
+#include "pl_blackbox_http_server.h"
+#include "pl_blackbox_trace.h"
+#include "esp_check.h"
+#include "mdns.h"
+#include <algorithm>
+#include <cinttypes>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_mdns_service";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+const std::string BlackBoxMdnsService::serviceType = "_plbb";
+const std::string BlackBoxMdnsService::serviceProtocol = "_tcp";
+
+//==============================================================================
+
+/// @brief Services that have not been destroyed (the update timer callback can be dispatched before the service destruction)
+struct BlackBoxMdnsLiveServices {
+  Mutex mutex;
+  std::vector<BlackBoxMdnsService*> services;
+};
+
+//==============================================================================
+
+static BlackBoxMdnsLiveServices& GetLiveServices() {
+  // Created on the first use, so services can be created during the static initialization
+  static BlackBoxMdnsLiveServices liveServices;
+  return liveServices;
+}
+
+//==============================================================================
+
+BlackBoxMdnsService::BlackBoxMdnsService(std::shared_ptr<BlackBox> blackBox) : Server("blackbox_mdns"), blackBox(blackBox) {
+  auto& liveServices = GetLiveServices();
+  LockGuard lg(liveServices.mutex);
+  liveServices.services.push_back(this);
+}
+
+//==============================================================================
+
+BlackBoxMdnsService::~BlackBoxMdnsService() {
+  Disable();
+  {
+    // The update timer callback that has already been dispatched runs under the live service mutex,
+    // so it either finishes before the service is removed or does not find the service
+    auto& liveServices = GetLiveServices();
+    LockGuard lg(liveServices.mutex);
+    liveServices.services.erase(std::remove(liveServices.services.begin(), liveServices.services.end(), this), liveServices.services.end());
+  }
+  if (updateTimer)
+    esp_timer_delete(updateTimer);
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxMdnsService::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxMdnsService::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxMdnsService::Enable() {
+  LockGuard lg(*this);
+  if (enabled)
+    return ESP_OK;
+
+  if (!updateTimer) {
+    esp_timer_create_args_t timerArgs = {};
+    timerArgs.callback = UpdateTimerCallback;
+    timerArgs.arg = this;
+    timerArgs.dispatch_method = ESP_TIMER_TASK;
+    timerArgs.name = "pl_bb_mdns";
+    ESP_RETURN_ON_ERROR(esp_timer_create(&timerArgs, &updateTimer), TAG, "update timer create failed");
+  }
+
+  enabled = true;
+  esp_err_t error = Update();
+  if (error != ESP_OK) {
+    enabled = false;
+    ESP_RETURN_ON_ERROR(error, TAG, "service add failed");
+  }
+
+  // The observer only starts the timer, so it does not block the change
+  changeObserverId = blackBox->AddChangeObserver([this](BlackBoxChangeType type, std::shared_ptr<BlackBoxConfiguration> configuration) {
+    esp_timer_start_once(updateTimer, updateDelay);
+  });
+  enabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxMdnsService::Disable() {
+  LockGuard lg(*this);
+  if (!enabled)
+    return ESP_OK;
+
+  blackBox->RemoveChangeObserver(changeObserverId);
+  esp_timer_stop(updateTimer);
+  enabled = false;
+  // The service does not exist if the mDNS server has been disabled
+  mdns_service_remove(serviceType.c_str(), serviceProtocol.c_str());
+  disabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool BlackBoxMdnsService::IsEnabled() {
+  LockGuard lg(*this);
+  return enabled;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxMdnsService::Update() {
+  LockGuard lg(*this);
+  if (!enabled) {
+    PL_BLACKBOX_TRACE(mdnsUpdate, 0);
+    return ESP_OK;
+  }
+
+  uint16_t port = 0;
+  auto txtRecords = GetTxtRecords(port);
+  std::vector<mdns_txt_item_t> txtItems;
+  for (auto& txtRecord : txtRecords)
+    txtItems.push_back({txtRecord.first.c_str(), txtRecord.second.c_str()});
+
+  // The service is added again if the mDNS server has been restarted
+  if (!mdns_service_exists(serviceType.c_str(), serviceProtocol.c_str(), NULL)) {
+    ESP_RETURN_ON_ERROR(mdns_service_add(NULL, serviceType.c_str(), serviceProtocol.c_str(), port, txtItems.data(), txtItems.size()), TAG, "service add failed");
+  }
+  else {
+    ESP_RETURN_ON_ERROR(mdns_service_port_set(serviceType.c_str(), serviceProtocol.c_str(), port), TAG, "service port set failed");
+    ESP_RETURN_ON_ERROR(mdns_service_txt_set(serviceType.c_str(), serviceProtocol.c_str(), txtItems.data(), txtItems.size()), TAG, "service TXT set failed");
+  }
+  PL_BLACKBOX_TRACE(mdnsUpdate, 1);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+std::vector<std::pair<std::string, std::string>> BlackBoxMdnsService::GetTxtRecords(uint16_t& port) {
+  auto getVersionString = [](const SemanticVersion& version) {
+    return std::to_string(version.major) + '.' + std::to_string(version.minor) + '.' + std::to_string(version.patch);
+  };
+
+  BlackBoxHardwareInfo hardwareInfo = blackBox->GetHardwareInfo();
+  BlackBoxFirmwareInfo firmwareInfo = blackBox->GetFirmwareInfo();
+  std::vector<std::pair<std::string, std::string>> txtRecords = {
+    {"hw", hardwareInfo.name}, {"hwv", getVersionString(hardwareInfo.version)}, {"uid", hardwareInfo.uid},
+    {"fw", firmwareInfo.name}, {"fwv", getVersionString(firmwareInfo.version)}, {"dev", blackBox->GetDeviceName()}
+  };
+
+  uint16_t modbusPort = 0, httpPort = 0;
+  blackBox->ForEachServerConfiguration([&](BlackBoxServerConfiguration& configuration) {
+    if (!configuration.enabled.GetValue())
+      return;
+    // Modbus servers with a stream have zero port
+    if (auto modbusServerConfiguration = dynamic_cast<BlackBoxModbusServerConfiguration*>(&configuration)) {
+      if (!modbusPort)
+        modbusPort = modbusServerConfiguration->port.GetValue();
+    }
+    else if (auto httpServer = dynamic_cast<BlackBoxHttpServer*>(configuration.GetServer().get())) {
+      if (!httpPort)
+        httpPort = httpServer->GetPort();
+    }
+  });
+  if (modbusPort)
+    txtRecords.push_back({"modbus", std::to_string(modbusPort)});
+  if (httpPort)
+    txtRecords.push_back({"http", std::to_string(httpPort)});
+  port = modbusPort ? modbusPort : httpPort;
+
+  char generation[17];
+  snprintf(generation, sizeof(generation), "%016" PRIx64, blackBox->GetConfigurationGeneration());
+  txtRecords.push_back({"gen", generation});
+  return txtRecords;
+}
+
+//==============================================================================
+
+void BlackBoxMdnsService::UpdateTimerCallback(void* arg) {
+  auto& liveServices = GetLiveServices();
+  LockGuard lg(liveServices.mutex);
+  // Update does nothing if the service has been disabled after the callback dispatch
+  if (std::find(liveServices.services.begin(), liveServices.services.end(), (BlackBoxMdnsService*)arg) != liveServices.services.end())
+    ((BlackBoxMdnsService*)arg)->Update();
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "pl_blackbox_modbus_server.h"
+#include "pl_blackbox_link_monitor.h"
+#include "pl_blackbox_trace.h"
 #include "esp_check.h"
+#include "esp_heap_caps.h"
 
 //==============================================================================
 
@@ -39,6 +42,25 @@ BlackBoxModbusServer::BlackBoxModbusServer(std::shared_ptr<BlackBox> blackBox, u
 
 //==============================================================================
 
+bool BlackBoxModbusServer::CheckMemoryMapBits() {
+  #define PL_BLACKBOX_MODBUS_CHECK_FIELD(area, field, offset, size, type)
+  #define PL_BLACKBOX_MODBUS_CHECK_BITS(area, field, offset, bit) { \
+    MemoryData memoryData = {}; \
+    memoryData.area.field = 1; \
+    MemoryData expectedMemoryData = {}; \
+    uint16_t expectedRegister = 1 << bit; \
+    memcpy(expectedMemoryData.dummy + offsetof(MemoryData, area) + offset, &expectedRegister, sizeof(expectedRegister)); \
+    if (memcmp(memoryData.dummy, expectedMemoryData.dummy, sizeof(memoryData.dummy))) \
+      return false; \
+  }
+  PL_BLACKBOX_MODBUS_MEMORY_MAP(PL_BLACKBOX_MODBUS_CHECK_FIELD, PL_BLACKBOX_MODBUS_CHECK_BITS)
+  #undef PL_BLACKBOX_MODBUS_CHECK_FIELD
+  #undef PL_BLACKBOX_MODBUS_CHECK_BITS
+  return true;
+}
+
+//==============================================================================
+
 void BlackBoxModbusServer::AddMemoryAreas() {
   memoryDataBuffer = std::make_shared<PL::TypedBuffer<MemoryData>>(&memoryData);
 
@@ -53,6 +75,15 @@ void BlackBoxModbusServer::AddMemoryAreas() {
   AddMemoryArea(std::make_shared<ServerConfigurationHR>(*this, PL::ModbusMemoryType::holdingRegisters, registerMemoryAreaSize));
   AddMemoryArea(std::make_shared<ServerConfigurationHR>(*this, PL::ModbusMemoryType::coils, coilMemoryAreaSize));
   AddMemoryArea(std::make_shared<ServerConfigurationIR>(*this));
+
+  AddMemoryArea(std::make_shared<EventLogHR>(*this));
+  AddMemoryArea(std::make_shared<EventLogIR>(*this));
+
+  AddMemoryArea(std::make_shared<HealthIR>(*this));
+
+  AddMemoryArea(std::make_shared<FirmwareUpdateHR>(*this));
+  AddMemoryArea(std::make_shared<FirmwareUpdateIR>(*this));
+  AddMemoryArea(std::make_shared<FirmwareImageHR>(*this));
 }
 
 //==============================================================================
@@ -64,13 +95,14 @@ BlackBoxModbusServer::GeneralConfigurationHR::GeneralConfigurationHR(BlackBoxMod
 //==============================================================================
 
 esp_err_t BlackBoxModbusServer::GeneralConfigurationHR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
   BlackBox& blackBox = *modbusServer.blackBox;
   
   memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
   auto& hr = modbusServer.memoryDataBuffer->data->generalConfigurationHR;
 
   auto name = blackBox.GetDeviceName();
-  memcpy(hr.name, name.data(), std::min(maxNameSize, name.size()));
+  memcpy(hr.name, name.data(), std::min(maxNameSize - 1, name.size()));
   hr.selectedHardwareInterfaceIndex = modbusServer.selectedHardwareInterfaceIndex;
   hr.selectedServerIndex = modbusServer.selectedServerIndex;
   return ESP_OK;
@@ -89,14 +121,17 @@ esp_err_t BlackBoxModbusServer::GeneralConfigurationHR::OnWrite() {
     blackBox.SaveAllConfigurations();
   if (hr.clearRestartedFlag)
     blackBox.ClearRestartedFlag();
-  std::string name(hr.name, maxNameSize);
+  if (hr.clearResetInfo)
+    blackBox.ClearResetInfo();
+  std::string name(hr.name, maxNameSize - 1);
   blackBox.SetDeviceName(name.c_str());
-  size_t numberOfHardwareInterfaces = blackBox.GetHardwareInterfaceConfigurations().size();
+  size_t numberOfHardwareInterfaces = blackBox.GetNumberOfHardwareInterfaceConfigurations();
   if (numberOfHardwareInterfaces)
     modbusServer.selectedHardwareInterfaceIndex = std::min(hr.selectedHardwareInterfaceIndex, (uint16_t)(numberOfHardwareInterfaces - 1));
-  size_t numberOfServers = blackBox.GetServerConfigurations().size();
+  size_t numberOfServers = blackBox.GetNumberOfServerConfigurations();
   if (numberOfServers)
     modbusServer.selectedServerIndex = std::min(hr.selectedServerIndex, (uint16_t)(numberOfServers - 1));
+  PL_BLACKBOX_TRACE(modbusAreaWrite, (uint16_t)memoryType, address);
   return ESP_OK;
 }
 
@@ -109,6 +144,7 @@ BlackBoxModbusServer::GeneralConfigurationIR::GeneralConfigurationIR(BlackBoxMod
 //==============================================================================
 
 esp_err_t BlackBoxModbusServer::GeneralConfigurationIR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
   BlackBox& blackBox = *modbusServer.blackBox;
   
   memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
@@ -118,18 +154,30 @@ esp_err_t BlackBoxModbusServer::GeneralConfigurationIR::OnRead() {
   memcpy(ir.plbbSignature, plbbSignature.data(), sizeof(ir.plbbSignature));
   ir.memoryMapVersion = memoryMapVersion;
   auto hardwareInfo = blackBox.GetHardwareInfo();
-  memcpy(ir.hardwareInfo.name, hardwareInfo.name.data(), std::min(maxNameSize, hardwareInfo.name.size()));
+  memcpy(ir.hardwareInfo.name, hardwareInfo.name.data(), std::min(maxNameSize - 1, hardwareInfo.name.size()));
   ir.hardwareInfo.version.major = hardwareInfo.version.major;
   ir.hardwareInfo.version.minor = hardwareInfo.version.minor;
   ir.hardwareInfo.version.patch = hardwareInfo.version.patch;
-  memcpy(ir.hardwareInfo.uid, hardwareInfo.uid.data(), std::min(maxNameSize, hardwareInfo.uid.size()));
+  memcpy(ir.hardwareInfo.uid, hardwareInfo.uid.data(), std::min(maxNameSize - 1, hardwareInfo.uid.size()));
   auto firmwareInfo = blackBox.GetFirmwareInfo();
-  memcpy(ir.firmwareInfo.name, firmwareInfo.name.data(), std::min(maxNameSize, firmwareInfo.name.size()));
+  memcpy(ir.firmwareInfo.name, firmwareInfo.name.data(), std::min(maxNameSize - 1, firmwareInfo.name.size()));
   ir.firmwareInfo.version.major = firmwareInfo.version.major;
   ir.firmwareInfo.version.minor = firmwareInfo.version.minor;
   ir.firmwareInfo.version.patch = firmwareInfo.version.patch;
-  ir.numberOfHardwareInterfaces = blackBox.GetHardwareInterfaceConfigurations().size();
-  ir.numberOfServers = blackBox.GetServerConfigurations().size();
+  ir.numberOfHardwareInterfaces = blackBox.GetNumberOfHardwareInterfaceConfigurations();
+  ir.numberOfServers = blackBox.GetNumberOfServerConfigurations();
+  ir.uptime = BlackBoxClock::GetMonotonicTime() / 1000000;
+  ir.minFreeHeapSize = heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+  auto resetInfo = blackBox.GetResetInfo();
+  ir.resetInfo.reason = resetInfo.reason;
+  ir.resetInfo.resetCounter = resetInfo.resetCounter;
+  ir.resetInfo.abnormalResetCounter = resetInfo.abnormalResetCounter;
+  ir.resetInfo.lastAbnormalResetReason = resetInfo.lastAbnormalResetReason;
+  ir.resetInfo.panicPc = resetInfo.panicPc;
+  memcpy(ir.resetInfo.panicBacktrace, resetInfo.panicBacktrace, sizeof(ir.resetInfo.panicBacktrace));
+  memcpy(ir.resetInfo.panicTaskName, resetInfo.panicTaskName, sizeof(ir.resetInfo.panicTaskName));
+  ir.utcTime = BlackBoxClock::GetUtcTime() / 1000000;
+  ir.timeSinceSynchronization = BlackBoxClock::IsSynchronized() ? (BlackBoxClock::GetMonotonicTime() - BlackBoxClock::GetLastSynchronizationTime()) / 1000000 : 0xFFFFFFFF;
   return ESP_OK;
 }
 //==============================================================================
@@ -141,17 +189,16 @@ BlackBoxModbusServer::HardwareInterfaceConfigurationHR::HardwareInterfaceConfigu
 //==============================================================================
 
 esp_err_t BlackBoxModbusServer::HardwareInterfaceConfigurationHR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
   BlackBox& blackBox = *modbusServer.blackBox;
   
   memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
   auto& hr = modbusServer.memoryDataBuffer->data->hardwareInterfaceConfigurationHR;
 
-  size_t numberOfHardwareInterfaces = blackBox.GetHardwareInterfaceConfigurations().size();
-  if (!numberOfHardwareInterfaces || modbusServer.selectedHardwareInterfaceIndex >= numberOfHardwareInterfaces)
+  auto hardwareInterfaceConfiguration = blackBox.GetHardwareInterfaceConfiguration(modbusServer.selectedHardwareInterfaceIndex);
+  if (!hardwareInterfaceConfiguration)
     return ESP_OK;
 
-  auto hardwareInterfaceConfiguration = blackBox.GetHardwareInterfaceConfigurations()[modbusServer.selectedHardwareInterfaceIndex];
-
   hr.common.enabled = hardwareInterfaceConfiguration->enabled.GetValue();
 
   if (auto uartConfiguration = dynamic_cast<PL::BlackBoxUartConfiguration*>(hardwareInterfaceConfiguration.get())) {
@@ -186,7 +233,7 @@ esp_err_t BlackBoxModbusServer::HardwareInterfaceConfigurationHR::OnRead() {
 
   if (auto wifiStationConfiguration = dynamic_cast<PL::BlackBoxWiFiStationConfiguration*>(hardwareInterfaceConfiguration.get())) {
     auto ssid = wifiStationConfiguration->ssid.GetValue();
-    memcpy(hr.wifi.ssid, ssid.data(), std::min(maxWiFiSsidSize, ssid.size()));
+    memcpy(hr.wifi.ssid, ssid.data(), std::min(maxWiFiSsidSize - 1, ssid.size()));
     memset(hr.wifi.password, 255, sizeof(hr.wifi.password));
   }
 
@@ -200,11 +247,11 @@ esp_err_t BlackBoxModbusServer::HardwareInterfaceConfigurationHR::OnWrite() {
 
   auto& hr = modbusServer.memoryDataBuffer->data->hardwareInterfaceConfigurationHR;
 
-  size_t numberOfHardwareInterfaces = blackBox.GetHardwareInterfaceConfigurations().size();
-  if (!numberOfHardwareInterfaces || modbusServer.selectedHardwareInterfaceIndex >= numberOfHardwareInterfaces)
+  auto hardwareInterfaceConfiguration = blackBox.GetHardwareInterfaceConfiguration(modbusServer.selectedHardwareInterfaceIndex);
+  if (!hardwareInterfaceConfiguration) {
+    PL_BLACKBOX_TRACE(modbusAreaWrite, (uint16_t)memoryType, address);
     return ESP_OK;
-
-  auto hardwareInterfaceConfiguration = blackBox.GetHardwareInterfaceConfigurations()[modbusServer.selectedHardwareInterfaceIndex];
+  }
 
   hardwareInterfaceConfiguration->enabled.SetValue(hr.common.enabled);
 
@@ -232,20 +279,21 @@ esp_err_t BlackBoxModbusServer::HardwareInterfaceConfigurationHR::OnWrite() {
   }
 
   if (auto wifiStationConfiguration = dynamic_cast<PL::BlackBoxWiFiStationConfiguration*>(hardwareInterfaceConfiguration.get())) {
-    std::string ssid(hr.wifi.ssid, maxWiFiSsidSize);
+    std::string ssid(hr.wifi.ssid, maxWiFiSsidSize - 1);
     wifiStationConfiguration->ssid.SetValue(ssid.c_str());
     bool passwordIsValid = true;
-    for (int i = 0; i < hr.wifi.password[i] && i < sizeof(hr.wifi.password); i++) {
+    for (size_t i = 0; i < maxWiFiPasswordSize - 1 && hr.wifi.password[i]; i++) {
       if (hr.wifi.password[i] < 32 || hr.wifi.password[i] > 126)
         passwordIsValid = false;
     }
 
     if (passwordIsValid) {
-      std::string password(hr.wifi.password, maxWiFiPasswordSize);
+      std::string password(hr.wifi.password, maxWiFiPasswordSize - 1);
       wifiStationConfiguration->password.SetValue(password.c_str());
     }
   }
 
+  PL_BLACKBOX_TRACE(modbusAreaWrite, (uint16_t)memoryType, address);
   return ESP_OK;
 }
 
@@ -258,39 +306,46 @@ BlackBoxModbusServer::HardwareInterfaceConfigurationIR::HardwareInterfaceConfigu
 //==============================================================================
 
 esp_err_t BlackBoxModbusServer::HardwareInterfaceConfigurationIR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
   BlackBox& blackBox = *modbusServer.blackBox;
   
   memset(modbusServer.memoryDataBuffer->data, 0, BlackBoxModbusServer::registerMemoryAreaSize);
   auto& ir = modbusServer.memoryDataBuffer->data->hardwareInterfaceConfigurationIR;
 
-  size_t numberOfHardwareInterfaces = blackBox.GetHardwareInterfaceConfigurations().size();
-  if (!numberOfHardwareInterfaces || modbusServer.selectedHardwareInterfaceIndex >= numberOfHardwareInterfaces)
+  auto hardwareInterfaceConfiguration = blackBox.GetHardwareInterfaceConfiguration(modbusServer.selectedHardwareInterfaceIndex);
+  if (!hardwareInterfaceConfiguration)
     return ESP_OK;
 
-  auto hardwareInterface = blackBox.GetHardwareInterfaceConfigurations()[modbusServer.selectedHardwareInterfaceIndex]->GetHardwareInterface();
+  auto hardwareInterface = hardwareInterfaceConfiguration->GetHardwareInterface();
 
   auto name = hardwareInterface->GetName();
-  memcpy(ir.common.name, name.data(), std::min(maxNameSize, name.size()));
+  memcpy(ir.common.name, name.data(), std::min(maxNameSize - 1, name.size()));
 
-  if (dynamic_cast<PL::Uart*>(hardwareInterface.get()))
-    ir.common.type = (uint16_t)BlackBoxHardwareInterfaceType::uart;
+  ir.common.type = (uint16_t)hardwareInterfaceConfiguration->GetType();
 
   if (auto networkInterface = dynamic_cast<PL::NetworkInterface*>(hardwareInterface.get())) {
-    ir.common.type = (uint16_t)BlackBoxHardwareInterfaceType::networkInterface;
     ir.networkInterface.connected = networkInterface->IsConnected();
     memcpy(ir.networkInterface.ipV6LinkLocalAddress, networkInterface->GetIpV6LinkLocalAddress().u32, sizeof(ir.networkInterface.ipV6LinkLocalAddress));
-  }
-
-  if (dynamic_cast<PL::Ethernet*>(hardwareInterface.get()))
-    ir.common.type = (uint16_t)BlackBoxHardwareInterfaceType::ethernet;
-
-  if (dynamic_cast<PL::WiFiStation*>(hardwareInterface.get()))
-    ir.common.type = (uint16_t)BlackBoxHardwareInterfaceType::wifiStation;
 
-#if CONFIG_TINYUSB_CDC_ENABLED
-  if (dynamic_cast<PL::UsbDeviceCdc*>(hardwareInterface.get()))
-    ir.common.type = (uint16_t)BlackBoxHardwareInterfaceType::usbDeviceCdc;
-#endif
+    // The link quality is read from the link monitor cache, so the request never waits for a driver
+    BlackBoxLinkQuality linkQuality;
+    auto linkMonitor = blackBox.GetLinkMonitor();
+    if (linkMonitor && linkMonitor->GetLinkQuality(*networkInterface, linkQuality) == ESP_OK) {
+      ir.networkInterface.reconnectCounter = linkQuality.reconnectCounter;
+      ir.networkInterface.timeSinceDisconnect = linkQuality.timeSinceDisconnect;
+      ir.networkInterface.linkErrorCounter = linkQuality.linkErrorCounter;
+      ir.networkInterface.linkDropCounter = linkQuality.linkDropCounter;
+      if (hardwareInterfaceConfiguration->GetType() == BlackBoxHardwareInterfaceType::ethernet) {
+        ir.ethernet.speed = linkQuality.ethernetSpeed;
+        ir.ethernet.fullDuplex = linkQuality.ethernetFullDuplex;
+      }
+      if (hardwareInterfaceConfiguration->GetType() == BlackBoxHardwareInterfaceType::wifiStation) {
+        ir.wifi.rssi = linkQuality.wifiRssi;
+        ir.wifi.channel = linkQuality.wifiChannel;
+        ir.wifi.phyMode = linkQuality.wifiPhyMode;
+      }
+    }
+  }
 
   return ESP_OK;
 }
@@ -304,17 +359,16 @@ BlackBoxModbusServer::ServerConfigurationHR::ServerConfigurationHR(BlackBoxModbu
 //==============================================================================
 
 esp_err_t BlackBoxModbusServer::ServerConfigurationHR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
   BlackBox& blackBox = *modbusServer.blackBox;
   
   memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
   auto& hr = modbusServer.memoryDataBuffer->data->serverConfigurationHR;
 
-  size_t numberOfServers = blackBox.GetServerConfigurations().size();
-  if (!numberOfServers || modbusServer.selectedServerIndex >= numberOfServers)
+  auto serverConfiguration = blackBox.GetServerConfiguration(modbusServer.selectedServerIndex);
+  if (!serverConfiguration)
     return ESP_OK;
 
-  auto serverConfiguration = blackBox.GetServerConfigurations()[modbusServer.selectedServerIndex];
-
   hr.common.enabled = serverConfiguration->enabled.GetValue();
 
   if (auto networkServerConfiguration = dynamic_cast<PL::BlackBoxNetworkServerConfiguration*>(serverConfiguration.get())) {
@@ -325,16 +379,22 @@ esp_err_t BlackBoxModbusServer::ServerConfigurationHR::OnRead() {
   if (auto modbusServerConfiguration = dynamic_cast<PL::BlackBoxModbusServerConfiguration*>(serverConfiguration.get())) {
     hr.modbusServer.protocol = (uint16_t)modbusServerConfiguration->protocol.GetValue();
     hr.modbusServer.stationAddress = modbusServerConfiguration->stationAddress.GetValue();
-    if (auto modbusServer = dynamic_cast<PL::ModbusServer*>(serverConfiguration->GetServer().get())) {
-      if (auto baseServer = modbusServer->GetBaseServer().lock()) {
-        if (dynamic_cast<PL::NetworkServer*>(baseServer.get())) {
-          hr.networkModbusServer.port = modbusServerConfiguration->port.GetValue();
-          hr.networkModbusServer.maxNumberOfClients = modbusServerConfiguration->maxNumberOfClients.GetValue();
-        }
-      }
+    if (serverConfiguration->GetType() == BlackBoxServerType::networkModbusServer) {
+      hr.networkModbusServer.port = modbusServerConfiguration->port.GetValue();
+      hr.networkModbusServer.maxNumberOfClients = modbusServerConfiguration->maxNumberOfClients.GetValue();
     }
   }
 
+  if (auto sntpConfiguration = dynamic_cast<PL::BlackBoxSntpConfiguration*>(serverConfiguration.get())) {
+    auto primaryServer = sntpConfiguration->primaryServer.GetValue();
+    memcpy(hr.sntpClient.primaryServer, primaryServer.data(), std::min(maxSntpServerNameSize - 1, primaryServer.size()));
+    auto secondaryServer = sntpConfiguration->secondaryServer.GetValue();
+    memcpy(hr.sntpClient.secondaryServer, secondaryServer.data(), std::min(maxSntpServerNameSize - 1, secondaryServer.size()));
+    hr.sntpClient.syncInterval = sntpConfiguration->syncInterval.GetValue();
+    auto timeZone = sntpConfiguration->timeZone.GetValue();
+    memcpy(hr.sntpClient.timeZone, timeZone.data(), std::min(maxTimeZoneSize - 1, timeZone.size()));
+  }
+
   return ESP_OK;
 }
 
@@ -345,11 +405,11 @@ esp_err_t BlackBoxModbusServer::ServerConfigurationHR::OnWrite() {
 
   auto& hr = modbusServer.memoryDataBuffer->data->serverConfigurationHR;
 
-  size_t numberOfServers = blackBox.GetServerConfigurations().size();
-  if (!numberOfServers || modbusServer.selectedServerIndex >= numberOfServers)
+  auto serverConfiguration = blackBox.GetServerConfiguration(modbusServer.selectedServerIndex);
+  if (!serverConfiguration) {
+    PL_BLACKBOX_TRACE(modbusAreaWrite, (uint16_t)memoryType, address);
     return ESP_OK;
-
-  auto serverConfiguration = blackBox.GetServerConfigurations()[modbusServer.selectedServerIndex];
+  }
 
   serverConfiguration->enabled.SetValue(hr.common.enabled);
 
@@ -361,16 +421,23 @@ esp_err_t BlackBoxModbusServer::ServerConfigurationHR::OnWrite() {
   if (auto modbusServerConfiguration = dynamic_cast<PL::BlackBoxModbusServerConfiguration*>(serverConfiguration.get())) {
     modbusServerConfiguration->protocol.SetValue((ModbusProtocol)hr.modbusServer.protocol);
     modbusServerConfiguration->stationAddress.SetValue(std::min(hr.modbusServer.stationAddress, (uint16_t)255));
-    if (auto modbusServer = dynamic_cast<PL::ModbusServer*>(serverConfiguration->GetServer().get())) {
-      if (auto baseServer = modbusServer->GetBaseServer().lock()) {
-        if (dynamic_cast<PL::NetworkServer*>(baseServer.get())) {
-          modbusServerConfiguration->port.SetValue(hr.networkModbusServer.port);
-          modbusServerConfiguration->maxNumberOfClients.SetValue(hr.networkModbusServer.maxNumberOfClients);
-        }
-      }
+    if (serverConfiguration->GetType() == BlackBoxServerType::networkModbusServer) {
+      modbusServerConfiguration->port.SetValue(hr.networkModbusServer.port);
+      modbusServerConfiguration->maxNumberOfClients.SetValue(hr.networkModbusServer.maxNumberOfClients);
     }
   }
 
+  if (auto sntpConfiguration = dynamic_cast<PL::BlackBoxSntpConfiguration*>(serverConfiguration.get())) {
+    std::string primaryServer(hr.sntpClient.primaryServer, maxSntpServerNameSize - 1);
+    sntpConfiguration->primaryServer.SetValue(primaryServer.c_str());
+    std::string secondaryServer(hr.sntpClient.secondaryServer, maxSntpServerNameSize - 1);
+    sntpConfiguration->secondaryServer.SetValue(secondaryServer.c_str());
+    sntpConfiguration->syncInterval.SetValue(hr.sntpClient.syncInterval);
+    std::string timeZone(hr.sntpClient.timeZone, maxTimeZoneSize - 1);
+    sntpConfiguration->timeZone.SetValue(timeZone.c_str());
+  }
+
+  PL_BLACKBOX_TRACE(modbusAreaWrite, (uint16_t)memoryType, address);
   return ESP_OK;
 }
 
@@ -383,46 +450,209 @@ BlackBoxModbusServer::ServerConfigurationIR::ServerConfigurationIR(BlackBoxModbu
 //==============================================================================
 
 esp_err_t BlackBoxModbusServer::ServerConfigurationIR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
   BlackBox& blackBox = *modbusServer.blackBox;
   
   memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
   auto& ir = modbusServer.memoryDataBuffer->data->serverConfigurationIR;
 
-  size_t numberOfServers = blackBox.GetServerConfigurations().size();
-  if (!numberOfServers || modbusServer.selectedServerIndex >= numberOfServers)
+  auto serverConfiguration = blackBox.GetServerConfiguration(modbusServer.selectedServerIndex);
+  if (!serverConfiguration)
     return ESP_OK;
 
-  auto server = blackBox.GetServerConfigurations()[modbusServer.selectedServerIndex]->GetServer();
+  auto server = serverConfiguration->GetServer();
 
   size_t maxNameSize = BlackBoxModbusServer::maxNameSize;
 
   auto name = server->GetName();
-  memcpy(ir.common.name, name.data(), std::min(maxNameSize, name.size()));
+  memcpy(ir.common.name, name.data(), std::min(maxNameSize - 1, name.size()));
 
-  if (dynamic_cast<PL::StreamServer*>(server.get()))
-    ir.common.type = (uint16_t)BlackBoxServerType::streamServer;
+  ir.common.type = (uint16_t)serverConfiguration->GetType();
 
-  if (dynamic_cast<PL::NetworkServer*>(server.get()))
-    ir.common.type = (uint16_t)BlackBoxServerType::networkServer;
+  return ESP_OK;
+}
 
-  if (auto modbusServer = dynamic_cast<PL::ModbusServer*>(server.get())) {
-    if (auto baseServer = modbusServer->GetBaseServer().lock()) {
-      if (dynamic_cast<PL::NetworkServer*>(baseServer.get()))
-        ir.common.type = (uint16_t)BlackBoxServerType::networkModbusServer;
-      else
-        ir.common.type = (uint16_t)BlackBoxServerType::streamModbusServer;
-    }
+//==============================================================================
+
+BlackBoxModbusServer::EventLogHR::EventLogHR(BlackBoxModbusServer& modbusServer) :
+  ModbusMemoryArea(PL::ModbusMemoryType::holdingRegisters, eventLogMemoryAddress, modbusServer.memoryDataBuffer->data, registerMemoryAreaSize, modbusServer.memoryDataBuffer),
+  modbusServer(modbusServer) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxModbusServer::EventLogHR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
+  memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
+  auto& hr = modbusServer.memoryDataBuffer->data->eventLogHR;
+
+  hr.selectedEventSequenceNumber = modbusServer.selectedEventSequenceNumber;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxModbusServer::EventLogHR::OnWrite() {
+  auto& hr = modbusServer.memoryDataBuffer->data->eventLogHR;
+
+  modbusServer.selectedEventSequenceNumber = hr.selectedEventSequenceNumber;
+  PL_BLACKBOX_TRACE(modbusAreaWrite, (uint16_t)memoryType, address);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+BlackBoxModbusServer::EventLogIR::EventLogIR(BlackBoxModbusServer& modbusServer) :
+  ModbusMemoryArea(PL::ModbusMemoryType::inputRegisters, eventLogMemoryAddress, modbusServer.memoryDataBuffer->data, registerMemoryAreaSize, modbusServer.memoryDataBuffer),
+  modbusServer(modbusServer) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxModbusServer::EventLogIR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
+  memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
+  auto& ir = modbusServer.memoryDataBuffer->data->eventLogIR;
+
+  ir.firstSequenceNumber = BlackBoxEventRecorder::GetFirstSequenceNumber();
+  ir.nextSequenceNumber = BlackBoxEventRecorder::GetNextSequenceNumber();
+  ir.selectedEventSequenceNumber = modbusServer.selectedEventSequenceNumber;
+  // Events that have been overwritten or have not been recorded yet have invalid sequence numbers
+  for (size_t i = 0; i < eventLogWindowSize; i++) {
+    BlackBoxEvent event = {};
+    if (BlackBoxEventRecorder::ReadEvent(ir.selectedEventSequenceNumber + i, event) != ESP_OK)
+      event.sequenceNumber = BlackBoxEventRecorder::invalidSequenceNumber;
+    ir.events[i] = event;
   }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+BlackBoxModbusServer::HealthIR::HealthIR(BlackBoxModbusServer& modbusServer) :
+  ModbusMemoryArea(PL::ModbusMemoryType::inputRegisters, healthMemoryAddress, modbusServer.memoryDataBuffer->data, registerMemoryAreaSize, modbusServer.memoryDataBuffer),
+  modbusServer(modbusServer) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxModbusServer::HealthIR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
+  BlackBox& blackBox = *modbusServer.blackBox;
+
+  memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
+  auto& ir = modbusServer.memoryDataBuffer->data->healthIR;
+
+  auto healthMonitor = blackBox.GetHealthMonitor();
+  if (!healthMonitor)
+    return ESP_OK;
 
-  if (dynamic_cast<PL::HttpServer*>(server.get()))
-    ir.common.type = (uint16_t)BlackBoxServerType::httpServer;
+  BlackBoxHealth health = healthMonitor->GetHealth();
+  ir.uptime = health.uptime / 1000;
+  const BlackBoxHeapHealth* heaps[] = {&health.defaultHeap, &health.internalHeap, &health.spiramHeap};
+  for (size_t i = 0; i < sizeof(heaps) / sizeof(heaps[0]); i++) {
+    ir.heaps[i].freeSize = heaps[i]->freeSize;
+    ir.heaps[i].minFreeSize = heaps[i]->minFreeSize;
+    ir.heaps[i].largestFreeBlockSize = heaps[i]->largestFreeBlockSize;
+  }
+  memcpy(ir.coreIdleTime, health.coreIdleTime, sizeof(ir.coreIdleTime));
+  ir.numberOfTasks = health.numberOfTasks;
+  for (size_t i = 0; i < BlackBoxHealthMonitor::maxNumberOfTasks; i++) {
+    memcpy(ir.tasks[i].name, health.tasks[i].name, sizeof(ir.tasks[i].name));
+    ir.tasks[i].stackHighWaterMark = health.tasks[i].stackHighWaterMark;
+    ir.tasks[i].cpuLoad = health.tasks[i].cpuLoad;
+  }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+BlackBoxModbusServer::FirmwareUpdateHR::FirmwareUpdateHR(BlackBoxModbusServer& modbusServer) :
+  ModbusMemoryArea(PL::ModbusMemoryType::holdingRegisters, firmwareUpdateMemoryAddress, modbusServer.memoryDataBuffer->data, registerMemoryAreaSize, modbusServer.memoryDataBuffer),
+  modbusServer(modbusServer) {}
 
-  if (dynamic_cast<PL::MdnsServer*>(server.get()))
-    ir.common.type = (uint16_t)BlackBoxServerType::mdnsServer;
+//==============================================================================
 
+esp_err_t BlackBoxModbusServer::FirmwareUpdateHR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
+  memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
   return ESP_OK;
 }
 
 //==============================================================================
 
+esp_err_t BlackBoxModbusServer::FirmwareUpdateHR::OnWrite() {
+  auto& hr = modbusServer.memoryDataBuffer->data->firmwareUpdateHR;
+
+  esp_err_t error = ESP_OK;
+  auto firmwareUpdater = modbusServer.blackBox->GetFirmwareUpdater();
+  if (!firmwareUpdater)
+    error = ESP_ERR_NOT_SUPPORTED;
+  else if (hr.abort)
+    error = firmwareUpdater->Abort();
+  else if (hr.begin)
+    error = firmwareUpdater->Begin(hr.imageSize, hr.sha256);
+  PL_BLACKBOX_TRACE(modbusAreaWrite, (uint16_t)memoryType, address);
+  return error;
+}
+
+//==============================================================================
+
+BlackBoxModbusServer::FirmwareUpdateIR::FirmwareUpdateIR(BlackBoxModbusServer& modbusServer) :
+  ModbusMemoryArea(PL::ModbusMemoryType::inputRegisters, firmwareUpdateMemoryAddress, modbusServer.memoryDataBuffer->data, registerMemoryAreaSize, modbusServer.memoryDataBuffer),
+  modbusServer(modbusServer) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxModbusServer::FirmwareUpdateIR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
+  memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
+  auto& ir = modbusServer.memoryDataBuffer->data->firmwareUpdateIR;
+
+  auto firmwareUpdater = modbusServer.blackBox->GetFirmwareUpdater();
+  if (!firmwareUpdater)
+    return ESP_OK;
+  auto status = firmwareUpdater->GetStatus();
+  ir.state = (uint16_t)status.state;
+  ir.error = status.error;
+  ir.imageSize = status.imageSize;
+  ir.receivedSize = status.receivedSize;
+  ir.writtenSize = status.writtenSize;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+BlackBoxModbusServer::FirmwareImageHR::FirmwareImageHR(BlackBoxModbusServer& modbusServer) :
+  ModbusMemoryArea(PL::ModbusMemoryType::holdingRegisters, firmwareImageMemoryAddress, modbusServer.memoryDataBuffer->data, registerMemoryAreaSize, modbusServer.memoryDataBuffer),
+  modbusServer(modbusServer) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxModbusServer::FirmwareImageHR::OnRead() {
+  PL_BLACKBOX_TRACE(modbusAreaRead, (uint16_t)memoryType, address);
+  memset(modbusServer.memoryDataBuffer->data, 0, registerMemoryAreaSize);
+  auto& hr = modbusServer.memoryDataBuffer->data->firmwareImageHR;
+
+  // The offset of the next expected data, zero size makes a partial write without the size ignored
+  auto firmwareUpdater = modbusServer.blackBox->GetFirmwareUpdater();
+  if (firmwareUpdater)
+    hr.offset = firmwareUpdater->GetStatus().receivedSize;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxModbusServer::FirmwareImageHR::OnWrite() {
+  auto& hr = modbusServer.memoryDataBuffer->data->firmwareImageHR;
+
+  esp_err_t error = ESP_OK;
+  auto firmwareUpdater = modbusServer.blackBox->GetFirmwareUpdater();
+  if (!firmwareUpdater)
+    error = ESP_ERR_NOT_SUPPORTED;
+  else if (hr.size)
+    error = firmwareUpdater->Write(hr.offset, hr.data, std::min<size_t>(hr.size, firmwareImageChunkSize));
+  PL_BLACKBOX_TRACE(modbusAreaWrite, (uint16_t)memoryType, address);
+  return error;
+}
+
+//==============================================================================
+
 }
\ No newline at end of file
@@ -27,50 +27,49 @@ BlackBoxModbusServerConfiguration::BlackBoxModbusServerConfiguration(std::shared
       maxNumberOfClients.SetValue(maxNumberOfClientsValue);
     }
   }
+  InitializeParameters(protocol, stationAddress, port, maxNumberOfClients);
 }
 
 //==============================================================================
 
-void BlackBoxModbusServerConfiguration::Load() {
+void BlackBoxModbusServerConfiguration::LoadParameters(BlackBoxConfigurationStorage& storage) {
   LockGuard lg(mutex);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readOnly);
   uint8_t u8Value;
   uint16_t u16Value;
   uint32_t u32Value;
 
-  if (nvsNamespace.Read(protocolNvsKey, u8Value) == ESP_OK)
+  if (storage.Read(protocolNvsKey, u8Value) == ESP_OK)
     protocol.SetValue((ModbusProtocol)u8Value);
-  if (nvsNamespace.Read(stationAddressNvsKey, u8Value) == ESP_OK)
+  if (storage.Read(stationAddressNvsKey, u8Value) == ESP_OK)
     stationAddress.SetValue(u8Value);
 
   if (auto baseServer = modbusServer->GetBaseServer().lock()) {
     if (dynamic_cast<NetworkServer*>(baseServer.get())) {
-      if (nvsNamespace.Read(portNvsKey, u16Value) == ESP_OK)
+      if (storage.Read(portNvsKey, u16Value) == ESP_OK)
         port.SetValue(u16Value);
-      if (nvsNamespace.Read(maxNumberOfClientsNvsKey, u32Value) == ESP_OK)
+      if (storage.Read(maxNumberOfClientsNvsKey, u32Value) == ESP_OK)
         maxNumberOfClients.SetValue(u32Value);
     }
   }
 
-  BlackBoxServerConfiguration::Load();
+  BlackBoxServerConfiguration::LoadParameters(storage);
 }
 
 //==============================================================================
 
-void BlackBoxModbusServerConfiguration::Save() {
+void BlackBoxModbusServerConfiguration::SaveParameters(BlackBoxConfigurationStorage& storage) {
   LockGuard lg(mutex);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readWrite);
 
-  nvsNamespace.Write(protocolNvsKey, (uint8_t)protocol.GetValue());
-  nvsNamespace.Write(stationAddressNvsKey, stationAddress.GetValue());
+  storage.Write(protocolNvsKey, (uint8_t)protocol.GetValue());
+  storage.Write(stationAddressNvsKey, stationAddress.GetValue());
   if (auto baseServer = modbusServer->GetBaseServer().lock()) {
     if (dynamic_cast<NetworkServer*>(baseServer.get())) {
-      nvsNamespace.Write(portNvsKey, port.GetValue());
-      nvsNamespace.Write(maxNumberOfClientsNvsKey, (uint32_t)maxNumberOfClients.GetValue());
+      storage.Write(portNvsKey, port.GetValue());
+      storage.Write(maxNumberOfClientsNvsKey, (uint32_t)maxNumberOfClients.GetValue());
     }
   }
 
-  BlackBoxServerConfiguration::Save();
+  BlackBoxServerConfiguration::SaveParameters(storage);
 }
 
 //==============================================================================
@@ -12,34 +12,34 @@ const std::string BlackBoxNetworkServerConfiguration::maxNumberOfClientsNvsKey =
 //==============================================================================
 
 BlackBoxNetworkServerConfiguration::BlackBoxNetworkServerConfiguration(std::shared_ptr<NetworkServer> networkServer, std::string nvsNamespaceName) :
-    BlackBoxServerConfiguration(networkServer, nvsNamespaceName), port(networkServer->GetPort()), maxNumberOfClients(networkServer->GetMaxNumberOfClients()), networkServer(networkServer) { }
+    BlackBoxServerConfiguration(networkServer, nvsNamespaceName), port(networkServer->GetPort()), maxNumberOfClients(networkServer->GetMaxNumberOfClients()), networkServer(networkServer) {
+  InitializeParameters(port, maxNumberOfClients);
+}
 
 //==============================================================================
 
-void BlackBoxNetworkServerConfiguration::Load() {
+void BlackBoxNetworkServerConfiguration::LoadParameters(BlackBoxConfigurationStorage& storage) {
   LockGuard lg(mutex);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readOnly);
   uint16_t u16Value;
-  uint16_t u32Value;
+  uint32_t u32Value;
 
-  if (nvsNamespace.Read(portNvsKey, u16Value) == ESP_OK)
+  if (storage.Read(portNvsKey, u16Value) == ESP_OK)
     port.SetValue(u16Value);
-  if (nvsNamespace.Read(maxNumberOfClientsNvsKey, u32Value) == ESP_OK)
+  if (storage.Read(maxNumberOfClientsNvsKey, u32Value) == ESP_OK)
     maxNumberOfClients.SetValue(u32Value);
 
-  BlackBoxServerConfiguration::Load();
+  BlackBoxServerConfiguration::LoadParameters(storage);
 }
 
 //==============================================================================
 
-void BlackBoxNetworkServerConfiguration::Save() {
+void BlackBoxNetworkServerConfiguration::SaveParameters(BlackBoxConfigurationStorage& storage) {
   LockGuard lg(mutex);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readWrite);
   
-  nvsNamespace.Write(portNvsKey, port.GetValue());
-  nvsNamespace.Write(maxNumberOfClientsNvsKey, (uint32_t)maxNumberOfClients.GetValue());
+  storage.Write(portNvsKey, port.GetValue());
+  storage.Write(maxNumberOfClientsNvsKey, (uint32_t)maxNumberOfClients.GetValue());
   
-  BlackBoxServerConfiguration::Save();
+  BlackBoxServerConfiguration::SaveParameters(storage);
 }
 
 //==============================================================================
@@ -1,4 +1,11 @@
 #include "pl_blackbox_server_configuration.h"
+#include "pl_network.h"
+#include "pl_modbus.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "pl_http.h"
+#include "pl_mdns.h"
+#endif
+#include "pl_blackbox_sntp_client.h"
 
 //==============================================================================
 
@@ -16,7 +23,29 @@ const std::string BlackBoxServerConfiguration::enabledNvsKey = "enabled";
 //==============================================================================
 
 BlackBoxServerConfiguration::BlackBoxServerConfiguration(std::shared_ptr<Server> server, std::string nvsNamespaceName) :
-  nvsNamespaceName(nvsNamespaceName), server(server) {}
+  nvsNamespaceName(nvsNamespaceName), server(server), type(BlackBoxServerType::unknown) {
+  if (dynamic_cast<StreamServer*>(server.get()))
+    type = BlackBoxServerType::streamServer;
+  if (dynamic_cast<NetworkServer*>(server.get()))
+    type = BlackBoxServerType::networkServer;
+  if (auto modbusServer = dynamic_cast<ModbusServer*>(server.get())) {
+    if (auto baseServer = modbusServer->GetBaseServer().lock()) {
+      if (dynamic_cast<NetworkServer*>(baseServer.get()))
+        type = BlackBoxServerType::networkModbusServer;
+      else
+        type = BlackBoxServerType::streamModbusServer;
+    }
+  }
+#if !CONFIG_IDF_TARGET_LINUX
+  if (dynamic_cast<HttpServer*>(server.get()))
+    type = BlackBoxServerType::httpServer;
+  if (dynamic_cast<MdnsServer*>(server.get()))
+    type = BlackBoxServerType::mdnsServer;
+#endif
+  if (dynamic_cast<BlackBoxSntpClient*>(server.get()))
+    type = BlackBoxServerType::sntpClient;
+  enabled.SetChangeHandler([this]() { OnParameterChanged(); });
+}
 
 //==============================================================================
 
@@ -27,22 +56,24 @@ std::shared_ptr<Server> BlackBoxServerConfiguration::GetServer() {
 
 //==============================================================================
 
+BlackBoxServerType BlackBoxServerConfiguration::GetType() {
+  return type;
+}
+
+//==============================================================================
+
 void BlackBoxServerConfiguration::Load() {
   LockGuard lg(mutex);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readOnly);
-  uint8_t u8Value;
-
-  if (nvsNamespace.Read(enabledNvsKey, u8Value) == ESP_OK)
-    enabled.SetValue(u8Value);
+  BlackBoxNvsConfigurationStorage storage(nvsNamespaceName, NvsAccessMode::readOnly);
+  LoadParameters(storage);
 }
 
 //==============================================================================
 
 void BlackBoxServerConfiguration::Save() {
   LockGuard lg(mutex);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readWrite);
-
-  nvsNamespace.Write(enabledNvsKey, (uint8_t)enabled.GetValue());
+  BlackBoxNvsConfigurationStorage storage(nvsNamespaceName, NvsAccessMode::readWrite);
+  SaveParameters(storage);
 }
 
 //==============================================================================
@@ -55,6 +86,86 @@ void BlackBoxServerConfiguration::Erase() {
 
 //==============================================================================
 
+void BlackBoxServerConfiguration::LoadParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(mutex);
+  uint8_t u8Value;
+
+  // The enabled flag of the deferred configuration has been set from the general configuration index and could have been changed since then
+  if (loadState != LoadState::loading && storage.Read(enabledNvsKey, u8Value) == ESP_OK)
+    enabled.SetValue(u8Value);
+}
+
+//==============================================================================
+
+void BlackBoxServerConfiguration::SaveParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(mutex);
+
+  storage.Write(enabledNvsKey, (uint8_t)enabled.GetValue());
+}
+
+//==============================================================================
+
+std::string BlackBoxServerConfiguration::GetNvsNamespaceName() {
+  LockGuard lg(mutex);
+  return nvsNamespaceName;
+}
+
+//==============================================================================
+
+void BlackBoxServerConfiguration::DeferLoad(std::shared_ptr<BlackBoxConfigurationStorage> storage) {
+  LockGuard lg(mutex);
+  deferredLoadStorage = storage;
+  loadState = LoadState::deferred;
+}
+
+//==============================================================================
+
+bool BlackBoxServerConfiguration::IsLoadDeferred() {
+  return loadState == LoadState::deferred;
+}
+
+//==============================================================================
+
+uint32_t BlackBoxServerConfiguration::GetGeneration() {
+  return generation;
+}
+
+//==============================================================================
+
+void BlackBoxServerConfiguration::SetChangeHandler(std::function<void()> changeHandler) {
+  LockGuard lg(mutex);
+  this->changeHandler = changeHandler;
+}
+
+//==============================================================================
+
+void BlackBoxServerConfiguration::LoadIfDeferred() {
+  if (loadState == LoadState::loaded)
+    return;
+  LockGuard lg(mutex);
+  // Other tasks wait for the mutex until the loading is finished, the loading task itself gets here from the parameter access handlers
+  if (loadState != LoadState::deferred)
+    return;
+  loadState = LoadState::loading;
+  if (deferredLoadStorage)
+    LoadParameters(*deferredLoadStorage);
+  else
+    Load();
+  deferredLoadStorage.reset();
+  loadState = LoadState::loaded;
+}
+
+//==============================================================================
+
+void BlackBoxServerConfiguration::OnParameterChanged() {
+  generation.fetch_add(1);
+  LockGuard lg(mutex);
+  if (changeHandler)
+    changeHandler();
+}
+
+//==============================================================================
+
 void BlackBoxServerConfiguration::Apply() {
   LockGuard lg(mutex, *server);
 
@@ -0,0 +1,167 @@
+#include "pl_blackbox_sntp_client.h"
+#include "esp_check.h"
+#include "esp_sntp.h"
+#include <algorithm>
+#include <time.h>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_sntp_client";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+const std::string BlackBoxSntpClient::defaultServerName = "pool.ntp.org";
+const std::string BlackBoxSntpClient::defaultTimeZone = "UTC0";
+
+//==============================================================================
+
+BlackBoxSntpClient::BlackBoxSntpClient() : Server("sntp_client"), timeZone(defaultTimeZone) {
+  serverNames[0] = defaultServerName;
+}
+
+//==============================================================================
+
+BlackBoxSntpClient::~BlackBoxSntpClient() {
+  Disable();
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxSntpClient::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxSntpClient::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxSntpClient::Enable() {
+  LockGuard lg(*this);
+  if (enabled)
+    return ESP_OK;
+
+  esp_sntp_setoperatingmode(ESP_SNTP_OPMODE_POLL);
+  // The SNTP service keeps the server name pointers, so the names are not changed while the service is running
+  for (size_t i = 0; i < std::min<size_t>(maxNumberOfServers, SNTP_MAX_SERVERS); i++)
+    esp_sntp_setservername(i, serverNames[i].empty() ? NULL : serverNames[i].c_str());
+  sntp_set_sync_interval(syncInterval * 1000);
+  sntp_set_time_sync_notification_cb(TimeSyncCallback);
+  esp_sntp_init();
+
+  enabled = true;
+  enabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxSntpClient::Disable() {
+  LockGuard lg(*this);
+  if (!enabled)
+    return ESP_OK;
+
+  esp_sntp_stop();
+  enabled = false;
+  disabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool BlackBoxSntpClient::IsEnabled() {
+  LockGuard lg(*this);
+  return enabled;
+}
+
+//==============================================================================
+
+std::string BlackBoxSntpClient::GetServerName(size_t index) {
+  LockGuard lg(*this);
+  return index < maxNumberOfServers ? serverNames[index] : std::string();
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxSntpClient::SetServerName(size_t index, const std::string& serverName) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(index < maxNumberOfServers, ESP_ERR_INVALID_ARG, TAG, "invalid server index");
+  if (serverNames[index] == serverName)
+    return ESP_OK;
+  bool wasEnabled = enabled;
+  ESP_RETURN_ON_ERROR(Disable(), TAG, "disable failed");
+  serverNames[index] = serverName;
+  if (wasEnabled)
+    ESP_RETURN_ON_ERROR(Enable(), TAG, "enable failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+uint32_t BlackBoxSntpClient::GetSyncInterval() {
+  LockGuard lg(*this);
+  return syncInterval;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxSntpClient::SetSyncInterval(uint32_t syncInterval) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(syncInterval >= minSyncInterval, ESP_ERR_INVALID_ARG, TAG, "invalid synchronization interval");
+  if (this->syncInterval == syncInterval)
+    return ESP_OK;
+  this->syncInterval = syncInterval;
+  return Restart();
+}
+
+//==============================================================================
+
+std::string BlackBoxSntpClient::GetTimeZone() {
+  LockGuard lg(*this);
+  return timeZone;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxSntpClient::SetTimeZone(const std::string& timeZone) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(!timeZone.empty(), ESP_ERR_INVALID_ARG, TAG, "invalid time zone");
+  ESP_RETURN_ON_FALSE(setenv("TZ", timeZone.c_str(), 1) == 0, ESP_ERR_NO_MEM, TAG, "time zone set failed");
+  tzset();
+  this->timeZone = timeZone;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxSntpClient::Restart() {
+  if (!enabled)
+    return ESP_OK;
+  ESP_RETURN_ON_ERROR(Disable(), TAG, "disable failed");
+  ESP_RETURN_ON_ERROR(Enable(), TAG, "enable failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+void BlackBoxSntpClient::TimeSyncCallback(struct timeval* time) {
+  BlackBoxClock::Synchronize();
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
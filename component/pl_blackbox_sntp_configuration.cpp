@@ -0,0 +1,69 @@
+#include "pl_blackbox_sntp_configuration.h"
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+const std::string BlackBoxSntpConfiguration::primaryServerNvsKey = "server1";
+const std::string BlackBoxSntpConfiguration::secondaryServerNvsKey = "server2";
+const std::string BlackBoxSntpConfiguration::syncIntervalNvsKey = "syncInterval";
+const std::string BlackBoxSntpConfiguration::timeZoneNvsKey = "timeZone";
+
+//==============================================================================
+
+BlackBoxSntpConfiguration::BlackBoxSntpConfiguration(std::shared_ptr<BlackBoxSntpClient> sntpClient, std::string nvsNamespaceName) :
+    BlackBoxServerConfiguration(sntpClient, nvsNamespaceName), primaryServer(sntpClient->GetServerName(0)), secondaryServer(sntpClient->GetServerName(1)),
+    syncInterval(sntpClient->GetSyncInterval()), timeZone(sntpClient->GetTimeZone()), sntpClient(sntpClient) {
+  InitializeParameters(primaryServer, secondaryServer, syncInterval, timeZone);
+}
+
+//==============================================================================
+
+void BlackBoxSntpConfiguration::LoadParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(mutex);
+  uint32_t u32Value;
+  std::string stringValue;
+
+  if (storage.Read(primaryServerNvsKey, stringValue) == ESP_OK)
+    primaryServer.SetValue(stringValue);
+  if (storage.Read(secondaryServerNvsKey, stringValue) == ESP_OK)
+    secondaryServer.SetValue(stringValue);
+  if (storage.Read(syncIntervalNvsKey, u32Value) == ESP_OK)
+    syncInterval.SetValue(u32Value);
+  if (storage.Read(timeZoneNvsKey, stringValue) == ESP_OK)
+    timeZone.SetValue(stringValue);
+
+  BlackBoxServerConfiguration::LoadParameters(storage);
+}
+
+//==============================================================================
+
+void BlackBoxSntpConfiguration::SaveParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(mutex);
+
+  storage.Write(primaryServerNvsKey, primaryServer.GetValue());
+  storage.Write(secondaryServerNvsKey, secondaryServer.GetValue());
+  storage.Write(syncIntervalNvsKey, syncInterval.GetValue());
+  storage.Write(timeZoneNvsKey, timeZone.GetValue());
+
+  BlackBoxServerConfiguration::SaveParameters(storage);
+}
+
+//==============================================================================
+
+void BlackBoxSntpConfiguration::Apply() {
+  LockGuard lg(mutex, *sntpClient);
+
+  sntpClient->SetServerName(0, primaryServer.GetValue());
+  sntpClient->SetServerName(1, secondaryServer.GetValue());
+  sntpClient->SetSyncInterval(syncInterval.GetValue());
+  sntpClient->SetTimeZone(timeZone.GetValue());
+
+  BlackBoxServerConfiguration::Apply();
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
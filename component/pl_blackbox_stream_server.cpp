@@ -0,0 +1,144 @@
+#include "pl_blackbox_stream_server.h"
+#include "esp_check.h"
+#include <unordered_map>
+
+//==============================================================================
+
+static const char* TAG = "pl_blackbox_stream_server";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+BlackBoxStreamServer::BlackBoxStreamServer(std::shared_ptr<BlackBox> blackBox, std::shared_ptr<Stream> stream) :
+  StreamServer(stream), blackBox(blackBox) {}
+
+//==============================================================================
+
+esp_err_t BlackBoxStreamServer::HandleRequest(Stream& stream) {
+  std::vector<uint8_t> frame(BlackBoxStreamProtocol::headerSize);
+  ESP_RETURN_ON_ERROR(stream.Read(frame.data(), 1), TAG, "stream read failed");
+  // Bytes outside of the frames are skipped
+  if (frame[0] != BlackBoxStreamProtocol::startByte)
+    return ESP_OK;
+
+  ESP_RETURN_ON_ERROR(stream.Read(frame.data() + 1, BlackBoxStreamProtocol::headerSize - 1), TAG, "stream read failed");
+  size_t payloadSize = frame[2] | (frame[3] << 8);
+  ESP_RETURN_ON_FALSE(payloadSize <= BlackBoxStreamProtocol::maxPayloadSize, ESP_ERR_INVALID_SIZE, TAG, "payload is too large");
+  frame.resize(BlackBoxStreamProtocol::headerSize + payloadSize + BlackBoxStreamProtocol::crcSize);
+  ESP_RETURN_ON_ERROR(stream.Read(frame.data() + BlackBoxStreamProtocol::headerSize, payloadSize + BlackBoxStreamProtocol::crcSize), TAG, "stream read failed");
+
+  uint8_t command;
+  std::vector<uint8_t> request, response;
+  size_t frameSize;
+  ESP_RETURN_ON_FALSE(BlackBoxStreamProtocol::DecodeFrame(frame.data(), frame.size(), command, request, frameSize) == BlackBoxStreamDecodeResult::ok,
+    ESP_ERR_INVALID_CRC, TAG, "invalid frame");
+
+  switch ((BlackBoxStreamCommand)command) {
+    case BlackBoxStreamCommand::readConfiguration: {
+      BlackBoxStreamStatus status = ReadConfiguration(request, response);
+      return SendResponse(stream, command, status, status == BlackBoxStreamStatus::ok ? response : std::vector<uint8_t>());
+    }
+
+    case BlackBoxStreamCommand::writeConfiguration:
+      return SendResponse(stream, command, WriteConfiguration(request));
+
+    case BlackBoxStreamCommand::saveConfiguration:
+      blackBox->SaveAllConfigurations();
+      return SendResponse(stream, command, BlackBoxStreamStatus::ok);
+
+    case BlackBoxStreamCommand::restart:
+      ESP_RETURN_ON_ERROR(SendResponse(stream, command, BlackBoxStreamStatus::ok), TAG, "response send failed");
+      return blackBox->Restart();
+
+    default:
+      return SendResponse(stream, command, BlackBoxStreamStatus::invalidCommand);
+  }
+}
+
+//==============================================================================
+
+BlackBoxStreamStatus BlackBoxStreamServer::ReadConfiguration(const std::vector<uint8_t>& request, std::vector<uint8_t>& response) {
+  std::unordered_map<std::string, uint32_t> requestGenerations;
+  bool requestValid = BlackBoxStreamProtocol::ForEachRecord(request.data(), request.size(), [&](uint8_t type, const std::string& key, const uint8_t* value, size_t size) {
+    if (type == (uint8_t)BlackBoxConfigurationValueType::u32 && size == sizeof(uint32_t))
+      requestGenerations[key] = BlackBoxStreamProtocol::ReadU32(value);
+  });
+  if (!requestValid)
+    return BlackBoxStreamStatus::invalidData;
+
+  std::vector<uint8_t> generations, sections;
+  uint32_t generationEpoch = blackBox->GetGenerationEpoch();
+  blackBox->ForEachConfiguration([&](BlackBoxConfiguration& configuration) {
+    std::string nvsNamespaceName = configuration.GetNvsNamespaceName();
+    if (nvsNamespaceName.empty())
+      return;
+    // The generation is read before the parameters, so a concurrent change is sent again in the next response.
+    // Generations restart after the reset, so the generations from before it are made different with the generation epoch.
+    uint32_t generation = configuration.GetGeneration();
+    if (generation)
+      generation += generationEpoch;
+    BlackBoxTlvConfigurationStorage generationStorage;
+    generationStorage.Write(nvsNamespaceName, generation);
+    auto generationRecord = generationStorage.GetData();
+    generations.insert(generations.end(), generationRecord.begin(), generationRecord.end());
+
+    auto requestGeneration = requestGenerations.find(nvsNamespaceName);
+    if (generation && requestGeneration != requestGenerations.end() && requestGeneration->second == generation)
+      return;
+    BlackBoxTlvConfigurationStorage parameters;
+    configuration.SaveReadableParameters(parameters);
+    BlackBoxStreamProtocol::AppendSection(sections, nvsNamespaceName, parameters.GetData());
+  });
+
+  if (2 + generations.size() + sections.size() > BlackBoxStreamProtocol::maxPayloadSize - 1)
+    return BlackBoxStreamStatus::tooLarge;
+  response = {(uint8_t)generations.size(), (uint8_t)(generations.size() >> 8)};
+  response.insert(response.end(), generations.begin(), generations.end());
+  response.insert(response.end(), sections.begin(), sections.end());
+  return BlackBoxStreamStatus::ok;
+}
+
+//==============================================================================
+
+BlackBoxStreamStatus BlackBoxStreamServer::WriteConfiguration(const std::vector<uint8_t>& request) {
+  BlackBoxConfigurationProfile profile;
+  if (profile.SetData(request.data(), request.size()) != ESP_OK)
+    return BlackBoxStreamStatus::invalidData;
+
+  // Nothing is applied if some configuration is not found
+  std::vector<std::pair<std::shared_ptr<BlackBoxConfiguration>, std::shared_ptr<BlackBoxTlvConfigurationStorage>>> changes;
+  for (auto& nvsNamespaceName : profile.GetSectionNames()) {
+    auto configuration = blackBox->GetConfiguration(nvsNamespaceName);
+    if (!configuration)
+      return BlackBoxStreamStatus::configurationNotFound;
+    changes.push_back({configuration, profile.GetSection(nvsNamespaceName)});
+  }
+
+  BlackBoxStreamStatus status = BlackBoxStreamStatus::ok;
+  for (auto& change : changes) {
+    change.first->LoadParameters(*change.second);
+
+    // Parameters with invalid values keep their previous values
+    BlackBoxTlvConfigurationStorage resultingParameters;
+    change.first->SaveParameters(resultingParameters);
+    if (!change.second->IsSubsetOf(resultingParameters))
+      status = BlackBoxStreamStatus::valueRejected;
+  }
+  return status;
+}
+
+//==============================================================================
+
+esp_err_t BlackBoxStreamServer::SendResponse(Stream& stream, uint8_t command, BlackBoxStreamStatus status, const std::vector<uint8_t>& payload) {
+  std::vector<uint8_t> responsePayload = {(uint8_t)status};
+  responsePayload.insert(responsePayload.end(), payload.begin(), payload.end());
+  auto frame = BlackBoxStreamProtocol::EncodeFrame(command | BlackBoxStreamProtocol::responseFlag, responsePayload.data(), responsePayload.size());
+  return stream.Write(frame.data(), frame.size());
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
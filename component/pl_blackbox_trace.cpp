@@ -0,0 +1,75 @@
+#include "pl_blackbox_trace.h"
+#include "pl_blackbox_event_recorder.h"
+#include "pl_common.h"
+#include <atomic>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+static std::atomic<BlackBoxTraceHook*> hook = NULL;
+// Tasks that pass the trace points are counted per epoch, so SetHook can wait for the tasks that could still use the previous hook
+static std::atomic<uint32_t> epoch = 0;
+static std::atomic<uint32_t> numberOfEmittingTasks[2] = {0, 0};
+
+//==============================================================================
+
+static Mutex& GetSetHookMutex() {
+  // Created on the first use, so the hook can be set during the static initialization
+  static Mutex setHookMutex;
+  return setHookMutex;
+}
+
+//==============================================================================
+
+BlackBoxTraceHook* BlackBoxTrace::GetHook() {
+  return PL::hook;
+}
+
+//==============================================================================
+
+void BlackBoxTrace::SetHook(BlackBoxTraceHook* hook) {
+  LockGuard lg(GetSetHookMutex());
+  PL::hook = hook;
+
+  // Tasks that started before the epoch change could still use the previous hook
+  uint32_t oldEpochIndex = epoch.fetch_add(1) & 1;
+  while (numberOfEmittingTasks[oldEpochIndex].load())
+    vTaskDelay(1);
+}
+
+//==============================================================================
+
+void BlackBoxTrace::Emit(BlackBoxTracePoint tracePoint, uint16_t code, uint32_t value) {
+  if (!PL::hook.load(std::memory_order_relaxed))
+    return;
+
+  uint32_t epochIndex;
+  while (true) {
+    epochIndex = epoch.load() & 1;
+    numberOfEmittingTasks[epochIndex].fetch_add(1);
+    if ((epoch.load() & 1) == epochIndex)
+      break;
+    numberOfEmittingTasks[epochIndex].fetch_sub(1);
+  }
+  if (BlackBoxTraceHook* hook = PL::hook.load())
+    hook->OnTracePoint(tracePoint, code, value);
+  numberOfEmittingTasks[epochIndex].fetch_sub(1);
+}
+
+//==============================================================================
+
+BlackBoxEventRecorderTraceHook::BlackBoxEventRecorderTraceHook(uint32_t tracePointMask) : tracePointMask(tracePointMask) {}
+
+//==============================================================================
+
+void BlackBoxEventRecorderTraceHook::OnTracePoint(BlackBoxTracePoint tracePoint, uint16_t code, uint32_t value) {
+  if (tracePointMask & GetMaskBit(tracePoint))
+    BlackBoxEventRecorder::Record(BlackBoxEventType::trace, ((uint16_t)tracePoint << 8) | (code & 0xFF), value);
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
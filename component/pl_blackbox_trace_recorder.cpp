@@ -0,0 +1,108 @@
+#include "pl_blackbox_trace_recorder.h"
+#include "pl_blackbox_clock.h"
+#include <algorithm>
+#include <cstring>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+BlackBoxTraceRecorder::BlackBoxTraceRecorder(size_t capacity) : records(std::max<size_t>(capacity, 1)) {}
+
+//==============================================================================
+
+void BlackBoxTraceRecorder::OnTracePoint(BlackBoxTracePoint tracePoint, uint16_t code, uint32_t value) {
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  // The time source can be user-defined, so it is not called in the critical section.
+  // A task can be preempted between reading the time and recording, so the time is clamped to keep the record times from decreasing.
+  int64_t time = BlackBoxClock::GetMonotonicTime();
+  taskENTER_CRITICAL(&spinlock);
+  time = std::max(time, lastRecordTime);
+  lastRecordTime = time;
+  BlackBoxTraceRecord& record = records[numberOfRecordedRecords++ % records.size()];
+  record.time = (uint32_t)time;
+  record.tracePoint = tracePoint;
+  record.taskIndex = GetTaskIndex(task);
+  record.code = code;
+  record.value = value;
+  taskEXIT_CRITICAL(&spinlock);
+}
+
+//==============================================================================
+
+size_t BlackBoxTraceRecorder::GetNumberOfRecords() {
+  taskENTER_CRITICAL(&spinlock);
+  size_t numberOfRecords = std::min<size_t>(numberOfRecordedRecords, records.size());
+  taskEXIT_CRITICAL(&spinlock);
+  return numberOfRecords;
+}
+
+//==============================================================================
+
+void BlackBoxTraceRecorder::Clear() {
+  taskENTER_CRITICAL(&spinlock);
+  numberOfRecordedRecords = 0;
+  numberOfTasks = 0;
+  // The time source could have been changed, so the new records are not clamped to the removed ones
+  lastRecordTime = 0;
+  taskEXIT_CRITICAL(&spinlock);
+}
+
+//==============================================================================
+
+std::vector<uint8_t> BlackBoxTraceRecorder::GetDump() {
+  // The dump is allocated before the critical section for the full task table and ring buffer and is shrunk after it
+  std::vector<uint8_t> dump(sizeof(BlackBoxTraceDumpHeader) + maxNumberOfTasks * taskNameSize + records.size() * sizeof(BlackBoxTraceRecord));
+  BlackBoxTraceDumpHeader header = {};
+  header.signature = dumpSignature;
+  header.version = dumpVersion;
+  header.headerSize = sizeof(BlackBoxTraceDumpHeader);
+  header.recordSize = sizeof(BlackBoxTraceRecord);
+  header.taskNameSize = taskNameSize;
+  int64_t time = BlackBoxClock::GetMonotonicTime();
+
+  taskENTER_CRITICAL(&spinlock);
+  header.numberOfTasks = numberOfTasks;
+  header.numberOfRecords = std::min<size_t>(numberOfRecordedRecords, records.size());
+  header.numberOfLostRecords = numberOfRecordedRecords - header.numberOfRecords;
+  // The record times are extended to 64 bits from the dump time, so it is not earlier than the newest record
+  header.time = std::max(time, lastRecordTime);
+  uint8_t* data = dump.data() + sizeof(BlackBoxTraceDumpHeader);
+  memcpy(data, taskNames, numberOfTasks * taskNameSize);
+  data += numberOfTasks * taskNameSize;
+  // The oldest record is the next one to be overwritten
+  size_t firstRecordIndex = (numberOfRecordedRecords - header.numberOfRecords) % records.size();
+  size_t firstPartSize = std::min<size_t>(header.numberOfRecords, records.size() - firstRecordIndex);
+  memcpy(data, records.data() + firstRecordIndex, firstPartSize * sizeof(BlackBoxTraceRecord));
+  memcpy(data + firstPartSize * sizeof(BlackBoxTraceRecord), records.data(), (header.numberOfRecords - firstPartSize) * sizeof(BlackBoxTraceRecord));
+  taskEXIT_CRITICAL(&spinlock);
+
+  header.utcTime = BlackBoxClock::ToUtcTime(header.time);
+  memcpy(dump.data(), &header, sizeof(BlackBoxTraceDumpHeader));
+  dump.resize(sizeof(BlackBoxTraceDumpHeader) + header.numberOfTasks * taskNameSize + header.numberOfRecords * sizeof(BlackBoxTraceRecord));
+  return dump;
+}
+
+//==============================================================================
+
+uint8_t BlackBoxTraceRecorder::GetTaskIndex(TaskHandle_t task) {
+  for (size_t i = 0; i < numberOfTasks; i++) {
+    if (tasks[i] == task)
+      return i;
+  }
+  if (numberOfTasks == maxNumberOfTasks)
+    return unknownTaskIndex;
+
+  tasks[numberOfTasks] = task;
+  // The names of the deleted tasks are kept until the recorder is cleared
+  memset(taskNames[numberOfTasks], 0, taskNameSize);
+  if (const char* taskName = task ? pcTaskGetName(task) : NULL)
+    strncpy(taskNames[numberOfTasks], taskName, taskNameSize - 1);
+  return numberOfTasks++;
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
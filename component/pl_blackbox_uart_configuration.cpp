@@ -18,45 +18,45 @@ const std::string BlackBoxUartConfiguration::flowControlNvsKey = "flowControl";
 BlackBoxUartConfiguration::BlackBoxUartConfiguration(std::shared_ptr<Uart> uart, std::string nvsNamespaceName) :
     BlackBoxHardwareInterfaceConfiguration(uart, nvsNamespaceName),
     baudRate(uart->GetBaudRate()), dataBits(uart->GetDataBits()), parity(uart->GetParity()), stopBits(uart->GetStopBits()), flowControl(uart->GetFlowControl()),
-    uart(uart) { }
+    uart(uart) {
+  InitializeParameters(baudRate, dataBits, parity, stopBits, flowControl);
+}
 
 
 //==============================================================================
 
-void BlackBoxUartConfiguration::Load() {
+void BlackBoxUartConfiguration::LoadParameters(BlackBoxConfigurationStorage& storage) {
   LockGuard lg(*this);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readOnly);
   uint8_t u8Value;
   uint16_t u16Value;
   uint32_t u32Value;
 
-  if (nvsNamespace.Read(baudRateNvsKey, u32Value) == ESP_OK)
+  if (storage.Read(baudRateNvsKey, u32Value) == ESP_OK)
     baudRate.SetValue(u32Value);
-  if (nvsNamespace.Read(dataBitsNvsKey, u16Value) == ESP_OK)
+  if (storage.Read(dataBitsNvsKey, u16Value) == ESP_OK)
     dataBits.SetValue(u16Value);
-  if (nvsNamespace.Read(parityNvsKey, u8Value) == ESP_OK)
+  if (storage.Read(parityNvsKey, u8Value) == ESP_OK)
     parity.SetValue((UartParity)u8Value);
-  if (nvsNamespace.Read(stopBitsNvsKey, u8Value) == ESP_OK)
+  if (storage.Read(stopBitsNvsKey, u8Value) == ESP_OK)
     stopBits.SetValue((UartStopBits)u8Value);
-  if (nvsNamespace.Read(flowControlNvsKey, u8Value) == ESP_OK)
+  if (storage.Read(flowControlNvsKey, u8Value) == ESP_OK)
     flowControl.SetValue((UartFlowControl)u8Value);
 
-  BlackBoxHardwareInterfaceConfiguration::Load();
+  BlackBoxHardwareInterfaceConfiguration::LoadParameters(storage);
 }
 
 //==============================================================================
 
-void BlackBoxUartConfiguration::Save() {
+void BlackBoxUartConfiguration::SaveParameters(BlackBoxConfigurationStorage& storage) {
   LockGuard lg(*this);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readWrite);
 
-  nvsNamespace.Write(baudRateNvsKey, baudRate.GetValue());
-  nvsNamespace.Write(dataBitsNvsKey, dataBits.GetValue());
-  nvsNamespace.Write(parityNvsKey, (uint8_t)parity.GetValue());
-  nvsNamespace.Write(stopBitsNvsKey, (uint8_t)stopBits.GetValue());
-  nvsNamespace.Write(flowControlNvsKey, (uint8_t)flowControl.GetValue());
+  storage.Write(baudRateNvsKey, baudRate.GetValue());
+  storage.Write(dataBitsNvsKey, dataBits.GetValue());
+  storage.Write(parityNvsKey, (uint8_t)parity.GetValue());
+  storage.Write(stopBitsNvsKey, (uint8_t)stopBits.GetValue());
+  storage.Write(flowControlNvsKey, (uint8_t)flowControl.GetValue());
 
-  return BlackBoxHardwareInterfaceConfiguration::Save();
+  return BlackBoxHardwareInterfaceConfiguration::SaveParameters(storage);
 }
 
 //==============================================================================
@@ -13,33 +13,44 @@ const std::string BlackBoxWiFiStationConfiguration::passwordNvsKey = "wifiPass";
 //==============================================================================
 
 BlackBoxWiFiStationConfiguration::BlackBoxWiFiStationConfiguration(std::shared_ptr<WiFiStation> wifiStation, std::string nvsNamespaceName) :
-    BlackBoxNetworkInterfaceConfiguration(wifiStation, nvsNamespaceName), ssid(wifiStation->GetSsid()), password(wifiStation->GetPassword()), wifiStation(wifiStation) { }
+    BlackBoxNetworkInterfaceConfiguration(wifiStation, nvsNamespaceName), ssid(wifiStation->GetSsid()), password(wifiStation->GetPassword()), wifiStation(wifiStation) {
+  InitializeParameters(ssid, password);
+}
 
 //==============================================================================
 
-void BlackBoxWiFiStationConfiguration::Load() {
+void BlackBoxWiFiStationConfiguration::LoadParameters(BlackBoxConfigurationStorage& storage) {
   LockGuard lg(*this);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readOnly);
   std::string stringValue;
 
-  if (nvsNamespace.Read(ssidNvsKey, stringValue) == ESP_OK)
+  if (storage.Read(ssidNvsKey, stringValue) == ESP_OK)
     ssid.SetValue(stringValue);
-  if (nvsNamespace.Read(passwordNvsKey, stringValue) == ESP_OK)
+  if (storage.Read(passwordNvsKey, stringValue) == ESP_OK)
     password.SetValue(stringValue);
 
-  BlackBoxNetworkInterfaceConfiguration::Load();
+  BlackBoxNetworkInterfaceConfiguration::LoadParameters(storage);
 }
 
 //==============================================================================
 
-void BlackBoxWiFiStationConfiguration::Save() {
+void BlackBoxWiFiStationConfiguration::SaveParameters(BlackBoxConfigurationStorage& storage) {
   LockGuard lg(*this);
-  NvsNamespace nvsNamespace(nvsNamespaceName, NvsAccessMode::readWrite);
 
-  nvsNamespace.Write(ssidNvsKey, ssid.GetValue());
-  nvsNamespace.Write(passwordNvsKey, password.GetValue());
+  storage.Write(ssidNvsKey, ssid.GetValue());
+  storage.Write(passwordNvsKey, password.GetValue());
   
-  BlackBoxNetworkInterfaceConfiguration::Save();
+  BlackBoxNetworkInterfaceConfiguration::SaveParameters(storage);
+}
+
+//==============================================================================
+
+void BlackBoxWiFiStationConfiguration::SaveReadableParameters(BlackBoxConfigurationStorage& storage) {
+  LockGuard lg(*this);
+
+  // The password is write-only
+  storage.Write(ssidNvsKey, ssid.GetValue());
+
+  BlackBoxNetworkInterfaceConfiguration::SaveParameters(storage);
 }
 
 //==============================================================================
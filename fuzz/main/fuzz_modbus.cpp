@@ -0,0 +1,272 @@
+#include "fuzz_modbus.h"
+#include "pl_blackbox.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+//==============================================================================
+
+// libFuzzer reports the abort as a crash with the input that caused it
+#define FUZZ_ASSERT(condition) do { \
+  if (!(condition)) { \
+    fprintf(stderr, "Invariant violated: %s (%s:%d)\n", #condition, __FILE__, __LINE__); \
+    abort(); \
+  } \
+} while (0)
+
+//==============================================================================
+
+class FuzzBlackBox : public PL::BlackBox {
+public:
+  PL::BlackBoxHardwareInfo GetHardwareInfo() override {
+    // The names are longer than the Modbus fields to check the truncation
+    return {"Fuzz Hardware With A Name Longer Than The Field", {1, 2, 3}, "12345678901234567890123456789012345"};
+  }
+
+  PL::BlackBoxFirmwareInfo GetFirmwareInfo() override {
+    return {"Fuzz Firmware With A Name Longer Than The Field", {4, 5, 6}};
+  }
+
+  esp_err_t Restart() override {
+    // The restart command must not stop the fuzzing
+    return ESP_OK;
+  }
+};
+
+//==============================================================================
+
+static const uint8_t stationAddress = 1;
+static const size_t maxPduSize = 253;
+static const size_t mbapHeaderSize = 7;
+static const TickType_t responseTimeout = 100 / portTICK_PERIOD_MS;
+static const std::vector<uint32_t> validBaudRates {9600, 19200, 115200};
+// The addresses are taken from the golden memory map, so the fuzzer uses the layout that the Modbus clients use
+static constexpr uint16_t selectedHardwareInterfaceIndexAddress = PL::GetBlackBoxModbusMemoryMapAddress("generalConfigurationHR", "selectedHardwareInterfaceIndex");
+static constexpr uint16_t selectedServerIndexAddress = PL::GetBlackBoxModbusMemoryMapAddress("generalConfigurationHR", "selectedServerIndex");
+
+static std::shared_ptr<FuzzBlackBox> blackBox = std::make_shared<FuzzBlackBox>();
+static std::shared_ptr<PL::Uart> clientUart = std::make_shared<PL::Uart>(UART_NUM_0);
+static std::shared_ptr<PL::Uart> serverUart = std::make_shared<PL::Uart>(UART_NUM_1);
+static std::shared_ptr<PL::BlackBoxModbusServer> server;
+static std::shared_ptr<PL::ModbusClient> client;
+static uint16_t transactionId = 0;
+
+static std::shared_ptr<PL::BlackBoxUartConfiguration> uartConfiguration;
+static std::shared_ptr<PL::BlackBoxWiFiStationConfiguration> wifiConfiguration;
+static std::shared_ptr<PL::BlackBoxEthernetConfiguration> ethernetConfiguration;
+static std::shared_ptr<PL::BlackBoxModbusServerConfiguration> uartModbusServerConfiguration;
+static std::shared_ptr<PL::BlackBoxModbusServerConfiguration> networkModbusServerConfiguration;
+static std::shared_ptr<PL::BlackBoxSntpConfiguration> sntpConfiguration;
+
+//==============================================================================
+
+static bool IsValidString(const std::string& value, size_t maxSize);
+static void ResetState();
+static void Transact(const uint8_t* pdu, size_t pduSize);
+static void CheckInvariants();
+static void CheckNullTerminated(const uint16_t* registers, const char* area, const char* field);
+
+//==============================================================================
+
+void InitializeBlackBoxModbusFuzzing() {
+  // The configurations are not the ones of the fuzzed server transport, so the fuzzer can enable and disable them
+  uartConfiguration = blackBox->AddUartConfiguration(std::make_shared<PL::Uart>(UART_NUM_2), "fzUart");
+  uartConfiguration->baudRate.SetValidValues(validBaudRates);
+  uartConfiguration->dataBits.SetValueValidator([](uint16_t value) { return value >= 5 && value <= 8; });
+  uartConfiguration->parity.SetValueValidator([](PL::UartParity value) { return value <= PL::UartParity::odd; });
+  uartConfiguration->stopBits.SetValueValidator([](PL::UartStopBits value) { return value <= PL::UartStopBits::two; });
+  uartConfiguration->flowControl.SetValueValidator([](PL::UartFlowControl value) { return value <= PL::UartFlowControl::rtsCts; });
+  uartConfiguration->enabled.DisableValueValidation();
+
+  auto wifi = std::make_shared<PL::EspWiFiStation>();
+  ESP_ERROR_CHECK(wifi->Initialize());
+  wifiConfiguration = blackBox->AddWiFiConfiguration(wifi, "fzWiFi");
+  wifiConfiguration->ssid.SetValueValidator([](std::string value) { return IsValidString(value, PL::BlackBoxModbusServer::maxWiFiSsidSize); });
+  wifiConfiguration->password.SetValueValidator([](std::string value) { return IsValidString(value, PL::BlackBoxModbusServer::maxWiFiPasswordSize); });
+  for (auto parameter : {&wifiConfiguration->ipV4DhcpClientEnabled, &wifiConfiguration->ipV6DhcpClientEnabled, &wifiConfiguration->enabled})
+    parameter->DisableValueValidation();
+  for (auto parameter : {&wifiConfiguration->ipV4Address, &wifiConfiguration->ipV4Netmask, &wifiConfiguration->ipV4Gateway})
+    parameter->DisableValueValidation();
+  wifiConfiguration->ipV6GlobalAddress.DisableValueValidation();
+
+  auto ethernet = std::make_shared<PL::EspEthernet>();
+  ESP_ERROR_CHECK(ethernet->Initialize());
+  ethernetConfiguration = blackBox->AddEthernetConfiguration(ethernet, "fzEth");
+  for (auto parameter : {&ethernetConfiguration->ipV4DhcpClientEnabled, &ethernetConfiguration->ipV6DhcpClientEnabled, &ethernetConfiguration->enabled})
+    parameter->DisableValueValidation();
+
+  auto uartModbusServer = std::make_shared<PL::ModbusServer>(std::make_shared<PL::Uart>(UART_NUM_2), PL::ModbusProtocol::rtu, 1);
+  uartModbusServerConfiguration = blackBox->AddModbusServerConfiguration(uartModbusServer, "fzUartMb");
+  uartModbusServerConfiguration->protocol.SetValueValidator([](PL::ModbusProtocol value) { return value <= PL::ModbusProtocol::tcp; });
+  uartModbusServerConfiguration->stationAddress.SetValueValidator([](uint8_t value) { return value >= 1 && value <= 247; });
+  uartModbusServerConfiguration->enabled.DisableValueValidation();
+
+  auto networkModbusServer = std::make_shared<PL::ModbusServer>(502);
+  networkModbusServerConfiguration = blackBox->AddModbusServerConfiguration(networkModbusServer, "fzNwMb");
+  networkModbusServerConfiguration->port.SetValueValidator([](uint16_t value) { return value != 0; });
+  networkModbusServerConfiguration->maxNumberOfClients.SetValueValidator([](size_t value) { return value >= 1 && value <= 16; });
+  networkModbusServerConfiguration->enabled.DisableValueValidation();
+
+  sntpConfiguration = blackBox->AddSntpConfiguration(std::make_shared<PL::BlackBoxSntpClient>(), "fzSntp");
+  sntpConfiguration->primaryServer.SetValueValidator([](std::string value) { return IsValidString(value, PL::BlackBoxModbusServer::maxSntpServerNameSize); });
+  sntpConfiguration->secondaryServer.SetValueValidator([](std::string value) { return IsValidString(value, PL::BlackBoxModbusServer::maxSntpServerNameSize); });
+  sntpConfiguration->syncInterval.SetValueValidator([](uint32_t value) { return value >= PL::BlackBoxSntpClient::minSyncInterval; });
+  sntpConfiguration->timeZone.SetValueValidator([](std::string value) { return IsValidString(value, PL::BlackBoxModbusServer::maxTimeZoneSize); });
+  // The enabled parameter validation of the SNTP client is not disabled, because the client needs the network
+
+  ESP_ERROR_CHECK(PL::Uart::Connect(*clientUart, *serverUart));
+  ESP_ERROR_CHECK(clientUart->Initialize());
+  ESP_ERROR_CHECK(clientUart->Enable());
+  ESP_ERROR_CHECK(clientUart->SetReadTimeout(responseTimeout));
+  ESP_ERROR_CHECK(serverUart->Initialize());
+  ESP_ERROR_CHECK(serverUart->Enable());
+
+  // The Modbus TCP protocol over the simulated UART has no inter-frame timing, so the requests are not split
+  server = std::make_shared<PL::BlackBoxModbusServer>(blackBox, serverUart, PL::ModbusProtocol::tcp, stationAddress);
+  ESP_ERROR_CHECK(server->Enable());
+  client = std::make_shared<PL::ModbusClient>(clientUart, PL::ModbusProtocol::tcp);
+  ESP_ERROR_CHECK(client->SetStationAddress(stationAddress));
+
+  // Every input starts from the initial parameters (see ResetState)
+  blackBox->SetDefaultProfile(blackBox->CreateProfile());
+}
+
+//==============================================================================
+
+int FuzzBlackBoxModbus(const uint8_t* data, size_t size) {
+  ResetState();
+
+  // The input is a sequence of Modbus PDUs (function code and data), each preceded by its size
+  while (size) {
+    size_t pduSize = std::min<size_t>({data[0], size - 1, maxPduSize});
+    Transact(data + 1, pduSize);
+    data += pduSize + 1;
+    size -= pduSize + 1;
+  }
+
+  CheckInvariants();
+  return 0;
+}
+
+//==============================================================================
+
+static bool IsValidString(const std::string& value, size_t maxSize) {
+  if (value.size() >= maxSize)
+    return false;
+  for (char c : value) {
+    if (c < 32 || c > 126)
+      return false;
+  }
+  return true;
+}
+
+//==============================================================================
+
+static void ResetState() {
+  // Factory reset to the default profile, so the crashes are reproducible from a single input
+  blackBox->EraseAllConfigurations();
+  blackBox->LoadAllConfigurations();
+  FUZZ_ASSERT(client->WriteSingleHoldingRegister(selectedHardwareInterfaceIndexAddress, 0, NULL) == ESP_OK);
+  FUZZ_ASSERT(client->WriteSingleHoldingRegister(selectedServerIndexAddress, 0, NULL) == ESP_OK);
+}
+
+//==============================================================================
+
+static void Transact(const uint8_t* pdu, size_t pduSize) {
+  if (!pduSize)
+    return;
+
+  uint8_t frame[mbapHeaderSize + maxPduSize];
+  transactionId++;
+  frame[0] = transactionId >> 8;
+  frame[1] = transactionId;
+  frame[2] = 0;
+  frame[3] = 0;
+  frame[4] = (pduSize + 1) >> 8;
+  frame[5] = pduSize + 1;
+  frame[6] = stationAddress;
+  memcpy(frame + mbapHeaderSize, pdu, pduSize);
+  // Late responses of the previous requests
+  clientUart->Read(NULL, clientUart->GetReadableSize());
+  FUZZ_ASSERT(clientUart->Write(frame, mbapHeaderSize + pduSize) == ESP_OK);
+
+  // The server does not have to respond to an invalid request, the response is discarded
+  uint8_t responseHeader[mbapHeaderSize];
+  if (clientUart->Read(responseHeader, mbapHeaderSize) != ESP_OK || responseHeader[0] != frame[0] || responseHeader[1] != frame[1])
+    return;
+  size_t responsePduSize = ((responseHeader[4] << 8) | responseHeader[5]) - 1;
+  FUZZ_ASSERT(responsePduSize >= 2 && responsePduSize <= maxPduSize);
+  FUZZ_ASSERT(clientUart->Read(NULL, responsePduSize) == ESP_OK);
+}
+
+//==============================================================================
+
+static void CheckInvariants() {
+  // Late responses of the discarded requests
+  clientUart->Read(NULL, clientUart->GetReadableSize());
+
+  // The names in the memory areas are null-terminated
+  uint16_t registers[PL::BlackBoxModbusServer::registerMemoryAreaSize / 2];
+  const size_t numberOfRegisters = PL::BlackBoxModbusServer::registerMemoryAreaSize / 2;
+  FUZZ_ASSERT(client->ReadHoldingRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress, numberOfRegisters, registers, NULL) == ESP_OK);
+  CheckNullTerminated(registers, "generalConfigurationHR", "name");
+  size_t selectedHardwareInterfaceIndex = registers[selectedHardwareInterfaceIndexAddress - PL::BlackBoxModbusServer::generalConfigurationMemoryAddress];
+  size_t selectedServerIndex = registers[selectedServerIndexAddress - PL::BlackBoxModbusServer::generalConfigurationMemoryAddress];
+  FUZZ_ASSERT(selectedHardwareInterfaceIndex < blackBox->GetNumberOfHardwareInterfaceConfigurations());
+  FUZZ_ASSERT(selectedServerIndex < blackBox->GetNumberOfServerConfigurations());
+
+  FUZZ_ASSERT(client->ReadInputRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress, numberOfRegisters, registers, NULL) == ESP_OK);
+  CheckNullTerminated(registers, "generalConfigurationIR", "hardwareInfo.name");
+  CheckNullTerminated(registers, "generalConfigurationIR", "hardwareInfo.uid");
+  CheckNullTerminated(registers, "generalConfigurationIR", "firmwareInfo.name");
+
+  FUZZ_ASSERT(client->ReadInputRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, numberOfRegisters, registers, NULL) == ESP_OK);
+  CheckNullTerminated(registers, "hardwareInterfaceConfigurationIR", "common.name");
+  if (blackBox->GetHardwareInterfaceConfiguration(selectedHardwareInterfaceIndex) == wifiConfiguration) {
+    FUZZ_ASSERT(client->ReadHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, numberOfRegisters, registers, NULL) == ESP_OK);
+    CheckNullTerminated(registers, "hardwareInterfaceConfigurationHR", "wifi.ssid");
+  }
+
+  FUZZ_ASSERT(client->ReadInputRegisters(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, numberOfRegisters, registers, NULL) == ESP_OK);
+  CheckNullTerminated(registers, "serverConfigurationIR", "common.name");
+  if (blackBox->GetServerConfiguration(selectedServerIndex) == sntpConfiguration) {
+    FUZZ_ASSERT(client->ReadHoldingRegisters(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, numberOfRegisters, registers, NULL) == ESP_OK);
+    CheckNullTerminated(registers, "serverConfigurationHR", "sntpClient.primaryServer");
+    CheckNullTerminated(registers, "serverConfigurationHR", "sntpClient.secondaryServer");
+    CheckNullTerminated(registers, "serverConfigurationHR", "sntpClient.timeZone");
+  }
+
+  // The parameters written by the master satisfy the validators
+  auto deviceName = blackBox->GetDeviceName();
+  FUZZ_ASSERT(deviceName.size() < PL::BlackBoxModbusServer::maxNameSize && strlen(deviceName.c_str()) == deviceName.size());
+  FUZZ_ASSERT(std::find(validBaudRates.begin(), validBaudRates.end(), uartConfiguration->baudRate.GetValue()) != validBaudRates.end());
+  FUZZ_ASSERT(uartConfiguration->dataBits.GetValue() >= 5 && uartConfiguration->dataBits.GetValue() <= 8);
+  FUZZ_ASSERT(uartConfiguration->parity.GetValue() <= PL::UartParity::odd);
+  FUZZ_ASSERT(uartConfiguration->stopBits.GetValue() <= PL::UartStopBits::two);
+  FUZZ_ASSERT(uartConfiguration->flowControl.GetValue() <= PL::UartFlowControl::rtsCts);
+  FUZZ_ASSERT(IsValidString(wifiConfiguration->ssid.GetValue(), PL::BlackBoxModbusServer::maxWiFiSsidSize));
+  FUZZ_ASSERT(IsValidString(wifiConfiguration->password.GetValue(), PL::BlackBoxModbusServer::maxWiFiPasswordSize));
+  FUZZ_ASSERT(uartModbusServerConfiguration->protocol.GetValue() <= PL::ModbusProtocol::tcp);
+  FUZZ_ASSERT(uartModbusServerConfiguration->stationAddress.GetValue() >= 1 && uartModbusServerConfiguration->stationAddress.GetValue() <= 247);
+  FUZZ_ASSERT(networkModbusServerConfiguration->port.GetValue() != 0);
+  FUZZ_ASSERT(networkModbusServerConfiguration->maxNumberOfClients.GetValue() >= 1 && networkModbusServerConfiguration->maxNumberOfClients.GetValue() <= 16);
+  FUZZ_ASSERT(IsValidString(sntpConfiguration->primaryServer.GetValue(), PL::BlackBoxModbusServer::maxSntpServerNameSize));
+  FUZZ_ASSERT(IsValidString(sntpConfiguration->secondaryServer.GetValue(), PL::BlackBoxModbusServer::maxSntpServerNameSize));
+  FUZZ_ASSERT(sntpConfiguration->syncInterval.GetValue() >= PL::BlackBoxSntpClient::minSyncInterval);
+  FUZZ_ASSERT(IsValidString(sntpConfiguration->timeZone.GetValue(), PL::BlackBoxModbusServer::maxTimeZoneSize));
+
+  // The persistent state loads back unchanged
+  auto profileData = blackBox->CreateProfile()->GetData();
+  blackBox->SaveAllConfigurations();
+  blackBox->LoadAllConfigurations();
+  FUZZ_ASSERT(blackBox->CreateProfile()->GetData() == profileData);
+}
+
+//==============================================================================
+
+static void CheckNullTerminated(const uint16_t* registers, const char* area, const char* field) {
+  auto memoryMapField = PL::FindBlackBoxModbusMemoryMapField(area, field);
+  FUZZ_ASSERT(memoryMapField);
+  FUZZ_ASSERT(memchr(registers + memoryMapField->offset / 2, 0, memoryMapField->size) != NULL);
+}
@@ -0,0 +1,8 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+//==============================================================================
+
+void InitializeBlackBoxModbusFuzzing();
+int FuzzBlackBoxModbus(const uint8_t* data, size_t size);
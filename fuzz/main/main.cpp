@@ -0,0 +1,51 @@
+#include "nvs_flash.h"
+#include "esp_event.h"
+#include "fuzz_modbus.h"
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+//==============================================================================
+
+extern "C" int LLVMFuzzerRunDriver(int* argc, char*** argv, int (*callback)(const uint8_t* data, size_t size));
+
+//==============================================================================
+
+extern "C" void app_main(void) {
+  ESP_ERROR_CHECK(esp_event_loop_create_default());
+  // The NVS partition of the host target is emulated in a flash image file
+  esp_err_t err = nvs_flash_init();
+  if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+      ESP_ERROR_CHECK(nvs_flash_erase());
+      err = nvs_flash_init();
+  }
+  ESP_ERROR_CHECK(err);
+
+  InitializeBlackBoxModbusFuzzing();
+
+  // app_main has no arguments, so the libFuzzer options are taken from the process command line
+  std::ifstream commandLineFile("/proc/self/cmdline", std::ios::binary);
+  std::string commandLine((std::istreambuf_iterator<char>(commandLineFile)), std::istreambuf_iterator<char>());
+  std::vector<std::string> arguments;
+  for (size_t start = 0; start < commandLine.size();) {
+    size_t end = commandLine.find('\0', start);
+    if (end == std::string::npos)
+      end = commandLine.size();
+    arguments.push_back(commandLine.substr(start, end - start));
+    start = end + 1;
+  }
+  if (arguments.empty())
+    arguments.push_back("pl_blackbox_fuzz");
+  // The FreeRTOS port of the host target uses SIGALRM for the tick, so the libFuzzer timeout (also SIGALRM) is disabled by default
+  arguments.insert(arguments.begin() + 1, "-timeout=0");
+
+  std::vector<char*> argv;
+  for (auto& argument : arguments)
+    argv.push_back(argument.data());
+  argv.push_back(NULL);
+  int argc = arguments.size();
+  char** argvData = argv.data();
+  exit(LLVMFuzzerRunDriver(&argc, &argvData, FuzzBlackBoxModbus));
+}
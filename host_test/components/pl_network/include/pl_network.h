@@ -0,0 +1,425 @@
+#pragma once
+#include "pl_common.h"
+#include "freertos/stream_buffer.h"
+#include <atomic>
+#include <list>
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief IPv4 address
+union IpV4Address {
+  /// @brief Creates an empty IPv4 address
+  IpV4Address();
+  /// @brief Creates an IPv4 address from a 32-bit value in the network byte order
+  /// @param u32 32-bit value
+  IpV4Address(uint32_t u32);
+  /// @brief Creates an IPv4 address from the octets
+  IpV4Address(uint8_t u8_0, uint8_t u8_1, uint8_t u8_2, uint8_t u8_3);
+
+  /// @brief Converts the address to a string
+  /// @return string
+  std::string ToString() const;
+
+  bool operator==(const IpV4Address& address) const;
+  bool operator!=(const IpV4Address& address) const;
+
+  uint32_t u32;
+  uint8_t u8[4];
+};
+
+//==============================================================================
+
+/// @brief IPv6 address
+union IpV6Address {
+  /// @brief Creates an empty IPv6 address
+  IpV6Address();
+  /// @brief Creates an IPv6 address from the 32-bit values in the network byte order
+  IpV6Address(uint32_t u32_0, uint32_t u32_1, uint32_t u32_2, uint32_t u32_3);
+
+  /// @brief Converts the address to a string
+  /// @return string
+  std::string ToString() const;
+
+  bool operator==(const IpV6Address& address) const;
+  bool operator!=(const IpV6Address& address) const;
+
+  uint32_t u32[4];
+  uint16_t u16[8];
+  uint8_t u8[16];
+};
+
+//==============================================================================
+
+/// @brief Simulated network interface of the host (Linux) target
+/// @details The network interface is connected while it is enabled and can connect. The DHCP client gets the simulated lease
+/// and the static addresses are kept as they are set. Connect and Disconnect simulate the link changes.
+class NetworkInterface : public HardwareInterface {
+public:
+  /// @brief Simulated DHCP lease IPv4 address
+  static const IpV4Address simulatedDhcpIpV4Address;
+  /// @brief Simulated DHCP lease IPv4 netmask
+  static const IpV4Address simulatedDhcpIpV4Netmask;
+  /// @brief Simulated DHCP lease IPv4 gateway
+  static const IpV4Address simulatedDhcpIpV4Gateway;
+
+  /// @brief Connected event
+  Event<NetworkInterface> connectedEvent;
+  /// @brief Disconnected event
+  Event<NetworkInterface> disconnectedEvent;
+  /// @brief IPv4 address received event
+  Event<NetworkInterface> gotIpV4AddressEvent;
+  /// @brief IPv6 address received event
+  Event<NetworkInterface> gotIpV6AddressEvent;
+
+  /// @brief Creates a simulated network interface
+  /// @param name network interface name
+  NetworkInterface(const std::string& name);
+  NetworkInterface(const NetworkInterface&) = delete;
+  NetworkInterface& operator=(const NetworkInterface&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+  esp_err_t Initialize() override;
+  esp_err_t Enable() override;
+  esp_err_t Disable() override;
+  bool IsEnabled() override;
+
+  /// @brief Checks if the network interface is connected
+  /// @return true if the network interface is connected
+  virtual bool IsConnected();
+
+  /// @brief Checks if the IPv4 DHCP client is enabled
+  /// @return true if the IPv4 DHCP client is enabled
+  virtual bool IsIpV4DhcpClientEnabled();
+
+  /// @brief Enables the IPv4 DHCP client
+  /// @return error code
+  virtual esp_err_t EnableIpV4DhcpClient();
+
+  /// @brief Disables the IPv4 DHCP client
+  /// @return error code
+  virtual esp_err_t DisableIpV4DhcpClient();
+
+  /// @brief Gets the IPv4 address
+  /// @return IPv4 address
+  virtual IpV4Address GetIpV4Address();
+
+  /// @brief Sets the static IPv4 address
+  /// @param address IPv4 address
+  /// @return error code
+  virtual esp_err_t SetIpV4Address(IpV4Address address);
+
+  /// @brief Gets the IPv4 netmask
+  /// @return IPv4 netmask
+  virtual IpV4Address GetIpV4Netmask();
+
+  /// @brief Sets the static IPv4 netmask
+  /// @param netmask IPv4 netmask
+  /// @return error code
+  virtual esp_err_t SetIpV4Netmask(IpV4Address netmask);
+
+  /// @brief Gets the IPv4 gateway
+  /// @return IPv4 gateway
+  virtual IpV4Address GetIpV4Gateway();
+
+  /// @brief Sets the static IPv4 gateway
+  /// @param gateway IPv4 gateway
+  /// @return error code
+  virtual esp_err_t SetIpV4Gateway(IpV4Address gateway);
+
+  /// @brief Checks if the IPv6 DHCP client is enabled
+  /// @return true if the IPv6 DHCP client is enabled
+  virtual bool IsIpV6DhcpClientEnabled();
+
+  /// @brief Enables the IPv6 DHCP client
+  /// @return error code
+  virtual esp_err_t EnableIpV6DhcpClient();
+
+  /// @brief Disables the IPv6 DHCP client
+  /// @return error code
+  virtual esp_err_t DisableIpV6DhcpClient();
+
+  /// @brief Gets the IPv6 link-local address
+  /// @return IPv6 link-local address (empty if the network interface is not connected)
+  virtual IpV6Address GetIpV6LinkLocalAddress();
+
+  /// @brief Gets the IPv6 global address
+  /// @return IPv6 global address
+  virtual IpV6Address GetIpV6GlobalAddress();
+
+  /// @brief Sets the static IPv6 global address
+  /// @param address IPv6 global address
+  /// @return error code
+  virtual esp_err_t SetIpV6GlobalAddress(IpV6Address address);
+
+  /// @brief Simulates the link connection
+  /// @return error code
+  esp_err_t Connect();
+
+  /// @brief Simulates the link disconnection
+  /// @return error code
+  esp_err_t Disconnect();
+
+protected:
+  /// @brief Checks if the network interface can connect
+  /// @return true if the network interface can connect
+  virtual bool CanConnect();
+
+  /// @brief Reconnects the network interface after a connection parameter is changed
+  /// @return error code
+  esp_err_t Reconnect();
+
+private:
+  Mutex mutex;
+  bool enabled = false;
+  bool connected = false;
+  bool ipV4DhcpClientEnabled = true;
+  bool ipV6DhcpClientEnabled = false;
+  IpV4Address ipV4Address;
+  IpV4Address ipV4Netmask;
+  IpV4Address ipV4Gateway;
+  IpV6Address ipV6GlobalAddress;
+};
+
+//==============================================================================
+
+/// @brief Simulated Ethernet of the host (Linux) target
+class Ethernet : public NetworkInterface {
+public:
+  /// @brief Default name
+  static const std::string defaultName;
+
+  /// @brief Creates a simulated Ethernet
+  Ethernet();
+};
+
+//==============================================================================
+
+/// @brief Simulated ESP Ethernet of the host (Linux) target
+class EspEthernet : public Ethernet {};
+
+//==============================================================================
+
+/// @brief Simulated Wi-Fi station of the host (Linux) target that can connect to any access point with a non-empty SSID
+class WiFiStation : public NetworkInterface {
+public:
+  /// @brief Default name
+  static const std::string defaultName;
+
+  /// @brief Creates a simulated Wi-Fi station
+  WiFiStation();
+
+  /// @brief Gets the SSID
+  /// @return SSID
+  virtual std::string GetSsid();
+
+  /// @brief Sets the SSID
+  /// @param ssid SSID
+  /// @return error code
+  virtual esp_err_t SetSsid(const std::string& ssid);
+
+  /// @brief Gets the password
+  /// @return password
+  virtual std::string GetPassword();
+
+  /// @brief Sets the password
+  /// @param password password
+  /// @return error code
+  virtual esp_err_t SetPassword(const std::string& password);
+
+protected:
+  bool CanConnect() override;
+
+private:
+  std::string ssid;
+  std::string password;
+};
+
+//==============================================================================
+
+/// @brief Simulated ESP Wi-Fi station of the host (Linux) target
+class EspWiFiStation : public WiFiStation {};
+
+//==============================================================================
+
+/// @brief In-memory network stream of the host (Linux) target connected to the network stream of the other side
+class NetworkStream : public Stream {
+public:
+  /// @brief Default read timeout
+  static const TickType_t defaultReadTimeout = 300 / portTICK_PERIOD_MS;
+  /// @brief Stream buffer size of each direction
+  static const size_t bufferSize = 4096;
+
+  /// @brief Creates a pair of connected network streams
+  /// @param stream1 stream 1
+  /// @param stream2 stream 2
+  /// @return error code
+  static esp_err_t CreatePair(std::shared_ptr<NetworkStream>& stream1, std::shared_ptr<NetworkStream>& stream2);
+
+  NetworkStream(const NetworkStream&) = delete;
+  NetworkStream& operator=(const NetworkStream&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+  esp_err_t Read(void* dest, size_t size) override;
+  esp_err_t Read(Buffer& dest, size_t offset, size_t size) override;
+  esp_err_t Write(const void* src, size_t size) override;
+  esp_err_t Write(Buffer& src, size_t offset, size_t size) override;
+  TickType_t GetReadTimeout() override;
+  esp_err_t SetReadTimeout(TickType_t timeout) override;
+  size_t GetReadableSize() override;
+
+  /// @brief Checks if the stream is open
+  /// @return true if both sides of the stream are open
+  bool IsOpen();
+
+  /// @brief Closes both sides of the stream
+  void Close();
+
+private:
+  struct Connection {
+    ~Connection();
+    StreamBufferHandle_t buffers[2] = {};
+    std::atomic<bool> open = true;
+  };
+
+  Mutex mutex;
+  std::shared_ptr<Connection> connection;
+  StreamBufferHandle_t readBuffer;
+  StreamBufferHandle_t writeBuffer;
+  TickType_t readTimeout = defaultReadTimeout;
+
+  NetworkStream(std::shared_ptr<Connection> connection, int side);
+};
+
+//==============================================================================
+
+/// @brief Network server
+class NetworkServer : public Server {
+public:
+  /// @brief Creates a network server
+  /// @param name server name
+  NetworkServer(const std::string& name) : Server(name) {}
+
+  /// @brief Gets the port
+  /// @return port
+  virtual uint16_t GetPort() = 0;
+
+  /// @brief Sets the port
+  /// @param port port
+  /// @return error code
+  virtual esp_err_t SetPort(uint16_t port) = 0;
+
+  /// @brief Gets the maximum number of clients
+  /// @return maximum number of clients
+  virtual size_t GetMaxNumberOfClients() = 0;
+
+  /// @brief Sets the maximum number of clients
+  /// @param maxNumberOfClients maximum number of clients
+  /// @return error code
+  virtual esp_err_t SetMaxNumberOfClients(size_t maxNumberOfClients) = 0;
+};
+
+//==============================================================================
+
+/// @brief In-memory TCP server of the host (Linux) target
+/// @details The enabled servers are reachable by the TCP clients of the same process at any address.
+/// Every client connection is handled by a separate task that calls HandleRequest when the client data is received.
+class TcpServer : public NetworkServer {
+public:
+  /// @brief Default maximum number of clients
+  static const size_t defaultMaxNumberOfClients = 5;
+  /// @brief Client task stack depth
+  static const uint32_t clientTaskStackDepth = 4096;
+
+  /// @brief Creates an in-memory TCP server
+  /// @param port port
+  TcpServer(uint16_t port);
+  ~TcpServer();
+  TcpServer(const TcpServer&) = delete;
+  TcpServer& operator=(const TcpServer&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+  esp_err_t Enable() override;
+  esp_err_t Disable() override;
+  bool IsEnabled() override;
+  uint16_t GetPort() override;
+  esp_err_t SetPort(uint16_t port) override;
+  size_t GetMaxNumberOfClients() override;
+  esp_err_t SetMaxNumberOfClients(size_t maxNumberOfClients) override;
+
+protected:
+  /// @brief Handles the client request
+  /// @param clientStream client stream
+  /// @return error code (the client is disconnected if the error code is not ESP_OK)
+  virtual esp_err_t HandleRequest(NetworkStream& clientStream) = 0;
+
+private:
+  friend class TcpClient;
+
+  Mutex mutex;
+  bool enabled = false;
+  uint16_t port;
+  size_t maxNumberOfClients = defaultMaxNumberOfClients;
+  std::list<std::shared_ptr<NetworkStream>> clientStreams;
+  std::atomic<size_t> numberOfClientTasks = 0;
+
+  esp_err_t Accept(std::shared_ptr<NetworkStream> clientStream);
+  static void ClientTask(void* parameters);
+};
+
+//==============================================================================
+
+/// @brief In-memory TCP client of the host (Linux) target
+class TcpClient : public Lockable {
+public:
+  /// @brief Creates an in-memory TCP client
+  /// @param address server address (the in-memory servers are reachable at any address)
+  /// @param port server port
+  TcpClient(IpV4Address address, uint16_t port);
+  ~TcpClient();
+  TcpClient(const TcpClient&) = delete;
+  TcpClient& operator=(const TcpClient&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+
+  /// @brief Connects to the server
+  /// @return error code
+  esp_err_t Connect();
+
+  /// @brief Disconnects from the server
+  /// @return error code
+  esp_err_t Disconnect();
+
+  /// @brief Checks if the client is connected
+  /// @return true if the client is connected
+  bool IsConnected();
+
+  /// @brief Gets the client stream
+  /// @return client stream (nullptr if the client is not connected)
+  std::shared_ptr<NetworkStream> GetStream();
+
+  /// @brief Gets the server address
+  /// @return server address
+  IpV4Address GetAddress();
+
+  /// @brief Gets the server port
+  /// @return server port
+  uint16_t GetPort();
+
+private:
+  Mutex mutex;
+  IpV4Address address;
+  uint16_t port;
+  std::shared_ptr<NetworkStream> stream;
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
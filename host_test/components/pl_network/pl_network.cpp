@@ -0,0 +1,738 @@
+#include "pl_network.h"
+#include "esp_check.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+//==============================================================================
+
+static const char* TAG = "pl_network";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+// Enabled in-memory TCP servers by port
+static Mutex tcpServerMutex;
+static std::map<uint16_t, TcpServer*> tcpServers;
+
+//==============================================================================
+
+IpV4Address::IpV4Address() : u32(0) {}
+
+//==============================================================================
+
+IpV4Address::IpV4Address(uint32_t u32) : u32(u32) {}
+
+//==============================================================================
+
+IpV4Address::IpV4Address(uint8_t u8_0, uint8_t u8_1, uint8_t u8_2, uint8_t u8_3) : u8{u8_0, u8_1, u8_2, u8_3} {}
+
+//==============================================================================
+
+std::string IpV4Address::ToString() const {
+  return std::to_string(u8[0]) + "." + std::to_string(u8[1]) + "." + std::to_string(u8[2]) + "." + std::to_string(u8[3]);
+}
+
+//==============================================================================
+
+bool IpV4Address::operator==(const IpV4Address& address) const {
+  return u32 == address.u32;
+}
+
+//==============================================================================
+
+bool IpV4Address::operator!=(const IpV4Address& address) const {
+  return u32 != address.u32;
+}
+
+//==============================================================================
+
+IpV6Address::IpV6Address() : u32{0, 0, 0, 0} {}
+
+//==============================================================================
+
+IpV6Address::IpV6Address(uint32_t u32_0, uint32_t u32_1, uint32_t u32_2, uint32_t u32_3) : u32{u32_0, u32_1, u32_2, u32_3} {}
+
+//==============================================================================
+
+std::string IpV6Address::ToString() const {
+  char string[40];
+  snprintf(string, sizeof(string), "%x:%x:%x:%x:%x:%x:%x:%x", (u8[0] << 8) | u8[1], (u8[2] << 8) | u8[3], (u8[4] << 8) | u8[5],
+    (u8[6] << 8) | u8[7], (u8[8] << 8) | u8[9], (u8[10] << 8) | u8[11], (u8[12] << 8) | u8[13], (u8[14] << 8) | u8[15]);
+  return string;
+}
+
+//==============================================================================
+
+bool IpV6Address::operator==(const IpV6Address& address) const {
+  return !memcmp(u32, address.u32, sizeof(u32));
+}
+
+//==============================================================================
+
+bool IpV6Address::operator!=(const IpV6Address& address) const {
+  return !(*this == address);
+}
+
+//==============================================================================
+
+const IpV4Address NetworkInterface::simulatedDhcpIpV4Address(192, 168, 0, 100);
+const IpV4Address NetworkInterface::simulatedDhcpIpV4Netmask(255, 255, 255, 0);
+const IpV4Address NetworkInterface::simulatedDhcpIpV4Gateway(192, 168, 0, 1);
+
+//==============================================================================
+
+NetworkInterface::NetworkInterface(const std::string& name) : HardwareInterface(name),
+  connectedEvent(*this), disconnectedEvent(*this), gotIpV4AddressEvent(*this), gotIpV6AddressEvent(*this) {}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::Initialize() {
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::Enable() {
+  LockGuard lg(*this);
+  if (enabled)
+    return ESP_OK;
+  enabled = true;
+  enabledEvent.Generate();
+  if (CanConnect())
+    ESP_RETURN_ON_ERROR(Connect(), TAG, "connect failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::Disable() {
+  LockGuard lg(*this);
+  if (!enabled)
+    return ESP_OK;
+  ESP_RETURN_ON_ERROR(Disconnect(), TAG, "disconnect failed");
+  enabled = false;
+  disabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool NetworkInterface::IsEnabled() {
+  LockGuard lg(*this);
+  return enabled;
+}
+
+//==============================================================================
+
+bool NetworkInterface::IsConnected() {
+  LockGuard lg(*this);
+  return connected;
+}
+
+//==============================================================================
+
+bool NetworkInterface::IsIpV4DhcpClientEnabled() {
+  LockGuard lg(*this);
+  return ipV4DhcpClientEnabled;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::EnableIpV4DhcpClient() {
+  LockGuard lg(*this);
+  if (ipV4DhcpClientEnabled)
+    return ESP_OK;
+  ipV4DhcpClientEnabled = true;
+  if (connected)
+    gotIpV4AddressEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::DisableIpV4DhcpClient() {
+  LockGuard lg(*this);
+  ipV4DhcpClientEnabled = false;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+IpV4Address NetworkInterface::GetIpV4Address() {
+  LockGuard lg(*this);
+  return (ipV4DhcpClientEnabled && connected) ? simulatedDhcpIpV4Address : ipV4Address;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::SetIpV4Address(IpV4Address address) {
+  LockGuard lg(*this);
+  ipV4Address = address;
+  if (!ipV4DhcpClientEnabled && connected && address.u32)
+    gotIpV4AddressEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+IpV4Address NetworkInterface::GetIpV4Netmask() {
+  LockGuard lg(*this);
+  return (ipV4DhcpClientEnabled && connected) ? simulatedDhcpIpV4Netmask : ipV4Netmask;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::SetIpV4Netmask(IpV4Address netmask) {
+  LockGuard lg(*this);
+  ipV4Netmask = netmask;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+IpV4Address NetworkInterface::GetIpV4Gateway() {
+  LockGuard lg(*this);
+  return (ipV4DhcpClientEnabled && connected) ? simulatedDhcpIpV4Gateway : ipV4Gateway;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::SetIpV4Gateway(IpV4Address gateway) {
+  LockGuard lg(*this);
+  ipV4Gateway = gateway;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool NetworkInterface::IsIpV6DhcpClientEnabled() {
+  LockGuard lg(*this);
+  return ipV6DhcpClientEnabled;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::EnableIpV6DhcpClient() {
+  LockGuard lg(*this);
+  ipV6DhcpClientEnabled = true;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::DisableIpV6DhcpClient() {
+  LockGuard lg(*this);
+  ipV6DhcpClientEnabled = false;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+IpV6Address NetworkInterface::GetIpV6LinkLocalAddress() {
+  LockGuard lg(*this);
+  // fe80::1 in the network byte order
+  return connected ? IpV6Address(0x000080fe, 0, 0, 0x01000000) : IpV6Address();
+}
+
+//==============================================================================
+
+IpV6Address NetworkInterface::GetIpV6GlobalAddress() {
+  LockGuard lg(*this);
+  return ipV6GlobalAddress;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::SetIpV6GlobalAddress(IpV6Address address) {
+  LockGuard lg(*this);
+  ipV6GlobalAddress = address;
+  if (connected && address != IpV6Address())
+    gotIpV6AddressEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::Connect() {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(enabled, ESP_ERR_INVALID_STATE, TAG, "network interface is not enabled");
+  if (connected)
+    return ESP_OK;
+  connected = true;
+  connectedEvent.Generate();
+  if (ipV4DhcpClientEnabled || ipV4Address.u32)
+    gotIpV4AddressEvent.Generate();
+  gotIpV6AddressEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::Disconnect() {
+  LockGuard lg(*this);
+  if (!connected)
+    return ESP_OK;
+  connected = false;
+  disconnectedEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool NetworkInterface::CanConnect() {
+  return true;
+}
+
+//==============================================================================
+
+esp_err_t NetworkInterface::Reconnect() {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_ERROR(Disconnect(), TAG, "disconnect failed");
+  if (enabled && CanConnect())
+    ESP_RETURN_ON_ERROR(Connect(), TAG, "connect failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+const std::string Ethernet::defaultName = "Ethernet";
+
+//==============================================================================
+
+Ethernet::Ethernet() : NetworkInterface(defaultName) {}
+
+//==============================================================================
+
+const std::string WiFiStation::defaultName = "Wi-Fi Station";
+
+//==============================================================================
+
+WiFiStation::WiFiStation() : NetworkInterface(defaultName) {}
+
+//==============================================================================
+
+std::string WiFiStation::GetSsid() {
+  LockGuard lg(*this);
+  return ssid;
+}
+
+//==============================================================================
+
+esp_err_t WiFiStation::SetSsid(const std::string& ssid) {
+  LockGuard lg(*this);
+  if (this->ssid == ssid)
+    return ESP_OK;
+  this->ssid = ssid;
+  return Reconnect();
+}
+
+//==============================================================================
+
+std::string WiFiStation::GetPassword() {
+  LockGuard lg(*this);
+  return password;
+}
+
+//==============================================================================
+
+esp_err_t WiFiStation::SetPassword(const std::string& password) {
+  LockGuard lg(*this);
+  if (this->password == password)
+    return ESP_OK;
+  this->password = password;
+  return Reconnect();
+}
+
+//==============================================================================
+
+bool WiFiStation::CanConnect() {
+  return !ssid.empty();
+}
+
+//==============================================================================
+
+NetworkStream::Connection::~Connection() {
+  for (auto buffer : buffers) {
+    if (buffer)
+      vStreamBufferDelete(buffer);
+  }
+}
+
+//==============================================================================
+
+esp_err_t NetworkStream::CreatePair(std::shared_ptr<NetworkStream>& stream1, std::shared_ptr<NetworkStream>& stream2) {
+  auto connection = std::make_shared<Connection>();
+  for (auto& buffer : connection->buffers) {
+    buffer = xStreamBufferCreate(bufferSize, 1);
+    ESP_RETURN_ON_FALSE(buffer, ESP_ERR_NO_MEM, TAG, "stream buffer create failed");
+  }
+  stream1 = std::shared_ptr<NetworkStream>(new NetworkStream(connection, 0));
+  stream2 = std::shared_ptr<NetworkStream>(new NetworkStream(connection, 1));
+  return ESP_OK;
+}
+
+//==============================================================================
+
+NetworkStream::NetworkStream(std::shared_ptr<Connection> connection, int side) :
+  connection(connection), readBuffer(connection->buffers[side]), writeBuffer(connection->buffers[1 - side]) {}
+
+//==============================================================================
+
+esp_err_t NetworkStream::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkStream::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkStream::Read(void* dest, size_t size) {
+  LockGuard lg(*this);
+  uint8_t discardedData[64];
+  TimeOut_t timeOut;
+  vTaskSetTimeOutState(&timeOut);
+  TickType_t remainingTime = readTimeout;
+  while (size) {
+    // The data received before the stream is closed can still be read
+    ESP_RETURN_ON_FALSE(connection->open || xStreamBufferBytesAvailable(readBuffer), ESP_FAIL, TAG, "stream is closed");
+    size_t receiveSize = dest ? size : std::min(size, sizeof(discardedData));
+    size_t receivedSize = xStreamBufferReceive(readBuffer, dest ? dest : discardedData, receiveSize, std::min<TickType_t>(remainingTime, 1));
+    size -= receivedSize;
+    if (dest)
+      dest = (uint8_t*)dest + receivedSize;
+    if (size && xTaskCheckForTimeOut(&timeOut, &remainingTime) == pdTRUE)
+      return ESP_ERR_TIMEOUT;
+  }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkStream::Read(Buffer& dest, size_t offset, size_t size) {
+  LockGuard lg(*this, dest);
+  ESP_RETURN_ON_FALSE(offset + size <= dest.size, ESP_ERR_INVALID_SIZE, TAG, "invalid size");
+  return Read((uint8_t*)dest.data + offset, size);
+}
+
+//==============================================================================
+
+esp_err_t NetworkStream::Write(const void* src, size_t size) {
+  LockGuard lg(*this);
+  while (size) {
+    ESP_RETURN_ON_FALSE(connection->open, ESP_FAIL, TAG, "stream is closed");
+    size_t sentSize = xStreamBufferSend(writeBuffer, src, size, 1);
+    size -= sentSize;
+    src = (const uint8_t*)src + sentSize;
+  }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t NetworkStream::Write(Buffer& src, size_t offset, size_t size) {
+  LockGuard lg(*this, src);
+  ESP_RETURN_ON_FALSE(offset + size <= src.size, ESP_ERR_INVALID_SIZE, TAG, "invalid size");
+  return Write((uint8_t*)src.data + offset, size);
+}
+
+//==============================================================================
+
+TickType_t NetworkStream::GetReadTimeout() {
+  LockGuard lg(*this);
+  return readTimeout;
+}
+
+//==============================================================================
+
+esp_err_t NetworkStream::SetReadTimeout(TickType_t timeout) {
+  LockGuard lg(*this);
+  readTimeout = timeout;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+size_t NetworkStream::GetReadableSize() {
+  return xStreamBufferBytesAvailable(readBuffer);
+}
+
+//==============================================================================
+
+bool NetworkStream::IsOpen() {
+  return connection->open;
+}
+
+//==============================================================================
+
+void NetworkStream::Close() {
+  connection->open = false;
+}
+
+//==============================================================================
+
+TcpServer::TcpServer(uint16_t port) : NetworkServer("tcp_server"), port(port) {}
+
+//==============================================================================
+
+TcpServer::~TcpServer() {
+  Disable();
+  while (numberOfClientTasks)
+    vTaskDelay(1);
+}
+
+//==============================================================================
+
+esp_err_t TcpServer::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t TcpServer::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t TcpServer::Enable() {
+  LockGuard lg(tcpServerMutex, *this);
+  if (enabled)
+    return ESP_OK;
+  ESP_RETURN_ON_FALSE(!tcpServers.count(port), ESP_ERR_INVALID_STATE, TAG, "port %d is in use", port);
+  tcpServers[port] = this;
+  enabled = true;
+  enabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t TcpServer::Disable() {
+  LockGuard lg(tcpServerMutex, *this);
+  if (!enabled)
+    return ESP_OK;
+  tcpServers.erase(port);
+  // The client tasks exit when their streams are closed
+  for (auto& clientStream : clientStreams)
+    clientStream->Close();
+  clientStreams.clear();
+  enabled = false;
+  disabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool TcpServer::IsEnabled() {
+  LockGuard lg(*this);
+  return enabled;
+}
+
+//==============================================================================
+
+uint16_t TcpServer::GetPort() {
+  LockGuard lg(*this);
+  return port;
+}
+
+//==============================================================================
+
+esp_err_t TcpServer::SetPort(uint16_t port) {
+  LockGuard lg(tcpServerMutex, *this);
+  if (this->port == port)
+    return ESP_OK;
+  bool wasEnabled = enabled;
+  ESP_RETURN_ON_ERROR(Disable(), TAG, "disable failed");
+  this->port = port;
+  if (wasEnabled)
+    ESP_RETURN_ON_ERROR(Enable(), TAG, "enable failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+size_t TcpServer::GetMaxNumberOfClients() {
+  LockGuard lg(*this);
+  return maxNumberOfClients;
+}
+
+//==============================================================================
+
+esp_err_t TcpServer::SetMaxNumberOfClients(size_t maxNumberOfClients) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(maxNumberOfClients, ESP_ERR_INVALID_ARG, TAG, "invalid maximum number of clients");
+  this->maxNumberOfClients = maxNumberOfClients;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t TcpServer::Accept(std::shared_ptr<NetworkStream> clientStream) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(enabled, ESP_ERR_INVALID_STATE, TAG, "server is not enabled");
+  clientStreams.remove_if([](std::shared_ptr<NetworkStream>& stream) { return !stream->IsOpen(); });
+  ESP_RETURN_ON_FALSE(clientStreams.size() < maxNumberOfClients, ESP_ERR_NOT_FINISHED, TAG, "maximum number of clients reached");
+
+  auto taskParameters = new std::pair<TcpServer*, std::shared_ptr<NetworkStream>>(this, clientStream);
+  numberOfClientTasks++;
+  if (xTaskCreate(ClientTask, "pl_tcp_client", clientTaskStackDepth, taskParameters, tskIDLE_PRIORITY + 1, NULL) != pdPASS) {
+    numberOfClientTasks--;
+    delete taskParameters;
+    ESP_RETURN_ON_ERROR(ESP_ERR_NO_MEM, TAG, "client task create failed");
+  }
+  clientStreams.push_back(clientStream);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+void TcpServer::ClientTask(void* parameters) {
+  auto taskParameters = (std::pair<TcpServer*, std::shared_ptr<NetworkStream>>*)parameters;
+  TcpServer& server = *taskParameters->first;
+  std::shared_ptr<NetworkStream> clientStream = taskParameters->second;
+  delete taskParameters;
+
+  while (clientStream->IsOpen()) {
+    if (!clientStream->GetReadableSize()) {
+      vTaskDelay(1);
+      continue;
+    }
+    if (server.HandleRequest(*clientStream) != ESP_OK)
+      clientStream->Close();
+  }
+
+  clientStream.reset();
+  server.numberOfClientTasks--;
+  vTaskDelete(NULL);
+}
+
+//==============================================================================
+
+TcpClient::TcpClient(IpV4Address address, uint16_t port) : address(address), port(port) {}
+
+//==============================================================================
+
+TcpClient::~TcpClient() {
+  Disconnect();
+}
+
+//==============================================================================
+
+esp_err_t TcpClient::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t TcpClient::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t TcpClient::Connect() {
+  LockGuard lg(*this);
+  if (stream && stream->IsOpen())
+    return ESP_OK;
+  stream.reset();
+
+  std::shared_ptr<NetworkStream> clientStream;
+  std::shared_ptr<NetworkStream> serverStream;
+  ESP_RETURN_ON_ERROR(NetworkStream::CreatePair(clientStream, serverStream), TAG, "stream create failed");
+  {
+    LockGuard lg(tcpServerMutex);
+    auto tcpServerIterator = tcpServers.find(port);
+    ESP_RETURN_ON_FALSE(tcpServerIterator != tcpServers.end(), ESP_ERR_NOT_FOUND, TAG, "connection refused");
+    ESP_RETURN_ON_ERROR(tcpServerIterator->second->Accept(serverStream), TAG, "connection refused");
+  }
+  stream = clientStream;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t TcpClient::Disconnect() {
+  LockGuard lg(*this);
+  if (stream)
+    stream->Close();
+  stream.reset();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool TcpClient::IsConnected() {
+  LockGuard lg(*this);
+  return stream && stream->IsOpen();
+}
+
+//==============================================================================
+
+std::shared_ptr<NetworkStream> TcpClient::GetStream() {
+  LockGuard lg(*this);
+  return IsConnected() ? stream : nullptr;
+}
+
+//==============================================================================
+
+IpV4Address TcpClient::GetAddress() {
+  return address;
+}
+
+//==============================================================================
+
+uint16_t TcpClient::GetPort() {
+  return port;
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
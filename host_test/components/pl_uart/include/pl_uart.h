@@ -0,0 +1,187 @@
+#pragma once
+#include "pl_common.h"
+#include "freertos/stream_buffer.h"
+#include <atomic>
+
+//==============================================================================
+
+/// @brief UART port number
+typedef int uart_port_t;
+#define UART_NUM_0 0
+#define UART_NUM_1 1
+#define UART_NUM_2 2
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+/// @brief UART parity
+enum class UartParity {
+  none,
+  even,
+  odd
+};
+
+/// @brief UART stop bits
+enum class UartStopBits {
+  one,
+  onePointFive,
+  two
+};
+
+/// @brief UART flow control
+enum class UartFlowControl {
+  none,
+  rts,
+  cts,
+  rtsCts
+};
+
+//==============================================================================
+
+/// @brief Simulated UART of the host (Linux) target
+/// @details The data written to the UART is received by the connected UART (see Connect) and is discarded if no UART is connected.
+/// The port settings are stored and validated and affect the transfer only if the baud rate pacing is enabled (see EnableBaudRatePacing).
+class Uart : public HardwareInterface, public Stream {
+public:
+  /// @brief Default baud rate
+  static const uint32_t defaultBaudRate = 115200;
+  /// @brief Default number of data bits
+  static const uint16_t defaultDataBits = 8;
+  /// @brief Default parity
+  static const UartParity defaultParity = UartParity::none;
+  /// @brief Default stop bits
+  static const UartStopBits defaultStopBits = UartStopBits::one;
+  /// @brief Default flow control
+  static const UartFlowControl defaultFlowControl = UartFlowControl::none;
+  /// @brief Default read buffer size
+  static const size_t defaultReadBufferSize = 1024;
+  /// @brief Default read timeout
+  static const TickType_t defaultReadTimeout = 300 / portTICK_PERIOD_MS;
+
+  /// @brief Creates a simulated UART
+  /// @param port port number
+  /// @param readBufferSize read buffer size
+  Uart(uart_port_t port, size_t readBufferSize = defaultReadBufferSize);
+  ~Uart();
+  Uart(const Uart&) = delete;
+  Uart& operator=(const Uart&) = delete;
+
+  esp_err_t Lock(TickType_t timeout = portMAX_DELAY) override;
+  esp_err_t Unlock() override;
+  esp_err_t Initialize() override;
+  esp_err_t Enable() override;
+  esp_err_t Disable() override;
+  bool IsEnabled() override;
+
+  esp_err_t Read(void* dest, size_t size) override;
+  esp_err_t Read(Buffer& dest, size_t offset, size_t size) override;
+  esp_err_t Write(const void* src, size_t size) override;
+  esp_err_t Write(Buffer& src, size_t offset, size_t size) override;
+  TickType_t GetReadTimeout() override;
+  esp_err_t SetReadTimeout(TickType_t timeout) override;
+  size_t GetReadableSize() override;
+
+  /// @brief Gets the port number
+  /// @return port number
+  uart_port_t GetPort();
+
+  /// @brief Gets the baud rate
+  /// @return baud rate
+  uint32_t GetBaudRate();
+
+  /// @brief Sets the baud rate
+  /// @param baudRate baud rate
+  /// @return error code
+  esp_err_t SetBaudRate(uint32_t baudRate);
+
+  /// @brief Gets the number of data bits
+  /// @return number of data bits
+  uint16_t GetDataBits();
+
+  /// @brief Sets the number of data bits
+  /// @param dataBits number of data bits (5..8)
+  /// @return error code
+  esp_err_t SetDataBits(uint16_t dataBits);
+
+  /// @brief Gets the parity
+  /// @return parity
+  UartParity GetParity();
+
+  /// @brief Sets the parity
+  /// @param parity parity
+  /// @return error code
+  esp_err_t SetParity(UartParity parity);
+
+  /// @brief Gets the stop bits
+  /// @return stop bits
+  UartStopBits GetStopBits();
+
+  /// @brief Sets the stop bits
+  /// @param stopBits stop bits
+  /// @return error code
+  esp_err_t SetStopBits(UartStopBits stopBits);
+
+  /// @brief Gets the flow control
+  /// @return flow control
+  UartFlowControl GetFlowControl();
+
+  /// @brief Sets the flow control
+  /// @param flowControl flow control
+  /// @return error code
+  esp_err_t SetFlowControl(UartFlowControl flowControl);
+
+  /// @brief Enables the baud rate pacing: the write blocks for the transmission time of the data (see GetTransmissionTime)
+  /// and the data is received by the connected UART at the end of the transmission
+  void EnableBaudRatePacing();
+
+  /// @brief Disables the baud rate pacing: the data is transferred immediately
+  void DisableBaudRatePacing();
+
+  /// @brief Checks if the baud rate pacing is enabled
+  /// @return true if the baud rate pacing is enabled
+  bool IsBaudRatePacingEnabled();
+
+  /// @brief Gets the transmission time of the data with the baud rate, data bits, parity and stop bits of the port
+  /// @param size number of bytes
+  /// @return transmission time in microseconds
+  int64_t GetTransmissionTime(size_t size);
+
+  /// @brief Connects the transmitters of the UARTs to the receivers of each other
+  /// @param uart1 UART 1
+  /// @param uart2 UART 2
+  /// @return error code
+  static esp_err_t Connect(Uart& uart1, Uart& uart2);
+
+  /// @brief Disconnects the UART from the connected UART
+  /// @return error code
+  esp_err_t Disconnect();
+
+  /// @brief Simulates the reception of the data (the data is received only if the UART is enabled)
+  /// @param src source
+  /// @param size number of bytes
+  /// @return error code (ESP_ERR_NO_MEM if the read buffer overflows)
+  esp_err_t Receive(const void* src, size_t size);
+
+private:
+  Mutex mutex;
+  // Serializes the writers of the read stream buffer that supports a single writer
+  Mutex receiveMutex;
+  uart_port_t port;
+  StreamBufferHandle_t readBuffer;
+  std::atomic<bool> enabled = false;
+  TickType_t readTimeout = defaultReadTimeout;
+  uint32_t baudRate = defaultBaudRate;
+  uint16_t dataBits = defaultDataBits;
+  UartParity parity = defaultParity;
+  UartStopBits stopBits = defaultStopBits;
+  UartFlowControl flowControl = defaultFlowControl;
+  bool baudRatePacingEnabled = false;
+  Uart* connectedUart = NULL;
+};
+
+//==============================================================================
+
+}
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "pl_uart.h"
+#include "esp_check.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+//==============================================================================
+
+static const char* TAG = "pl_uart";
+
+//==============================================================================
+
+namespace PL {
+
+//==============================================================================
+
+// Protects the UART connections, is locked after the UART mutexes
+static Mutex connectionMutex;
+
+//==============================================================================
+
+Uart::Uart(uart_port_t port, size_t readBufferSize) : HardwareInterface("UART" + std::to_string(port)), port(port) {
+  readBuffer = xStreamBufferCreate(readBufferSize, 1);
+}
+
+//==============================================================================
+
+Uart::~Uart() {
+  Disconnect();
+  if (readBuffer)
+    vStreamBufferDelete(readBuffer);
+}
+
+//==============================================================================
+
+esp_err_t Uart::Lock(TickType_t timeout) {
+  esp_err_t error = mutex.Lock(timeout);
+  if (error == ESP_OK)
+    return ESP_OK;
+  if (error == ESP_ERR_TIMEOUT && timeout == 0)
+    return ESP_ERR_TIMEOUT;
+  ESP_RETURN_ON_ERROR(error, TAG, "mutex lock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Unlock() {
+  ESP_RETURN_ON_ERROR(mutex.Unlock(), TAG, "mutex unlock failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Initialize() {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(readBuffer, ESP_ERR_NO_MEM, TAG, "read buffer create failed");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Enable() {
+  LockGuard lg(*this);
+  if (enabled)
+    return ESP_OK;
+  ESP_RETURN_ON_FALSE(readBuffer, ESP_ERR_NO_MEM, TAG, "read buffer create failed");
+  xStreamBufferReset(readBuffer);
+  enabled = true;
+  enabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Disable() {
+  LockGuard lg(*this);
+  if (!enabled)
+    return ESP_OK;
+  enabled = false;
+  disabledEvent.Generate();
+  return ESP_OK;
+}
+
+//==============================================================================
+
+bool Uart::IsEnabled() {
+  LockGuard lg(*this);
+  return enabled;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Read(void* dest, size_t size) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(enabled, ESP_ERR_INVALID_STATE, TAG, "UART is not enabled");
+
+  uint8_t discardedData[64];
+  TimeOut_t timeOut;
+  vTaskSetTimeOutState(&timeOut);
+  TickType_t remainingTime = readTimeout;
+  while (size) {
+    size_t receiveSize = dest ? size : std::min(size, sizeof(discardedData));
+    size_t receivedSize = xStreamBufferReceive(readBuffer, dest ? dest : discardedData, receiveSize, remainingTime);
+    size -= receivedSize;
+    if (dest)
+      dest = (uint8_t*)dest + receivedSize;
+    if (size && xTaskCheckForTimeOut(&timeOut, &remainingTime) == pdTRUE)
+      return ESP_ERR_TIMEOUT;
+  }
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Read(Buffer& dest, size_t offset, size_t size) {
+  LockGuard lg(*this, dest);
+  ESP_RETURN_ON_FALSE(offset + size <= dest.size, ESP_ERR_INVALID_SIZE, TAG, "invalid size");
+  return Read((uint8_t*)dest.data + offset, size);
+}
+
+//==============================================================================
+
+esp_err_t Uart::Write(const void* src, size_t size) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(enabled, ESP_ERR_INVALID_STATE, TAG, "UART is not enabled");
+
+  if (baudRatePacingEnabled) {
+    // The transmitter is busy for the transmission time: the whole ticks are delayed and the rest is spent yielding to the other tasks
+    int64_t transmissionEndTime = esp_timer_get_time() + GetTransmissionTime(size);
+    for (int64_t remainingTime; (remainingTime = transmissionEndTime - esp_timer_get_time()) > 0;) {
+      if (remainingTime >= 2000 * portTICK_PERIOD_MS)
+        vTaskDelay(remainingTime / 1000 / portTICK_PERIOD_MS - 1);
+      else
+        taskYIELD();
+    }
+  }
+
+  LockGuard connectionLg(connectionMutex);
+  if (connectedUart)
+    connectedUart->Receive(src, size);
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Write(Buffer& src, size_t offset, size_t size) {
+  LockGuard lg(*this, src);
+  ESP_RETURN_ON_FALSE(offset + size <= src.size, ESP_ERR_INVALID_SIZE, TAG, "invalid size");
+  return Write((uint8_t*)src.data + offset, size);
+}
+
+//==============================================================================
+
+TickType_t Uart::GetReadTimeout() {
+  LockGuard lg(*this);
+  return readTimeout;
+}
+
+//==============================================================================
+
+esp_err_t Uart::SetReadTimeout(TickType_t timeout) {
+  LockGuard lg(*this);
+  readTimeout = timeout;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+size_t Uart::GetReadableSize() {
+  LockGuard lg(*this);
+  return readBuffer ? xStreamBufferBytesAvailable(readBuffer) : 0;
+}
+
+//==============================================================================
+
+uart_port_t Uart::GetPort() {
+  return port;
+}
+
+//==============================================================================
+
+uint32_t Uart::GetBaudRate() {
+  LockGuard lg(*this);
+  return baudRate;
+}
+
+//==============================================================================
+
+esp_err_t Uart::SetBaudRate(uint32_t baudRate) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(baudRate, ESP_ERR_INVALID_ARG, TAG, "invalid baud rate");
+  this->baudRate = baudRate;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+uint16_t Uart::GetDataBits() {
+  LockGuard lg(*this);
+  return dataBits;
+}
+
+//==============================================================================
+
+esp_err_t Uart::SetDataBits(uint16_t dataBits) {
+  LockGuard lg(*this);
+  ESP_RETURN_ON_FALSE(dataBits >= 5 && dataBits <= 8, ESP_ERR_INVALID_ARG, TAG, "invalid number of data bits");
+  this->dataBits = dataBits;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+UartParity Uart::GetParity() {
+  LockGuard lg(*this);
+  return parity;
+}
+
+//==============================================================================
+
+esp_err_t Uart::SetParity(UartParity parity) {
+  LockGuard lg(*this);
+  this->parity = parity;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+UartStopBits Uart::GetStopBits() {
+  LockGuard lg(*this);
+  return stopBits;
+}
+
+//==============================================================================
+
+esp_err_t Uart::SetStopBits(UartStopBits stopBits) {
+  LockGuard lg(*this);
+  this->stopBits = stopBits;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+UartFlowControl Uart::GetFlowControl() {
+  LockGuard lg(*this);
+  return flowControl;
+}
+
+//==============================================================================
+
+esp_err_t Uart::SetFlowControl(UartFlowControl flowControl) {
+  LockGuard lg(*this);
+  this->flowControl = flowControl;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+void Uart::EnableBaudRatePacing() {
+  LockGuard lg(*this);
+  baudRatePacingEnabled = true;
+}
+
+//==============================================================================
+
+void Uart::DisableBaudRatePacing() {
+  LockGuard lg(*this);
+  baudRatePacingEnabled = false;
+}
+
+//==============================================================================
+
+bool Uart::IsBaudRatePacingEnabled() {
+  LockGuard lg(*this);
+  return baudRatePacingEnabled;
+}
+
+//==============================================================================
+
+int64_t Uart::GetTransmissionTime(size_t size) {
+  LockGuard lg(*this);
+  // Character length in half bits: start bit, data bits, parity bit and 1, 1.5 or 2 stop bits
+  uint64_t characterHalfBits = 2 * (1 + dataBits + (parity == UartParity::none ? 0 : 1));
+  characterHalfBits += (stopBits == UartStopBits::one) ? 2 : ((stopBits == UartStopBits::onePointFive) ? 3 : 4);
+  return size * characterHalfBits * 1000000 / (2 * baudRate);
+}
+
+//==============================================================================
+
+esp_err_t Uart::Connect(Uart& uart1, Uart& uart2) {
+  ESP_RETURN_ON_FALSE(&uart1 != &uart2, ESP_ERR_INVALID_ARG, TAG, "UART cannot be connected to itself");
+  ESP_RETURN_ON_ERROR(uart1.Disconnect(), TAG, "UART 1 disconnect failed");
+  ESP_RETURN_ON_ERROR(uart2.Disconnect(), TAG, "UART 2 disconnect failed");
+  LockGuard lg(connectionMutex);
+  uart1.connectedUart = &uart2;
+  uart2.connectedUart = &uart1;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Disconnect() {
+  LockGuard lg(connectionMutex);
+  if (connectedUart)
+    connectedUart->connectedUart = NULL;
+  connectedUart = NULL;
+  return ESP_OK;
+}
+
+//==============================================================================
+
+esp_err_t Uart::Receive(const void* src, size_t size) {
+  LockGuard lg(receiveMutex);
+  // The UART mutex is not locked, because the reader holds it while waiting for the data
+  if (!enabled || !readBuffer)
+    return ESP_OK;
+  ESP_RETURN_ON_FALSE(xStreamBufferSend(readBuffer, src, size, 0) == size, ESP_ERR_NO_MEM, TAG, "read buffer overflow");
+  return ESP_OK;
+}
+
+//==============================================================================
+
+}
\ No newline at end of file
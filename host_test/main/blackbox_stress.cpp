@@ -0,0 +1,271 @@
+#include "blackbox.h"
+#include "blackbox_stress.h"
+#include "lock_monitor.h"
+#include "unity.h"
+#include "freertos/event_groups.h"
+#include <atomic>
+#include <random>
+
+//==============================================================================
+
+enum class StressTaskType {
+  application,
+  modbusClient,
+  streamClient,
+  maintenance
+};
+
+struct StressTaskParameters {
+  StressTaskType type;
+  uint32_t seed;
+  std::atomic<size_t> numberOfOperations;
+  EventBits_t doneBit;
+};
+
+static const uint16_t port = 1502;
+static const size_t numberOfApplicationTasks = 3;
+static const size_t numberOfModbusClientTasks = 3;
+static const size_t numberOfStreamClientTasks = 2;
+static const size_t numberOfMaintenanceTasks = 1;
+static const size_t numberOfTasks = numberOfApplicationTasks + numberOfModbusClientTasks + numberOfStreamClientTasks + numberOfMaintenanceTasks;
+static const TickType_t duration = CONFIG_TEST_STRESS_DURATION / portTICK_PERIOD_MS;
+static const TickType_t watchdogTimeout = CONFIG_TEST_STRESS_WATCHDOG_TIMEOUT / portTICK_PERIOD_MS;
+static const TickType_t watchdogPeriod = 100 / portTICK_PERIOD_MS;
+// The addresses are taken from the golden memory map, so the test uses the layout that the Modbus clients use
+static constexpr uint16_t selectedHardwareInterfaceIndexAddress = PL::GetBlackBoxModbusMemoryMapAddress("generalConfigurationHR", "selectedHardwareInterfaceIndex");
+static constexpr uint16_t selectedServerIndexAddress = PL::GetBlackBoxModbusMemoryMapAddress("generalConfigurationHR", "selectedServerIndex");
+static constexpr uint16_t nameAddress = PL::GetBlackBoxModbusMemoryMapAddress("generalConfigurationHR", "name");
+static constexpr uint16_t uartDataBitsAddress = PL::GetBlackBoxModbusMemoryMapAddress("hardwareInterfaceConfigurationHR", "uart.dataBits");
+static constexpr uint16_t saveConfigurationCoil = PL::GetBlackBoxModbusMemoryMapCoil("generalConfigurationHR", "saveConfiguration");
+
+static auto blackBox = std::make_shared<BlackBox>();
+static std::shared_ptr<PL::BlackBoxUartConfiguration> uartConfiguration;
+static std::shared_ptr<PL::BlackBoxWiFiStationConfiguration> wifiConfiguration;
+static std::shared_ptr<PL::BlackBoxStreamServer> streamServer;
+// The tasks that are not stopped by a failed test keep using the parameters, so they are not allocated on the stack
+static StressTaskParameters taskParameters[numberOfTasks];
+static std::atomic<bool> stopFlag;
+static EventGroupHandle_t eventGroup;
+
+//==============================================================================
+
+static void StressTask(void* parameters);
+static void ExecuteApplicationOperation(std::minstd_rand& random);
+static void ExecuteModbusClientOperation(PL::ModbusClient& client, std::minstd_rand& random);
+static void ExecuteStreamClientOperation(std::minstd_rand& random);
+static void ExecuteMaintenanceOperation(std::minstd_rand& random);
+
+//==============================================================================
+
+void TestBlackBoxStress() {
+  uartConfiguration = blackBox->AddUartConfiguration(uart, "stressUart");
+  wifiConfiguration = blackBox->AddWiFiConfiguration(wifi, "stressWifi");
+  auto server = std::make_shared<PL::BlackBoxModbusServer>(blackBox, port);
+  if (auto networkServer = std::dynamic_pointer_cast<PL::NetworkServer>(server->GetBaseServer().lock()))
+    TEST_ASSERT(networkServer->SetMaxNumberOfClients(numberOfModbusClientTasks) == ESP_OK);
+  blackBox->AddModbusServerConfiguration(server, "stressMbSrv");
+  TEST_ASSERT(server->Enable() == ESP_OK);
+  vTaskDelay(10);
+  // The stream client tasks call the request handlers directly, so the stream server is not enabled
+  streamServer = std::make_shared<PL::BlackBoxStreamServer>(blackBox, uart);
+
+  eventGroup = xEventGroupCreate();
+  TEST_ASSERT(eventGroup);
+  LockMonitor::Reset();
+  stopFlag = false;
+
+  EventBits_t doneBits = 0;
+  for (size_t i = 0; i < numberOfTasks; i++) {
+    StressTaskType type = StressTaskType::maintenance;
+    if (i < numberOfApplicationTasks)
+      type = StressTaskType::application;
+    else if (i < numberOfApplicationTasks + numberOfModbusClientTasks)
+      type = StressTaskType::modbusClient;
+    else if (i < numberOfApplicationTasks + numberOfModbusClientTasks + numberOfStreamClientTasks)
+      type = StressTaskType::streamClient;
+    taskParameters[i].type = type;
+    // The seeds are fixed, so a failure can be reproduced
+    taskParameters[i].seed = i + 1;
+    taskParameters[i].numberOfOperations = 0;
+    taskParameters[i].doneBit = (EventBits_t)1 << i;
+    doneBits |= taskParameters[i].doneBit;
+    TEST_ASSERT(xTaskCreate(StressTask, "stress", 8192, &taskParameters[i], tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+  }
+
+  // Watchdog: every task should complete an operation within the watchdog timeout
+  size_t numberOfOperations[numberOfTasks] = {};
+  TickType_t progressTime[numberOfTasks];
+  std::fill(progressTime, progressTime + numberOfTasks, xTaskGetTickCount());
+  TickType_t startTime = xTaskGetTickCount();
+  while (xTaskGetTickCount() - startTime < duration) {
+    vTaskDelay(watchdogPeriod);
+    for (size_t i = 0; i < numberOfTasks; i++) {
+      if (taskParameters[i].numberOfOperations != numberOfOperations[i]) {
+        numberOfOperations[i] = taskParameters[i].numberOfOperations;
+        progressTime[i] = xTaskGetTickCount();
+      }
+      else if (xTaskGetTickCount() - progressTime[i] > watchdogTimeout) {
+        stopFlag = true;
+        LockMonitor::PrintHeldLocks();
+        TEST_FAIL_MESSAGE("stress task deadlock");
+      }
+    }
+  }
+
+  stopFlag = true;
+  if ((xEventGroupWaitBits(eventGroup, doneBits, pdFALSE, pdTRUE, watchdogTimeout) & doneBits) != doneBits) {
+    LockMonitor::PrintHeldLocks();
+    TEST_FAIL_MESSAGE("stress task deadlock");
+  }
+  vEventGroupDelete(eventGroup);
+
+  for (size_t i = 0; i < numberOfTasks; i++)
+    TEST_ASSERT(taskParameters[i].numberOfOperations > 0);
+
+  LockMonitor::PrintContentionReport();
+  LockMonitor::PrintOrderInversions();
+  TEST_ASSERT_EQUAL(0, LockMonitor::GetNumberOfOrderInversions());
+
+  TEST_ASSERT(server->Disable() == ESP_OK);
+  streamServer.reset();
+  blackBox->EraseAllConfigurations();
+}
+
+//==============================================================================
+
+static void StressTask(void* parameters) {
+  StressTaskParameters& taskParameters = *(StressTaskParameters*)parameters;
+  {
+    std::minstd_rand random(taskParameters.seed);
+    std::unique_ptr<PL::ModbusClient> client;
+    if (taskParameters.type == StressTaskType::modbusClient)
+      client = std::make_unique<PL::ModbusClient>(PL::IpV4Address(127, 0, 0, 1), port);
+
+    while (!stopFlag) {
+      switch (taskParameters.type) {
+        case StressTaskType::application:
+          ExecuteApplicationOperation(random);
+          break;
+        case StressTaskType::modbusClient:
+          ExecuteModbusClientOperation(*client, random);
+          break;
+        case StressTaskType::streamClient:
+          ExecuteStreamClientOperation(random);
+          break;
+        case StressTaskType::maintenance:
+          ExecuteMaintenanceOperation(random);
+          break;
+      }
+      taskParameters.numberOfOperations++;
+      taskYIELD();
+    }
+  }
+  xEventGroupSetBits(eventGroup, taskParameters.doneBit);
+  vTaskDelete(NULL);
+}
+
+//==============================================================================
+
+static void ExecuteApplicationOperation(std::minstd_rand& random) {
+  // The results are not checked: the values are changed concurrently, only the locking is tested
+  switch (random() % 6) {
+    case 0:
+      uartConfiguration->baudRate.SetValue((random() % 2) ? 9600 : 115200);
+      break;
+    case 1:
+      uartConfiguration->dataBits.SetValue(7 + random() % 2);
+      break;
+    case 2:
+      wifiConfiguration->ssid.SetValue("ssid" + std::to_string(random() % 10));
+      break;
+    case 3:
+      blackBox->SetDeviceName("Stress " + std::to_string(random() % 10));
+      break;
+    case 4:
+      uartConfiguration->Apply();
+      break;
+    default:
+      uartConfiguration->baudRate.GetValue();
+      wifiConfiguration->ssid.GetValue();
+      blackBox->GetDeviceName();
+      break;
+  }
+}
+
+//==============================================================================
+
+static void ExecuteModbusClientOperation(PL::ModbusClient& client, std::minstd_rand& random) {
+  // The results are not checked: the selected indexes are changed concurrently, only the locking is tested
+  uint16_t data[PL::BlackBoxModbusServer::registerMemoryAreaSize / 2];
+  char name[PL::BlackBoxModbusServer::maxNameSize] = {};
+  switch (random() % 6) {
+    case 0:
+      client.ReadInputRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL);
+      break;
+    case 1:
+      client.WriteSingleHoldingRegister(selectedHardwareInterfaceIndexAddress, random() % blackBox->GetNumberOfHardwareInterfaceConfigurations(), NULL);
+      client.ReadInputRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL);
+      break;
+    case 2:
+      client.WriteSingleHoldingRegister(selectedServerIndexAddress, random() % blackBox->GetNumberOfServerConfigurations(), NULL);
+      client.ReadHoldingRegisters(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL);
+      break;
+    case 3:
+      snprintf(name, sizeof(name), "Modbus %u", (unsigned)(random() % 10));
+      client.WriteMultipleHoldingRegisters(nameAddress, sizeof(name) / 2, name, NULL);
+      break;
+    case 4:
+      client.ReadHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL);
+      client.WriteSingleHoldingRegister(uartDataBitsAddress, 7 + random() % 2, NULL);
+      break;
+    default:
+      // Saves the configurations
+      if (random() % 10 == 0)
+        client.WriteSingleCoil(saveConfigurationCoil, true, NULL);
+      break;
+  }
+}
+
+//==============================================================================
+
+static void ExecuteStreamClientOperation(std::minstd_rand& random) {
+  // The stream server locks the configurations without the BlackBox mutex, unlike the maintenance operations
+  std::vector<uint8_t> response;
+  PL::BlackBoxTlvConfigurationStorage parameters;
+  std::vector<uint8_t> sections;
+  switch (random() % 3) {
+    case 0:
+      streamServer->ReadConfiguration({}, response);
+      break;
+    case 1:
+      parameters.Write(PL::BlackBox::generalConfigurationDeviceNameNvsKey, "Stream " + std::to_string(random() % 10));
+      PL::BlackBoxStreamProtocol::AppendSection(sections, blackBox->GetGeneralConfigurationNvsNamespaceName(), parameters.GetData());
+      streamServer->WriteConfiguration(sections);
+      break;
+    default:
+      parameters.Write(PL::BlackBoxUartConfiguration::dataBitsNvsKey, (uint16_t)(7 + random() % 2));
+      PL::BlackBoxStreamProtocol::AppendSection(sections, uartConfiguration->GetNvsNamespaceName(), parameters.GetData());
+      streamServer->WriteConfiguration(sections);
+      break;
+  }
+}
+
+//==============================================================================
+
+static void ExecuteMaintenanceOperation(std::minstd_rand& random) {
+  switch (random() % 4) {
+    case 0:
+      blackBox->SaveAllConfigurations();
+      break;
+    case 1:
+      blackBox->LoadAllConfigurations();
+      break;
+    case 2:
+      blackBox->ApplyHardwareInterfaceConfigurations();
+      break;
+    default:
+      blackBox->CreateProfile();
+      break;
+  }
+  vTaskDelay(1);
+}
\ No newline at end of file
@@ -0,0 +1,5 @@
+#include "pl_blackbox.h"
+
+//==============================================================================
+
+void TestBlackBoxStress();
\ No newline at end of file
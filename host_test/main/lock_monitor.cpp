@@ -0,0 +1,530 @@
+#include "lock_monitor.h"
+#include "freertos/queue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cxxabi.h>
+#include <execinfo.h>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+//==============================================================================
+
+static const size_t maxNumberOfEvents = 65536;
+static const size_t eventBatchSize = 256;
+static const size_t maxNumberOfMutexNames = 1024;
+static const size_t maxMutexNameSize = 160;
+static const size_t maxNumberOfTaskNames = 64;
+
+//==============================================================================
+
+enum class LockEventType : uint8_t {
+  create,
+  remove,
+  waitStart,
+  waitEnd,
+  acquire,
+  release
+};
+
+struct LockEvent {
+  LockEventType type;
+  bool blocking;
+  bool contended;
+  // Mutex name index (create) or task name index (other events)
+  uint16_t nameIndex;
+  QueueHandle_t mutex;
+  TaskHandle_t task;
+  int64_t contentionTime;
+};
+
+/// @brief Name table that is filled in the critical section, so it does not allocate memory
+template <size_t capacity, size_t nameSize>
+struct NameTable {
+  char names[capacity][nameSize] = {{"unknown"}};
+  size_t size = 1;
+
+  uint16_t Add(const char* name) {
+    for (size_t i = 0; i < size; i++) {
+      if (!strncmp(names[i], name, nameSize - 1))
+        return i;
+    }
+    // Names that do not fit the table are unknown
+    if (size == capacity)
+      return 0;
+    strncpy(names[size], name, nameSize - 1);
+    return size++;
+  }
+};
+
+struct MutexCounters {
+  size_t numberOfInstances = 0;
+  size_t numberOfAcquisitions = 0;
+  size_t numberOfContendedAcquisitions = 0;
+  int64_t contentionTime = 0;
+};
+
+struct MonitoredMutex {
+  uint16_t nameIndex = 0;
+  MutexCounters counters;
+};
+
+struct HeldLock {
+  QueueHandle_t mutex;
+  size_t numberOfAcquisitions;
+};
+
+struct MonitoredTask {
+  uint16_t nameIndex = 0;
+  std::vector<HeldLock> heldLocks;
+  QueueHandle_t waitedMutex = NULL;
+};
+
+struct OrderInversion {
+  std::string heldMutexName;
+  std::string acquiredMutexName;
+  std::string taskName;
+};
+
+struct LockMonitorState {
+  // The FreeRTOS tasks of the host target are threads that are suspended by the scheduler at any point,
+  // so the events are recorded in a critical section instead of a pthread mutex, that can be held by a suspended task.
+  // A suspended task can also hold the heap lock, so the critical section only copies the events to the preallocated buffer
+  // and the events are analyzed outside of it.
+  portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+  LockEvent events[maxNumberOfEvents];
+  size_t eventHead = 0;
+  size_t eventTail = 0;
+  NameTable<maxNumberOfMutexNames, maxMutexNameSize> mutexNames;
+  NameTable<maxNumberOfTaskNames, configMAX_TASK_NAME_LEN> taskNames;
+
+  // The analysis state is accessed by one task at a time (the task that has set the analyzing flag)
+  std::atomic<bool> analyzing = false;
+  LockEvent eventBatch[eventBatchSize];
+  std::unordered_map<QueueHandle_t, MonitoredMutex> mutexes;
+  // Counters of the deleted mutexes by name
+  std::map<std::string, MutexCounters> deletedMutexCounters;
+  std::unordered_map<TaskHandle_t, MonitoredTask> tasks;
+  // Lock order graph: held mutex -> mutexes acquired while it is held
+  std::unordered_map<QueueHandle_t, std::unordered_set<QueueHandle_t>> lockOrder;
+  std::set<std::pair<QueueHandle_t, QueueHandle_t>> invertedLockOrder;
+  std::vector<OrderInversion> orderInversions;
+};
+
+//==============================================================================
+
+static LockMonitorState& GetState();
+static std::string GetCreatorName();
+static const char* GetTaskName(TaskHandle_t task);
+static void RecordEvent(LockEvent event, const char* name);
+static bool LockAnalysis(bool wait);
+static void UnlockAnalysis();
+static void ProcessEvent(LockMonitorState& state, const LockEvent& event);
+static void OnAcquired(LockMonitorState& state, const LockEvent& event);
+static void OnReleased(LockMonitorState& state, const LockEvent& event);
+static bool IsLockOrderPath(LockMonitorState& state, QueueHandle_t from, QueueHandle_t to);
+
+//==============================================================================
+
+extern "C" {
+  QueueHandle_t __real_xQueueCreateMutex(const uint8_t queueType);
+  BaseType_t __real_xQueueTakeMutexRecursive(QueueHandle_t mutex, TickType_t timeout);
+  BaseType_t __real_xQueueGiveMutexRecursive(QueueHandle_t mutex);
+  void __real_vQueueDelete(QueueHandle_t queue);
+
+  QueueHandle_t __wrap_xQueueCreateMutex(const uint8_t queueType);
+  BaseType_t __wrap_xQueueTakeMutexRecursive(QueueHandle_t mutex, TickType_t timeout);
+  BaseType_t __wrap_xQueueGiveMutexRecursive(QueueHandle_t mutex);
+  void __wrap_vQueueDelete(QueueHandle_t queue);
+}
+
+//==============================================================================
+
+QueueHandle_t __wrap_xQueueCreateMutex(const uint8_t queueType) {
+  QueueHandle_t mutex = __real_xQueueCreateMutex(queueType);
+  if (!mutex || queueType != queueQUEUE_TYPE_RECURSIVE_MUTEX)
+    return mutex;
+
+  RecordEvent({LockEventType::create, false, false, 0, mutex, NULL, 0}, GetCreatorName().c_str());
+  return mutex;
+}
+
+//==============================================================================
+
+BaseType_t __wrap_xQueueTakeMutexRecursive(QueueHandle_t mutex, TickType_t timeout) {
+  // The mutex is taken without waiting first to detect the contention
+  BaseType_t result = __real_xQueueTakeMutexRecursive(mutex, 0);
+  bool contended = false;
+  int64_t contentionTime = 0;
+  TaskHandle_t task = xTaskGetCurrentTaskHandle();
+  if (result != pdPASS && timeout) {
+    contended = true;
+    RecordEvent({LockEventType::waitStart, false, false, 0, mutex, task, 0}, GetTaskName(task));
+
+    auto startTime = std::chrono::steady_clock::now();
+    result = __real_xQueueTakeMutexRecursive(mutex, timeout);
+    contentionTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+    RecordEvent({LockEventType::waitEnd, false, false, 0, mutex, task, 0}, GetTaskName(task));
+  }
+
+  if (result == pdPASS)
+    RecordEvent({LockEventType::acquire, timeout != 0, contended, 0, mutex, task, contentionTime}, GetTaskName(task));
+  return result;
+}
+
+//==============================================================================
+
+BaseType_t __wrap_xQueueGiveMutexRecursive(QueueHandle_t mutex) {
+  BaseType_t result = __real_xQueueGiveMutexRecursive(mutex);
+  if (result == pdPASS) {
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    RecordEvent({LockEventType::release, false, false, 0, mutex, task, 0}, GetTaskName(task));
+  }
+  return result;
+}
+
+//==============================================================================
+
+void __wrap_vQueueDelete(QueueHandle_t queue) {
+  // The event is recorded before the handle can be reused by a new mutex
+  RecordEvent({LockEventType::remove, false, false, 0, queue, NULL, 0}, NULL);
+  __real_vQueueDelete(queue);
+}
+
+//==============================================================================
+
+void LockMonitor::Reset() {
+  LockMonitorState& state = GetState();
+  LockAnalysis(true);
+  for (auto& mutex : state.mutexes)
+    mutex.second.counters = {1, 0, 0, 0};
+  state.deletedMutexCounters.clear();
+  state.lockOrder.clear();
+  state.invertedLockOrder.clear();
+  state.orderInversions.clear();
+  UnlockAnalysis();
+}
+
+//==============================================================================
+
+size_t LockMonitor::GetNumberOfOrderInversions() {
+  LockMonitorState& state = GetState();
+  LockAnalysis(true);
+  size_t numberOfOrderInversions = state.orderInversions.size();
+  UnlockAnalysis();
+  return numberOfOrderInversions;
+}
+
+//==============================================================================
+
+void LockMonitor::PrintContentionReport() {
+  LockMonitorState& state = GetState();
+  LockAnalysis(true);
+  std::map<std::string, MutexCounters> counters = state.deletedMutexCounters;
+  for (auto& mutex : state.mutexes) {
+    MutexCounters& nameCounters = counters[state.mutexNames.names[mutex.second.nameIndex]];
+    nameCounters.numberOfInstances += mutex.second.counters.numberOfInstances;
+    nameCounters.numberOfAcquisitions += mutex.second.counters.numberOfAcquisitions;
+    nameCounters.numberOfContendedAcquisitions += mutex.second.counters.numberOfContendedAcquisitions;
+    nameCounters.contentionTime += mutex.second.counters.contentionTime;
+  }
+  UnlockAnalysis();
+
+  // The most contended mutexes are printed first
+  std::vector<std::pair<std::string, MutexCounters>> sortedCounters(counters.begin(), counters.end());
+  std::stable_sort(sortedCounters.begin(), sortedCounters.end(), [](const auto& a, const auto& b) { return a.second.contentionTime > b.second.contentionTime; });
+  for (auto& nameCounters : sortedCounters) {
+    if (!nameCounters.second.numberOfAcquisitions)
+      continue;
+    printf("{\"mutex\":\"%s\",\"instances\":%zu,\"acquisitions\":%zu,\"contendedAcquisitions\":%zu,\"contentionUs\":%lld}\n",
+      nameCounters.first.c_str(), nameCounters.second.numberOfInstances, nameCounters.second.numberOfAcquisitions,
+      nameCounters.second.numberOfContendedAcquisitions, (long long)nameCounters.second.contentionTime);
+  }
+}
+
+//==============================================================================
+
+void LockMonitor::PrintOrderInversions() {
+  LockMonitorState& state = GetState();
+  LockAnalysis(true);
+  std::vector<OrderInversion> orderInversions = state.orderInversions;
+  UnlockAnalysis();
+
+  for (auto& orderInversion : orderInversions)
+    printf("Lock order inversion: task %s acquired %s while holding %s, the mutexes have been acquired in the reverse order before\n",
+      orderInversion.taskName.c_str(), orderInversion.acquiredMutexName.c_str(), orderInversion.heldMutexName.c_str());
+}
+
+//==============================================================================
+
+void LockMonitor::PrintHeldLocks() {
+  LockMonitorState& state = GetState();
+  std::vector<std::string> lines;
+  LockAnalysis(true);
+  for (auto& task : state.tasks) {
+    if (task.second.heldLocks.empty() && !task.second.waitedMutex)
+      continue;
+    std::string line = std::string("Task ") + state.taskNames.names[task.second.nameIndex] + " holds";
+    for (auto& heldLock : task.second.heldLocks)
+      line += std::string(" ") + state.mutexNames.names[state.mutexes[heldLock.mutex].nameIndex];
+    if (task.second.waitedMutex)
+      line += std::string(", waits for ") + state.mutexNames.names[state.mutexes[task.second.waitedMutex].nameIndex];
+    lines.push_back(line);
+  }
+  UnlockAnalysis();
+
+  for (auto& line : lines)
+    printf("%s\n", line.c_str());
+}
+
+//==============================================================================
+
+static LockMonitorState& GetState() {
+  // The mutexes of the static objects are created before the static objects of this file are initialized
+  static LockMonitorState* state = new LockMonitorState;
+  return *state;
+}
+
+//==============================================================================
+
+static std::string GetCreatorName() {
+  const int maxNumberOfFrames = 32;
+  void* frames[maxNumberOfFrames];
+  int numberOfFrames = backtrace(frames, maxNumberOfFrames);
+  char** symbols = backtrace_symbols(frames, numberOfFrames);
+  if (!symbols)
+    return "unknown";
+
+  std::string name = "unknown";
+  for (int i = 1; i < numberOfFrames; i++) {
+    // The symbol format is "file(mangled name+offset) [address]"
+    std::string symbol = symbols[i];
+    size_t begin = symbol.find('(');
+    size_t end = symbol.find('+', begin);
+    if (begin == std::string::npos || end == std::string::npos || end == begin + 1)
+      continue;
+
+    int status;
+    char* demangledName = abi::__cxa_demangle(symbol.substr(begin + 1, end - begin - 1).c_str(), NULL, NULL, &status);
+    if (!demangledName)
+      continue;
+    std::string function = demangledName;
+    free(demangledName);
+    if (function.rfind("PL::", 0) != 0 || function.rfind("PL::Mutex::", 0) == 0)
+      continue;
+
+    // The parameter list is removed
+    size_t parametersEnd = function.rfind(')');
+    int depth = 0;
+    for (size_t j = parametersEnd; parametersEnd != std::string::npos && j-- > 0;) {
+      if (function[j] == ')')
+        depth++;
+      else if (function[j] == '(' && depth-- == 0) {
+        function.resize(j);
+        break;
+      }
+    }
+    name = function;
+    break;
+  }
+  free(symbols);
+  return name;
+}
+
+//==============================================================================
+
+static const char* GetTaskName(TaskHandle_t task) {
+  // The mutexes of the static objects are used before the scheduler starts
+  return task ? pcTaskGetName(task) : NULL;
+}
+
+//==============================================================================
+
+static void RecordEvent(LockEvent event, const char* name) {
+  LockMonitorState& state = GetState();
+  while (true) {
+    taskENTER_CRITICAL(&state.spinlock);
+    size_t numberOfEvents = state.eventHead - state.eventTail;
+    bool recorded = numberOfEvents < maxNumberOfEvents;
+    if (recorded) {
+      if (name)
+        event.nameIndex = (event.type == LockEventType::create) ? state.mutexNames.Add(name) : state.taskNames.Add(name);
+      state.events[state.eventHead++ % maxNumberOfEvents] = event;
+    }
+    taskEXIT_CRITICAL(&state.spinlock);
+
+    if (recorded) {
+      // The events are analyzed by the task that fills the half of the buffer (unless another task is analyzing them)
+      if (numberOfEvents + 1 >= maxNumberOfEvents / 2 && LockAnalysis(false))
+        UnlockAnalysis();
+      return;
+    }
+    // The events are not dropped, because a missing release would be reported as a lock order inversion
+    LockAnalysis(true);
+    UnlockAnalysis();
+  }
+}
+
+//==============================================================================
+
+static bool LockAnalysis(bool wait) {
+  LockMonitorState& state = GetState();
+  bool analyzing = false;
+  while (!state.analyzing.compare_exchange_strong(analyzing, true)) {
+    if (!wait)
+      return false;
+    analyzing = false;
+    vTaskDelay(1);
+  }
+
+  while (true) {
+    taskENTER_CRITICAL(&state.spinlock);
+    size_t numberOfEvents = std::min(state.eventHead - state.eventTail, eventBatchSize);
+    for (size_t i = 0; i < numberOfEvents; i++)
+      state.eventBatch[i] = state.events[(state.eventTail + i) % maxNumberOfEvents];
+    state.eventTail += numberOfEvents;
+    taskEXIT_CRITICAL(&state.spinlock);
+
+    if (!numberOfEvents)
+      return true;
+    for (size_t i = 0; i < numberOfEvents; i++)
+      ProcessEvent(state, state.eventBatch[i]);
+  }
+}
+
+//==============================================================================
+
+static void UnlockAnalysis() {
+  GetState().analyzing = false;
+}
+
+//==============================================================================
+
+static void ProcessEvent(LockMonitorState& state, const LockEvent& event) {
+  switch (event.type) {
+    case LockEventType::create:
+      state.mutexes[event.mutex] = {event.nameIndex, {1, 0, 0, 0}};
+      break;
+
+    case LockEventType::remove: {
+      auto mutexIterator = state.mutexes.find(event.mutex);
+      if (mutexIterator == state.mutexes.end())
+        break;
+      MutexCounters& deletedCounters = state.deletedMutexCounters[state.mutexNames.names[mutexIterator->second.nameIndex]];
+      deletedCounters.numberOfInstances += mutexIterator->second.counters.numberOfInstances;
+      deletedCounters.numberOfAcquisitions += mutexIterator->second.counters.numberOfAcquisitions;
+      deletedCounters.numberOfContendedAcquisitions += mutexIterator->second.counters.numberOfContendedAcquisitions;
+      deletedCounters.contentionTime += mutexIterator->second.counters.contentionTime;
+      state.mutexes.erase(mutexIterator);
+
+      // The handle can be reused by a new mutex, so the lock order of the deleted mutex is removed
+      state.lockOrder.erase(event.mutex);
+      for (auto& acquiredMutexes : state.lockOrder)
+        acquiredMutexes.second.erase(event.mutex);
+      for (auto it = state.invertedLockOrder.begin(); it != state.invertedLockOrder.end();) {
+        if (it->first == event.mutex || it->second == event.mutex)
+          it = state.invertedLockOrder.erase(it);
+        else
+          it++;
+      }
+      break;
+    }
+
+    case LockEventType::waitStart:
+    case LockEventType::waitEnd: {
+      MonitoredTask& task = state.tasks[event.task];
+      task.nameIndex = event.nameIndex;
+      task.waitedMutex = (event.type == LockEventType::waitStart) ? event.mutex : NULL;
+      break;
+    }
+
+    case LockEventType::acquire:
+      OnAcquired(state, event);
+      break;
+
+    case LockEventType::release:
+      OnReleased(state, event);
+      break;
+  }
+}
+
+//==============================================================================
+
+static void OnAcquired(LockMonitorState& state, const LockEvent& event) {
+  MonitoredMutex& monitoredMutex = state.mutexes[event.mutex];
+  monitoredMutex.counters.numberOfAcquisitions++;
+  if (event.contended) {
+    monitoredMutex.counters.numberOfContendedAcquisitions++;
+    monitoredMutex.counters.contentionTime += event.contentionTime;
+  }
+
+  MonitoredTask& task = state.tasks[event.task];
+  task.nameIndex = event.nameIndex;
+  std::vector<HeldLock>& heldLocks = task.heldLocks;
+  auto heldLock = std::find_if(heldLocks.begin(), heldLocks.end(), [&](const HeldLock& heldLock) { return heldLock.mutex == event.mutex; });
+  if (heldLock != heldLocks.end()) {
+    // The recursive acquisition of a held mutex does not block
+    heldLock->numberOfAcquisitions++;
+    return;
+  }
+
+  if (event.blocking) {
+    uint16_t acquiredMutexNameIndex = monitoredMutex.nameIndex;
+    for (auto& heldLock : heldLocks) {
+      auto& acquiredMutexes = state.lockOrder[heldLock.mutex];
+      if (acquiredMutexes.count(event.mutex))
+        continue;
+      // A cycle of any length in the lock order graph (not only a reversed pair) is a potential deadlock
+      if (!state.invertedLockOrder.count({heldLock.mutex, event.mutex}) && IsLockOrderPath(state, event.mutex, heldLock.mutex)) {
+        state.invertedLockOrder.insert({heldLock.mutex, event.mutex});
+        state.orderInversions.push_back({state.mutexNames.names[state.mutexes[heldLock.mutex].nameIndex],
+          state.mutexNames.names[acquiredMutexNameIndex], state.taskNames.names[event.nameIndex]});
+      }
+      acquiredMutexes.insert(event.mutex);
+    }
+  }
+  heldLocks.push_back({event.mutex, 1});
+}
+
+//==============================================================================
+
+static void OnReleased(LockMonitorState& state, const LockEvent& event) {
+  auto taskIterator = state.tasks.find(event.task);
+  if (taskIterator == state.tasks.end())
+    return;
+  std::vector<HeldLock>& heldLocks = taskIterator->second.heldLocks;
+  auto heldLock = std::find_if(heldLocks.begin(), heldLocks.end(), [&](const HeldLock& heldLock) { return heldLock.mutex == event.mutex; });
+  if (heldLock != heldLocks.end() && --heldLock->numberOfAcquisitions == 0)
+    heldLocks.erase(heldLock);
+  if (heldLocks.empty() && !taskIterator->second.waitedMutex)
+    state.tasks.erase(taskIterator);
+}
+
+//==============================================================================
+
+static bool IsLockOrderPath(LockMonitorState& state, QueueHandle_t from, QueueHandle_t to) {
+  std::vector<QueueHandle_t> pendingMutexes = {from};
+  std::unordered_set<QueueHandle_t> visitedMutexes = {from};
+  while (!pendingMutexes.empty()) {
+    QueueHandle_t mutex = pendingMutexes.back();
+    pendingMutexes.pop_back();
+    if (mutex == to)
+      return true;
+    auto acquiredMutexes = state.lockOrder.find(mutex);
+    if (acquiredMutexes == state.lockOrder.end())
+      continue;
+    for (auto acquiredMutex : acquiredMutexes->second) {
+      if (visitedMutexes.insert(acquiredMutex).second)
+        pendingMutexes.push_back(acquiredMutex);
+    }
+  }
+  return false;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <cstddef>
+
+//==============================================================================
+
+/// @brief Lock monitor of the host (Linux) target
+/// @details Monitors the recursive FreeRTOS mutexes (PL::Mutex) by wrapping the FreeRTOS mutex functions at link time.
+/// Counts the acquisitions and the time spent waiting for each mutex and checks the lock order:
+/// a blocking acquisition of a mutex while another mutex is held records the order of the two mutexes,
+/// and an acquisition that closes a cycle in the recorded order (the same two mutexes in the reverse order or a longer cycle, like A-B, B-C, C-A)
+/// is reported as an order inversion (potential deadlock). Try-locks (zero timeout) do not record the lock order, because they cannot deadlock.
+/// The mutex functions only copy the events to a preallocated buffer in a critical section, the events are analyzed outside of it.
+/// The mutexes are named by the first PL function (except PL::Mutex) in the backtrace of their creation.
+class LockMonitor {
+public:
+  /// @brief Resets the acquisition counters, the contention times and the lock order
+  static void Reset();
+
+  /// @brief Gets the number of lock order inversions since the reset
+  /// @return number of lock order inversions
+  static size_t GetNumberOfOrderInversions();
+
+  /// @brief Prints the acquisitions and the contention time of the mutexes (grouped by name) as JSON lines
+  static void PrintContentionReport();
+
+  /// @brief Prints the lock order inversions
+  static void PrintOrderInversions();
+
+  /// @brief Prints the mutexes held and waited for by each task
+  static void PrintHeldLocks();
+};
\ No newline at end of file
@@ -1,5 +1,12 @@
 #include "blackbox.h"
 #include "unity.h"
+#include "soc/soc_caps.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "mbedtls/sha256.h"
+#endif
+#include "freertos/semphr.h"
+#include <atomic>
+#include <sys/time.h>
 
 //==============================================================================
 
@@ -7,6 +14,11 @@ static std::shared_ptr<BlackBox> blackBox = std::make_shared<BlackBox>();
 const PL::BlackBoxHardwareInfo BlackBox::hardwareInfo = {"Test Hardware", {1, 2, 3}, "1234567890"};
 const PL::BlackBoxFirmwareInfo BlackBox::firmwareInfo = {"Test Firmware", {4, 5, 6}};
 static const std::string testName = "Test Name";
+static const TickType_t firmwareUpdateTimeout = 10000 / portTICK_PERIOD_MS;
+static const TickType_t deadlockTimeout = 10000 / portTICK_PERIOD_MS;
+static const size_t numberOfConcurrentOperations = 20;
+static const size_t numberOfEventRecordingTasks = 4;
+static const uint16_t eventRecordingTaskCode = 100;
 
 std::shared_ptr<PL::Uart> uart = std::make_shared<PL::Uart>(UART_NUM_1);
 const uint32_t baudRate = 19200;
@@ -22,7 +34,7 @@ const PL::IpV4Address netmask(4, 3, 2, 1);
 const PL::IpV4Address gateway(5, 6, 7, 8);
 const std::string ssid = CONFIG_TEST_WIFI_SSID;
 const std::string password = CONFIG_TEST_WIFI_PASSWORD;
-const TickType_t connectionTimeout = 5000 / portTICK_PERIOD_MS;
+const TickType_t connectionTimeout = CONFIG_TEST_CONNECTION_TIMEOUT / portTICK_PERIOD_MS;
 
 std::shared_ptr<PL::ModbusServer> uartModbusServer = std::make_shared<PL::ModbusServer>(uart, PL::ModbusProtocol::rtu, 1);
 
@@ -36,6 +48,14 @@ const PL::ModbusProtocol networkModbusServerProtocol = PL::ModbusProtocol::tcp;
 
 //==============================================================================
 
+static PL::BlackBoxFirmwareUpdateStatus WaitForFirmwareUpdate(PL::BlackBoxFirmwareUpdater& firmwareUpdater);
+#if !CONFIG_IDF_TARGET_LINUX
+static void HttpGeneralConfigurationTask(void* parameters);
+#endif
+static void EventRecordingTask(void* parameters);
+
+//==============================================================================
+
 void TestBlackBox() {
   auto uartConfiguration = blackBox->AddUartConfiguration(uart, "uart");
   uartConfiguration->baudRate.SetValidValues(validBaudRates);
@@ -91,6 +111,14 @@ void TestBlackBox() {
   blackBox->ClearRestartedFlag();
   TEST_ASSERT(!blackBox->GetRestartedFlag());
 
+  auto resetInfo = blackBox->GetResetInfo();
+  TEST_ASSERT_EQUAL(esp_reset_reason(), resetInfo.reason);
+  TEST_ASSERT(resetInfo.resetCounter > 0);
+  blackBox->ClearResetInfo();
+  resetInfo = blackBox->GetResetInfo();
+  TEST_ASSERT_EQUAL(0, resetInfo.abnormalResetCounter);
+  TEST_ASSERT_EQUAL(ESP_RST_UNKNOWN, resetInfo.lastAbnormalResetReason);
+
   auto hardwareInterfaceConfigurations = blackBox->GetHardwareInterfaceConfigurations();
   TEST_ASSERT(hardwareInterfaceConfigurations[0] == uartConfiguration);
   TEST_ASSERT(hardwareInterfaceConfigurations[1] == wifiConfiguration);
@@ -99,6 +127,23 @@ void TestBlackBox() {
   TEST_ASSERT(serverConfigurations[0] == uartModbusServerConfiguration);
   TEST_ASSERT(serverConfigurations[1] == networkModbusServerConfiguration);
 
+  TEST_ASSERT_EQUAL(2, blackBox->GetNumberOfHardwareInterfaceConfigurations());
+  TEST_ASSERT(blackBox->GetHardwareInterfaceConfiguration(1) == wifiConfiguration);
+  TEST_ASSERT(blackBox->GetHardwareInterfaceConfiguration(2) == nullptr);
+  TEST_ASSERT(blackBox->GetHardwareInterfaceConfiguration(uart->GetName()) == uartConfiguration);
+  TEST_ASSERT(blackBox->GetHardwareInterfaceConfiguration(PL::BlackBoxHardwareInterfaceType::wifiStation) == wifiConfiguration);
+  TEST_ASSERT_EQUAL(1, blackBox->GetHardwareInterfaceConfigurationIndex(*wifiConfiguration));
+  TEST_ASSERT_EQUAL(1, blackBox->GetServerConfigurationIndex(*networkModbusServerConfiguration));
+  TEST_ASSERT_EQUAL(1, blackBox->GetNumberOfHardwareInterfaceConfigurations(PL::BlackBoxHardwareInterfaceType::uart));
+  TEST_ASSERT_EQUAL(2, blackBox->GetNumberOfServerConfigurations());
+  TEST_ASSERT(blackBox->GetServerConfiguration(PL::BlackBoxServerType::streamModbusServer) == uartModbusServerConfiguration);
+  TEST_ASSERT(blackBox->GetServerConfiguration(PL::BlackBoxServerType::networkModbusServer) == networkModbusServerConfiguration);
+  TEST_ASSERT(blackBox->GetConfiguration("wifi") == wifiConfiguration);
+  TEST_ASSERT(blackBox->GetConfiguration(PL::BlackBox::defaultGeneralConfigurationNvsNamespaceName) != nullptr);
+  size_t numberOfVisitedServerConfigurations = 0;
+  blackBox->ForEachServerConfiguration([&](PL::BlackBoxServerConfiguration& configuration) { numberOfVisitedServerConfigurations++; });
+  TEST_ASSERT_EQUAL(2, numberOfVisitedServerConfigurations);
+
   TEST_ASSERT(uartConfiguration->baudRate.SetValue(0) == ESP_ERR_INVALID_ARG);
   TEST_ASSERT(uartConfiguration->baudRate.SetValue(baudRate) == ESP_OK);
   TEST_ASSERT(uartConfiguration->dataBits.SetValue(dataBits) == ESP_OK);
@@ -178,11 +223,357 @@ void TestBlackBox() {
   TEST_ASSERT_EQUAL(port, ((PL::NetworkServer*)networkModbusServer->GetBaseServer().lock().get())->GetPort());
   TEST_ASSERT_EQUAL(maxNumberOfClients, ((PL::NetworkServer*)networkModbusServer->GetBaseServer().lock().get())->GetMaxNumberOfClients());
 
+  blackBox->EnableLazyLoading();
+  TEST_ASSERT(uartConfiguration->enabled.SetValue(false) == ESP_OK);
+  blackBox->LoadAllConfigurations();
+  TEST_ASSERT(uartConfiguration->IsLoadDeferred());
+  TEST_ASSERT(uartConfiguration->enabled.GetValue());
+  TEST_ASSERT(uartConfiguration->IsLoadDeferred());
+  TEST_ASSERT_EQUAL(baudRate, uartConfiguration->baudRate.GetValue());
+  TEST_ASSERT(!uartConfiguration->IsLoadDeferred());
+  blackBox->LoadAllConfigurations();
+  TEST_ASSERT(uartConfiguration->enabled.SetValue(false) == ESP_OK);
+  TEST_ASSERT(uartModbusServerConfiguration->enabled.SetValue(false) == ESP_OK);
+  TEST_ASSERT(uartConfiguration->IsLoadDeferred() && uartModbusServerConfiguration->IsLoadDeferred());
+  TEST_ASSERT_EQUAL(baudRate, uartConfiguration->baudRate.GetValue());
+  TEST_ASSERT_EQUAL(uartModbusServerStationAddress, uartModbusServerConfiguration->stationAddress.GetValue());
+  TEST_ASSERT(!uartConfiguration->enabled.GetValue());
+  TEST_ASSERT(!uartModbusServerConfiguration->enabled.GetValue());
+  TEST_ASSERT(uartConfiguration->enabled.SetValue(true) == ESP_OK);
+  TEST_ASSERT(uartModbusServerConfiguration->enabled.SetValue(true) == ESP_OK);
+  blackBox->DisableLazyLoading();
+
+  blackBox->EnableSnapshotSaving();
+  blackBox->SaveAllConfigurations();
+  TEST_ASSERT(uartConfiguration->baudRate.SetValue(PL::Uart::defaultBaudRate) == ESP_OK);
+  TEST_ASSERT(wifiConfiguration->ssid.SetValue("") == ESP_OK);
+  blackBox->LoadAllConfigurations();
+  TEST_ASSERT_EQUAL(baudRate, uartConfiguration->baudRate.GetValue());
+  TEST_ASSERT(wifiConfiguration->ssid.GetValue() == ssid);
+  blackBox->DisableSnapshotSaving();
+
+  std::vector<uint8_t> defaultProfileData = blackBox->CreateProfile()->GetData();
+  blackBox->SetDefaultProfile(std::make_shared<PL::BlackBoxConfigurationProfile>(defaultProfileData.data(), defaultProfileData.size()));
+  blackBox->EraseAllConfigurations();
+  TEST_ASSERT(uartConfiguration->baudRate.SetValue(PL::Uart::defaultBaudRate) == ESP_OK);
+  blackBox->LoadAllConfigurations();
+  TEST_ASSERT_EQUAL(baudRate, uartConfiguration->baudRate.GetValue());
+  // The erased general configuration has no index, so the index of the default profile is kept
+  blackBox->EnableLazyLoading();
+  blackBox->LoadAllConfigurations();
+  TEST_ASSERT(uartConfiguration->IsLoadDeferred());
+  TEST_ASSERT_EQUAL(baudRate, uartConfiguration->baudRate.GetValue());
+  blackBox->DisableLazyLoading();
+  blackBox->SetDefaultProfile(nullptr);
+
+  PL::BlackBoxTlvConfigurationStorage defaultStorage, overrideStorage;
+  PL::BlackBoxOverrideConfigurationStorage storage(defaultStorage, overrideStorage);
+  const uint8_t defaultBlob[] = {1, 2}, staleBlob[] = {3, 4, 5, 6}, smallBlob[] = {7};
+  uint8_t blob[sizeof(staleBlob)];
+  size_t blobSize;
+  TEST_ASSERT(defaultStorage.Write("blob", defaultBlob, sizeof(defaultBlob)) == ESP_OK);
+  TEST_ASSERT(overrideStorage.Write("blob", staleBlob, sizeof(staleBlob)) == ESP_OK);
+  TEST_ASSERT(storage.Write("blob", defaultBlob, sizeof(defaultBlob)) == ESP_OK);
+  TEST_ASSERT(overrideStorage.Read("blob", blob, sizeof(blob), &blobSize) == ESP_ERR_NOT_FOUND);
+  TEST_ASSERT(overrideStorage.Write("blob", staleBlob, sizeof(staleBlob)) == ESP_OK);
+  TEST_ASSERT(storage.Write("blob", smallBlob, sizeof(smallBlob)) == ESP_OK);
+  TEST_ASSERT(storage.Read("blob", blob, sizeof(blob), &blobSize) == ESP_OK);
+  TEST_ASSERT(blobSize == sizeof(smallBlob) && blob[0] == smallBlob[0]);
+
+  uint64_t configurationGeneration = blackBox->GetConfigurationGeneration();
+  PL::BlackBoxJsonConfigurationStorage jsonStorage;
+  TEST_ASSERT(jsonStorage.SetJson("{\"baudRate\": 9600, \"enabled\": true}") == ESP_OK);
+  uartConfiguration->LoadParameters(jsonStorage);
+  TEST_ASSERT_EQUAL(9600, uartConfiguration->baudRate.GetValue());
+  TEST_ASSERT(blackBox->GetConfigurationGeneration() != configurationGeneration);
+  PL::BlackBoxJsonConfigurationStorage resultingJsonStorage;
+  uartConfiguration->SaveParameters(resultingJsonStorage);
+  TEST_ASSERT(jsonStorage.IsSubsetOf(resultingJsonStorage));
+  TEST_ASSERT(jsonStorage.SetJson("{\"baudRate\": -1}") == ESP_ERR_INVALID_ARG);
+  TEST_ASSERT(uartConfiguration->baudRate.SetValue(baudRate) == ESP_OK);
+
+  const std::string storedPassword = "Stored Password";
+  TEST_ASSERT(jsonStorage.SetJson("{\"wifiPass\": " + PL::BlackBoxJsonConfigurationStorage::EncodeString(storedPassword) + "}") == ESP_OK);
+  wifiConfiguration->LoadParameters(jsonStorage);
+  TEST_ASSERT(wifiConfiguration->password.GetValue() == storedPassword);
+#if !CONFIG_IDF_TARGET_LINUX
+  std::string configurationJson = PL::BlackBoxHttpServer::GetConfigurationJson(*wifiConfiguration, wifiConfiguration->GetHardwareInterface()->GetName(), (uint8_t)wifiConfiguration->GetType());
+  TEST_ASSERT(configurationJson.find(storedPassword) == std::string::npos);
+  TEST_ASSERT(configurationJson.find(PL::BlackBoxWiFiStationConfiguration::passwordNvsKey) == std::string::npos);
+  TEST_ASSERT(configurationJson.find(wifiConfiguration->ssid.GetValue()) != std::string::npos);
+#endif
+  // Event stream sends the changed configuration with the same JSON
+  std::shared_ptr<PL::BlackBoxConfiguration> passwordChangedConfiguration;
+  uint32_t passwordChangeObserverId = blackBox->AddChangeObserver([&](PL::BlackBoxChangeType type, std::shared_ptr<PL::BlackBoxConfiguration> configuration) {
+    if (type == PL::BlackBoxChangeType::configuration)
+      passwordChangedConfiguration = configuration;
+  });
+  TEST_ASSERT(wifiConfiguration->password.SetValue(password) == ESP_OK);
+  blackBox->RemoveChangeObserver(passwordChangeObserverId);
+  TEST_ASSERT(passwordChangedConfiguration == wifiConfiguration);
+#if !CONFIG_IDF_TARGET_LINUX
+  configurationJson = PL::BlackBoxHttpServer::GetConfigurationJson(*passwordChangedConfiguration, wifiConfiguration->GetHardwareInterface()->GetName(),
+    (uint8_t)wifiConfiguration->GetType());
+  TEST_ASSERT(password.empty() || configurationJson.find(password) == std::string::npos);
+  // The HTTP server reads and writes the general configuration concurrently with the saving, so both must lock in the same order
+  SemaphoreHandle_t httpTaskDone = xSemaphoreCreateBinary();
+  TEST_ASSERT(xTaskCreate(HttpGeneralConfigurationTask, "http", 4096, httpTaskDone, tskIDLE_PRIORITY + 1, NULL) == pdPASS);
+  for (size_t i = 0; i < numberOfConcurrentOperations; i++)
+    blackBox->SaveAllConfigurations();
+  TEST_ASSERT(xSemaphoreTake(httpTaskDone, deadlockTimeout) == pdTRUE);
+  vSemaphoreDelete(httpTaskDone);
+#endif
+
+  std::shared_ptr<PL::BlackBoxConfiguration> changedConfiguration;
+  uint32_t changeObserverId = blackBox->AddChangeObserver([&](PL::BlackBoxChangeType type, std::shared_ptr<PL::BlackBoxConfiguration> configuration) {
+    if (type == PL::BlackBoxChangeType::configuration)
+      changedConfiguration = configuration;
+  });
+  TEST_ASSERT(uartConfiguration->baudRate.SetValue(PL::Uart::defaultBaudRate) == ESP_OK);
+  TEST_ASSERT(changedConfiguration == uartConfiguration);
+  blackBox->RemoveChangeObserver(changeObserverId);
+  changedConfiguration = nullptr;
+  TEST_ASSERT(uartConfiguration->baudRate.SetValue(baudRate) == ESP_OK);
+  TEST_ASSERT(changedConfiguration == nullptr);
+
+  std::vector<uint8_t> records;
+  uint32_t streamBaudRate = 9600;
+  PL::BlackBoxStreamProtocol::AppendRecord(records, (uint8_t)PL::BlackBoxConfigurationValueType::u32, "baudRate", &streamBaudRate, sizeof(streamBaudRate));
+  std::vector<uint8_t> sections;
+  PL::BlackBoxStreamProtocol::AppendSection(sections, "uart", records);
+  auto frame = PL::BlackBoxStreamProtocol::EncodeFrame((uint8_t)PL::BlackBoxStreamCommand::writeConfiguration, sections.data(), sections.size());
+  uint8_t command;
+  std::vector<uint8_t> payload;
+  size_t frameSize;
+  TEST_ASSERT(PL::BlackBoxStreamProtocol::DecodeFrame(frame.data(), frame.size() - 1, command, payload, frameSize) == PL::BlackBoxStreamDecodeResult::incomplete);
+  TEST_ASSERT(PL::BlackBoxStreamProtocol::DecodeFrame(frame.data(), frame.size(), command, payload, frameSize) == PL::BlackBoxStreamDecodeResult::ok);
+  TEST_ASSERT(command == (uint8_t)PL::BlackBoxStreamCommand::writeConfiguration && payload == sections && frameSize == frame.size());
+  frame[PL::BlackBoxStreamProtocol::headerSize] ^= 1;
+  TEST_ASSERT(PL::BlackBoxStreamProtocol::DecodeFrame(frame.data(), frame.size(), command, payload, frameSize) == PL::BlackBoxStreamDecodeResult::invalid);
+  PL::BlackBoxConfigurationProfile streamProfile;
+  TEST_ASSERT(streamProfile.SetData(sections.data(), sections.size()) == ESP_OK);
+  TEST_ASSERT(streamProfile.GetSectionNames() == std::vector<std::string>{"uart"});
+  PL::BlackBoxTlvConfigurationStorage streamParameters;
+  uartConfiguration->SaveParameters(streamParameters);
+  TEST_ASSERT(!streamProfile.GetSection("uart")->IsSubsetOf(streamParameters));
+  uartConfiguration->LoadParameters(*streamProfile.GetSection("uart"));
+  uartConfiguration->SaveParameters(streamParameters);
+  TEST_ASSERT(streamProfile.GetSection("uart")->IsSubsetOf(streamParameters));
+  TEST_ASSERT(uartConfiguration->baudRate.SetValue(baudRate) == ESP_OK);
+
+#if !CONFIG_IDF_TARGET_LINUX
+  auto blackBoxHttpServer = std::make_shared<PL::BlackBoxHttpServer>(blackBox);
+  PL::BlackBoxNetworkServerConfiguration blackBoxHttpServerConfiguration(blackBoxHttpServer, "bbHttp");
+  TEST_ASSERT(blackBoxHttpServerConfiguration.port.SetValue(8080) == ESP_OK);
+  TEST_ASSERT(blackBoxHttpServerConfiguration.maxNumberOfClients.SetValue(2) == ESP_OK);
+  TEST_ASSERT(blackBoxHttpServerConfiguration.enabled.SetValue(false) == ESP_OK);
+  blackBoxHttpServerConfiguration.Apply();
+  TEST_ASSERT_EQUAL(8080, blackBoxHttpServer->GetPort());
+  TEST_ASSERT_EQUAL(2, blackBoxHttpServer->GetMaxNumberOfClients());
+  TEST_ASSERT(!blackBoxHttpServer->IsEnabled());
+#endif
+
+  PL::BlackBoxStreamServer streamServer(blackBox, uart);
+  std::vector<uint8_t> streamResponse;
+  TEST_ASSERT(streamServer.ReadConfiguration({}, streamResponse) == PL::BlackBoxStreamStatus::ok);
+  std::string streamResponseData(streamResponse.begin(), streamResponse.end());
+  TEST_ASSERT(streamResponseData.find(wifiConfiguration->GetNvsNamespaceName()) != std::string::npos);
+  TEST_ASSERT(streamResponseData.find(PL::BlackBoxWiFiStationConfiguration::passwordNvsKey) == std::string::npos);
+  TEST_ASSERT(password.empty() || streamResponseData.find(password) == std::string::npos);
+  std::vector<uint8_t> streamRequest(streamResponse.begin() + 2, streamResponse.begin() + 2 + (streamResponse[0] | (streamResponse[1] << 8)));
+  bool streamGenerationFound = false;
+  PL::BlackBoxStreamProtocol::ForEachRecord(streamRequest.data(), streamRequest.size(), [&](uint8_t type, const std::string& key, const uint8_t* value, size_t size) {
+    if (key == uartConfiguration->GetNvsNamespaceName())
+      streamGenerationFound = PL::BlackBoxStreamProtocol::ReadU32(value) == uartConfiguration->GetGeneration() + blackBox->GetGenerationEpoch();
+  });
+  TEST_ASSERT(streamGenerationFound);
+  TEST_ASSERT(streamServer.ReadConfiguration(streamRequest, streamResponse) == PL::BlackBoxStreamStatus::ok);
+  PL::BlackBoxConfigurationProfile streamResponseProfile;
+  size_t streamResponseGenerationsSize = streamResponse[0] | (streamResponse[1] << 8);
+  TEST_ASSERT(streamResponseProfile.SetData(streamResponse.data() + 2 + streamResponseGenerationsSize, streamResponse.size() - 2 - streamResponseGenerationsSize) == ESP_OK);
+  TEST_ASSERT(!streamResponseProfile.GetSection(uartConfiguration->GetNvsNamespaceName()));
+  PL::BlackBoxTlvConfigurationStorage deviceNameParameters;
+  deviceNameParameters.Write(PL::BlackBox::generalConfigurationDeviceNameNvsKey, std::string("Stream Name"));
+  std::vector<uint8_t> deviceNameSections;
+  PL::BlackBoxStreamProtocol::AppendSection(deviceNameSections, blackBox->GetGeneralConfigurationNvsNamespaceName(), deviceNameParameters.GetData());
+  TEST_ASSERT(streamServer.WriteConfiguration(deviceNameSections) == PL::BlackBoxStreamStatus::ok);
+  TEST_ASSERT(blackBox->GetDeviceName() == "Stream Name");
+  blackBox->SetDeviceName(testName);
+
+  uint32_t eventSequenceNumber = PL::BlackBoxEventRecorder::GetNextSequenceNumber();
+  PL::BlackBoxEventRecorder::Record(PL::BlackBoxEventType::user, 1, 2);
+  PL::BlackBoxEvent event;
+  TEST_ASSERT(PL::BlackBoxEventRecorder::ReadEvent(eventSequenceNumber, event) == ESP_OK);
+  TEST_ASSERT(event.sequenceNumber == eventSequenceNumber && event.type == PL::BlackBoxEventType::user && event.code == 1 && event.value == 2);
+  TEST_ASSERT(PL::BlackBoxEventRecorder::ReadEvent(eventSequenceNumber + 1, event) == ESP_ERR_NOT_FOUND);
+  TEST_ASSERT(uartConfiguration->baudRate.SetValue(PL::Uart::defaultBaudRate) == ESP_OK);
+  TEST_ASSERT(PL::BlackBoxEventRecorder::ReadEvent(eventSequenceNumber + 1, event) == ESP_OK);
+  TEST_ASSERT(event.type == PL::BlackBoxEventType::configurationChanged);
+  TEST_ASSERT(uartConfiguration->baudRate.SetValue(baudRate) == ESP_OK);
+
+  // Concurrent producers wrap the ring buffer many times: the readable events are never mixed from different producers
+  SemaphoreHandle_t eventRecordingTasksDone = xSemaphoreCreateCounting(numberOfEventRecordingTasks, 0);
+  for (size_t i = 0; i < numberOfEventRecordingTasks; i++)
+    TEST_ASSERT(xTaskCreate(EventRecordingTask, "events", 4096, eventRecordingTasksDone, tskIDLE_PRIORITY + 1 + i % 2, NULL) == pdPASS);
+  for (size_t i = 0; i < numberOfEventRecordingTasks; i++)
+    TEST_ASSERT(xSemaphoreTake(eventRecordingTasksDone, deadlockTimeout) == pdTRUE);
+  vSemaphoreDelete(eventRecordingTasksDone);
+  size_t numberOfReadEvents = 0;
+  for (uint32_t sequenceNumber = PL::BlackBoxEventRecorder::GetFirstSequenceNumber(); sequenceNumber != PL::BlackBoxEventRecorder::GetNextSequenceNumber(); sequenceNumber++) {
+    if (PL::BlackBoxEventRecorder::ReadEvent(sequenceNumber, event) != ESP_OK)
+      continue;
+    numberOfReadEvents++;
+    TEST_ASSERT_EQUAL(sequenceNumber, event.sequenceNumber);
+    if (event.type == PL::BlackBoxEventType::user && event.code >= eventRecordingTaskCode)
+      TEST_ASSERT_EQUAL(event.code, event.value >> 16);
+  }
+  TEST_ASSERT(numberOfReadEvents > 0);
+
+  PL::BlackBoxHealthMonitor healthMonitor;
+  TEST_ASSERT_EQUAL(0, healthMonitor.GetHealth().sampleNumber);
+  TEST_ASSERT(healthMonitor.Sample() == ESP_OK);
+  PL::BlackBoxHealth health = healthMonitor.GetHealth();
+  TEST_ASSERT_EQUAL(1, health.sampleNumber);
+  TEST_ASSERT(health.defaultHeap.freeSize > 0 && health.defaultHeap.minFreeSize <= health.defaultHeap.freeSize);
+  TEST_ASSERT(health.defaultHeap.largestFreeBlockSize <= health.defaultHeap.freeSize);
+
+  PL::BlackBoxLinkMonitor linkMonitor(blackBox);
+  PL::BlackBoxLinkQuality linkQuality;
+  TEST_ASSERT(linkMonitor.GetLinkQuality(*wifi, linkQuality) == ESP_ERR_NOT_FOUND);
+  TEST_ASSERT(linkMonitor.Sample() == ESP_OK);
+  TEST_ASSERT(linkMonitor.GetLinkQuality(*wifi, linkQuality) == ESP_OK);
+#if SOC_WIFI_SUPPORTED
+  TEST_ASSERT(linkQuality.wifiRssi < 0 && linkQuality.wifiChannel > 0);
+#endif
+  TEST_ASSERT_EQUAL(0, linkQuality.reconnectCounter);
+  TEST_ASSERT_EQUAL(0xFFFFFFFF, linkQuality.timeSinceDisconnect);
+
+  PL::BlackBoxFirmwareUpdater firmwareUpdater;
+  uint8_t imageSha256[PL::BlackBoxFirmwareUpdater::sha256Size] = {};
+  TEST_ASSERT(firmwareUpdater.GetStatus().state == PL::BlackBoxFirmwareUpdateState::idle);
+  TEST_ASSERT(firmwareUpdater.Write(0, imageSha256, sizeof(imageSha256)) == ESP_ERR_INVALID_STATE);
+  TEST_ASSERT(firmwareUpdater.Begin(0, imageSha256) == ESP_ERR_INVALID_SIZE);
+  std::vector<uint8_t> image(4096);
+  for (size_t i = 0; i < image.size(); i++)
+    image[i] = i;
+#if CONFIG_IDF_TARGET_LINUX
+  // The host target has no OTA partitions, so the update fails before the hash is checked
+  TEST_ASSERT(firmwareUpdater.Begin(image.size(), imageSha256) == ESP_OK);
+  TEST_ASSERT(WaitForFirmwareUpdate(firmwareUpdater).error == ESP_ERR_NOT_SUPPORTED);
+  TEST_ASSERT(firmwareUpdater.GetStatus().state == PL::BlackBoxFirmwareUpdateState::error);
+#else
+  mbedtls_sha256(image.data(), image.size(), imageSha256, 0);
+  // Retransmitted data is skipped, data after a gap is rejected
+  TEST_ASSERT(firmwareUpdater.Begin(image.size(), imageSha256) == ESP_OK);
+  TEST_ASSERT(firmwareUpdater.Write(0, image.data(), 100) == ESP_OK);
+  TEST_ASSERT(firmwareUpdater.Write(0, image.data(), 200) == ESP_OK);
+  TEST_ASSERT(firmwareUpdater.Write(50, image.data() + 50, 100) == ESP_OK);
+  TEST_ASSERT_EQUAL(200, firmwareUpdater.GetStatus().receivedSize);
+  TEST_ASSERT(firmwareUpdater.Write(300, image.data() + 300, 100) == ESP_ERR_INVALID_ARG);
+  TEST_ASSERT(firmwareUpdater.Write(150, image.data() + 150, image.size() - 150) == ESP_OK);
+  PL::BlackBoxFirmwareUpdateStatus firmwareUpdateStatus = WaitForFirmwareUpdate(firmwareUpdater);
+  // The hash matches, the test image is rejected by the image verification
+  TEST_ASSERT_EQUAL(image.size(), firmwareUpdateStatus.writtenSize);
+  TEST_ASSERT(firmwareUpdateStatus.error != ESP_OK && firmwareUpdateStatus.error != ESP_ERR_INVALID_CRC);
+
+  // Hash mismatch
+  uint8_t invalidSha256[PL::BlackBoxFirmwareUpdater::sha256Size] = {};
+  TEST_ASSERT(firmwareUpdater.Begin(image.size(), invalidSha256) == ESP_OK);
+  TEST_ASSERT(firmwareUpdater.Write(0, image.data(), image.size()) == ESP_OK);
+  firmwareUpdateStatus = WaitForFirmwareUpdate(firmwareUpdater);
+  TEST_ASSERT(firmwareUpdateStatus.state == PL::BlackBoxFirmwareUpdateState::error && firmwareUpdateStatus.error == ESP_ERR_INVALID_CRC);
+
+  // Abort during the transfer
+  TEST_ASSERT(firmwareUpdater.Begin(image.size(), imageSha256) == ESP_OK);
+  TEST_ASSERT(firmwareUpdater.Write(0, image.data(), image.size() / 2) == ESP_OK);
+  TEST_ASSERT(firmwareUpdater.Abort() == ESP_OK);
+  TEST_ASSERT(WaitForFirmwareUpdate(firmwareUpdater).state == PL::BlackBoxFirmwareUpdateState::idle);
+  TEST_ASSERT(firmwareUpdater.Write(image.size() / 2, image.data() + image.size() / 2, image.size() / 2) == ESP_ERR_INVALID_STATE);
+
+  // Inactivity timeout releases the OTA partition, so the next update can begin
+  PL::BlackBoxFirmwareUpdater inactiveFirmwareUpdater(PL::BlackBoxFirmwareUpdater::defaultBufferSize, pdMS_TO_TICKS(300));
+  TEST_ASSERT(inactiveFirmwareUpdater.Begin(image.size(), imageSha256) == ESP_OK);
+  TEST_ASSERT(inactiveFirmwareUpdater.Write(0, image.data(), image.size() / 2) == ESP_OK);
+  firmwareUpdateStatus = WaitForFirmwareUpdate(inactiveFirmwareUpdater);
+  TEST_ASSERT(firmwareUpdateStatus.state == PL::BlackBoxFirmwareUpdateState::error && firmwareUpdateStatus.error == ESP_ERR_TIMEOUT);
+  TEST_ASSERT(firmwareUpdater.Begin(image.size(), imageSha256) == ESP_OK);
+  TEST_ASSERT(firmwareUpdater.Abort() == ESP_OK);
+  TEST_ASSERT(WaitForFirmwareUpdate(firmwareUpdater).state == PL::BlackBoxFirmwareUpdateState::idle);
+#endif
+
+  PL::BlackBoxSntpClient sntpClient;
+  TEST_ASSERT(sntpClient.GetServerName(0) == PL::BlackBoxSntpClient::defaultServerName);
+  TEST_ASSERT(sntpClient.SetServerName(PL::BlackBoxSntpClient::maxNumberOfServers, testName) == ESP_ERR_INVALID_ARG);
+  TEST_ASSERT(sntpClient.SetSyncInterval(PL::BlackBoxSntpClient::minSyncInterval - 1) == ESP_ERR_INVALID_ARG);
+  struct timeval testTime = {1700000000, 0};
+  TEST_ASSERT(settimeofday(&testTime, NULL) == 0);
+  PL::BlackBoxClock::Synchronize();
+  TEST_ASSERT(PL::BlackBoxClock::IsSynchronized());
+  TEST_ASSERT(PL::BlackBoxClock::GetUtcTime() / 1000000 - testTime.tv_sec <= 1);
+  TEST_ASSERT(PL::BlackBoxClock::ToUtcTime(0) / 1000000 <= testTime.tv_sec);
+
   blackBox->EraseAllConfigurations();
+
+  auto replacementUartConfiguration = std::make_shared<PL::BlackBoxUartConfiguration>(uart, "uart2");
+  TEST_ASSERT(blackBox->ReplaceConfiguration(uartConfiguration, replacementUartConfiguration) == ESP_OK);
+  TEST_ASSERT(blackBox->GetHardwareInterfaceConfiguration(0) == replacementUartConfiguration);
+  TEST_ASSERT(blackBox->GetConfiguration("uart") == nullptr);
+  TEST_ASSERT(blackBox->GetConfiguration("uart2") == replacementUartConfiguration);
+  TEST_ASSERT(blackBox->ReplaceConfiguration(replacementUartConfiguration, uartModbusServerConfiguration) == ESP_ERR_INVALID_ARG);
+  configurationGeneration = blackBox->GetConfigurationGeneration();
+  TEST_ASSERT(blackBox->RemoveConfiguration(wifiConfiguration) == ESP_OK);
+  TEST_ASSERT(blackBox->GetConfigurationGeneration() != configurationGeneration);
+  TEST_ASSERT(blackBox->RemoveConfiguration(wifiConfiguration) == ESP_ERR_NOT_FOUND);
+  TEST_ASSERT_EQUAL(SIZE_MAX, blackBox->GetHardwareInterfaceConfigurationIndex(*wifiConfiguration));
+  TEST_ASSERT_EQUAL(1, blackBox->GetNumberOfHardwareInterfaceConfigurations());
+  TEST_ASSERT(blackBox->GetHardwareInterfaceConfiguration(PL::BlackBoxHardwareInterfaceType::wifiStation) == nullptr);
+  TEST_ASSERT(blackBox->GetConfiguration("wifi") == nullptr);
 }
 
 //==============================================================================
 
 PL::BlackBoxFirmwareInfo BlackBox::GetFirmwareInfo() {
   return firmwareInfo;
+}
+
+//==============================================================================
+
+#if !CONFIG_IDF_TARGET_LINUX
+static void HttpGeneralConfigurationTask(void* parameters) {
+  auto generalConfiguration = blackBox->GetConfiguration(blackBox->GetGeneralConfigurationNvsNamespaceName());
+  PL::BlackBoxJsonConfigurationStorage jsonStorage;
+  jsonStorage.Write(PL::BlackBox::generalConfigurationDeviceNameNvsKey, testName);
+  for (size_t i = 0; i < numberOfConcurrentOperations; i++) {
+    generalConfiguration->LoadParameters(jsonStorage);
+    PL::BlackBoxHttpServer::GetConfigurationJson(*generalConfiguration, std::string(), 0);
+  }
+  xSemaphoreGive((SemaphoreHandle_t)parameters);
+  vTaskDelete(NULL);
+}
+#endif
+
+//==============================================================================
+
+static void EventRecordingTask(void* parameters) {
+  static std::atomic<uint16_t> nextTaskIndex = 0;
+  uint16_t code = eventRecordingTaskCode + nextTaskIndex++;
+  for (uint32_t i = 0; i < 16 * PL::BlackBoxEventRecorder::ringBufferCapacity; i++) {
+    PL::BlackBoxEventRecorder::Record(PL::BlackBoxEventType::user, code, ((uint32_t)code << 16) | (uint16_t)i);
+    if (i % 8 == 0)
+      taskYIELD();
+  }
+  xSemaphoreGive((SemaphoreHandle_t)parameters);
+  vTaskDelete(NULL);
+}
+
+//==============================================================================
+
+static PL::BlackBoxFirmwareUpdateStatus WaitForFirmwareUpdate(PL::BlackBoxFirmwareUpdater& firmwareUpdater) {
+  // The write task is finished when the update leaves the receiving and verifying states
+  for (TickType_t startTime = xTaskGetTickCount(); xTaskGetTickCount() - startTime < firmwareUpdateTimeout; vTaskDelay(1)) {
+    PL::BlackBoxFirmwareUpdateStatus status = firmwareUpdater.GetStatus();
+    if (status.state != PL::BlackBoxFirmwareUpdateState::receiving && status.state != PL::BlackBoxFirmwareUpdateState::verifying)
+      return status;
+  }
+  return firmwareUpdater.GetStatus();
 }
\ No newline at end of file
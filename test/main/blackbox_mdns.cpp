@@ -0,0 +1,85 @@
+#include "blackbox.h"
+#include "blackbox_mdns.h"
+#include "blackbox_trace.h"
+#include "unity.h"
+#include "pl_mdns.h"
+#include "mdns.h"
+
+//==============================================================================
+
+static auto blackBox = std::make_shared<BlackBox>();
+static const std::string hostname = "blackbox-test";
+static const std::string mdnsDeviceName = "mDNS Device";
+static const TickType_t updateTimeout = (PL::BlackBoxMdnsService::updateDelay / 1000 + 500) / portTICK_PERIOD_MS;
+
+//==============================================================================
+
+static std::string GetTxtRecord(const std::string& key);
+
+//==============================================================================
+
+void TestBlackBoxMdns() {
+  auto mdnsServer = std::make_shared<PL::MdnsServer>();
+  TEST_ASSERT(mdnsServer->SetHostname(hostname) == ESP_OK);
+  TEST_ASSERT(mdnsServer->Enable() == ESP_OK);
+  std::string deviceName = blackBox->GetDeviceName();
+  PL::BlackBoxTrace::SetHook(&traceHook);
+
+  // Enable
+  auto mdnsService = std::make_shared<PL::BlackBoxMdnsService>(blackBox);
+  TEST_ASSERT(mdnsService->Enable() == ESP_OK);
+  TEST_ASSERT(mdnsService->IsEnabled());
+  TEST_ASSERT(mdns_service_exists(PL::BlackBoxMdnsService::serviceType.c_str(), PL::BlackBoxMdnsService::serviceProtocol.c_str(), NULL));
+  TEST_ASSERT(GetTxtRecord("fw") == BlackBox::firmwareInfo.name);
+  TEST_ASSERT(GetTxtRecord("dev") == deviceName);
+
+  // Update after the change
+  traceHook.Reset();
+  blackBox->SetDeviceName(mdnsDeviceName);
+  TEST_ASSERT(GetTxtRecord("dev") == deviceName);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::mdnsUpdate, 1, updateTimeout));
+  TEST_ASSERT(GetTxtRecord("dev") == mdnsDeviceName);
+  blackBox->SetDeviceName(deviceName);
+  TEST_ASSERT(mdnsService->Update() == ESP_OK);
+  TEST_ASSERT(GetTxtRecord("dev") == deviceName);
+
+  // Disable: the changes do not add the service again
+  TEST_ASSERT(mdnsService->Disable() == ESP_OK);
+  TEST_ASSERT(!mdnsService->IsEnabled());
+  TEST_ASSERT(!mdns_service_exists(PL::BlackBoxMdnsService::serviceType.c_str(), PL::BlackBoxMdnsService::serviceProtocol.c_str(), NULL));
+  traceHook.Reset();
+  blackBox->SetDeviceName(mdnsDeviceName);
+  TEST_ASSERT(mdnsService->Update() == ESP_OK);
+  TEST_ASSERT_EQUAL(1, traceHook.GetCount(PL::BlackBoxTracePoint::mdnsUpdate));
+  // No update is scheduled, so the absence of the update is checked for the update delay
+  TEST_ASSERT(!traceHook.Wait(PL::BlackBoxTracePoint::mdnsUpdate, 2, updateTimeout));
+  TEST_ASSERT(!mdns_service_exists(PL::BlackBoxMdnsService::serviceType.c_str(), PL::BlackBoxMdnsService::serviceProtocol.c_str(), NULL));
+  blackBox->SetDeviceName(deviceName);
+
+  // Destruction with a pending update: the update timer callback does not use the destroyed service
+  TEST_ASSERT(mdnsService->Enable() == ESP_OK);
+  blackBox->SetDeviceName(mdnsDeviceName);
+  traceHook.Reset();
+  mdnsService.reset();
+  TEST_ASSERT(!traceHook.Wait(PL::BlackBoxTracePoint::mdnsUpdate, 1, updateTimeout));
+  TEST_ASSERT(!mdns_service_exists(PL::BlackBoxMdnsService::serviceType.c_str(), PL::BlackBoxMdnsService::serviceProtocol.c_str(), NULL));
+  blackBox->SetDeviceName(deviceName);
+
+  PL::BlackBoxTrace::SetHook(NULL);
+  TEST_ASSERT(mdnsServer->Disable() == ESP_OK);
+}
+
+//==============================================================================
+
+static std::string GetTxtRecord(const std::string& key) {
+  mdns_result_t* results = NULL;
+  std::string value;
+  if (mdns_lookup_selfhosted_service(NULL, PL::BlackBoxMdnsService::serviceType.c_str(), PL::BlackBoxMdnsService::serviceProtocol.c_str(), 1, &results) != ESP_OK)
+    return value;
+  for (size_t i = 0; results && i < results->txt_count; i++) {
+    if (key == results->txt[i].key && results->txt[i].value)
+      value = results->txt[i].value;
+  }
+  mdns_query_results_free(results);
+  return value;
+}
\ No newline at end of file
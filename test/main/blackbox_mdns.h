@@ -0,0 +1,5 @@
+#include "pl_blackbox.h"
+
+//==============================================================================
+
+void TestBlackBoxMdns();
\ No newline at end of file
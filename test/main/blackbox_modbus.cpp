@@ -1,5 +1,6 @@
 #include "blackbox.h"
 #include "blackbox_modbus.h"
+#include "blackbox_trace.h"
 #include "unity.h"
 
 //==============================================================================
@@ -21,7 +22,8 @@ const PL::IpV4Address netmask(5, 6, 7, 8);
 const PL::IpV4Address gateway(1, 2, 3, 4);
 const std::string ssid = "ssid";
 const std::string password = "password";
-const TickType_t connectionTimeout = 5000 / portTICK_PERIOD_MS;
+const TickType_t connectionTimeout = CONFIG_TEST_CONNECTION_TIMEOUT / portTICK_PERIOD_MS;
+const TickType_t writeTimeout = 1000 / portTICK_PERIOD_MS;
 
 const uint16_t port = 101;
 const size_t maxNumberOfClients = 11;
@@ -30,9 +32,26 @@ const PL::ModbusProtocol uartModbusServerProtocol = PL::ModbusProtocol::tcp;
 const uint8_t networkModbusServerStationAddress = 8;
 const PL::ModbusProtocol networkModbusServerProtocol = PL::ModbusProtocol::ascii;
 
+// Memory areas of the golden memory map
+static const char* generalHR = "generalConfigurationHR";
+static const char* generalIR = "generalConfigurationIR";
+static const char* hardwareInterfaceHR = "hardwareInterfaceConfigurationHR";
+static const char* hardwareInterfaceIR = "hardwareInterfaceConfigurationIR";
+static const char* serverHR = "serverConfigurationHR";
+static const char* serverIR = "serverConfigurationIR";
+
+//==============================================================================
+
+static uint16_t Register(const char* area, const char* field);
+static uint16_t Address(const char* area, const char* field);
+static uint16_t Coil(const char* area, const char* field);
+
 //==============================================================================
 
 void TestBlackBoxModbus() {
+  // The bit fields are set one by one and checked against the golden memory map register bits
+  TEST_ASSERT(PL::BlackBoxModbusServer::CheckMemoryMapBits());
+
   auto uartConfiguration = blackBox->AddUartConfiguration(uart, "uart");
   uartConfiguration->baudRate.DisableValueValidation();
   uartConfiguration->dataBits.DisableValueValidation();
@@ -67,64 +86,83 @@ void TestBlackBoxModbus() {
 
   TEST_ASSERT(server->Enable() == ESP_OK);
   vTaskDelay(10);
+  // The Modbus writes are waited for with the trace hook
+  PL::BlackBoxTrace::SetHook(&traceHook);
 
   // General
   TEST_ASSERT(client.ReadInputRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(blackBox->GetRestartedFlag(), data[1]);
-  TEST_ASSERT(memcmp(PL::BlackBoxModbusServer::plbbSignature.data(), &data[2], 4) == 0);
-  TEST_ASSERT_EQUAL(PL::BlackBoxModbusServer::memoryMapVersion, data[4]);
+  TEST_ASSERT_EQUAL(blackBox->GetRestartedFlag(), data[Register(generalIR, "restartedFlag")]);
+  TEST_ASSERT(memcmp(PL::BlackBoxModbusServer::plbbSignature.data(), &data[Register(generalIR, "plbbSignature")], 4) == 0);
+  TEST_ASSERT_EQUAL(PL::BlackBoxModbusServer::memoryMapVersion, data[Register(generalIR, "memoryMapVersion")]);
   auto hardwareInfo = blackBox->GetHardwareInfo();
-  TEST_ASSERT(hardwareInfo.name == (char*)&data[5]);
-  TEST_ASSERT_EQUAL(hardwareInfo.version.major, data[21]);
-  TEST_ASSERT_EQUAL(hardwareInfo.version.minor, data[22]);
-  TEST_ASSERT_EQUAL(hardwareInfo.version.patch, data[23]);
-  TEST_ASSERT(hardwareInfo.uid == (char*)&data[24]);
+  TEST_ASSERT(hardwareInfo.name == (char*)&data[Register(generalIR, "hardwareInfo.name")]);
+  TEST_ASSERT_EQUAL(hardwareInfo.version.major, data[Register(generalIR, "hardwareInfo.version.major")]);
+  TEST_ASSERT_EQUAL(hardwareInfo.version.minor, data[Register(generalIR, "hardwareInfo.version.minor")]);
+  TEST_ASSERT_EQUAL(hardwareInfo.version.patch, data[Register(generalIR, "hardwareInfo.version.patch")]);
+  TEST_ASSERT(hardwareInfo.uid == (char*)&data[Register(generalIR, "hardwareInfo.uid")]);
   auto firmwareInfo = blackBox->GetFirmwareInfo();
-  TEST_ASSERT(firmwareInfo.name == (char*)&data[40]);
-  TEST_ASSERT_EQUAL(firmwareInfo.version.major, data[56]);
-  TEST_ASSERT_EQUAL(firmwareInfo.version.minor, data[57]);
-  TEST_ASSERT_EQUAL(firmwareInfo.version.patch, data[58]);
-  TEST_ASSERT_EQUAL(blackBox->GetHardwareInterfaceConfigurations().size(), data[59]);
-  TEST_ASSERT_EQUAL(blackBox->GetServerConfigurations().size(), data[60]);
+  TEST_ASSERT(firmwareInfo.name == (char*)&data[Register(generalIR, "firmwareInfo.name")]);
+  TEST_ASSERT_EQUAL(firmwareInfo.version.major, data[Register(generalIR, "firmwareInfo.version.major")]);
+  TEST_ASSERT_EQUAL(firmwareInfo.version.minor, data[Register(generalIR, "firmwareInfo.version.minor")]);
+  TEST_ASSERT_EQUAL(firmwareInfo.version.patch, data[Register(generalIR, "firmwareInfo.version.patch")]);
+  TEST_ASSERT_EQUAL(blackBox->GetHardwareInterfaceConfigurations().size(), data[Register(generalIR, "numberOfHardwareInterfaces")]);
+  TEST_ASSERT_EQUAL(blackBox->GetServerConfigurations().size(), data[Register(generalIR, "numberOfServers")]);
+  TEST_ASSERT_EQUAL(blackBox->GetResetInfo().reason, data[Register(generalIR, "resetInfo.reason")]);
+  TEST_ASSERT_EQUAL(blackBox->GetResetInfo().resetCounter, *(uint32_t*)&data[Register(generalIR, "resetInfo.resetCounter")]);
 
   TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT(blackBox->GetDeviceName() == (char*)&data[2]);
+  TEST_ASSERT(blackBox->GetDeviceName() == (char*)&data[Register(generalHR, "name")]);
 
-  TEST_ASSERT(client.WriteSingleCoil(16, true, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteMultipleHoldingRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 2, sizeof(testName) / 2, testName, NULL) == ESP_OK);
-  vTaskDelay(10);
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteSingleCoil(Coil(generalHR, "clearRestartedFlag"), true, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(generalHR, "name"), sizeof(testName) / 2, testName, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 2, writeTimeout));
   TEST_ASSERT_EQUAL(false, blackBox->GetRestartedFlag());
   TEST_ASSERT(blackBox->GetDeviceName() == testName);
 
+  char longName[PL::BlackBoxModbusServer::maxNameSize];
+  memset(longName, 'N', sizeof(longName));
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(generalHR, "name"), sizeof(longName) / 2, longName, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 1, writeTimeout));
+  TEST_ASSERT(blackBox->GetDeviceName() == std::string(sizeof(longName) - 1, 'N'));
+  TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
+  TEST_ASSERT(memchr(&data[Register(generalHR, "name")], 0, PL::BlackBoxModbusServer::maxNameSize));
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(generalHR, "name"), sizeof(testName) / 2, testName, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 1, writeTimeout));
+
   uint16_t hardwareInterfaceIndexToSet;
   uint16_t actualHardwareInterfaceIndex;
 
   // UART
   hardwareInterfaceIndexToSet = 0;
   TEST_ASSERT(uartConfiguration->enabled.SetValue(true) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 18, hardwareInterfaceIndexToSet, NULL) == ESP_OK);
-  vTaskDelay(10);
-  TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 18, 1, &actualHardwareInterfaceIndex, NULL) == ESP_OK);
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(generalHR, "selectedHardwareInterfaceIndex"), hardwareInterfaceIndexToSet, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 1, writeTimeout));
+  TEST_ASSERT(client.ReadHoldingRegisters(Address(generalHR, "selectedHardwareInterfaceIndex"), 1, &actualHardwareInterfaceIndex, NULL) == ESP_OK);
   TEST_ASSERT_EQUAL(hardwareInterfaceIndexToSet, actualHardwareInterfaceIndex);
   TEST_ASSERT(client.ReadInputRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(PL::BlackBoxHardwareInterfaceType::uart, data[2]);
-  TEST_ASSERT(uart->GetName() == (char*)&data[3]);
+  TEST_ASSERT_EQUAL(PL::BlackBoxHardwareInterfaceType::uart, data[Register(hardwareInterfaceIR, "common.type")]);
+  TEST_ASSERT(uart->GetName() == (char*)&data[Register(hardwareInterfaceIR, "common.name")]);
 
   TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(1, data[0]);
-  TEST_ASSERT_EQUAL(uart->GetBaudRate(), *(uint32_t*)&data[2]);
-  TEST_ASSERT_EQUAL(uart->GetDataBits(), data[4]);
-  TEST_ASSERT_EQUAL(uart->GetParity(), data[5]);
-  TEST_ASSERT_EQUAL(uart->GetStopBits(), data[6]);
-  TEST_ASSERT_EQUAL(uart->GetFlowControl(), data[7]);
-
-  TEST_ASSERT(client.WriteSingleCoil(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, false, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteMultipleHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 2, 2, &baudRate, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 4, dataBits, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 5, (uint16_t)parity, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 6, (uint16_t)stopBits, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 7, (uint16_t)flowControl, NULL) == ESP_OK);
-  vTaskDelay(10);
+  TEST_ASSERT_EQUAL(1, data[Register(hardwareInterfaceHR, "common.enabled")]);
+  TEST_ASSERT_EQUAL(uart->GetBaudRate(), *(uint32_t*)&data[Register(hardwareInterfaceHR, "uart.baudRate")]);
+  TEST_ASSERT_EQUAL(uart->GetDataBits(), data[Register(hardwareInterfaceHR, "uart.dataBits")]);
+  TEST_ASSERT_EQUAL(uart->GetParity(), data[Register(hardwareInterfaceHR, "uart.parity")]);
+  TEST_ASSERT_EQUAL(uart->GetStopBits(), data[Register(hardwareInterfaceHR, "uart.stopBits")]);
+  TEST_ASSERT_EQUAL(uart->GetFlowControl(), data[Register(hardwareInterfaceHR, "uart.flowControl")]);
+
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteSingleCoil(Coil(hardwareInterfaceHR, "common.enabled"), false, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(hardwareInterfaceHR, "uart.baudRate"), 2, &baudRate, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(hardwareInterfaceHR, "uart.dataBits"), dataBits, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(hardwareInterfaceHR, "uart.parity"), (uint16_t)parity, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(hardwareInterfaceHR, "uart.stopBits"), (uint16_t)stopBits, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(hardwareInterfaceHR, "uart.flowControl"), (uint16_t)flowControl, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 6, writeTimeout));
   TEST_ASSERT(!uartConfiguration->enabled.GetValue());
   TEST_ASSERT_EQUAL(baudRate, uartConfiguration->baudRate.GetValue());
   TEST_ASSERT_EQUAL(dataBits, uartConfiguration->dataBits.GetValue());
@@ -136,43 +174,44 @@ void TestBlackBoxModbus() {
   hardwareInterfaceIndexToSet = 1;
   TEST_ASSERT(wifiConfiguration->enabled.SetValue(true) == ESP_OK);
   TEST_ASSERT(wifiConfiguration->ipV4DhcpClientEnabled.SetValue(true) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 18, hardwareInterfaceIndexToSet, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(generalHR, "selectedHardwareInterfaceIndex"), hardwareInterfaceIndexToSet, NULL) == ESP_OK);
   vTaskDelay(connectionTimeout);
-  TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 18, 1, &actualHardwareInterfaceIndex, NULL) == ESP_OK);
+  TEST_ASSERT(client.ReadHoldingRegisters(Address(generalHR, "selectedHardwareInterfaceIndex"), 1, &actualHardwareInterfaceIndex, NULL) == ESP_OK);
   TEST_ASSERT_EQUAL(hardwareInterfaceIndexToSet, actualHardwareInterfaceIndex);
   TEST_ASSERT(wifi->IsConnected());
   TEST_ASSERT(wifi->GetIpV4Address().u32);
   TEST_ASSERT(wifi->GetIpV6LinkLocalAddress().u32[0]);
   TEST_ASSERT(client.ReadInputRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(1, data[0]);
-  TEST_ASSERT_EQUAL(PL::BlackBoxHardwareInterfaceType::wifiStation, data[2]);
-  TEST_ASSERT(wifi->GetName() == (char*)&data[3]);
+  TEST_ASSERT_EQUAL(1, data[Register(hardwareInterfaceIR, "networkInterface.connected")]);
+  TEST_ASSERT_EQUAL(PL::BlackBoxHardwareInterfaceType::wifiStation, data[Register(hardwareInterfaceIR, "networkInterface.type")]);
+  TEST_ASSERT(wifi->GetName() == (char*)&data[Register(hardwareInterfaceIR, "networkInterface.name")]);
   auto ipV6LinkLocalAddress = wifi->GetIpV6LinkLocalAddress();
-  TEST_ASSERT_EQUAL(ipV6LinkLocalAddress.u32[0], ((uint32_t*)&data[19])[0]);
-  TEST_ASSERT_EQUAL(ipV6LinkLocalAddress.u32[1], ((uint32_t*)&data[19])[1]);
-  TEST_ASSERT_EQUAL(ipV6LinkLocalAddress.u32[2], ((uint32_t*)&data[19])[2]);
-  TEST_ASSERT_EQUAL(ipV6LinkLocalAddress.u32[3], ((uint32_t*)&data[19])[3]);
+  TEST_ASSERT_EQUAL(ipV6LinkLocalAddress.u32[0], ((uint32_t*)&data[Register(hardwareInterfaceIR, "networkInterface.ipV6LinkLocalAddress")])[0]);
+  TEST_ASSERT_EQUAL(ipV6LinkLocalAddress.u32[1], ((uint32_t*)&data[Register(hardwareInterfaceIR, "networkInterface.ipV6LinkLocalAddress")])[1]);
+  TEST_ASSERT_EQUAL(ipV6LinkLocalAddress.u32[2], ((uint32_t*)&data[Register(hardwareInterfaceIR, "networkInterface.ipV6LinkLocalAddress")])[2]);
+  TEST_ASSERT_EQUAL(ipV6LinkLocalAddress.u32[3], ((uint32_t*)&data[Register(hardwareInterfaceIR, "networkInterface.ipV6LinkLocalAddress")])[3]);
 
   TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(3, data[0]);
-  TEST_ASSERT_EQUAL(wifi->GetIpV4Address().u32, *(uint32_t*)&data[2]);
-  TEST_ASSERT_EQUAL(wifi->GetIpV4Netmask().u32, *(uint32_t*)&data[4]);
-  TEST_ASSERT_EQUAL(wifi->GetIpV4Gateway().u32, *(uint32_t*)&data[6]);
+  TEST_ASSERT_EQUAL(3, data[Register(hardwareInterfaceHR, "networkInterface.enabled")]);
+  TEST_ASSERT_EQUAL(wifi->GetIpV4Address().u32, *(uint32_t*)&data[Register(hardwareInterfaceHR, "networkInterface.ipV4Address")]);
+  TEST_ASSERT_EQUAL(wifi->GetIpV4Netmask().u32, *(uint32_t*)&data[Register(hardwareInterfaceHR, "networkInterface.ipV4Netmask")]);
+  TEST_ASSERT_EQUAL(wifi->GetIpV4Gateway().u32, *(uint32_t*)&data[Register(hardwareInterfaceHR, "networkInterface.ipV4Gateway")]);
   auto ipV6GlobalAddress = wifi->GetIpV6GlobalAddress();
-  TEST_ASSERT_EQUAL(ipV6GlobalAddress.u32[0], ((uint32_t*)&data[8])[0]);
-  TEST_ASSERT_EQUAL(ipV6GlobalAddress.u32[1], ((uint32_t*)&data[8])[1]);
-  TEST_ASSERT_EQUAL(ipV6GlobalAddress.u32[2], ((uint32_t*)&data[8])[2]);
-  TEST_ASSERT_EQUAL(ipV6GlobalAddress.u32[3], ((uint32_t*)&data[8])[3]);
-  TEST_ASSERT(wifi->GetSsid() == (char*)&data[16]);
-
-  TEST_ASSERT(client.WriteSingleCoil(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress, false, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleCoil(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 1, false, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteMultipleHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 2, 2, &ipAddress, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteMultipleHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 4, 2, &netmask, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteMultipleHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 6, 2, &gateway, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteMultipleHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 16, sizeof(ssid) / 2, ssid.data(), NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteMultipleHoldingRegisters(PL::BlackBoxModbusServer::hardwareInterfaceConfigurationMemoryAddress + 32, sizeof(password) / 2, password.data(), NULL) == ESP_OK);
-  vTaskDelay(10);
+  TEST_ASSERT_EQUAL(ipV6GlobalAddress.u32[0], ((uint32_t*)&data[Register(hardwareInterfaceHR, "networkInterface.ipV6GlobalAddress")])[0]);
+  TEST_ASSERT_EQUAL(ipV6GlobalAddress.u32[1], ((uint32_t*)&data[Register(hardwareInterfaceHR, "networkInterface.ipV6GlobalAddress")])[1]);
+  TEST_ASSERT_EQUAL(ipV6GlobalAddress.u32[2], ((uint32_t*)&data[Register(hardwareInterfaceHR, "networkInterface.ipV6GlobalAddress")])[2]);
+  TEST_ASSERT_EQUAL(ipV6GlobalAddress.u32[3], ((uint32_t*)&data[Register(hardwareInterfaceHR, "networkInterface.ipV6GlobalAddress")])[3]);
+  TEST_ASSERT(wifi->GetSsid() == (char*)&data[Register(hardwareInterfaceHR, "wifi.ssid")]);
+
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteSingleCoil(Coil(hardwareInterfaceHR, "networkInterface.enabled"), false, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleCoil(Coil(hardwareInterfaceHR, "networkInterface.ipV4DhcpClientEnabled"), false, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(hardwareInterfaceHR, "networkInterface.ipV4Address"), 2, &ipAddress, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(hardwareInterfaceHR, "networkInterface.ipV4Netmask"), 2, &netmask, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(hardwareInterfaceHR, "networkInterface.ipV4Gateway"), 2, &gateway, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(hardwareInterfaceHR, "wifi.ssid"), sizeof(ssid) / 2, ssid.data(), NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteMultipleHoldingRegisters(Address(hardwareInterfaceHR, "wifi.password"), sizeof(password) / 2, password.data(), NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 7, writeTimeout));
   TEST_ASSERT(!wifiConfiguration->enabled.GetValue());
   TEST_ASSERT(!wifiConfiguration->ipV4DhcpClientEnabled.GetValue());
   TEST_ASSERT_EQUAL(ipAddress.u32, wifiConfiguration->ipV4Address.GetValue().u32);
@@ -188,23 +227,25 @@ void TestBlackBoxModbus() {
   serverIndexToSet = 0;
   uartModbusServerConfiguration->enabled.SetValue(true);
   uartModbusServerConfiguration->Apply();
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 19, serverIndexToSet, NULL) == ESP_OK);
-  vTaskDelay(10);
-  TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 19, 1, &actualServerIndex, NULL) == ESP_OK);
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(generalHR, "selectedServerIndex"), serverIndexToSet, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 1, writeTimeout));
+  TEST_ASSERT(client.ReadHoldingRegisters(Address(generalHR, "selectedServerIndex"), 1, &actualServerIndex, NULL) == ESP_OK);
   TEST_ASSERT_EQUAL(serverIndexToSet, actualServerIndex);
   TEST_ASSERT(client.ReadInputRegisters(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(PL::BlackBoxServerType::streamModbusServer, data[2]);
-  TEST_ASSERT(uartModbusServer->GetName() == (char*)&data[3]);
+  TEST_ASSERT_EQUAL(PL::BlackBoxServerType::streamModbusServer, data[Register(serverIR, "common.type")]);
+  TEST_ASSERT(uartModbusServer->GetName() == (char*)&data[Register(serverIR, "common.name")]);
 
   TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(1, data[0]);
-  TEST_ASSERT_EQUAL(uartModbusServer->GetProtocol(), data[2]);
-  TEST_ASSERT_EQUAL(uartModbusServer->GetStationAddress(), data[3]);
+  TEST_ASSERT_EQUAL(1, data[Register(serverHR, "common.enabled")]);
+  TEST_ASSERT_EQUAL(uartModbusServer->GetProtocol(), data[Register(serverHR, "modbusServer.protocol")]);
+  TEST_ASSERT_EQUAL(uartModbusServer->GetStationAddress(), data[Register(serverHR, "modbusServer.stationAddress")]);
 
-  TEST_ASSERT(client.WriteSingleCoil(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, false, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress + 2, (uint16_t)uartModbusServerProtocol, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress + 3, uartModbusServerStationAddress, NULL) == ESP_OK);
-  vTaskDelay(10);
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteSingleCoil(Coil(serverHR, "common.enabled"), false, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(serverHR, "modbusServer.protocol"), (uint16_t)uartModbusServerProtocol, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(serverHR, "modbusServer.stationAddress"), uartModbusServerStationAddress, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 3, writeTimeout));
   TEST_ASSERT(!uartModbusServerConfiguration->enabled.GetValue());
   TEST_ASSERT_EQUAL(uartModbusServerStationAddress, uartModbusServerConfiguration->stationAddress.GetValue());
   TEST_ASSERT_EQUAL(uartModbusServerProtocol, uartModbusServerConfiguration->protocol.GetValue());
@@ -213,24 +254,55 @@ void TestBlackBoxModbus() {
   serverIndexToSet = 1;
   networkModbusServerConfiguration->enabled.SetValue(true);
   networkModbusServerConfiguration->Apply();
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 19, serverIndexToSet, NULL) == ESP_OK);
-  vTaskDelay(10);
-  TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::generalConfigurationMemoryAddress + 19, 1, &actualServerIndex, NULL) == ESP_OK);
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(generalHR, "selectedServerIndex"), serverIndexToSet, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 1, writeTimeout));
+  TEST_ASSERT(client.ReadHoldingRegisters(Address(generalHR, "selectedServerIndex"), 1, &actualServerIndex, NULL) == ESP_OK);
   TEST_ASSERT_EQUAL(serverIndexToSet, actualServerIndex);
   TEST_ASSERT(client.ReadInputRegisters(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(PL::BlackBoxServerType::networkModbusServer, data[2]);
-  TEST_ASSERT(networkModbusServer->GetName() == (char*)&data[3]);
+  TEST_ASSERT_EQUAL(PL::BlackBoxServerType::networkModbusServer, data[Register(serverIR, "common.type")]);
+  TEST_ASSERT(networkModbusServer->GetName() == (char*)&data[Register(serverIR, "common.name")]);
 
   TEST_ASSERT(client.ReadHoldingRegisters(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, PL::BlackBoxModbusServer::registerMemoryAreaSize / 2, data, NULL) == ESP_OK);
-  TEST_ASSERT_EQUAL(1, data[0]);
-  TEST_ASSERT_EQUAL(networkModbusServer->GetProtocol(), data[2]);
-  TEST_ASSERT_EQUAL(networkModbusServer->GetStationAddress(), data[3]);
+  TEST_ASSERT_EQUAL(1, data[Register(serverHR, "common.enabled")]);
+  TEST_ASSERT_EQUAL(networkModbusServer->GetProtocol(), data[Register(serverHR, "modbusServer.protocol")]);
+  TEST_ASSERT_EQUAL(networkModbusServer->GetStationAddress(), data[Register(serverHR, "modbusServer.stationAddress")]);
 
-  TEST_ASSERT(client.WriteSingleCoil(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress, false, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress + 2, (uint16_t)networkModbusServerProtocol, NULL) == ESP_OK);
-  TEST_ASSERT(client.WriteSingleHoldingRegister(PL::BlackBoxModbusServer::serverConfigurationMemoryAddress + 3, networkModbusServerStationAddress, NULL) == ESP_OK);
-  vTaskDelay(10);
+  traceHook.Reset();
+  TEST_ASSERT(client.WriteSingleCoil(Coil(serverHR, "common.enabled"), false, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(serverHR, "modbusServer.protocol"), (uint16_t)networkModbusServerProtocol, NULL) == ESP_OK);
+  TEST_ASSERT(client.WriteSingleHoldingRegister(Address(serverHR, "modbusServer.stationAddress"), networkModbusServerStationAddress, NULL) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::modbusAreaWrite, 3, writeTimeout));
   TEST_ASSERT(!networkModbusServerConfiguration->enabled.GetValue());
   TEST_ASSERT_EQUAL(networkModbusServerStationAddress, networkModbusServerConfiguration->stationAddress.GetValue());
   TEST_ASSERT_EQUAL(networkModbusServerProtocol, networkModbusServerConfiguration->protocol.GetValue());
+  PL::BlackBoxTrace::SetHook(NULL);
+}
+
+//==============================================================================
+
+static uint16_t Register(const char* area, const char* field) {
+  // The register offsets are taken from the golden memory map, so the test checks the layout that the Modbus clients use
+  auto memoryMapField = PL::FindBlackBoxModbusMemoryMapField(area, field);
+  TEST_ASSERT_NOT_NULL_MESSAGE(memoryMapField, field);
+  return memoryMapField->offset / 2;
+}
+
+//==============================================================================
+
+static uint16_t Address(const char* area, const char* field) {
+  auto memoryArea = PL::FindBlackBoxModbusMemoryArea(area);
+  TEST_ASSERT_NOT_NULL_MESSAGE(memoryArea, area);
+  return memoryArea->address + Register(area, field);
+}
+
+//==============================================================================
+
+static uint16_t Coil(const char* area, const char* field) {
+  // The coils of a holding register area start at the area address, 16 coils per register
+  auto memoryArea = PL::FindBlackBoxModbusMemoryArea(area);
+  TEST_ASSERT_NOT_NULL_MESSAGE(memoryArea, area);
+  auto memoryMapField = PL::FindBlackBoxModbusMemoryMapField(area, field);
+  TEST_ASSERT_NOT_NULL_MESSAGE(memoryMapField, field);
+  return memoryArea->address + memoryMapField->offset / 2 * 16 + memoryMapField->bit;
 }
\ No newline at end of file
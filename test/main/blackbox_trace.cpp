@@ -0,0 +1,212 @@
+#include "blackbox.h"
+#include "blackbox_trace.h"
+#include "unity.h"
+#include "esp_timer.h"
+#include <atomic>
+#include <cstring>
+
+//==============================================================================
+
+TestTraceHook traceHook;
+static auto blackBox = std::make_shared<BlackBox>();
+static std::atomic<int64_t> manualTime;
+static const int64_t manualStartTime = 123456789;
+static const TickType_t traceTimeout = 1000 / portTICK_PERIOD_MS;
+static const size_t traceRecorderCapacity = 8;
+
+//==============================================================================
+
+static int64_t GetManualTime();
+
+//==============================================================================
+
+void TestBlackBoxTrace() {
+  auto uartConfiguration = blackBox->AddUartConfiguration(uart, "traceUart");
+  uartConfiguration->dataBits.DisableValueValidation();
+  PL::BlackBoxTrace::SetHook(&traceHook);
+
+  // Parameter change
+  traceHook.Reset();
+  uint32_t eventSequenceNumber = PL::BlackBoxEventRecorder::GetNextSequenceNumber();
+  TEST_ASSERT(uartConfiguration->dataBits.SetValue((uartConfiguration->dataBits.GetValue() == 7) ? 8 : 7) == ESP_OK);
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::parameterChange, 1, traceTimeout));
+  PL::BlackBoxEvent event;
+  TEST_ASSERT(PL::BlackBoxEventRecorder::ReadEvent(eventSequenceNumber, event) == ESP_OK);
+  TEST_ASSERT(event.type == PL::BlackBoxEventType::configurationChanged);
+  TEST_ASSERT_EQUAL(event.value, traceHook.GetLastValue(PL::BlackBoxTracePoint::parameterChange));
+
+  // Save, load and apply
+  traceHook.Reset();
+  blackBox->SaveAllConfigurations();
+  auto log = traceHook.GetLog();
+  TEST_ASSERT_EQUAL(2, log.size());
+  TEST_ASSERT(log[0] == PL::BlackBoxTracePoint::saveStart && log[1] == PL::BlackBoxTracePoint::saveEnd);
+
+  traceHook.Reset();
+  blackBox->LoadAllConfigurations();
+  log = traceHook.GetLog();
+  TEST_ASSERT(log.size() >= 2);
+  TEST_ASSERT(log.front() == PL::BlackBoxTracePoint::loadStart && log.back() == PL::BlackBoxTracePoint::loadEnd);
+
+  traceHook.Reset();
+  blackBox->ApplyHardwareInterfaceConfigurations();
+  blackBox->ApplyServerConfigurations();
+  TEST_ASSERT(traceHook.Wait(PL::BlackBoxTracePoint::applyEnd, 2, traceTimeout));
+  TEST_ASSERT_EQUAL(2, traceHook.GetCount(PL::BlackBoxTracePoint::applyStart));
+
+  // Event recorder trace hook
+  PL::BlackBoxEventRecorderTraceHook eventRecorderTraceHook(PL::BlackBoxEventRecorderTraceHook::GetMaskBit(PL::BlackBoxTracePoint::saveEnd));
+  PL::BlackBoxTrace::SetHook(&eventRecorderTraceHook);
+  TEST_ASSERT(PL::BlackBoxTrace::GetHook() == &eventRecorderTraceHook);
+  eventSequenceNumber = PL::BlackBoxEventRecorder::GetNextSequenceNumber();
+  blackBox->SaveAllConfigurations();
+  PL::BlackBoxTrace::SetHook(&traceHook);
+  TEST_ASSERT(PL::BlackBoxEventRecorder::ReadEvent(eventSequenceNumber, event) == ESP_OK);
+  TEST_ASSERT(event.type == PL::BlackBoxEventType::trace);
+  TEST_ASSERT_EQUAL((uint16_t)PL::BlackBoxTracePoint::saveEnd << 8, event.code);
+  TEST_ASSERT(PL::BlackBoxEventRecorder::ReadEvent(eventSequenceNumber + 1, event) == ESP_OK);
+  TEST_ASSERT(event.type == PL::BlackBoxEventType::configurationsSaved);
+
+  // Trace recorder
+  auto traceRecorder = std::make_shared<PL::BlackBoxTraceRecorder>(traceRecorderCapacity);
+  blackBox->SetTraceRecorder(traceRecorder);
+  TEST_ASSERT(blackBox->GetTraceRecorder() == traceRecorder);
+  TEST_ASSERT(PL::BlackBoxTrace::GetHook() == traceRecorder.get());
+  blackBox->SaveAllConfigurations();
+  std::vector<uint8_t> dump = traceRecorder->GetDump();
+  PL::BlackBoxTraceDumpHeader header;
+  TEST_ASSERT(dump.size() >= sizeof(header));
+  memcpy(&header, dump.data(), sizeof(header));
+  TEST_ASSERT_EQUAL(PL::BlackBoxTraceRecorder::dumpSignature, header.signature);
+  TEST_ASSERT_EQUAL(PL::BlackBoxTraceRecorder::dumpVersion, header.version);
+  TEST_ASSERT_EQUAL(sizeof(PL::BlackBoxTraceRecord), header.recordSize);
+  TEST_ASSERT_EQUAL(1, header.numberOfTasks);
+  TEST_ASSERT_EQUAL(2, header.numberOfRecords);
+  TEST_ASSERT_EQUAL(0, header.numberOfLostRecords);
+  TEST_ASSERT_EQUAL(sizeof(header) + header.numberOfTasks * header.taskNameSize + header.numberOfRecords * header.recordSize, dump.size());
+  TEST_ASSERT_EQUAL_STRING(pcTaskGetName(NULL), (char*)dump.data() + sizeof(header));
+  PL::BlackBoxTraceRecord records[2];
+  memcpy(records, dump.data() + sizeof(header) + header.taskNameSize, sizeof(records));
+  TEST_ASSERT(records[0].tracePoint == PL::BlackBoxTracePoint::saveStart && records[1].tracePoint == PL::BlackBoxTracePoint::saveEnd);
+  TEST_ASSERT(records[0].taskIndex == 0 && records[1].taskIndex == 0);
+
+  // The oldest records are overwritten
+  for (size_t i = 0; i < traceRecorderCapacity; i++)
+    blackBox->SaveAllConfigurations();
+  TEST_ASSERT_EQUAL(traceRecorderCapacity, traceRecorder->GetNumberOfRecords());
+  dump = traceRecorder->GetDump();
+  memcpy(&header, dump.data(), sizeof(header));
+  TEST_ASSERT_EQUAL(traceRecorderCapacity, header.numberOfRecords);
+  TEST_ASSERT_EQUAL(2 * traceRecorderCapacity + 2, header.numberOfRecords + header.numberOfLostRecords);
+  memcpy(records, dump.data() + sizeof(header) + header.taskNameSize, sizeof(records));
+  TEST_ASSERT(records[0].tracePoint == PL::BlackBoxTracePoint::saveStart && records[1].tracePoint == PL::BlackBoxTracePoint::saveEnd);
+  traceRecorder->Clear();
+  TEST_ASSERT_EQUAL(0, traceRecorder->GetNumberOfRecords());
+  blackBox->SetTraceRecorder(nullptr);
+  TEST_ASSERT(PL::BlackBoxTrace::GetHook() == NULL);
+
+  // The removed trace recorders are released (SetHook waits for the tasks that pass the trace points to them)
+  std::weak_ptr<PL::BlackBoxTraceRecorder> removedTraceRecorder = traceRecorder;
+  traceRecorder.reset();
+  TEST_ASSERT(removedTraceRecorder.expired());
+  {
+    auto destroyedBlackBox = std::make_shared<BlackBox>();
+    auto destroyedBlackBoxTraceRecorder = std::make_shared<PL::BlackBoxTraceRecorder>(traceRecorderCapacity);
+    destroyedBlackBox->SetTraceRecorder(destroyedBlackBoxTraceRecorder);
+    TEST_ASSERT(PL::BlackBoxTrace::GetHook() == destroyedBlackBoxTraceRecorder.get());
+    removedTraceRecorder = destroyedBlackBoxTraceRecorder;
+  }
+  TEST_ASSERT(PL::BlackBoxTrace::GetHook() == NULL);
+  TEST_ASSERT(removedTraceRecorder.expired());
+
+  // Time source
+  manualTime = manualStartTime;
+  PL::BlackBoxClock::SetTimeSource(GetManualTime);
+  TEST_ASSERT(PL::BlackBoxClock::GetMonotonicTime() == manualStartTime);
+  eventSequenceNumber = PL::BlackBoxEventRecorder::GetNextSequenceNumber();
+  PL::BlackBoxEventRecorder::Record(PL::BlackBoxEventType::user, 3, 4);
+  TEST_ASSERT(PL::BlackBoxEventRecorder::ReadEvent(eventSequenceNumber, event) == ESP_OK);
+  TEST_ASSERT_EQUAL(manualStartTime / 1000, event.time);
+  manualTime += 1000000;
+  TEST_ASSERT(PL::BlackBoxClock::GetMonotonicTime() == manualStartTime + 1000000);
+  PL::BlackBoxClock::SetTimeSource(NULL);
+  int64_t time = esp_timer_get_time();
+  TEST_ASSERT(PL::BlackBoxClock::GetMonotonicTime() >= time);
+
+  PL::BlackBoxTrace::SetHook(NULL);
+  blackBox->EraseAllConfigurations();
+}
+
+//==============================================================================
+
+TestTraceHook::TestTraceHook() : traceSemaphore(xSemaphoreCreateBinary()) {
+  log.reserve(maxLogSize);
+}
+
+//==============================================================================
+
+TestTraceHook::~TestTraceHook() {
+  vSemaphoreDelete(traceSemaphore);
+}
+
+//==============================================================================
+
+void TestTraceHook::OnTracePoint(PL::BlackBoxTracePoint tracePoint, uint16_t code, uint32_t value) {
+  {
+    PL::LockGuard lg(mutex);
+    counts[(size_t)tracePoint]++;
+    lastValues[(size_t)tracePoint] = value;
+    if (log.size() < maxLogSize)
+      log.push_back(tracePoint);
+  }
+  xSemaphoreGive(traceSemaphore);
+}
+
+//==============================================================================
+
+void TestTraceHook::Reset() {
+  PL::LockGuard lg(mutex);
+  std::fill(counts, counts + numberOfTracePoints, 0);
+  std::fill(lastValues, lastValues + numberOfTracePoints, 0);
+  log.clear();
+}
+
+//==============================================================================
+
+size_t TestTraceHook::GetCount(PL::BlackBoxTracePoint tracePoint) {
+  PL::LockGuard lg(mutex);
+  return counts[(size_t)tracePoint];
+}
+
+//==============================================================================
+
+uint32_t TestTraceHook::GetLastValue(PL::BlackBoxTracePoint tracePoint) {
+  PL::LockGuard lg(mutex);
+  return lastValues[(size_t)tracePoint];
+}
+
+//==============================================================================
+
+std::vector<PL::BlackBoxTracePoint> TestTraceHook::GetLog() {
+  PL::LockGuard lg(mutex);
+  return log;
+}
+
+//==============================================================================
+
+bool TestTraceHook::Wait(PL::BlackBoxTracePoint tracePoint, size_t count, TickType_t timeout) {
+  // The semaphore is given after every trace point, so the count is checked again after every trace point until the timeout
+  TickType_t startTime = xTaskGetTickCount();
+  while (GetCount(tracePoint) < count) {
+    TickType_t elapsedTime = xTaskGetTickCount() - startTime;
+    if (elapsedTime >= timeout || xSemaphoreTake(traceSemaphore, timeout - elapsedTime) != pdTRUE)
+      return GetCount(tracePoint) >= count;
+  }
+  return true;
+}
+
+//==============================================================================
+
+static int64_t GetManualTime() {
+  return manualTime;
+}
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "pl_blackbox.h"
+#include "freertos/semphr.h"
+
+//==============================================================================
+
+/// @brief Trace hook that counts the BlackBox trace points, so the tests can wait for them instead of sleeping
+class TestTraceHook : public PL::BlackBoxTraceHook {
+public:
+  TestTraceHook();
+  ~TestTraceHook();
+
+  void OnTracePoint(PL::BlackBoxTracePoint tracePoint, uint16_t code, uint32_t value) override;
+
+  /// @brief Resets the trace point counters and the trace point log
+  void Reset();
+
+  /// @brief Gets the number of the trace points since the reset
+  /// @param tracePoint trace point
+  /// @return number of the trace points
+  size_t GetCount(PL::BlackBoxTracePoint tracePoint);
+
+  /// @brief Gets the value of the last trace point
+  /// @param tracePoint trace point
+  /// @return trace point value
+  uint32_t GetLastValue(PL::BlackBoxTracePoint tracePoint);
+
+  /// @brief Gets the trace points since the reset in the order they were passed
+  /// @return trace points
+  std::vector<PL::BlackBoxTracePoint> GetLog();
+
+  /// @brief Waits until the number of the trace points since the reset reaches the count
+  /// @param tracePoint trace point
+  /// @param count number of the trace points
+  /// @param timeout timeout in FreeRTOS ticks
+  /// @return true if the number of the trace points has reached the count
+  bool Wait(PL::BlackBoxTracePoint tracePoint, size_t count, TickType_t timeout);
+
+private:
+  static const size_t numberOfTracePoints = (size_t)PL::BlackBoxTracePoint::mdnsUpdate + 1;
+  static const size_t maxLogSize = 64;
+
+  PL::Mutex mutex;
+  SemaphoreHandle_t traceSemaphore;
+  size_t counts[numberOfTracePoints] = {};
+  uint32_t lastValues[numberOfTracePoints] = {};
+  std::vector<PL::BlackBoxTracePoint> log;
+};
+
+//==============================================================================
+
+extern TestTraceHook traceHook;
+
+//==============================================================================
+
+void TestBlackBoxTrace();
\ No newline at end of file
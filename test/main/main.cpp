@@ -3,6 +3,8 @@
 #include "pl_nvs.h"
 #include "blackbox.h"
 #include "blackbox_modbus.h"
+#include "blackbox_trace.h"
+#include "blackbox_mdns.h"
 
 //==============================================================================
 
@@ -28,5 +30,7 @@ extern "C" void app_main(void) {
   UNITY_BEGIN();
   RUN_TEST(TestBlackBox);
   RUN_TEST(TestBlackBoxModbus);
+  RUN_TEST(TestBlackBoxTrace);
+  RUN_TEST(TestBlackBoxMdns);
   UNITY_END();
 }
\ No newline at end of file
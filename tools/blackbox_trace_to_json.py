@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""Converts the BlackBox trace recorder dump to the Chrome/Perfetto trace JSON.
+
+The dump is downloaded from the BlackBox HTTP server (GET <URI prefix>/trace) or read from a file.
+The JSON can be opened in https://ui.perfetto.dev or chrome://tracing.
+
+Usage:
+  blackbox_trace_to_json.py http://192.168.1.10/blackbox/trace -o blackbox.json
+  blackbox_trace_to_json.py blackbox.trace -o blackbox.json
+"""
+
+import argparse
+import json
+import struct
+import sys
+import urllib.request
+
+# BlackBoxTraceDumpHeader (pl_blackbox_trace_recorder.h)
+DUMP_HEADER_FORMAT = "<IHHHHHHIIqq"
+DUMP_SIGNATURE = 0x54424C50
+DUMP_VERSION = 1
+# BlackBoxTraceRecord (pl_blackbox_trace_recorder.h)
+RECORD_FORMAT = "<IBBHI"
+UNKNOWN_TASK_INDEX = 0xFF
+
+# BlackBoxTracePoint (pl_blackbox_trace.h)
+APPLY_START, APPLY_END, SAVE_START, SAVE_END, LOAD_START, LOAD_END = range(6)
+MODBUS_AREA_READ, MODBUS_AREA_WRITE, PARAMETER_CHANGE, INTERFACE_CONNECTED, INTERFACE_DISCONNECTED, MDNS_UPDATE = range(6, 12)
+
+# Duration trace points: start trace point -> (end trace point, name per code)
+DURATIONS = {
+  APPLY_START: (APPLY_END, {0: "apply hardware interfaces", 1: "apply servers"}),
+  SAVE_START: (SAVE_END, {}),
+  LOAD_START: (LOAD_END, {}),
+}
+DURATION_NAMES = {SAVE_START: "save", LOAD_START: "load"}
+
+# ModbusMemoryType (pl_modbus)
+MODBUS_MEMORY_TYPES = {0: "coils", 1: "discreteInputs", 2: "holdingRegisters", 3: "inputRegisters"}
+# Golden BlackBox Modbus memory areas (pl_blackbox_modbus_memory_map.h): (memory type, address) -> area
+MODBUS_MEMORY_AREAS = {
+  (2, 0): "generalConfigurationHR", (3, 0): "generalConfigurationIR",
+  (2, 100): "hardwareInterfaceConfigurationHR", (3, 100): "hardwareInterfaceConfigurationIR",
+  (2, 200): "serverConfigurationHR", (3, 200): "serverConfigurationIR",
+  (2, 300): "eventLogHR", (3, 300): "eventLogIR",
+  (3, 400): "healthIR",
+  (2, 500): "firmwareUpdateHR", (3, 500): "firmwareUpdateIR",
+  (2, 600): "firmwareImageHR",
+}
+
+PROCESS_ID = 1
+
+
+def read_dump(source):
+  if source.startswith("http://") or source.startswith("https://"):
+    with urllib.request.urlopen(source) as response:
+      return response.read()
+  with open(source, "rb") as file:
+    return file.read()
+
+
+def parse_dump(dump):
+  header_size = struct.calcsize(DUMP_HEADER_FORMAT)
+  if len(dump) < header_size:
+    raise ValueError("dump is too short")
+  (signature, version, dump_header_size, record_size, task_name_size, number_of_tasks, _,
+   number_of_records, number_of_lost_records, time, utc_time) = struct.unpack_from(DUMP_HEADER_FORMAT, dump)
+  if signature != DUMP_SIGNATURE:
+    raise ValueError("invalid dump signature")
+  if version != DUMP_VERSION:
+    raise ValueError("unsupported dump version %d" % version)
+  if record_size < struct.calcsize(RECORD_FORMAT):
+    raise ValueError("invalid record size")
+  if len(dump) < dump_header_size + number_of_tasks * task_name_size + number_of_records * record_size:
+    raise ValueError("dump is truncated")
+
+  offset = dump_header_size
+  tasks = []
+  for _ in range(number_of_tasks):
+    tasks.append(dump[offset:offset + task_name_size].split(b"\0")[0].decode("utf-8", "replace"))
+    offset += task_name_size
+
+  records = []
+  for _ in range(number_of_records):
+    records.append(struct.unpack_from(RECORD_FORMAT, dump, offset))
+    offset += record_size
+
+  # The record times are the low 32 bits of the microseconds since the reset: they are extended from the newest record
+  # back to the oldest one with the 64-bit dump time, so the records can span any time as long as the gaps are below 71 minutes
+  full_times = [0] * len(records)
+  next_time = time
+  for i in reversed(range(len(records))):
+    next_time -= (next_time - records[i][0]) & 0xFFFFFFFF
+    full_times[i] = next_time
+
+  return {"tasks": tasks, "records": records, "times": full_times, "numberOfLostRecords": number_of_lost_records,
+          "time": time, "utcTime": utc_time}
+
+
+def convert(trace):
+  events = [{"name": "process_name", "ph": "M", "pid": PROCESS_ID, "args": {"name": "BlackBox"}}]
+  for task_index, task_name in enumerate(trace["tasks"]):
+    events.append({"name": "thread_name", "ph": "M", "pid": PROCESS_ID, "tid": task_index, "args": {"name": task_name or "task %d" % task_index}})
+  events.append({"name": "thread_name", "ph": "M", "pid": PROCESS_ID, "tid": UNKNOWN_TASK_INDEX, "args": {"name": "other tasks"}})
+
+  end_trace_points = {end: (start, names) for start, (end, names) in DURATIONS.items()}
+  for (_, trace_point, task_index, code, value), time in zip(trace["records"], trace["times"]):
+    event = {"pid": PROCESS_ID, "tid": task_index, "ts": time}
+    if trace_point in DURATIONS:
+      event.update({"ph": "B", "name": DURATIONS[trace_point][1].get(code, DURATION_NAMES.get(trace_point))})
+    elif trace_point in end_trace_points:
+      start, names = end_trace_points[trace_point]
+      event.update({"ph": "E", "name": names.get(code, DURATION_NAMES.get(start))})
+    elif trace_point in (MODBUS_AREA_READ, MODBUS_AREA_WRITE):
+      area = MODBUS_MEMORY_AREAS.get((code, value), "%s %d" % (MODBUS_MEMORY_TYPES.get(code, str(code)), value))
+      event.update({"ph": "i", "s": "t", "name": "%s %s" % ("modbus read" if trace_point == MODBUS_AREA_READ else "modbus write", area),
+                    "args": {"memoryType": MODBUS_MEMORY_TYPES.get(code, code), "address": value}})
+    elif trace_point == PARAMETER_CHANGE:
+      event.update({"ph": "i", "s": "t", "name": "parameter change", "args": {"nvsNamespaceNameHash": "%08x" % value}})
+    elif trace_point in (INTERFACE_CONNECTED, INTERFACE_DISCONNECTED):
+      # Interface events are shown on all tasks, because they are not caused by the task that passes them
+      event.update({"ph": "i", "s": "p", "name": "interface %d %s" % (code, "connected" if trace_point == INTERFACE_CONNECTED else "disconnected"),
+                    "args": {"hardwareInterfaceIndex": code}})
+    elif trace_point == MDNS_UPDATE:
+      event.update({"ph": "i", "s": "t", "name": "mdns update" if code else "mdns update (disabled)"})
+    else:
+      event.update({"ph": "i", "s": "t", "name": "trace point %d" % trace_point, "args": {"code": code, "value": value}})
+    events.append(event)
+
+  return {"traceEvents": events, "displayTimeUnit": "ms",
+          "metadata": {"numberOfLostRecords": trace["numberOfLostRecords"], "dumpTime": trace["time"], "dumpUtcTime": trace["utcTime"]}}
+
+
+def main():
+  parser = argparse.ArgumentParser(description="Converts the BlackBox trace recorder dump to the Chrome/Perfetto trace JSON.")
+  parser.add_argument("source", help="dump file or BlackBox HTTP server trace URL")
+  parser.add_argument("-o", "--output", help="output JSON file (standard output if not specified)")
+  arguments = parser.parse_args()
+
+  try:
+    trace = parse_dump(read_dump(arguments.source))
+  except (OSError, ValueError) as error:
+    sys.exit("error: %s" % error)
+
+  if trace["numberOfLostRecords"]:
+    print("%d oldest records have been overwritten" % trace["numberOfLostRecords"], file=sys.stderr)
+  if arguments.output:
+    with open(arguments.output, "w") as file:
+      json.dump(convert(trace), file)
+  else:
+    json.dump(convert(trace), sys.stdout)
+
+
+if __name__ == "__main__":
+  main()